@@ -1,10 +1,12 @@
 QT += core gui widgets
 
-CONFIG += c++11
+CONFIG += c++17
 
 TEMPLATE = app
 TARGET = ButtonNetwork
 
+include(buttonnetwork_core.pri)
+
 SOURCES += \
     main.cpp \
     buttonnetwork.cpp
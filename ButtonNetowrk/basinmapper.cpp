@@ -0,0 +1,270 @@
+#include "basinmapper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#include "rhskernel.h"
+#include "workerpool.h"
+
+namespace {
+
+struct CellResult {
+    BasinOutcome outcome = BasinOutcome::Unsettled;
+    int steps = 0;
+};
+
+// Euler from y until it settles, diverges or runs all steps; the descriptor
+// (low[d], high[d]) is written to desc. Same arithmetic as integrateEuler.
+template <class Kernel>
+CellResult integrateCell(const Kernel& kernel, std::vector<double>& y, std::vector<double>& dy,
+                         int steps, double h, int tailStart, const BasinSettings& s, int d, double* desc)
+{
+    const int n = kernel.nodeCount();
+    CellResult cell;
+    double* lo = desc;
+    double* hi = desc + d;
+    bool tail = false;
+
+    for (int t = 0; t < steps; ++t) {
+        kernel.eval(y.data(), dy.data());
+        double rate = 0.0;
+        for (int i = 0; i < n; ++i) rate = std::max(rate, std::fabs(dy[i]));
+        if (rate < s.settleTolerance) {
+            cell.outcome = BasinOutcome::Settled;
+            cell.steps = t;
+            std::copy(y.begin(), y.begin() + d, lo);
+            std::copy(y.begin(), y.begin() + d, hi);
+            return cell;
+        }
+
+        bool finite = true;
+        for (int i = 0; i < n; ++i) {
+            y[i] += h * dy[i];
+            if (!(std::fabs(y[i]) <= s.divergeLimit)) finite = false;
+        }
+        if (!finite) {
+            cell.outcome = BasinOutcome::Diverged;
+            cell.steps = t + 1;
+            return cell;
+        }
+
+        if (t + 1 >= tailStart) {
+            for (int i = 0; i < d; ++i) {
+                lo[i] = tail ? std::min(lo[i], y[i]) : y[i];
+                hi[i] = tail ? std::max(hi[i], y[i]) : y[i];
+            }
+            tail = true;
+        }
+    }
+
+    cell.steps = steps;
+    if (!tail) {
+        std::copy(y.begin(), y.begin() + d, lo);
+        std::copy(y.begin(), y.begin() + d, hi);
+    }
+    return cell;
+}
+
+// max-norm over (low, high), relative to the leader's widest range: min and max over
+// the tail do not depend on the phase an oscillation ends at, up to the step size
+double distance(const double* cell, const double* leader, int d)
+{
+    double m = 0.0, widest = 0.0;
+    for (int i = 0; i < 2 * d; ++i) m = std::max(m, std::fabs(cell[i] - leader[i]));
+    for (int i = 0; i < d; ++i) widest = std::max(widest, leader[d + i] - leader[i]);
+    return m / (1.0 + widest);
+}
+
+} // namespace
+
+double BasinMap::cellX(int c) const
+{
+    if (settings.width < 2) return settings.xMin;
+    return settings.xMin + (settings.xMax - settings.xMin) * c / double(settings.width - 1);
+}
+
+double BasinMap::cellY(int r) const
+{
+    if (settings.height < 2) return settings.yMin;
+    return settings.yMin + (settings.yMax - settings.yMin) * r / double(settings.height - 1);
+}
+
+bool mapBasins(const NetworkSpec& spec, const std::vector<double>& y0, int steps, double h,
+               const BasinSettings& settings, BasinMap& map, const BasinProgressFn& progress)
+{
+    const auto wallStart = std::chrono::steady_clock::now();
+    const int n = spec.nodeCount;
+
+    map = BasinMap();
+    map.settings = settings;
+    map.settings.width = std::max(1, settings.width);
+    map.settings.height = std::max(1, settings.height);
+    map.steps = steps;
+    map.h = h;
+    const BasinSettings& s = map.settings;
+    const int width = s.width;
+    const int height = s.height;
+    const int cells = width * height;
+    const int d = std::min(n, kBasinDescriptorNodes);
+    const int tailStart = std::min(std::max(int(std::floor(steps * (s.transientPercent / 100.0))), 0), steps);
+    map.descriptorNodes = d;
+
+    std::vector<double> desc(std::size_t(cells) * 2 * d);
+    std::vector<CellResult> result(cells);
+
+    // workers build their own kernel: bytecode / sparse kernels keep scratch state
+    NetworkSpec workerSpec = spec;
+    workerSpec.threads = 1;
+    WorkerPool pool(std::min(s.threads > 0 ? s.threads : WorkerPool::hardwareThreads(), height));
+
+    std::atomic<int> nextRow(0);
+    std::atomic<int> rowsDone(0);
+    std::atomic<bool> stop(false);
+
+    // rows are handed out one at a time, so slow (unsettled) regions do not hold up a thread
+    auto job = [&](int k) {
+        visitRhsKernel(workerSpec, [&](const auto& kernel) {
+            std::vector<double> y(n), dy(n);
+            for (;;) {
+                const int r = nextRow++;
+                if (r >= height || stop) break;
+                for (int c = 0; c < width; ++c) {
+                    const int cell = r * width + c;
+                    std::copy(y0.begin(), y0.begin() + n, y.begin());
+                    y[s.xNode] = map.cellX(c);
+                    y[s.yNode] = map.cellY(r);
+                    result[cell] = integrateCell(kernel, y, dy, steps, h, tailStart, s, d,
+                                                 desc.data() + std::size_t(cell) * 2 * d);
+                }
+                ++rowsDone;
+                if (k == 0 && progress && !progress(rowsDone)) stop = true;
+            }
+        });
+    };
+    pool.run(job);
+    if (stop) return false;
+
+    // leader clustering in cell order; diverged cells form one basin of their own
+    std::vector<int> cluster(cells, -1);
+    std::vector<int> leader;
+    int divergedCluster = -1;
+    for (int cell = 0; cell < cells; ++cell) {
+        map.eulerSteps += result[cell].steps;
+        if (result[cell].outcome == BasinOutcome::Diverged) {
+            if (divergedCluster < 0) {
+                divergedCluster = int(leader.size());
+                leader.push_back(cell);
+            }
+            cluster[cell] = divergedCluster;
+            continue;
+        }
+
+        const double* mine = desc.data() + std::size_t(cell) * 2 * d;
+        int best = -1;
+        double bestDistance = 0.0;
+        for (int k = 0; k < int(leader.size()); ++k) {
+            if (k == divergedCluster) continue;
+            const double dist = distance(mine, desc.data() + std::size_t(leader[k]) * 2 * d, d);
+            if (dist <= s.clusterRadius) {
+                best = k;
+                bestDistance = dist;
+                break;
+            }
+            if (best < 0 || dist < bestDistance) {
+                best = k;
+                bestDistance = dist;
+            }
+        }
+        const bool full = int(leader.size()) - (divergedCluster >= 0 ? 1 : 0) >= kBasinMaxAttractors;
+        if (best < 0 || (bestDistance > s.clusterRadius && !full)) {
+            best = int(leader.size());
+            leader.push_back(cell);
+        }
+        cluster[cell] = best;
+    }
+
+    std::vector<BasinAttractor> found(leader.size());
+    for (std::size_t k = 0; k < leader.size(); ++k) {
+        found[k].firstCell = leader[k];
+        found[k].diverged = (int(k) == divergedCluster);
+        found[k].low.assign(d, 0.0);
+        found[k].high.assign(d, 0.0);
+    }
+    for (int cell = 0; cell < cells; ++cell) {
+        BasinAttractor& a = found[cluster[cell]];
+        ++a.cells;
+        a.meanSteps += result[cell].steps;
+        if (result[cell].outcome == BasinOutcome::Unsettled) ++a.unsettledCells;
+        if (a.diverged) continue;
+        const double* mine = desc.data() + std::size_t(cell) * 2 * d;
+        for (int i = 0; i < d; ++i) {
+            a.low[i] += mine[i];
+            a.high[i] += mine[d + i];
+        }
+    }
+    for (BasinAttractor& a : found) {
+        a.meanSteps /= a.cells;
+        double widest = 0.0;
+        for (int i = 0; i < d && !a.diverged; ++i) {
+            a.low[i] /= a.cells;
+            a.high[i] /= a.cells;
+            widest = std::max(widest, a.high[i] - a.low[i]);
+        }
+        a.fixedPoint = !a.diverged && widest < s.clusterRadius;
+        if (a.diverged) {
+            a.low.clear();
+            a.high.clear();
+        }
+    }
+
+    // largest basin first, ties by first cell
+    std::vector<int> order(found.size());
+    for (std::size_t k = 0; k < order.size(); ++k) order[k] = int(k);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return found[a].cells != found[b].cells ? found[a].cells > found[b].cells
+                                                : found[a].firstCell < found[b].firstCell;
+    });
+    std::vector<int> rank(found.size());
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        rank[order[k]] = int(k);
+        map.attractors.push_back(found[order[k]]);
+    }
+    map.label.resize(cells);
+    for (int cell = 0; cell < cells; ++cell) map.label[cell] = rank[cluster[cell]];
+
+    map.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    return true;
+}
+
+void basinColour(const BasinMap& map, int label, unsigned char rgb[3])
+{
+    static const unsigned char palette[][3] = {
+        {31, 119, 180}, {255, 127, 14}, {44, 160, 44},   {214, 39, 40},   {148, 103, 189},
+        {140, 86, 75},  {227, 119, 194}, {127, 127, 127}, {188, 189, 34}, {23, 190, 207},
+    };
+    const int colours = int(sizeof(palette) / sizeof(palette[0]));
+    if (map.attractors[label].diverged) {
+        rgb[0] = rgb[1] = rgb[2] = 0;
+        return;
+    }
+    const double shade = 1.0 / (1 + label / colours);
+    for (int k = 0; k < 3; ++k) rgb[k] = (unsigned char)(palette[label % colours][k] * shade);
+}
+
+std::string basinImagePpm(const BasinMap& map)
+{
+    const int width = map.settings.width;
+    const int height = map.settings.height;
+
+    std::string image = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    const std::size_t header = image.size();
+    image.resize(header + std::size_t(width) * height * 3);
+    unsigned char* px = reinterpret_cast<unsigned char*>(&image[header]);
+    for (int row = 0; row < height; ++row) {
+        const int r = height - 1 - row; // yMax on top
+        for (int c = 0; c < width; ++c, px += 3) basinColour(map, map.label[std::size_t(r) * width + c], px);
+    }
+    return image;
+}
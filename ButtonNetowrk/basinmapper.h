@@ -0,0 +1,82 @@
+#ifndef BASINMAPPER_H
+#define BASINMAPPER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "networkspec.h"
+
+// Basin-of-attraction map for the Euler (ODE) solver: two node coordinates of the
+// initial state are swept over a width x height grid, the other nodes keep the
+// default initial state. Every cell is integrated on its own (cells run in parallel,
+// one RHS kernel per worker) and stops early once it sits on a fixed point or diverges.
+// The cells are then grouped into attractors by a descriptor of where they ended:
+// per node the min and max after the transient (both equal for a fixed point). Cells are
+// independent and grouped serially in cell order, so the map does not depend on the
+// thread count.
+
+enum class BasinOutcome { Settled, Unsettled, Diverged };
+
+struct BasinSettings {
+    int xNode = 0;                 // swept coordinates, 0-based node index
+    int yNode = 1;
+    double xMin = -1.0;
+    double xMax = 1.0;
+    double yMin = -1.0;
+    double yMax = 1.0;
+    int width = 512;               // grid points, the ranges include both ends
+    int height = 512;
+    double settleTolerance = 1e-8; // max |dy_i| below it: fixed point reached, stop
+    double divergeLimit = 1e6;     // |y_i| above it (or not finite): diverged, stop
+    int transientPercent = 70;     // unsettled cells: descriptor over the steps after it
+    double clusterRadius = 1e-2;   // max |descriptor difference| / (1 + max - min) in one attractor
+    int threads = 0;               // 0: all cores
+};
+
+// Descriptors use the first kBasinDescriptorNodes nodes, which bounds the memory of a
+// 512 x 512 map for large networks.
+constexpr int kBasinDescriptorNodes = 16;
+// Beyond this many attractors (e.g. chaotic tails) cells join the nearest one.
+constexpr int kBasinMaxAttractors = 64;
+
+struct BasinAttractor {
+    bool diverged = false;
+    bool fixedPoint = false;      // max - min below clusterRadius on every node
+    int cells = 0;
+    int unsettledCells = 0;       // cells that ran all steps without reaching the tolerance
+    int firstCell = 0;            // row-major index of the first cell in the basin
+    double meanSteps = 0.0;       // steps until the cells stopped
+    std::vector<double> low;      // per descriptor node: min / max after the transient,
+    std::vector<double> high;     // averaged over the cells (empty when diverged)
+};
+
+struct BasinMap {
+    BasinSettings settings;
+    int steps = 0;
+    double h = 0.0;
+    int descriptorNodes = 0;
+    std::vector<int> label;                 // row-major, row 0 = yMin; index into attractors
+    std::vector<BasinAttractor> attractors; // largest basin first
+    long long eulerSteps = 0;               // over all cells
+    double wallSeconds = 0.0;
+
+    double cellX(int c) const;
+    double cellY(int r) const;
+};
+
+// Called on the calling thread with the number of finished grid rows; false cancels.
+using BasinProgressFn = std::function<bool(int rowsDone)>;
+
+// Returns false when cancelled (map is then incomplete).
+bool mapBasins(const NetworkSpec& spec, const std::vector<double>& y0, int steps, double h,
+               const BasinSettings& settings, BasinMap& map,
+               const BasinProgressFn& progress = BasinProgressFn());
+
+// Colour of a basin in the image: ten colours, darker on every round; diverged is black.
+void basinColour(const BasinMap& map, int label, unsigned char rgb[3]);
+
+// Binary PPM (P6) with one pixel per cell, yMax at the top.
+std::string basinImagePpm(const BasinMap& map);
+
+#endif // BASINMAPPER_H
@@ -0,0 +1,12 @@
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+TARGET = buttonnetwork-cli
+
+include(buttonnetwork_core.pri)
+
+SOURCES += \
+    buttonnetwork_cli.cpp
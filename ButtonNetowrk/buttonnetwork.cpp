@@ -16,13 +16,17 @@
 #include <QDoubleSpinBox>
 #include <QCoreApplication> //long loop 동안 UI 멈추는 것 방지
 #include <QDir>
-#include <QDateTime>
 #include <QFileInfo>
 #include <QCheckBox> // 옵션 ON/OFF 체크
 #include <QComboBox> //함수 선택
+#include <QPlainTextEdit>
+#include <QSpinBox>
 
 #include <cmath>
 
+#include "networkloader.h"
+#include "runoutput.h"
+
 ButtonNetwork::ButtonNetwork(QWidget *parent) : QWidget(parent) //passing parent ensures proper Qt ownership and event propagation.
 {
     setMouseTracking(true); //마우스를 누르지 않아도 mouse move 이벤트를 받을 수 있게
@@ -32,20 +36,12 @@ ButtonNetwork::ButtonNetwork(QWidget *parent) : QWidget(parent) //passing parent
         this, "Number of Nodes", "How many nodes?", 5, 1, 100, 1, &ok);
     if (ok) maxNodes = userInput;
 
-    baseResultDir = QDir::homePath() + "/ButtonNetwork/result";
-
-    // Defaults for demo
-    gateNode4.enabled = true;
-    gateNode4.baseType = "alpha2";
-    gateNode4.baseConst = 1.0;
-    gateNode4.coeff = 1.2;
-    gateNode4.fn = "sin";
-
-    gateNode5.enabled = true;
-    gateNode5.baseType = "const";
-    gateNode5.baseConst = 1.0;
-    gateNode5.coeff = 2.2;
-    gateNode5.fn = "tanh";
+    runner.baseResultDir = QDir::homePath() + "/ButtonNetwork/result";
+    runner.keepAlive = []() { QCoreApplication::processEvents(); }; //long loop 동안 UI 멈추는 것 방지
+    runner.cancelRequested = [this]() { return cancelRequested; };
+    runner.log = [this](const QString& line) {
+        if (equationEditor) equationEditor->append(line);
+    };
 }
 
 void ButtonNetwork::updateEquationEditor(QTextEdit* editor)
@@ -128,7 +124,7 @@ void ButtonNetwork::showFunctionDialog(QPushButton* start, QPushButton* end)
             "Enter value for " + key + ":", 0.0, -1000, 1000, 6, &ok);
 
         if (ok) {
-            weightValues[key] = weightVal;
+            config.weightValues[key] = weightVal;
             connections.append({start, end, color, functionType});
             update();
         }
@@ -154,7 +150,7 @@ void ButtonNetwork::paintEvent(QPaintEvent *)
 
         const int sIdx = conn.start->text().toInt(); // 1-based
         QString label = "s" + conn.start->text() + conn.end->text();
-        double val = weightValues.value(label, 0.0);
+        double val = config.weightValues.value(label, 0.0);
 
         // Self-loop on node4 or node5 => show G2 / G1 label (visual)
         if (conn.start == conn.end && (sIdx == 4 || sIdx == 5)) {
@@ -169,19 +165,19 @@ void ButtonNetwork::paintEvent(QPaintEvent *)
             p.drawArc(loop, 0, 360 * 16);
 
             if (sIdx == 4) {
-                const double base = baseValueFromType(gateNode4.baseType, gateNode4.baseConst);
+                const double base = config.baseValueFromType(config.gateNode4.baseType, config.gateNode4.baseConst);
                 p.drawText(start.x() - 80, start.y() - 50,
                            QString("G2=%1-%2*%3(y4)")
                                .arg(base, 0, 'f', 3)
-                               .arg(gateNode4.coeff, 0, 'f', 3)
-                               .arg(gateNode4.fn));
+                               .arg(config.gateNode4.coeff, 0, 'f', 3)
+                               .arg(config.gateNode4.fn));
             } else if (sIdx == 5) {
-                const double base = baseValueFromType(gateNode5.baseType, gateNode5.baseConst);
+                const double base = config.baseValueFromType(config.gateNode5.baseType, config.gateNode5.baseConst);
                 p.drawText(start.x() - 80, start.y() - 50,
                            QString("G1=%1-%2*%3(y5)")
                                .arg(base, 0, 'f', 3)
-                               .arg(gateNode5.coeff, 0, 'f', 3)
-                               .arg(gateNode5.fn));
+                               .arg(config.gateNode5.coeff, 0, 'f', 3)
+                               .arg(config.gateNode5.fn));
             } else {
                 p.drawText(start.x() - 30, start.y() - 50,
                            label + "=" + QString::number(val));
@@ -201,6 +197,15 @@ void ButtonNetwork::paintEvent(QPaintEvent *)
                        label + "=" + QString::number(val));
         }
     }
+
+    // drawn edges/gates are not used while custom equations / a large network are set
+    if (!config.equations.trimmed().isEmpty()) {
+        p.setPen(Qt::darkRed);
+        p.drawText(10, 20, "Custom equations active (Equations...)");
+    } else if (config.large.enabled()) {
+        p.setPen(Qt::darkRed);
+        p.drawText(10, 20, "Large network active: " + config.large.kind + " (Large Network...)");
+    }
 }
 
 QString ButtonNetwork::buildTerm(const QString& from,
@@ -214,48 +219,32 @@ QString ButtonNetwork::buildTerm(const QString& from,
     return QString::number(val) + "*" + from;
 }
 
-// ================= Gate helpers =================
+// ================= Widget -> SimulationConfig =================
 
-double ButtonNetwork::baseValueFromType(const QString& baseType, double baseConst) const
-{
-    if (baseType == "alpha1") return alpha1;
-    if (baseType == "alpha2") return alpha2;
-    if (baseType == "alpha3") return alpha3;
-    if (baseType == "const")  return baseConst;
-    return baseConst;
-}
-
-double ButtonNetwork::applyFn(const QString& fn, double x) const
-{
-    if (fn == "sin")  return std::sin(x);
-    if (fn == "tanh") return std::tanh(x);
-    if (fn == "relu") return (x > 0.0) ? x : 0.0;
-    return std::sin(x);
-}
-//nodeIndex가 node4 또는 node5일 때, 그 노드의 Gate(G2 또는 G1)를 yValue(현재 상태 값)에기반해서계산해 반환.
-//다른 노드면 0.0을 반환
-double ButtonNetwork::evalGateForNode(int nodeIndex, double yValue) const
+//canvas 연결선(QPushButton 기준)을 config.connections 로 옮긴 뒤 반환
+SimulationConfig& ButtonNetwork::currentConfig()
 {
-    const GateConfig* gate = nullptr;
-    if (nodeIndex == 3) gate = &gateNode4; // node4
-    if (nodeIndex == 4) gate = &gateNode5; // node5
-    if (!gate) return 0.0;
-
-    const double base = baseValueFromType(gate->baseType, gate->baseConst);
-    const double fnv  = applyFn(gate->fn, yValue);
-    return base - gate->coeff * fnv;
+    config.connections.clear();
+    for (const auto& conn : connections) {
+        ConnectionConfig c;
+        c.from = conn.start->text().toInt();
+        c.to   = conn.end->text().toInt();
+        c.function = conn.function;
+        config.connections.push_back(c);
+    }
+    return config;
 }
 
 // ================= Run folder =================
 
 bool ButtonNetwork::ensureBaseResultDir()
 {
-    if (!baseResultDir.isEmpty()) {
-        QDir d(baseResultDir);
+    if (!runner.baseResultDir.isEmpty()) {
+        QDir d(runner.baseResultDir);
         if (!d.exists()) {
             if (!d.mkpath(".")) {
                 QMessageBox::critical(this, "Error",
-                                      "Cannot create base result dir:\n" + baseResultDir);
+                                      "Cannot create base result dir:\n" + runner.baseResultDir);
                 return false;
             }
         }
@@ -266,16 +255,16 @@ bool ButtonNetwork::ensureBaseResultDir()
         this, "Select base result folder (choose once)", QDir::homePath());
 
     if (selected.isEmpty()) {
-        baseResultDir = QDir::homePath() + "/ButtonNetwork/result";
+        runner.baseResultDir = QDir::homePath() + "/ButtonNetwork/result";
     } else {
-        baseResultDir = selected;
+        runner.baseResultDir = selected;
     }
 
-    QDir d(baseResultDir);
+    QDir d(runner.baseResultDir);
     if (!d.exists()) {
         if (!d.mkpath(".")) {
             QMessageBox::critical(this, "Error",
-                                  "Cannot create base result dir:\n" + baseResultDir);
+                                  "Cannot create base result dir:\n" + runner.baseResultDir);
             return false;
         }
     }
@@ -286,14 +275,8 @@ bool ButtonNetwork::createNewRunDir()
 {
     if (!ensureBaseResultDir()) return false;
 
-    const QString ts = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
-    currentRunDir = baseResultDir + "/run_" + ts;
-
-    QDir d;
-    if (!d.mkpath(currentRunDir)) {
-        QMessageBox::critical(this, "Error",
-                              "Cannot create run folder:\n" + currentRunDir);
-        currentRunDir.clear();
+    if (!runner.createRunDir()) {
+        QMessageBox::critical(this, "Error", runner.lastError());
         return false;
     }
     return true;
@@ -301,282 +284,85 @@ bool ButtonNetwork::createNewRunDir()
 
 QString ButtonNetwork::runPath(const QString& filename) const
 {
-    if (currentRunDir.isEmpty()) return filename;
-    return currentRunDir + "/" + filename;
-}
-
-void ButtonNetwork::writeRunInfoFile() const
-{
-    if (currentRunDir.isEmpty()) return;
-    QFile f(runPath("run_info.txt"));
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return;
-
-    QTextStream out(&f); //f는 QFile 객체,TextStream writes formatted text to a QIODevice
-    out << "=== Hopfield Fractional Network Run Info ===\n";
-    out << "RunDir: " << currentRunDir << "\n";
-    out << "Solver: " << solverMode << "\n";
-    out << "tMax: " << tMax << "\n";
-    out << "alpha1=" << alpha1 << " alpha2=" << alpha2 << " alpha3=" << alpha3 << "\n";
-    out << "nu=" << nu << "\n";
-    out << "Gate4(G2): enabled=" << gateNode4.enabled
-        << " base=" << gateNode4.baseType << "(" << gateNode4.baseConst << ")"
-        << " coeff=" << gateNode4.coeff << " fn=" << gateNode4.fn << "\n";
-    out << "Gate5(G1): enabled=" << gateNode5.enabled
-        << " base=" << gateNode5.baseType << "(" << gateNode5.baseConst << ")"
-        << " coeff=" << gateNode5.coeff << " fn=" << gateNode5.fn << "\n\n";
-
-    out << "Connections:\n";
-    for (const auto& c : connections) {
-        QString key = "s" + c.start->text() + c.end->text();
-        out << " " << key << " = " << weightValues.value(key, 0.0)
-            << " fn=" << c.function << "\n";
-    }
-    f.close();
+    return runner.runPath(filename);
 }
 
-void ButtonNetwork::saveParams(const QString& path)
+bool ButtonNetwork::reportStatus(SimulationRunner::Status status, const QString& title)
 {
-    QFile f(path);
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return;
-    QTextStream out(&f);
-
-    out << "solverMode=" << solverMode << "\n";
-    out << "tMax=" << tMax << "\n";
-    out << "alpha1=" << alpha1 << "\n";
-    out << "alpha2=" << alpha2 << "\n";
-    out << "alpha3=" << alpha3 << "\n";
-    out << "nu=" << nu << "\n";
-
-    out << "GateNode4.enabled=" << gateNode4.enabled << "\n";
-    out << "GateNode4.baseType=" << gateNode4.baseType << "\n";
-    out << "GateNode4.baseConst=" << gateNode4.baseConst << "\n";
-    out << "GateNode4.coeff=" << gateNode4.coeff << "\n";
-    out << "GateNode4.fn=" << gateNode4.fn << "\n";
-
-    out << "GateNode5.enabled=" << gateNode5.enabled << "\n";
-    out << "GateNode5.baseType=" << gateNode5.baseType << "\n";
-    out << "GateNode5.baseConst=" << gateNode5.baseConst << "\n";
-    out << "GateNode5.coeff=" << gateNode5.coeff << "\n";
-    out << "GateNode5.fn=" << gateNode5.fn << "\n";
-
-    out << "\n[weights]\n";
-    for (auto it = weightValues.begin(); it != weightValues.end(); ++it) {
-        out << it.key() << "=" << it.value() << "\n";
+    switch (status) {
+    case SimulationRunner::Status::Done:
+    case SimulationRunner::Status::CacheHit:
+        return true;
+    case SimulationRunner::Status::Cancelled:
+        if (equationEditor) equationEditor->append("(press Resume to continue)");
+        return false;
+    case SimulationRunner::Status::Failed:
+        QMessageBox::warning(this, title, runner.lastError());
+        return false;
     }
-    f.close();
+    return false;
 }
 
 // ================= Solver core =================
 
-double ButtonNetwork::sinEFunction(double x) { return std::sin(x); }
-double ButtonNetwork::tanhFunction(double x) { return std::tanh(x); }
-double ButtonNetwork::reluFunction(double x) { return (x > 0.0) ? x : 0.0; }
-
-
-double ButtonNetwork::gammaWeight(int om, int r, double nu)
-{
-    double k = om - r;
-    return std::pow(k + 1.0, nu) - std::pow(k, nu);
-}
-
-
 void ButtonNetwork::computeResults()
 {
     if (!createNewRunDir()) return;
 
-    saveParams(runPath("params.txt"));
-    writeRunInfoFile();
-
-    if (solverMode == "ODE") runODE();
-    else runGamma();
+    cancelRequested = false;
+    if (reportStatus(runner.computeRun(currentConfig()), "Error"))
+        emit fileSaved(runPath("result.dat"));
 }
 
-void ButtonNetwork::runODE()
-{
-    const int steps = tMax;
-    const double h = 0.01;
-
-    QVector<QVector<double>> y(5, QVector<double>(steps + 1));
-    y[0][0] = 0.8; y[1][0] = 0.3; y[2][0] = 0.4; y[3][0] = 0.6; y[4][0] = 0.7;
-
-    for (int t = 1; t <= steps; ++t) {
-        if (t % 400 == 0) QCoreApplication::processEvents();
-
-        for (int i = 0; i < 5; ++i) {
-            double sum = -y[i][t - 1];
-
-            for (const auto& conn : connections) { //버튼에 적힌 노드 번호가 1부터 시작인데, 배열/벡터 인덱스는 0부터 시작
-                int from = conn.start->text().toInt() - 1;
-                int to   = conn.end->text().toInt() - 1;
-                if (to != i) continue;
+// ================= Checkpoint / resume =================
 
-                QString key = "s" + conn.start->text() + conn.end->text();
-                double w = weightValues.value(key, 0.0);
-                double in = y[from][t - 1];
-
-                if (conn.function == "sin_exp") sum += w * sinEFunction(in);
-                else if (conn.function == "tanh") sum += w * tanhFunction(in);
-                else if (conn.function == "relu") sum += w * reluFunction(in);
-            }
-
-            if (i == 3) {
-                if (gateNode4.enabled) {
-                    const double G2 = evalGateForNode(3, y[3][t - 1]);
-                    sum += G2 * tanhFunction(y[3][t - 1]);
-                } else {
-                    sum += (alpha2 - alpha3 * sinEFunction(y[4][t - 1]))
-                         * tanhFunction(y[3][t - 1]);
-                }
-            }
-
-            if (i == 4) {
-                if (gateNode5.enabled) {
-                    const double G1 = evalGateForNode(4, y[4][t - 1]);
-                    sum += G1 * tanhFunction(y[4][t - 1]);
-                } else {
-                    sum += (1 - alpha1 * tanhFunction(y[2][t - 1]))
-                         * tanhFunction(y[4][t - 1]);
-                }
-            }
-
-            y[i][t] = y[i][t - 1] + h * sum; // Euler
-        }
-    }
-
-    saveAndDisplayResult(y, steps);
+void ButtonNetwork::cancelComputation()
+{
+    cancelRequested = true;
 }
 
-void ButtonNetwork::runGamma()
+//checkpoint 가 있는 run 폴더에서 중단된 run / alpha2 scan 이어서 계산 (결과는 중단 없이 돌린 것과 동일)
+void ButtonNetwork::resumeFromCheckpoint()
 {
-    const int steps = tMax;
-
-    QVector<QVector<double>> y(5, QVector<double>(steps + 1));
-    y[0][0] = 0.8;
-    y[1][0] = 0.3;
-    y[2][0] = 0.4;
-    y[3][0] = 0.6;
-    y[4][0] = 0.7;
-
-    for (int om = 1; om <= steps; ++om) {
-
-        for (int i = 0; i < 5; ++i)
-            y[i][om] = 0.0;  // important (same as C code)
-
-        for (int r = 1; r <= om; ++r) {
-
-            double bg = gammaWeight(om, r, nu);
-
-            // y0
-            y[0][om] += (
-                            -y[0][r-1]
-                            + weightValues.value("s12",0.0)*tanhFunction(y[1][r-1])
-                            + weightValues.value("s13",0.0)*sinEFunction(y[2][r-1])
-                            + weightValues.value("s14",0.0)*sinEFunction(y[3][r-1])
-                            ) * bg;
-
-            // y1
-            y[1][om] += (
-                            -y[1][r-1]
-                            + weightValues.value("s21",0.0)*sinEFunction(y[0][r-1])
-                            + weightValues.value("s23",0.0)*sinEFunction(y[2][r-1])
-                            + weightValues.value("s25",0.0)*sinEFunction(y[4][r-1])
-                            ) * bg;
-
-            // y2
-            y[2][om] += (
-                            -y[2][r-1]
-                            + weightValues.value("s31",0.0)*tanhFunction(y[0][r-1])
-                            + weightValues.value("s32",0.0)*tanhFunction(y[1][r-1])
-                            + weightValues.value("s33",0.0)*sinEFunction(y[2][r-1])
-                            ) * bg;
-
-            // y3 (node4)
-            double gate4Term;
-            if (gateNode4.enabled) {
-                const double G2 = evalGateForNode(3, y[3][r-1]);
-                gate4Term = G2 * tanhFunction(y[3][r-1]);
-            } else {
-                gate4Term = (alpha2 - alpha3*sinEFunction(y[4][r-1]))
-                * tanhFunction(y[3][r-1]);
-            }
-
-            y[3][om] += (
-                            -y[3][r-1]
-                            + weightValues.value("s41",0.0)*tanhFunction(y[0][r-1])
-                            + gate4Term
-                            ) * bg;
-
-            // y4 (node5)
-            double gate5Term;
-            if (gateNode5.enabled) {
-                const double G1 = evalGateForNode(4, y[4][r-1]);
-                gate5Term = G1 * tanhFunction(y[4][r-1]);
-            } else {
-                gate5Term = (1.0 - alpha1*tanhFunction(y[2][r-1]))
-                * tanhFunction(y[4][r-1]);
-            }
+    auto hasCheckpoint = [this]() {
+        return runner.hasScanCheckpoint() || runner.hasRunCheckpoint();
+    };
 
-            y[4][om] += (
-                            -y[4][r-1]
-                            + weightValues.value("s52",0.0)*tanhFunction(y[1][r-1])
-                            + gate5Term
-                            ) * bg;
+    if (runner.runDir.isEmpty() || !hasCheckpoint()) {
+        const QString dir = QFileDialog::getExistingDirectory(
+            this, "Select run folder to resume", runner.baseResultDir);
+        if (dir.isEmpty()) return;
+        runner.runDir = dir;
+        if (!hasCheckpoint()) {
+            QMessageBox::information(this, "Resume", "No checkpoint in:\n" + runner.runDir);
+            return;
         }
-
-        // add initial condition (same as C code)
-        for (int i = 0; i < 5; ++i)
-            y[i][om] += y[i][0];
     }
 
-    saveAndDisplayResult(y, steps);
-}
-
+    cancelRequested = false;
 
-void ButtonNetwork::saveAndDisplayResult(const QVector<QVector<double>>& y, int steps)
-{
-    QFile f(runPath("result.dat"));
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Error", "Cannot write result.dat");
+    if (runner.hasScanCheckpoint()) {
+        if (reportStatus(runner.resumeScan(currentConfig()), "Resume")) plotAlpha2Scan();
         return;
     }
 
-    QTextStream out(&f);
-    for (int t = 0; t <= steps; ++t) {
-        out << y[0][t] << " " << y[1][t] << " " << y[2][t] << " " << y[3][t] << " " << y[4][t] << "\n";
-    }
-    f.close();
-
-    QFile stream(runPath("result_stream.csv"));
-    if (stream.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream s(&stream);
-        s << "t,y1,y2,y3,y4,y5\n";
-        for (int t = 0; t <= steps; ++t) {
-            s << t << "," << y[0][t] << "," << y[1][t] << "," << y[2][t] << "," << y[3][t] << "," << y[4][t] << "\n";
-        }
-        stream.close();
-    }
+    if (reportStatus(runner.resumeRun(currentConfig()), "Resume"))
+        emit fileSaved(runPath("result.dat"));
+}
 
-    QFile fin(runPath("result_final.csv"));
-    if (fin.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream s(&fin);
-        s << "y1,y2,y3,y4,y5\n";
-        s << y[0][steps] << "," << y[1][steps] << "," << y[2][steps] << "," << y[3][steps] << "," << y[4][steps] << "\n";
-        fin.close();
-    }
+// ================= Extend run =================
 
-    QFile table(runPath("table.txt"));
-    if (table.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream t(&table);
-        t << "Output Table (result.dat)\n";
-        t << "Rows: " << (steps + 1) << "\n\n";
-        t << "y1 y2 y3 y4 y5\n";
-        for (int i = 0; i <= steps; ++i) {
-            t << y[0][i] << " " << y[1][i] << " " << y[2][i] << " " << y[3][i] << " " << y[4][i] << "\n";
-        }
-        table.close();
+//현재 run의 state.bin을 불러와 old tMax+1 .. tMax 구간만 추가로 적분 (0부터 다시 계산하지 않음)
+void ButtonNetwork::extendCurrentRun()
+{
+    if (runner.runDir.isEmpty()) {
+        QMessageBox::warning(this, "Error", "No run folder. Press Compute first.");
+        return;
     }
 
-    emit fileSaved(runPath("result.dat"));
+    cancelRequested = false;
+    if (reportStatus(runner.extendRun(currentConfig()), "Extend Run"))
+        emit fileSaved(runPath("result.dat"));
 }
 
 // ================= UI helpers =================
@@ -588,7 +374,7 @@ void ButtonNetwork::showTable()
 
 void ButtonNetwork::showOutputTable()
 {
-    if (currentRunDir.isEmpty()) {
+    if (runner.runDir.isEmpty()) {
         QMessageBox::warning(this, "Error", "No run folder. Press Compute first.");
         return;
     }
@@ -606,8 +392,10 @@ void ButtonNetwork::showOutputTable()
     f.close();
 }
 
-void ButtonNetwork::setSolverMode(const QString& mode) { solverMode = mode; }
-void ButtonNetwork::setTimeLimit(int t) { tMax = t; }
+void ButtonNetwork::setSolverMode(const QString& mode) { config.solverMode = mode; }
+void ButtonNetwork::setFractionalKernel(const QString& kernel) { config.fractionalKernel = kernel; }
+void ButtonNetwork::setTimeLimit(int t) { config.tMax = t; }
+void ButtonNetwork::setNativeCode(bool on) { runner.useNativeCode = on; }
 void ButtonNetwork::setAlpha2ScanRange(double minVal, double maxVal, double stepVal)
 {
     scanAlpha2Min = minVal;
@@ -627,7 +415,9 @@ void ButtonNetwork::clearNetwork()
     }
     buttons.clear();
     connections.clear();
-    weightValues.clear();
+    config.weightValues.clear();
+    config.equations.clear();
+    config.large = LargeNetworkConfig();
     firstSelected = nullptr;
 
     if (equationEditor) equationEditor->clear();
@@ -636,43 +426,9 @@ void ButtonNetwork::clearNetwork()
 
 // ================= gnuplot: y_all =================
 
-void ButtonNetwork::generateGnuplotScript()
-{
-    if (currentRunDir.isEmpty()) return;
-
-    QFile script(runPath("plot.gnu"));
-    if (!script.open(QIODevice::WriteOnly | QIODevice::Text)) return;
-
-    QTextStream out(&script);
-
-    out << "set terminal pngcairo size 1200,900\n";
-    out << "set output 'y_all.png'\n";
-    out << "set multiplot layout 5,1 title 'Hopfield Network Results'\n";
-    out << "set grid\n";
-    out << "set key left\n";
-    out << "set xlabel 't (step)'\n";
-    out << "set xrange [0:*]\n";
-
-    out << "set ylabel 'y1'\n";
-    out << "plot 'result.dat' using 0:1 with lines linewidth 2 title 'y1'\n\n";
-    out << "set ylabel 'y2'\n";
-    out << "plot 'result.dat' using 0:2 with lines linewidth 2 title 'y2'\n\n";
-    out << "set ylabel 'y3'\n";
-    out << "plot 'result.dat' using 0:3 with lines linewidth 2 title 'y3'\n\n";
-    out << "set ylabel 'y4'\n";
-    out << "plot 'result.dat' using 0:4 with lines linewidth 2 title 'y4'\n\n";
-    out << "set ylabel 'y5'\n";
-    out << "plot 'result.dat' using 0:5 with lines linewidth 2 title 'y5'\n\n";
-
-    out << "unset multiplot\n";
-    out << "set output\n";
-
-    script.close();
-}
-
 void ButtonNetwork::showGraph()
 {
-    if (currentRunDir.isEmpty()) {
+    if (runner.runDir.isEmpty()) {
         QMessageBox::warning(this, "Error", "No run folder. Press Compute first.");
         return;
     }
@@ -684,20 +440,16 @@ void ButtonNetwork::showGraph()
         return;
     }
 
-    generateGnuplotScript();
+    writeGnuplotScript(runner.runDir);
 
-    QProcess proc;
-    proc.setWorkingDirectory(currentRunDir);
-    proc.start("gnuplot", QStringList() << "plot.gnu");
     //Qt에서 외부 프로그램(gnuplot)을 실행해서 PNG 그래프를 만든 다음, 성공하면 신호(signal)를 보내고, Linux에서는 파일을 열어주는 흐름
-    if (!proc.waitForStarted()) {
-        QMessageBox::critical(this, "Error", "Failed to start gnuplot. Is it installed?");
-        return;
-    }
-
-    if (!proc.waitForFinished(-1) || proc.exitCode() != 0) {
-        QMessageBox::critical(this, "Error",
-                              "gnuplot failed. Check if pngcairo is available.");
+    bool started = false;
+    if (!runGnuplot(runner.runDir, "plot.gnu", &started)) {
+        if (!started)
+            QMessageBox::critical(this, "Error", "Failed to start gnuplot. Is it installed?");
+        else
+            QMessageBox::critical(this, "Error",
+                                  "gnuplot failed. Check if pngcairo is available.");
         return;
     }
 
@@ -713,14 +465,13 @@ void ButtonNetwork::showGraph()
 void ButtonNetwork::scanAlpha2()
 {
     if (!createNewRunDir()) return;
-    saveParams(runPath("params.txt"));
-    writeRunInfoFile();
+    runner.writeRunHeaderFiles(currentConfig());
     scanAlpha2ReuseCurrentRun();
 }
-//currentRunDir를 그대로 사용해 alpha2 값을 여러 개로 바꿔가며 시뮬레이션을 반복 실행,  결과파일로 저장(gnuplot으로 PNG도 만들려고 시도)하는alpha2 파라미터 스윕/스캔 함수
+//현재 run 폴더를 그대로 사용해 alpha2 값을 여러 개로 바꿔가며 시뮬레이션을 반복 실행,  결과파일로 저장(gnuplot으로 PNG도 만들려고 시도)하는alpha2 파라미터 스윕/스캔 함수
 void ButtonNetwork::scanAlpha2ReuseCurrentRun()
 {
-    if (currentRunDir.isEmpty()) {
+    if (runner.runDir.isEmpty()) {
         QMessageBox::warning(this, "Error", "No run folder. Press Compute first (or Auto Test).");
         return;
     }
@@ -743,154 +494,29 @@ void ButtonNetwork::scanAlpha2ReuseCurrentRun()
     if (transientPercent < 0 || transientPercent > 99) transientPercent = 70;
     if (sampleStride < 1) sampleStride = 20;
 
-    QFile f3d(runPath("alpha2_scan_3d.dat"));
-    QFile f2d(runPath("alpha2_scan_2d.dat"));
-    if (!f3d.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Error", "Cannot write alpha2_scan_3d.dat");
-        return;
-    }
-    if (!f2d.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Error", "Cannot write alpha2_scan_2d.dat");
-        return;
-    }
-
-    QTextStream out3d(&f3d);
-    QTextStream out2d(&f2d);
-
-    const int steps = tMax;
-    const double h = 0.01;
-    const int transientStart = std::min(std::max(int(std::floor(steps * (transientPercent / 100.0))), 0), steps);
-
-    for (double a2 = a2Min; a2 <= a2Max + 1e-12; a2 += a2Step) {
-        const double oldAlpha2 = alpha2;
-        alpha2 = a2;
-
-        QVector<QVector<double>> y(5, QVector<double>(steps + 1));
-        y[0][0] = 0.8; y[1][0] = 0.3; y[2][0] = 0.4; y[3][0] = 0.6; y[4][0] = 0.7;
-
-        if (solverMode == "ODE") {
-            for (int t = 1; t <= steps; ++t) {
-                if (t % 400 == 0) QCoreApplication::processEvents();
-
-                for (int i = 0; i < 5; ++i) {
-                    double sum = -y[i][t - 1];
-
-                    for (const auto& conn : connections) {
-                        int from = conn.start->text().toInt() - 1;
-                        int to   = conn.end->text().toInt() - 1;
-                        if (to != i) continue;
-
-                        QString key = "s" + conn.start->text() + conn.end->text();
-                        double w = weightValues.value(key, 0.0);
-                        double in = y[from][t - 1];
-
-                        if (conn.function == "sin_exp") sum += w * sinEFunction(in);
-                        else if (conn.function == "tanh") sum += w * tanhFunction(in);
-                        else if (conn.function == "relu") sum += w * reluFunction(in);
-                    }
-
-                    if (i == 3) {
-                        const double G2 = gateNode4.enabled ? evalGateForNode(3, y[3][t - 1])
-                                                            : (alpha2 - alpha3 * sinEFunction(y[4][t - 1]));
-                        sum += G2 * tanhFunction(y[3][t - 1]);
-                    }
-                    if (i == 4) {
-                        const double G1 = gateNode5.enabled ? evalGateForNode(4, y[4][t - 1])
-                                                            : (1 - alpha1 * tanhFunction(y[2][t - 1]));
-                        sum += G1 * tanhFunction(y[4][t - 1]);
-                    }
-
-                    y[i][t] = y[i][t - 1] + h * sum;
-                }
-
-                if (t % sampleStride == 0 || t == steps) {
-                    out3d << a2 << " " << t << " "
-                          << y[0][t] << " " << y[1][t] << " " << y[2][t] << " "
-                          << y[3][t] << " " << y[4][t] << "\n";
-                }
-            }
-        }
-        else {
-            // GAMMA MODE
-            for (int om = 1; om <= steps; ++om) {
-                if (om % 100 == 0) QCoreApplication::processEvents();
-
-                for (int i = 0; i < 5; ++i)
-                    y[i][om] = 0.0;
-
-                for (int r = 1; r <= om; ++r) {
-                    double bg = gammaWeight(om, r, nu);
-
-                    y[0][om] += (-y[0][r-1] + weightValues.value("s12",0.0)*tanhFunction(y[1][r-1])
-                                 + weightValues.value("s13",0.0)*sinEFunction(y[2][r-1])
-                                 + weightValues.value("s14",0.0)*sinEFunction(y[3][r-1])) * bg;
-
-                    y[1][om] += (-y[1][r-1] + weightValues.value("s21",0.0)*sinEFunction(y[0][r-1])
-                                 + weightValues.value("s23",0.0)*sinEFunction(y[2][r-1])
-                                 + weightValues.value("s25",0.0)*sinEFunction(y[4][r-1])) * bg;
-
-                    y[2][om] += (-y[2][r-1] + weightValues.value("s31",0.0)*tanhFunction(y[0][r-1])
-                                 + weightValues.value("s32",0.0)*tanhFunction(y[1][r-1])
-                                 + weightValues.value("s33",0.0)*sinEFunction(y[2][r-1])) * bg;
-
-                    double gate4Term;
-                    if (gateNode4.enabled) {
-                        const double G2 = evalGateForNode(3, y[3][r-1]);
-                        gate4Term = G2 * tanhFunction(y[3][r-1]);
-                    } else {
-                        gate4Term = (alpha2 - alpha3*sinEFunction(y[4][r-1])) * tanhFunction(y[3][r-1]);
-                    }
-                    y[3][om] += (-y[3][r-1] + weightValues.value("s41",0.0)*tanhFunction(y[0][r-1]) + gate4Term) * bg;
-
-                    double gate5Term;
-                    if (gateNode5.enabled) {
-                        const double G1 = evalGateForNode(4, y[4][r-1]);
-                        gate5Term = G1 * tanhFunction(y[4][r-1]);
-                    } else {
-                        gate5Term = (1.0 - alpha1*tanhFunction(y[2][r-1])) * tanhFunction(y[4][r-1]);
-                    }
-                    y[4][om] += (-y[4][r-1] + weightValues.value("s52",0.0)*tanhFunction(y[1][r-1]) + gate5Term) * bg;
-                }
-
-                for (int i = 0; i < 5; ++i)
-                    y[i][om] += y[i][0];
-
-                if (om % sampleStride == 0 || om == steps) {
-                    out3d << a2 << " " << om << " " << y[0][om] << " " << y[1][om] << " "
-                          << y[2][om] << " " << y[3][om] << " " << y[4][om] << "\n";
-                }
-            }
-        }
+    Alpha2ScanSettings scan;
+    scan.min = a2Min;
+    scan.max = a2Max;
+    scan.step = a2Step;
+    scan.transientPercent = transientPercent;
+    scan.sampleStride = sampleStride;
 
-        for (int t = transientStart; t <= steps; t += sampleStride) {
-            out2d << a2 << " "
-                  << y[0][t] << " " << y[1][t] << " " << y[2][t] << " "
-                  << y[3][t] << " " << y[4][t] << "\n";
-        }
-
-        alpha2 = oldAlpha2;
-        out3d << "\n";
-        out2d << "\n";
-    }
-
-    f3d.close();
-    f2d.close();
-
-    generateAlpha2ScanGnuplotScripts();
+    cancelRequested = false;
+    if (reportStatus(runner.scanAlpha2(currentConfig(), scan), "Error")) plotAlpha2Scan();
+}
 
-    QProcess proc;
-    proc.setWorkingDirectory(currentRunDir);
-    proc.start("gnuplot", QStringList() << "alpha2_scan.gnu");
+void ButtonNetwork::plotAlpha2Scan()
+{
+    writeAlpha2ScanGnuplotScript(runner.runDir);
 
-    if (!proc.waitForStarted()) {
+    bool started = false;
+    QString gpStdout, gpStderr;
+    const bool ok = runGnuplot(runner.runDir, "alpha2_scan.gnu", &started, &gpStdout, &gpStderr);
+    if (!started) {
         QMessageBox::warning(this, "Gnuplot", "Failed to start gnuplot. Is it installed?");
         return;
     }
 //nuplot 실행 결과가 실패인지 성공인지 판단해서, 실패면 경고 띄우고 종료 / 성공이면 파일 저장 완료 signal을 emit
-    const bool finished = proc.waitForFinished(-1);
-    const QString gpStdout = QString::fromLocal8Bit(proc.readAllStandardOutput());
-    const QString gpStderr = QString::fromLocal8Bit(proc.readAllStandardError());
-
     QFile gpLog(runPath("alpha2_gnuplot_log.txt"));
     if (gpLog.open(QIODevice::WriteOnly | QIODevice::Text)) {
         QTextStream gl(&gpLog);
@@ -904,7 +530,7 @@ void ButtonNetwork::scanAlpha2ReuseCurrentRun()
         if (!gpStdout.trimmed().isEmpty()) equationEditor->append("\n[gnuplot stdout]\n" + gpStdout);
     }
 
-    if (!finished || proc.exitStatus() != QProcess::NormalExit || proc.exitCode() != 0) {
+    if (!ok) {
         QMessageBox::warning(this, "Gnuplot",
                              "alpha2 scan data saved, but gnuplot failed.\n"
                              "See alpha2_gnuplot_log.txt in the run folder.");
@@ -914,35 +540,6 @@ void ButtonNetwork::scanAlpha2ReuseCurrentRun()
     emit fileSaved(runPath("alpha2_y1.png"));
 }
 
-void ButtonNetwork::generateAlpha2ScanGnuplotScripts() const
-{
-    if (currentRunDir.isEmpty()) return;
-
-    QFile script(runPath("alpha2_scan.gnu"));
-    if (!script.open(QIODevice::WriteOnly | QIODevice::Text)) return;
-
-    QTextStream g(&script);
-
-    g << "set term pngcairo size 900,700\n";
-    g << "set grid\n";
-    g << "set xlabel 'alpha2'\n";
-    g << "unset key\n";
-    g << "set pointsize 0.6\n";
-
-    const char* yNames[5] = {"y1","y2","y3","y4","y5"};
-    const int col2d[5] = {2,3,4,5,6};
-
-    for (int i = 0; i < 5; ++i) {
-        g << "set output 'alpha2_" << yNames[i] << ".png'\n";
-        g << "set ylabel '" << yNames[i] << "'\n";
-        g << "plot 'alpha2_scan_2d.dat' using 1:" << col2d[i]
-          << " with points pt 7 ps 0.4\n\n";
-    }
-
-    g << "set output\n";
-    script.close();
-}
-
 // ================= Click-edit connections =================
 //선(연결선)을 클릭했는지 판단하는 hit-testing 용도
 double ButtonNetwork::distancePointToSegment(const QPointF& p,
@@ -1029,7 +626,7 @@ void ButtonNetwork::editConnectionAt(int index)
     // self-loop on node4 or node5 => edit Gate
     if (conn.start == conn.end && (sIdx == 4 || sIdx == 5)) {
 
-        GateConfig* gate = (sIdx == 4) ? &gateNode4 : &gateNode5;
+        GateConfig* gate = (sIdx == 4) ? &config.gateNode4 : &config.gateNode5;
         const QString gateName = (sIdx == 4) ? "G2 (Node4)" : "G1 (Node5)";
 
         QDialog dialog(this);
@@ -1102,11 +699,11 @@ void ButtonNetwork::editConnectionAt(int index)
     bool ok;
     double newVal = QInputDialog::getDouble(
         this, "Edit Weight",
-        "Enter value for " + key + ":", weightValues.value(key, 0.0),
+        "Enter value for " + key + ":", config.weightValues.value(key, 0.0),
         -1000, 1000, 6, &ok);
     if (!ok) return;
 
-    weightValues[key] = newVal;
+    config.weightValues[key] = newVal;
 
     QStringList items;
     items << "sin_exp" << "tanh" << "relu";
@@ -1119,6 +716,847 @@ void ButtonNetwork::editConnectionAt(int index)
     }
 }
 
+// ================= Load network =================
+
+//params.txt / run_info.txt 는 run 폴더 단위로 (둘을 합쳐서), graph.txt 등은 파일 하나로 읽음
+void ButtonNetwork::loadNetwork()
+{
+    const QString path = QFileDialog::getOpenFileName(
+        this, "Load network (params.txt / run_info.txt / graph.txt)", runner.baseResultDir,
+        "Network files (*.txt);;All files (*)");
+    if (path.isEmpty()) return;
+
+    const QFileInfo fi(path);
+    SimulationConfig loaded;
+    QString error;
+    QStringList warnings;
+    const bool inRunFolder = fi.fileName() == "params.txt" || fi.fileName() == "run_info.txt";
+    const bool ok = inRunFolder ? loadRunFolder(fi.absolutePath(), loaded, &error, &warnings)
+                                : loadNetworkFile(path, loaded, &error, &warnings);
+    if (!ok) {
+        QMessageBox::warning(this, "Load Network", error);
+        return;
+    }
+
+    applyLoadedConfig(loaded);
+
+    if (equationEditor) {
+        equationEditor->append(QString("[load] %1: %2 connections, solver %3, tMax %4")
+                                   .arg(path).arg(loaded.connections.size())
+                                   .arg(loaded.solverMode).arg(loaded.tMax));
+        for (const QString& w : warnings) equationEditor->append("[warn] " + w);
+    }
+    emit networkLoaded(config.solverMode, config.tMax, config.fractionalKernel);
+}
+
+void ButtonNetwork::applyLoadedConfig(const SimulationConfig& loaded)
+{
+    clearNetwork();
+    config = loaded;
+    ensurePresetNodes5();
+
+    for (const ConnectionConfig& c : loaded.connections) {
+        if (c.from > buttons.size() || c.to > buttons.size()) continue;
+        addOrUpdateConnection(c.from, c.to,
+                              loaded.weightValues.value(SimulationConfig::weightKey(c.from, c.to), 0.0),
+                              c.function);
+    }
+    update();
+}
+
+// ================= Custom equations =================
+
+//"Dy1 = ..." 식을 직접 입력. 비어 있으면 canvas 를 식으로 바꿔서 보여줌 (그대로 고쳐 쓰기 쉽게)
+//OK 할 때 한 번 compile 해서 오류를 바로 알려주고, 계산 중에는 bytecode 만 실행
+void ButtonNetwork::editEquations()
+{
+    SimulationConfig& cfg = currentConfig();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Equations");
+    dialog.resize(640, 360);
+
+    QVBoxLayout layout(&dialog);
+    QLabel help("Dy<i> = expression, one per line. Names: y1..y5, alpha1..alpha3, nu, s<ij>;\n"
+                "functions sin, cos, tanh, exp, log, sqrt, abs, relu, pow(a,b); '#' starts a comment.",
+                &dialog);
+    QPlainTextEdit text(&dialog);
+    text.setPlainText(cfg.equations.trimmed().isEmpty() ? cfg.networkAsEquations() : cfg.equations);
+    QCheckBox useBox("Use these equations instead of the drawn network", &dialog);
+    useBox.setChecked(!cfg.equations.trimmed().isEmpty());
+    QLabel status(&dialog);
+    QPushButton checkButton("Check", &dialog);
+    QPushButton okButton("OK", &dialog);
+
+    layout.addWidget(&help);
+    layout.addWidget(&text, 1);
+    layout.addWidget(&useBox);
+    layout.addWidget(&status);
+    layout.addWidget(&checkButton);
+    layout.addWidget(&okButton);
+
+    auto compileText = [&](QString* error) {
+        SimulationConfig trial = cfg;
+        trial.equations = text.toPlainText();
+        return trial.compileEquations(error);
+    };
+
+    connect(&checkButton, &QPushButton::clicked, [&]() {
+        QString error;
+        const auto program = compileText(&error);
+        status.setText(program ? QString("OK: %1 operations").arg(program->operationCount()) : error);
+    });
+
+    connect(&okButton, &QPushButton::clicked, [&]() {
+        if (!useBox.isChecked()) {
+            cfg.equations.clear();
+            dialog.accept();
+            return;
+        }
+        QString error;
+        const auto program = compileText(&error);
+        if (!program) {
+            QMessageBox::warning(this, "Equations", error);
+            return;
+        }
+        cfg.equations = text.toPlainText();
+        if (equationEditor)
+            equationEditor->append(QString("[equations] compiled to %1 operations")
+                                       .arg(program->operationCount()));
+        dialog.accept();
+    });
+
+    dialog.exec();
+    update();
+}
+
+// ================= Large network =================
+
+//canvas 대신 random / small-world / lattice graph 생성 또는 edge list 파일 (networkgenerator.h)
+//결과는 result_final.csv(모든 node), result_summary.dat(node 전체 통계), result.dat 은 y1..y5
+void ButtonNetwork::editLargeNetwork()
+{
+    SimulationConfig& cfg = currentConfig();
+    LargeNetworkConfig large = cfg.large;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Large Network");
+
+    QVBoxLayout layout(&dialog);
+    QComboBox kindBox(&dialog);
+    kindBox.addItems({"off", "random", "smallworld", "lattice", "edgelist"});
+    kindBox.setCurrentText(large.enabled() ? large.kind : QString("off"));
+
+    QSpinBox nodesBox(&dialog);
+    nodesBox.setRange(5, 10000000);
+    nodesBox.setValue(large.nodes);
+    QSpinBox degreeBox(&dialog);
+    degreeBox.setRange(1, 10000);
+    degreeBox.setValue(large.degree);
+    QDoubleSpinBox rewireBox(&dialog);
+    rewireBox.setRange(0.0, 1.0);
+    rewireBox.setSingleStep(0.05);
+    rewireBox.setValue(large.rewire);
+    QDoubleSpinBox scaleBox(&dialog);
+    scaleBox.setRange(-100.0, 100.0);
+    scaleBox.setDecimals(4);
+    scaleBox.setValue(large.weightScale);
+    QSpinBox seedBox(&dialog);
+    seedBox.setRange(0, 2147483647);
+    seedBox.setValue(int(std::min<quint64>(large.seed, 2147483647)));
+    QComboBox fnBox(&dialog);
+    fnBox.addItems({"tanh", "sin", "relu"});
+    fnBox.setCurrentText(large.fn == "sin_exp" ? QString("sin") : large.fn);
+    QPushButton fileButton(large.edgeListPath.isEmpty() ? QString("Edge list file...") : large.edgeListPath, &dialog);
+    QComboBox orderingBox(&dialog);
+    orderingBox.addItems({"none", "rcm", "community"});
+    orderingBox.setCurrentText(large.ordering);
+    QSpinBox threadsBox(&dialog);
+    threadsBox.setRange(0, 1024);
+    threadsBox.setValue(runner.rhsThreads);
+    threadsBox.setSpecialValueText("all cores");
+
+    QLabel status(&dialog);
+    QPushButton okButton("OK", &dialog);
+
+    auto row = [&](const QString& name, QWidget* w) {
+        auto* h = new QHBoxLayout();
+        h->addWidget(new QLabel(name, &dialog));
+        h->addWidget(w, 1);
+        layout.addLayout(h);
+    };
+    row("Graph", &kindBox);
+    row("Nodes", &nodesBox);
+    row("In-degree", &degreeBox);
+    row("Rewire p (small-world)", &rewireBox);
+    row("Weight scale", &scaleBox);
+    row("Seed", &seedBox);
+    row("Function", &fnBox);
+    row("Edge list (from to [w [fn]])", &fileButton);
+    row("Node order (memory only)", &orderingBox);
+    row("RHS threads", &threadsBox);
+    layout.addWidget(&status);
+    layout.addWidget(&okButton);
+
+    connect(&fileButton, &QPushButton::clicked, [&]() {
+        const QString path = QFileDialog::getOpenFileName(&dialog, "Edge list", QFileInfo(large.edgeListPath).path());
+        if (path.isEmpty()) return;
+        large.edgeListPath = path;
+        fileButton.setText(path);
+        kindBox.setCurrentText("edgelist");
+    });
+
+    connect(&okButton, &QPushButton::clicked, [&]() {
+        large.kind = (kindBox.currentText() == "off") ? QString() : kindBox.currentText();
+        large.nodes = nodesBox.value();
+        large.degree = degreeBox.value();
+        large.rewire = rewireBox.value();
+        large.weightScale = scaleBox.value();
+        large.seed = quint64(seedBox.value());
+        large.fn = fnBox.currentText();
+        large.ordering = orderingBox.currentText();
+
+        SimulationConfig trial = cfg;
+        trial.equations.clear();
+        trial.large = large;
+        QString error;
+        if (!trial.checkLargeNetwork(&error)) {
+            QMessageBox::warning(this, "Large Network", error);
+            return;
+        }
+
+        cfg.large = large;
+        runner.rhsThreads = threadsBox.value();
+        if (equationEditor && large.enabled()) {
+            const NetworkSpec spec = trial.networkSpec();
+            equationEditor->append(QString("[large] %1: %2 nodes, %3 edges")
+                                       .arg(large.kind).arg(spec.nodeCount).arg(qint64(spec.edges.size())));
+        }
+        dialog.accept();
+    });
+
+    dialog.exec();
+    update();
+}
+
+// ================= Parareal =================
+
+//ODE(Euler) 전용: tMax 를 slice 로 나누고 coarse Euler(ratio*h) 예측 + slice 별 fine Euler 병렬 보정
+//tolerance 0 또는 maxIterations = slices 이면 일반 Euler 와 bit 단위로 같은 결과
+void ButtonNetwork::editParareal()
+{
+    SimulationConfig& cfg = currentConfig();
+    PararealConfig parareal = cfg.parareal;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Parareal");
+
+    QVBoxLayout layout(&dialog);
+    QCheckBox enabledBox("Parallel-in-time Euler (ODE only)", &dialog);
+    enabledBox.setChecked(parareal.enabled);
+    QSpinBox slicesBox(&dialog);
+    slicesBox.setRange(2, 4096);
+    slicesBox.setValue(parareal.slices);
+    QSpinBox ratioBox(&dialog);
+    ratioBox.setRange(1, 100000);
+    ratioBox.setValue(parareal.coarseRatio);
+    QDoubleSpinBox tolBox(&dialog);
+    tolBox.setRange(0.0, 1.0);
+    tolBox.setDecimals(12);
+    tolBox.setValue(parareal.tolerance);
+    QSpinBox iterBox(&dialog);
+    iterBox.setRange(0, 4096);
+    iterBox.setValue(parareal.maxIterations);
+    iterBox.setSpecialValueText("slices (exact)");
+    QSpinBox threadsBox(&dialog);
+    threadsBox.setRange(0, 1024);
+    threadsBox.setValue(runner.rhsThreads);
+    threadsBox.setSpecialValueText("all cores");
+    QPushButton okButton("OK", &dialog);
+
+    auto row = [&](const QString& name, QWidget* w) {
+        auto* h = new QHBoxLayout();
+        h->addWidget(new QLabel(name, &dialog));
+        h->addWidget(w, 1);
+        layout.addLayout(h);
+    };
+    layout.addWidget(&enabledBox);
+    row("Time slices", &slicesBox);
+    row("Coarse step (x h)", &ratioBox);
+    row("Tolerance (relative)", &tolBox);
+    row("Max iterations", &iterBox);
+    row("Threads", &threadsBox);
+    layout.addWidget(&okButton);
+
+    connect(&okButton, &QPushButton::clicked, [&]() {
+        parareal.enabled = enabledBox.isChecked();
+        parareal.slices = slicesBox.value();
+        parareal.coarseRatio = ratioBox.value();
+        parareal.tolerance = tolBox.value();
+        parareal.maxIterations = iterBox.value();
+        cfg.parareal = parareal;
+        runner.rhsThreads = threadsBox.value();
+        if (equationEditor && parareal.enabled && cfg.solverMode != "ODE")
+            equationEditor->append("[parareal] only used with the ODE solver");
+        dialog.accept();
+    });
+
+    dialog.exec();
+}
+
+// ================= Per-node orders =================
+
+//GAMMA 전용: "node=nu" 목록, 나머지 node 는 nu. nu=1 인 node 는 일반 ODE 처럼 동작
+void ButtonNetwork::editNodeOrders()
+{
+    SimulationConfig& cfg = currentConfig();
+    QStringList choices = {cfg.nodeOrdersText(), ""};
+    choices.removeDuplicates();
+
+    bool ok = false;
+    const QString text = QInputDialog::getItem(this, "Node Orders",
+                                               "Per-node orders (GAMMA), e.g. 3=0.5 5=1; empty: every node uses nu:",
+                                               choices, 0, true, &ok);
+    if (!ok) return;
+    if (!cfg.setNodeOrdersText(text)) {
+        QMessageBox::warning(this, "Node Orders", "Expected node=nu pairs, node >= 1, nu > 0.");
+        return;
+    }
+    if (equationEditor && cfg.mixedOrders() && cfg.solverMode != "GAMMA")
+        equationEditor->append("[orders] only used with the GAMMA solver");
+}
+
+// ================= Events =================
+
+//"y3 up 0, y2 max": Compute 는 events.dat, alpha2 scan 은 stride sample 대신 event 상태로 2d 그림
+void ButtonNetwork::editEvents()
+{
+    SimulationConfig& cfg = currentConfig();
+    QStringList choices = {cfg.events, "y3 up 0", "y1 max", ""};
+    choices.removeDuplicates();
+
+    bool ok = false;
+    const QString text = QInputDialog::getItem(this, "Events",
+                                               "Events, comma separated (y<i> up|down|cross <level>, y<i> max|min); "
+                                               "empty: off:",
+                                               choices, 0, true, &ok);
+    if (!ok) return;
+    SimulationConfig trial = cfg;
+    trial.events = text.trimmed();
+    QString why;
+    if (!trial.checkEvents(0, &why)) {
+        QMessageBox::warning(this, "Events", why);
+        return;
+    }
+    cfg.events = trial.events;
+}
+
+// ================= Basin map =================
+
+//y_i(0), y_j(0) 두 초기값을 grid 로 sweep, 나머지 초기값은 고정. ODE 전용
+//결과: basin.ppm, basin_labels.dat, basin_summary.txt, basin.png (gnuplot)
+void ButtonNetwork::mapBasins()
+{
+    SimulationConfig& cfg = currentConfig();
+    if (cfg.solverMode != "ODE") {
+        QMessageBox::warning(this, "Basin Map", "Basin maps need the ODE solver.");
+        return;
+    }
+    const int nodes = cfg.networkSpec().nodeCount;
+    BasinSettings basin = basinSettings;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Basin Map");
+
+    QVBoxLayout layout(&dialog);
+    QSpinBox xNodeBox(&dialog), yNodeBox(&dialog);
+    xNodeBox.setRange(1, nodes);
+    yNodeBox.setRange(1, nodes);
+    xNodeBox.setValue(std::min(basin.xNode + 1, nodes));
+    yNodeBox.setValue(std::min(basin.yNode + 1, nodes));
+    QDoubleSpinBox xMinBox(&dialog), xMaxBox(&dialog), yMinBox(&dialog), yMaxBox(&dialog);
+    for (QDoubleSpinBox* b : {&xMinBox, &xMaxBox, &yMinBox, &yMaxBox}) {
+        b->setRange(-1000.0, 1000.0);
+        b->setDecimals(4);
+    }
+    xMinBox.setValue(basin.xMin);
+    xMaxBox.setValue(basin.xMax);
+    yMinBox.setValue(basin.yMin);
+    yMaxBox.setValue(basin.yMax);
+    QSpinBox sizeBox(&dialog);
+    sizeBox.setRange(2, 4096);
+    sizeBox.setValue(basin.width);
+    QPushButton okButton("Map", &dialog);
+
+    auto row = [&](const QString& name, QWidget* a, QWidget* b = nullptr) {
+        auto* h = new QHBoxLayout();
+        h->addWidget(new QLabel(name, &dialog));
+        h->addWidget(a, 1);
+        if (b) h->addWidget(b, 1);
+        layout.addLayout(h);
+    };
+    row("x: node / min", &xNodeBox, &xMinBox);
+    row("x: max", &xMaxBox);
+    row("y: node / min", &yNodeBox, &yMinBox);
+    row("y: max", &yMaxBox);
+    row("Grid (cells per side)", &sizeBox);
+    layout.addWidget(new QLabel(QString("Each cell runs up to tMax = %1 steps, the other initial values stay fixed.")
+                                    .arg(cfg.tMax), &dialog));
+    layout.addWidget(&okButton);
+
+    connect(&okButton, &QPushButton::clicked, [&]() {
+        if (xNodeBox.value() == yNodeBox.value() || xMaxBox.value() <= xMinBox.value()
+            || yMaxBox.value() <= yMinBox.value()) {
+            QMessageBox::warning(&dialog, "Basin Map", "Pick two different nodes and non-empty ranges.");
+            return;
+        }
+        basin.xNode = xNodeBox.value() - 1;
+        basin.yNode = yNodeBox.value() - 1;
+        basin.xMin = xMinBox.value();
+        basin.xMax = xMaxBox.value();
+        basin.yMin = yMinBox.value();
+        basin.yMax = yMaxBox.value();
+        basin.width = basin.height = sizeBox.value();
+        dialog.accept();
+    });
+    if (dialog.exec() != QDialog::Accepted) return;
+    basinSettings = basin;
+
+    if (!createNewRunDir()) return;
+    runner.writeRunHeaderFiles(cfg);
+
+    cancelRequested = false;
+    const SimulationRunner::Status status = runner.mapBasins(cfg, basin);
+    if (status == SimulationRunner::Status::Cancelled) return;
+    if (!reportStatus(status, "Basin Map")) return;
+
+    bool started = false;
+    QString gpStderr;
+    if (!runGnuplot(runner.runDir, "basin.gnu", &started, nullptr, &gpStderr)) {
+        if (equationEditor)
+            equationEditor->append(started ? "[gnuplot stderr]\n" + gpStderr
+                                           : QString("[gnuplot] not started, basin.ppm is in the run folder"));
+        emit fileSaved(runPath("basin.ppm"));
+        return;
+    }
+    emit fileSaved(runPath("basin.png"));
+}
+
+// ================= Plane scan =================
+
+//parameter 두 개(alpha1-3, nu, h)를 grid 로 sweep 해서 cell 마다 fixed / periodic / chaotic ... 분류
+//결과: plane_scan.ppm (pass 마다 갱신), plane_scan.bin, plane_scan_summary.txt
+void ButtonNetwork::scanPlane()
+{
+    SimulationConfig& cfg = currentConfig();
+    const bool ode = (cfg.solverMode == "ODE");
+    const bool stepped = (cfg.solverMode != "GAMMA"); //GAMMA 는 h 가 없음
+    QStringList names;
+    for (const QString& name : SimulationConfig::scanParameterNames())
+        if ((name != "nu" || !ode) && (name != "h" || stepped)) names << name;
+    PlaneScanSettings plane = planeSettings;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Plane Scan");
+
+    QVBoxLayout layout(&dialog);
+    QComboBox xParamBox(&dialog), yParamBox(&dialog);
+    xParamBox.addItems(names);
+    yParamBox.addItems(names);
+    xParamBox.setCurrentText(QString::fromStdString(plane.xParam));
+    yParamBox.setCurrentText(QString::fromStdString(plane.yParam));
+    QDoubleSpinBox xMinBox(&dialog), xMaxBox(&dialog), yMinBox(&dialog), yMaxBox(&dialog);
+    for (QDoubleSpinBox* b : {&xMinBox, &xMaxBox, &yMinBox, &yMaxBox}) {
+        b->setRange(-1000.0, 1000.0);
+        b->setDecimals(4);
+    }
+    xMinBox.setValue(plane.xMin);
+    xMaxBox.setValue(plane.xMax);
+    yMinBox.setValue(plane.yMin);
+    yMaxBox.setValue(plane.yMax);
+    QSpinBox sizeBox(&dialog);
+    sizeBox.setRange(2, 2048);
+    sizeBox.setValue(plane.width);
+    QPushButton okButton("Scan", &dialog);
+
+    auto row = [&](const QString& name, QWidget* a, QWidget* b = nullptr) {
+        auto* h = new QHBoxLayout();
+        h->addWidget(new QLabel(name, &dialog));
+        h->addWidget(a, 1);
+        if (b) h->addWidget(b, 1);
+        layout.addLayout(h);
+    };
+    row("x: parameter / min", &xParamBox, &xMinBox);
+    row("x: max", &xMaxBox);
+    row("y: parameter / min", &yParamBox, &yMinBox);
+    row("y: max", &yMaxBox);
+    row("Grid (cells per side)", &sizeBox);
+    layout.addWidget(new QLabel(QString("Each cell runs tMax = %1 steps; the image fills in coarse to fine.")
+                                    .arg(cfg.tMax), &dialog));
+    layout.addWidget(&okButton);
+
+    connect(&okButton, &QPushButton::clicked, [&]() {
+        if (xParamBox.currentText() == yParamBox.currentText() || xMaxBox.value() <= xMinBox.value()
+            || yMaxBox.value() <= yMinBox.value()) {
+            QMessageBox::warning(&dialog, "Plane Scan", "Pick two different parameters and non-empty ranges.");
+            return;
+        }
+        plane.xParam = xParamBox.currentText().toStdString();
+        plane.yParam = yParamBox.currentText().toStdString();
+        plane.xMin = xMinBox.value();
+        plane.xMax = xMaxBox.value();
+        plane.yMin = yMinBox.value();
+        plane.yMax = yMaxBox.value();
+        plane.width = plane.height = sizeBox.value();
+        dialog.accept();
+    });
+    if (dialog.exec() != QDialog::Accepted) return;
+    planeSettings = plane;
+
+    if (!createNewRunDir()) return;
+    runner.writeRunHeaderFiles(cfg);
+
+    cancelRequested = false;
+    const SimulationRunner::Status status = runner.scanPlane(cfg, plane);
+    if (status == SimulationRunner::Status::Cancelled) {
+        emit fileSaved(runPath("plane_scan.ppm")); // finished passes
+        return;
+    }
+    if (!reportStatus(status, "Plane Scan")) return;
+    emit fileSaved(runPath("plane_scan.ppm"));
+}
+
+// ================= Equilibria =================
+
+//Newton 으로 f(y) = 0 을 직접 찾음 (불안정한 평형점도). 결과: equilibria.txt, equilibria_eigenvalues.dat
+void ButtonNetwork::findEquilibria()
+{
+    SimulationConfig& cfg = currentConfig();
+    bool ok = false;
+    const int seeds = QInputDialog::getInt(this, "Equilibria",
+                                           "Newton seeds (initial state, origin, then random in [-2, 2]):",
+                                           equilibriumSeeds, 1, 100000, 1, &ok);
+    if (!ok) return;
+    equilibriumSeeds = seeds;
+
+    if (!createNewRunDir()) return;
+    runner.writeRunHeaderFiles(cfg);
+
+    EquilibriumSettings settings;
+    settings.seeds = seeds;
+    cancelRequested = false;
+    const SimulationRunner::Status status = runner.findEquilibria(cfg, settings);
+    if (status == SimulationRunner::Status::Cancelled) return;
+    if (!reportStatus(status, "Equilibria")) return;
+    emit fileSaved(runPath("equilibria.txt"));
+}
+
+// ================= Continuation =================
+
+//parameter 하나를 바꿔가며 평형점 branch 를 따라감 (fold 너머 unstable 쪽도). 결과: continuation.dat, continuation_y*.png
+void ButtonNetwork::continueBranches()
+{
+    SimulationConfig& cfg = currentConfig();
+    QStringList names = {"alpha1", "alpha2", "alpha3"};
+    for (int i = 1; i <= 5; ++i)
+        for (int j = 1; j <= 5; ++j)
+            if (i != j) names << QString("s%1%2").arg(i).arg(j);
+    ContinuationSettings settings = continuationSettings;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Continuation");
+
+    QVBoxLayout layout(&dialog);
+    QComboBox paramBox(&dialog);
+    paramBox.addItems(names);
+    paramBox.setCurrentText(continuationParameter);
+    QDoubleSpinBox minBox(&dialog), maxBox(&dialog);
+    for (QDoubleSpinBox* b : {&minBox, &maxBox}) {
+        b->setRange(-1000.0, 1000.0);
+        b->setDecimals(4);
+    }
+    minBox.setValue(settings.pMin);
+    maxBox.setValue(settings.pMax);
+    QPushButton okButton("Continue", &dialog);
+
+    auto row = [&](const QString& name, QWidget* w) {
+        auto* h = new QHBoxLayout();
+        h->addWidget(new QLabel(name, &dialog));
+        h->addWidget(w, 1);
+        layout.addLayout(h);
+    };
+    row("Parameter", &paramBox);
+    row("min", &minBox);
+    row("max", &maxBox);
+    layout.addWidget(new QLabel("Branches start at the equilibria of the current value and run both ways.", &dialog));
+    layout.addWidget(&okButton);
+
+    connect(&okButton, &QPushButton::clicked, [&]() {
+        double p0 = 0.0;
+        if (!cfg.scanParameter(paramBox.currentText(), p0) || !(maxBox.value() > minBox.value())
+            || p0 < minBox.value() || p0 > maxBox.value()) {
+            QMessageBox::warning(&dialog, "Continuation",
+                                 QString("The range must contain the current value %1.").arg(p0));
+            return;
+        }
+        settings.pMin = minBox.value();
+        settings.pMax = maxBox.value();
+        dialog.accept();
+    });
+    if (dialog.exec() != QDialog::Accepted) return;
+    continuationParameter = paramBox.currentText();
+    continuationSettings = settings;
+
+    if (!createNewRunDir()) return;
+    runner.writeRunHeaderFiles(cfg);
+
+    cancelRequested = false;
+    const SimulationRunner::Status status = runner.continueBranches(cfg, continuationParameter, settings);
+    if (status == SimulationRunner::Status::Cancelled) return;
+    if (!reportStatus(status, "Continuation")) return;
+
+    bool started = false;
+    QString gpStderr;
+    if (!runGnuplot(runner.runDir, "continuation.gnu", &started, nullptr, &gpStderr)) {
+        if (equationEditor)
+            equationEditor->append(started ? "[gnuplot stderr]\n" + gpStderr
+                                           : QString("[gnuplot] not started, continuation.dat is in the run folder"));
+        emit fileSaved(runPath("continuation.dat"));
+        return;
+    }
+    emit fileSaved(runPath("continuation_y1.png"));
+}
+
+// ================= Sensitivities =================
+
+//parameter 별로 다시 돌리지 않고 d y / d p 를 한 번의 run 에서 같이 적분. 결과: sensitivity_<p>.dat, .png
+void ButtonNetwork::computeSensitivities()
+{
+    SimulationConfig& cfg = currentConfig();
+    if (cfg.solverMode != "ODE") {
+        QMessageBox::warning(this, "Sensitivities", "Sensitivities need the ODE solver.");
+        return;
+    }
+    QStringList choices = {sensitivityParameters, "alpha1,alpha2,alpha3"};
+    QStringList weights;
+    for (const ConnectionConfig& c : cfg.connections) weights << SimulationConfig::weightKey(c.from, c.to);
+    if (!weights.isEmpty()) choices << weights.join(",");
+    choices.removeDuplicates();
+
+    bool ok = false;
+    const QString text = QInputDialog::getItem(this, "Sensitivities",
+                                               "Parameters, comma separated (alpha1-3, s<ij>, g4coeff, g5coeff, "
+                                               "g4base, g5base):",
+                                               choices, 0, true, &ok);
+    if (!ok) return;
+    QStringList parameters;
+    for (const QString& p : text.split(',', Qt::SkipEmptyParts)) parameters << p.trimmed();
+    if (parameters.isEmpty()) return;
+    sensitivityParameters = parameters.join(",");
+
+    if (!createNewRunDir()) return;
+
+    cancelRequested = false;
+    const SimulationRunner::Status status = runner.computeSensitivities(cfg, parameters);
+    if (status == SimulationRunner::Status::Cancelled) return;
+    if (!reportStatus(status, "Sensitivities")) return;
+
+    bool started = false;
+    QString gpStderr;
+    if (!runGnuplot(runner.runDir, "sensitivity.gnu", &started, nullptr, &gpStderr)) {
+        if (equationEditor)
+            equationEditor->append(started ? "[gnuplot stderr]\n" + gpStderr
+                                           : QString("[gnuplot] not started, sensitivity_*.dat is in the run folder"));
+        emit fileSaved(runPath("sensitivity_" + parameters.front() + ".dat"));
+        return;
+    }
+    emit fileSaved(runPath("sensitivity_" + parameters.front() + ".png"));
+}
+
+// ================= Parameter fit =================
+
+//기록된 궤적(result.dat 형식)에 맞게 parameter 를 LM 으로 맞춤. 맞춘 network 는 새 run 폴더의 params.txt (Load Network 로 읽힘)
+void ButtonNetwork::fitParameters()
+{
+    SimulationConfig& cfg = currentConfig();
+    if (cfg.solverMode != "ODE") {
+        QMessageBox::warning(this, "Fit Parameters", "Parameter fitting needs the ODE solver.");
+        return;
+    }
+    const QString target = QFileDialog::getOpenFileName(this, "Target trajectory (one row per step: y1 y2 ...)",
+                                                        fitTargetPath.isEmpty() ? runner.baseResultDir
+                                                                                : fitTargetPath);
+    if (target.isEmpty()) return;
+    fitTargetPath = target;
+
+    QStringList weights;
+    for (const ConnectionConfig& c : cfg.connections) weights << SimulationConfig::weightKey(c.from, c.to);
+    QStringList choices;
+    if (!weights.isEmpty()) choices << weights.join(",");
+    choices << "alpha1,alpha2,alpha3";
+    if (!weights.isEmpty()) choices << weights.join(",") + ",alpha1,alpha2,alpha3";
+
+    bool ok = false;
+    const QString text = QInputDialog::getItem(this, "Fit Parameters",
+                                               "Parameters, comma separated (alpha1-3, s<ij>, g4coeff, g5coeff, "
+                                               "g4base, g5base):",
+                                               choices, 0, true, &ok);
+    if (!ok) return;
+    QStringList parameters;
+    for (const QString& p : text.split(',', Qt::SkipEmptyParts)) parameters << p.trimmed();
+    if (parameters.isEmpty()) return;
+
+    if (!createNewRunDir()) return;
+
+    cancelRequested = false;
+    const SimulationRunner::Status status = runner.fitParameters(cfg, target, parameters, FitSettings());
+    if (status == SimulationRunner::Status::Cancelled) return;
+    if (!reportStatus(status, "Fit Parameters")) return;
+
+    bool started = false;
+    QString gpStderr;
+    if (!runGnuplot(runner.runDir, "fit.gnu", &started, nullptr, &gpStderr)) {
+        if (equationEditor)
+            equationEditor->append(started ? "[gnuplot stderr]\n" + gpStderr
+                                           : QString("[gnuplot] not started, fit_summary.txt is in the run folder"));
+        emit fileSaved(runPath("fit_summary.txt"));
+        return;
+    }
+    emit fileSaved(runPath("fit.png"));
+}
+
+// ================= Noisy ensemble =================
+
+//각 node 에 noise (sigma dW) 를 넣고 path 를 많이 돌려 평균 / quantile band 를 그림. 결과: ensemble.dat, ensemble_y*.png
+void ButtonNetwork::runEnsemble()
+{
+    SimulationConfig& cfg = currentConfig();
+    if (cfg.solverMode != "ODE") {
+        QMessageBox::warning(this, "Noisy Ensemble", "Noisy ensembles need the ODE solver.");
+        return;
+    }
+    SdeSettings settings = sdeSettings;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Noisy Ensemble");
+
+    QVBoxLayout layout(&dialog);
+    QSpinBox pathsBox(&dialog), seedBox(&dialog);
+    pathsBox.setRange(1, 1000000);
+    pathsBox.setValue(settings.paths);
+    seedBox.setRange(0, 1000000000);
+    seedBox.setValue(int(settings.seed));
+    QDoubleSpinBox sigmaBox(&dialog);
+    sigmaBox.setRange(0.0, 100.0);
+    sigmaBox.setDecimals(4);
+    sigmaBox.setValue(settings.sigma.empty() ? 0.1 : settings.sigma.front());
+    QComboBox noiseBox(&dialog), schemeBox(&dialog);
+    noiseBox.addItems({"additive: sigma dW", "multiplicative: sigma y dW"});
+    noiseBox.setCurrentIndex(settings.noise == NoiseKind::Multiplicative ? 1 : 0);
+    schemeBox.addItems({"Euler-Maruyama", "Milstein"});
+    schemeBox.setCurrentIndex(settings.scheme == SdeScheme::Milstein ? 1 : 0);
+    QPushButton okButton("Run", &dialog);
+
+    auto row = [&](const QString& name, QWidget* w) {
+        auto* h = new QHBoxLayout();
+        h->addWidget(new QLabel(name, &dialog));
+        h->addWidget(w, 1);
+        layout.addLayout(h);
+    };
+    row("Paths", &pathsBox);
+    row("sigma (all nodes)", &sigmaBox);
+    row("Noise", &noiseBox);
+    row("Scheme", &schemeBox);
+    row("Seed", &seedBox);
+    layout.addWidget(new QLabel("Same seed, same paths: the result does not depend on the thread count.", &dialog));
+    layout.addWidget(&okButton);
+
+    connect(&okButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+    if (dialog.exec() != QDialog::Accepted) return;
+    settings.paths = pathsBox.value();
+    settings.sigma = {sigmaBox.value()};
+    settings.noise = noiseBox.currentIndex() == 1 ? NoiseKind::Multiplicative : NoiseKind::Additive;
+    settings.scheme = schemeBox.currentIndex() == 1 ? SdeScheme::Milstein : SdeScheme::EulerMaruyama;
+    settings.seed = std::uint64_t(seedBox.value());
+    sdeSettings = settings;
+
+    if (!createNewRunDir()) return;
+    runner.writeRunHeaderFiles(cfg);
+
+    cancelRequested = false;
+    const SimulationRunner::Status status = runner.runEnsemble(cfg, settings);
+    if (status == SimulationRunner::Status::Cancelled) return;
+    if (!reportStatus(status, "Noisy Ensemble")) return;
+
+    bool started = false;
+    QString gpStderr;
+    if (!runGnuplot(runner.runDir, "ensemble.gnu", &started, nullptr, &gpStderr)) {
+        if (equationEditor)
+            equationEditor->append(started ? "[gnuplot stderr]\n" + gpStderr
+                                           : QString("[gnuplot] not started, ensemble.dat is in the run folder"));
+        emit fileSaved(runPath("ensemble.dat"));
+        return;
+    }
+    emit fileSaved(runPath("ensemble_y1.png"));
+}
+
+// ================= Weight uncertainty =================
+
+//weight (또는 다른 parameter) 를 분포에서 뽑아 여러 번 돌려 y 의 quantile band 를 그림. 결과: uncertainty.dat, uncertainty_y*.png
+void ButtonNetwork::propagateUncertainty()
+{
+    SimulationConfig& cfg = currentConfig();
+    if (cfg.solverMode != "ODE") {
+        QMessageBox::warning(this, "Weight Uncertainty", "Uncertainty runs need the ODE solver.");
+        return;
+    }
+    QStringList weights;
+    for (const ConnectionConfig& c : cfg.connections) weights << SimulationConfig::weightKey(c.from, c.to);
+    QStringList choices;
+    if (!uncertaintyParameters.isEmpty()) choices << uncertaintyParameters;
+    if (!weights.isEmpty()) choices << weights.join(",");
+    choices << "alpha1,alpha2,alpha3";
+    choices.removeDuplicates();
+
+    bool ok = false;
+    const QString text = QInputDialog::getItem(this, "Weight Uncertainty",
+                                               QString("Parameters, comma separated: name (normal, sd = %1 x value), "
+                                                       "name=normal:mean:sd or name=uniform:low:high")
+                                                   .arg(uncertaintySettings.relativeSpread),
+                                               choices, 0, true, &ok);
+    if (!ok) return;
+    QStringList parameters;
+    for (const QString& p : text.split(',', Qt::SkipEmptyParts)) parameters << p.trimmed();
+    if (parameters.isEmpty()) return;
+    const int samples = QInputDialog::getInt(this, "Weight Uncertainty",
+                                             "Maximum samples (stops earlier once the bands settle):",
+                                             uncertaintySettings.maxSamples, 1, 1 << 20, 1024, &ok);
+    if (!ok) return;
+    uncertaintyParameters = parameters.join(",");
+    uncertaintySettings.maxSamples = samples;
+    UncertaintySettings settings = uncertaintySettings;
+    settings.minSamples = qMin(settings.minSamples, samples);
+
+    if (!createNewRunDir()) return;
+    runner.writeRunHeaderFiles(cfg);
+
+    cancelRequested = false;
+    const SimulationRunner::Status status = runner.propagateUncertainty(cfg, parameters, settings);
+    if (status == SimulationRunner::Status::Cancelled) return;
+    if (!reportStatus(status, "Weight Uncertainty")) return;
+
+    bool started = false;
+    QString gpStderr;
+    if (!runGnuplot(runner.runDir, "uncertainty.gnu", &started, nullptr, &gpStderr)) {
+        if (equationEditor)
+            equationEditor->append(started ? "[gnuplot stderr]\n" + gpStderr
+                                           : QString("[gnuplot] not started, uncertainty.dat is in the run folder"));
+        emit fileSaved(runPath("uncertainty.dat"));
+        return;
+    }
+    emit fileSaved(runPath("uncertainty_y1.png"));
+}
+
 // ================= Auto preset =================
 //같은 이름이 이미 있으면 새로 만들 때 덮어써야 하니까
 bool ButtonNetwork::copyOverwrite(const QString& src, const QString& dst) const
@@ -1165,7 +1603,7 @@ void ButtonNetwork::addOrUpdateConnection(int from, int to, double w, const QStr
     else if (fn == "relu") color = Qt::blue;
 
     QString key = "s" + QString::number(from) + QString::number(to);
-    weightValues[key] = w;
+    config.weightValues[key] = w;
 
     for (Connection& c : connections) {
         if (c.start == start && c.end == end) {
@@ -1182,8 +1620,8 @@ void ButtonNetwork::addOrUpdateConnection(int from, int to, double w, const QStr
 
 void ButtonNetwork::runAutoTestNode5Preset()
 {
-    nu = 0.70;
-    solverMode = "GAMMA";
+    config.nu = 0.70;
+    config.solverMode = "GAMMA";
     ensurePresetNodes5();
 
     addOrUpdateConnection(1, 4, -0.6, "sin_exp");
@@ -1200,7 +1638,7 @@ void ButtonNetwork::runAutoTestNode5Preset()
     if (equationEditor) equationEditor->append("\n[AUTO TEST Node5] preset applied. Running...\n");
 
     computeResults();
-    const QString runDirFixed = currentRunDir;
+    const QString runDirFixed = runner.runDir;
 
     showGraph();
     scanAlpha2ReuseCurrentRun();
@@ -11,14 +11,10 @@
 #include <QMouseEvent>
 #include <QPaintEvent>
 #include <QPointF>
+#include <QStringList>
 
-struct GateConfig {
-    bool enabled = false;
-    QString baseType = "const"; // "const", "alpha1", "alpha2", "alpha3"
-    double baseConst = 1.0;
-    double coeff = 1.0;
-    QString fn = "tanh";        // "sin", "tanh", "relu"
-};
+#include "simulationconfig.h"
+#include "simulationrunner.h"
 
 struct Connection {
     QPushButton* start = nullptr;
@@ -38,9 +34,11 @@ public:
     // UI helpers / actions
     void clearNetwork();
     void setSolverMode(const QString& mode);
+    void setFractionalKernel(const QString& kernel); // "pow" or "gamma" (GAMMA solver)
     void setTimeLimit(int t);
     void setAlpha2ScanRange(double minVal, double maxVal, double stepVal);
     void setAlpha2ScanSampling(int transientPercent, int sampleStride);
+    void setNativeCode(bool on); // run compiled native code instead of the interpreter
 
 public slots:
     void computeResults();
@@ -51,8 +49,58 @@ public slots:
     // Auto test preset
     void runAutoTestNode5Preset();
 
+    // Continue the current run up to tMax
+    void extendCurrentRun();
+
+    // Checkpoint / restart
+    void cancelComputation();
+    void resumeFromCheckpoint();
+
+    // Rebuild the canvas from params.txt / run_info.txt / graph.txt
+    void loadNetwork();
+
+    // Custom Dy_i = ... right-hand side (equationdsl.h)
+    void editEquations();
+
+    // Generated / edge-list network of thousands of nodes instead of the canvas
+    void editLargeNetwork();
+
+    // Parallel-in-time Euler (networksolver.h, integrateEulerParareal)
+    void editParareal();
+
+    // Per-node fractional orders of the GAMMA solver (SimulationConfig::nodeOrders)
+    void editNodeOrders();
+
+    // Event list (crossings / extrema, eventdetector.h) logged per run and alpha2 scan point
+    void editEvents();
+
+    // Basin-of-attraction map over two initial values (basinmapper.h), new run folder
+    void mapBasins();
+
+    // Regime map over two parameters (planescan.h), new run folder
+    void scanPlane();
+
+    // Equilibria by Newton + Jacobian eigenvalues (equilibrium.h), new run folder
+    void findEquilibria();
+
+    // Equilibrium branches over one parameter (continuation.h), new run folder
+    void continueBranches();
+
+    // Run with d y / d parameter sensitivities (sensitivity.h), new run folder
+    void computeSensitivities();
+
+    // Fit weights / alphas / gate coefficients to a recorded trajectory (parameterfit.h), new run folder
+    void fitParameters();
+
+    // Noisy (SDE) ensemble: mean / std / quantile bands over many paths (sdeensemble.h), new run folder
+    void runEnsemble();
+
+    // Monte Carlo quantile bands over uncertain weights / parameters (uncertainty.h), new run folder
+    void propagateUncertainty();
+
 signals:
     void fileSaved(const QString& path);
+    void networkLoaded(const QString& solverMode, int tMax, const QString& fractionalKernel);
 
 protected:
     void mousePressEvent(QMouseEvent *event) override;
@@ -67,42 +115,32 @@ private:
     QString buildTerm(const QString& from, const QString& to,
                       const QString& function, double val);
 
-    // Gate helpers
-    double baseValueFromType(const QString& baseType, double baseConst) const;
-    double applyFn(const QString& fn, double x) const;
-    double evalGateForNode(int nodeIndex, double yValue) const;
+    // Widget -> SimulationConfig (canvas connections synced in)
+    SimulationConfig& currentConfig();
 
     // Save / run folder
     bool ensureBaseResultDir();
     bool createNewRunDir();
     QString runPath(const QString& filename) const;
-    void writeRunInfoFile() const;
-    void saveParams(const QString& path);
-
-    // Solver core
-    static double sinEFunction(double x);
-    static double tanhFunction(double x);
-    static double reluFunction(double x);
-    double gammaWeight(int om, int r, double nu);
-    void runODE();
-    void runGamma();
-    void saveAndDisplayResult(const QVector<QVector<double>>& y, int steps);
+
+    // Runner status -> log / message boxes; true if results are in the run folder
+    bool reportStatus(SimulationRunner::Status status, const QString& title);
 
     // Table display
     void showOutputTable();
 
-    // gnuplot
-    void generateGnuplotScript();
-    void generateAlpha2ScanGnuplotScripts() const;
-
     // Alpha2 scan
     void scanAlpha2ReuseCurrentRun();
+    void plotAlpha2Scan();
 
     // Connection click-edit
     double distancePointToSegment(const QPointF& p, const QPointF& a, const QPointF& b) const;
     int findClickedConnectionIndex(const QPoint& pos) const;
     void editConnectionAt(int index);
 
+    // Loaded network -> canvas
+    void applyLoadedConfig(const SimulationConfig& loaded);
+
     // Auto preset helpers
     bool copyOverwrite(const QString& src, const QString& dst) const;
     void ensurePresetNodes5();
@@ -112,23 +150,14 @@ private:
     // UI state
     QVector<QPushButton*> buttons;
     QVector<Connection> connections;
-    QMap<QString, double> weightValues;
     QPushButton* firstSelected = nullptr;
     QTextEdit* equationEditor = nullptr;
 
     int maxNodes = 5;
     int connectionHitRadiusPx = 10;
 
-    // Parameters
-    QString solverMode = "ODE";
-    int tMax = 800;          // steps
-    double alpha1 = 1.0;
-    double alpha2 = 1.0;
-    double alpha3 = 1.0;
-    double nu = 0.9;
-
-    GateConfig gateNode4;
-    GateConfig gateNode5;
+    // Parameters (network, solver, gates, weights)
+    SimulationConfig config;
 
     // Alpha2 scan settings
     double scanAlpha2Min = -10.0;
@@ -137,9 +166,27 @@ private:
     int scanTransientPercent = 70;
     int scanSampleStride = 20;
 
-    // Saving folders
-    QString baseResultDir;
-    QString currentRunDir;
+    // Basin map settings (last dialog values)
+    BasinSettings basinSettings;
+    // Plane scan settings (last dialog values)
+    PlaneScanSettings planeSettings;
+    int equilibriumSeeds = 64;
+    // Continuation settings (last dialog values)
+    QString continuationParameter = "alpha2";
+    ContinuationSettings continuationSettings;
+    QString sensitivityParameters = "alpha2";
+    QString fitTargetPath;
+    // Ensemble settings (last dialog values)
+    SdeSettings sdeSettings;
+    QString uncertaintyParameters;
+    UncertaintySettings uncertaintySettings;
+
+    // Runs / scans / checkpoints into the run folder (also used by buttonnetwork-cli)
+    SimulationRunner runner;
+
+    // Cancel
+    bool cancelRequested = false;
+
 };
 
 #endif // BUTTONNETWORK_H
@@ -0,0 +1,575 @@
+// buttonnetwork-cli: headless runs / alpha2 scans for batch and cluster use.
+//
+//   buttonnetwork-cli [options] <params.txt | run folder | folder of runs>
+//
+// The network comes from params.txt (written into every run folder), run_info.txt
+// or graph.txt, or from a whole folder of archived runs: each network found is
+// run into its own new run folder (see networkloader.h). --equations replaces the
+// right-hand side with Dy<i> = ... lines (equationdsl.h); --generate / --edge-list
+// run a large network instead (networkgenerator.h, no network file needed). Run folders are the
+// same as the GUI's; their paths are printed on stdout, logs go to stderr.
+// SIGINT / SIGTERM stop at the next progress point and leave a checkpoint that
+// --resume continues. Exit codes: 0 ok, 1 error, 2 cancelled (checkpoint saved).
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <csignal>
+
+#include "networkloader.h"
+#include "runoutput.h"
+#include "simulationconfig.h"
+#include "simulationrunner.h"
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onStopSignal(int) { stopRequested = 1; }
+
+QTextStream& err()
+{
+    static QTextStream s(stderr);
+    return s;
+}
+
+int failWith(const QString& message)
+{
+    err() << "buttonnetwork-cli: " << message << Qt::endl;
+    return 1;
+}
+
+// "min:max:step"
+bool parseScanRange(const QString& text, Alpha2ScanSettings& scan)
+{
+    const QStringList parts = text.split(':');
+    if (parts.size() != 3) return false;
+    bool ok1 = false, ok2 = false, ok3 = false;
+    scan.min = parts[0].toDouble(&ok1);
+    scan.max = parts[1].toDouble(&ok2);
+    scan.step = parts[2].toDouble(&ok3);
+    return ok1 && ok2 && ok3 && scan.step > 0.0 && scan.max >= scan.min;
+}
+
+// "n" or "WxH"
+bool parseGridSize(const QString& text, int& width, int& height)
+{
+    const QStringList size = text.toLower().split('x');
+    bool ok = size.size() <= 2;
+    if (ok) width = size[0].toInt(&ok);
+    height = width;
+    if (ok && size.size() == 2) height = size[1].toInt(&ok);
+    return ok && width >= 1 && height >= 1;
+}
+
+int exitCode(SimulationRunner::Status status, const SimulationRunner& runner)
+{
+    switch (status) {
+    case SimulationRunner::Status::Done:
+    case SimulationRunner::Status::CacheHit:
+        return 0;
+    case SimulationRunner::Status::Cancelled:
+        return 2;
+    case SimulationRunner::Status::Failed:
+        return failWith(runner.lastError());
+    }
+    return 1;
+}
+
+void plot(const SimulationRunner& runner)
+{
+    auto plotScript = [&](const QString& script) {
+        bool started = false;
+        QString gpStderr;
+        if (!runGnuplot(runner.runDir, script, &started, nullptr, &gpStderr))
+            err() << "[gnuplot] " << script << (started ? " failed: " + gpStderr : QString(" not started")) << Qt::endl;
+    };
+
+    if (QFileInfo::exists(runner.runPath("result.dat"))) {
+        writeGnuplotScript(runner.runDir);
+        plotScript("plot.gnu");
+    }
+    if (QFileInfo::exists(runner.runPath("alpha2_scan_2d.dat"))) {
+        writeAlpha2ScanGnuplotScript(runner.runDir);
+        plotScript("alpha2_scan.gnu");
+    }
+    if (QFileInfo::exists(runner.runPath("basin.gnu"))) plotScript("basin.gnu");
+    if (QFileInfo::exists(runner.runPath("continuation.gnu"))) plotScript("continuation.gnu");
+    if (QFileInfo::exists(runner.runPath("sensitivity.gnu"))) plotScript("sensitivity.gnu");
+    if (QFileInfo::exists(runner.runPath("fit.gnu"))) plotScript("fit.gnu");
+    if (QFileInfo::exists(runner.runPath("ensemble.gnu"))) plotScript("ensemble.gnu");
+    if (QFileInfo::exists(runner.runPath("uncertainty.gnu"))) plotScript("uncertainty.gnu");
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("buttonnetwork-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless ButtonNetwork solver: runs ODE/GAMMA and alpha2 scans "
+                                     "from saved network files into standard run folders.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("network", "params.txt / run_info.txt / graph.txt, a run folder, or a folder "
+                                            "of those (batch: one new run folder each). Default: --run-dir.");
+
+    const QCommandLineOption outOpt("out", "Base result folder (run_* folders and cache/).", "dir",
+                                    QDir::homePath() + "/ButtonNetwork/result");
+    const QCommandLineOption runDirOpt("run-dir", "Use this run folder instead of a new run_<timestamp>.", "dir");
+    const QCommandLineOption solverOpt("solver", "ODE, GAMMA, GAMMA-ABM (fractional predictor-corrector) or "
+                                                 "GAMMA-GRADED (the same on a graded mesh).", "mode");
+    const QCommandLineOption tMaxOpt("tmax", "Number of steps.", "steps");
+    const QCommandLineOption hOpt("h", "Step: Euler step (ODE), predictor-corrector step (GAMMA-ABM) or largest "
+                                       "mesh step (GAMMA-GRADED).", "value");
+    const QCommandLineOption gradedOpt("graded-mesh", "GAMMA-GRADED: M graded intervals near t = 0 and mesh "
+                                                      "exponent r (default 128, r = min(2, 1+nu)/nu).", "M[:r]");
+    const QCommandLineOption nuOpt("nu", "Fractional order (GAMMA).", "value");
+    const QCommandLineOption kernelOpt("kernel", "GAMMA history weights: pow ((k+1)^nu - k^nu) or gamma "
+                                                 "(Gamma(k+nu)/(Gamma(k+1)Gamma(nu)) as in solver.c).", "name");
+    const QCommandLineOption nodeNuOpt("node-nu", "GAMMA: per-node orders, e.g. \"3=0.5,5=1\"; other nodes "
+                                                  "use --nu.", "list");
+    const QCommandLineOption eventsOpt("events", "Event log per run / alpha2 scan point, e.g. \"y3 up 0, y2 max\" "
+                                                 "(up / down / cross <level>, max, min); the scan then plots "
+                                                 "the event states.", "list");
+    const QCommandLineOption alpha1Opt("alpha1", "alpha1.", "value");
+    const QCommandLineOption alpha2Opt("alpha2", "alpha2.", "value");
+    const QCommandLineOption alpha3Opt("alpha3", "alpha3.", "value");
+    const QCommandLineOption scanOpt("scan-alpha2", "alpha2 scan range.", "min:max:step");
+    const QCommandLineOption transientOpt("transient", "Scan transient percent (default 70).", "percent", "70");
+    const QCommandLineOption strideOpt("stride", "Scan sample stride (default 20).", "steps", "20");
+    const QCommandLineOption scanOnlyOpt("scan-only", "Skip the single run, only scan / map basins / planes / "
+                                                            "find equilibria.");
+    const QCommandLineOption resumeOpt("resume", "Continue the checkpointed run/scan in --run-dir.");
+    const QCommandLineOption extendOpt("extend", "Extend the finished run in --run-dir to --tmax.");
+    const QCommandLineOption plotOpt("plot", "Run gnuplot on the written data.");
+    const QCommandLineOption noCacheOpt("no-cache", "Do not read or write the result cache.");
+    const QCommandLineOption checkpointOpt("checkpoint-interval", "Seconds between checkpoints (default 30).", "seconds", "30");
+    const QCommandLineOption quietOpt({"q", "quiet"}, "No log lines on stderr.");
+    const QCommandLineOption noRecurseOpt("no-recurse", "Batch: only the given folder, not its subfolders.");
+    const QCommandLineOption shardOpt("shard", "Batch: take networks k, k+n, k+2n, ... (for n parallel jobs).", "k/n");
+    const QCommandLineOption listOpt("list", "Only list the networks found, do not run.");
+    const QCommandLineOption nativeOpt("native", "Compile the network with the host compiler ($CXX) and run native code.");
+    const QCommandLineOption equationsOpt("equations", "Custom right-hand side: file of Dy<i> = ... lines.", "file");
+    const QCommandLineOption generateOpt("generate", "Large network: random, smallworld or lattice graph.",
+                                         "kind:nodes[:degree[:rewire]]");
+    const QCommandLineOption edgeListOpt("edge-list", "Large network from a file of \"from to [weight [fn]]\" lines.", "file");
+    const QCommandLineOption seedOpt("seed", "--generate: random seed (default 1).", "n");
+    const QCommandLineOption weightScaleOpt("weight-scale", "--generate: weights U(-1,1)*scale/sqrt(degree).", "value");
+    const QCommandLineOption fnOpt("fn", "--generate / --edge-list: tanh, sin or relu (default tanh).", "name");
+    const QCommandLineOption threadsOpt("threads", "RHS threads for large networks (default: all cores).", "n");
+    const QCommandLineOption orderingOpt("ordering", "Large networks: node memory order none, rcm or community "
+                                                     "(results unchanged).", "name");
+    const QCommandLineOption pararealOpt("parareal", "ODE: parallel-in-time Euler over slices with a coarse "
+                                                     "step of ratio*h (default 16:10:1e-9).",
+                                         "slices[:ratio[:tol]]");
+    const QCommandLineOption basinOpt("basin", "ODE: basin-of-attraction map over the initial values of "
+                                               "nodes i and j.", "i:j:xmin:xmax:ymin:ymax");
+    const QCommandLineOption basinSizeOpt("basin-size", "Basin map grid (default 512).", "n|WxH", "512");
+    const QCommandLineOption planeOpt("plane", "Regime map (fixed / periodic / chaotic ...) over two of alpha1, "
+                                               "alpha2, alpha3, nu (GAMMA), h (ODE).", "x:xmin:xmax:y:ymin:ymax");
+    const QCommandLineOption equilibriaOpt("equilibria", "Find equilibria by Newton from n seeds and classify "
+                                                         "them by the Jacobian eigenvalues.", "seeds");
+    const QCommandLineOption continuationOpt("continuation", "Follow the equilibrium branches through a "
+                                                             "parameter (alpha1-3 or s<ij>) over [min, max].",
+                                             "param:min:max");
+    const QCommandLineOption sensitivityOpt("sensitivity", "ODE: integrate d y / d p for these parameters "
+                                                           "(alpha1-3, s<ij>, g4coeff, g5coeff, g4base, g5base) "
+                                                           "with the run.", "p1,p2,...");
+    const QCommandLineOption fitOpt("fit", "ODE: fit parameters to a target trajectory (result.dat layout, row = "
+                                           "step) and run the best fit.", "file");
+    const QCommandLineOption fitParamsOpt("fit-params", "Parameters to fit (default: the drawn connection "
+                                                        "weights).", "p1,p2,...");
+    const QCommandLineOption fitStartsOpt("fit-starts", "Fit start points, run in parallel (default 8).", "n", "8");
+    const QCommandLineOption sdeOpt("sde", "ODE: noisy ensemble of this many paths (sigma per node, additive or "
+                                           "multiplicative noise, Euler-Maruyama or Milstein, seed).",
+                                    "paths[:s1,s2..[:add|mul[:em|milstein[:seed]]]]");
+    const QCommandLineOption uncertaintyOpt("uncertainty", "ODE: Monte Carlo quantile bands over uncertain "
+                                                           "parameters, up to this many Sobol samples; stops "
+                                                           "early when the bands move less than tol (default "
+                                                           "0.01) over a doubling.", "samples[:tol]");
+    const QCommandLineOption uncertaintyParamsOpt("uncertainty-params", "Uncertain parameters: name (normal, sd = "
+                                                                        "spread x value), name=normal:mean:sd or "
+                                                                        "name=uniform:low:high (default: the "
+                                                                        "drawn connection weights).", "p1,p2,...");
+    const QCommandLineOption uncertaintySpreadOpt("uncertainty-spread", "Relative sd of parameters given by name "
+                                                                        "only (default 0.1).", "cv", "0.1");
+    const QCommandLineOption planeSizeOpt("plane-size", "Regime map grid (default 256).", "n|WxH", "256");
+
+    parser.addOptions({outOpt, runDirOpt, solverOpt, tMaxOpt, hOpt, gradedOpt, nuOpt, kernelOpt, nodeNuOpt, eventsOpt, alpha1Opt, alpha2Opt, alpha3Opt,
+                       scanOpt, transientOpt, strideOpt, scanOnlyOpt, resumeOpt, extendOpt, plotOpt,
+                       noCacheOpt, checkpointOpt, quietOpt, noRecurseOpt, shardOpt, listOpt,
+                       equationsOpt, nativeOpt, generateOpt, edgeListOpt, seedOpt, weightScaleOpt, fnOpt,
+                       threadsOpt, orderingOpt, pararealOpt, basinOpt, basinSizeOpt,
+                       planeOpt, planeSizeOpt, equilibriaOpt, continuationOpt, sensitivityOpt,
+                       fitOpt, fitParamsOpt, fitStartsOpt, sdeOpt, uncertaintyOpt, uncertaintyParamsOpt,
+                       uncertaintySpreadOpt});
+    parser.process(app);
+
+    // ---- large network ----
+    const bool largeNetwork = parser.isSet(generateOpt) || parser.isSet(edgeListOpt);
+    LargeNetworkConfig large;
+    if (parser.isSet(generateOpt) && parser.isSet(edgeListOpt))
+        return failWith("--generate and --edge-list exclude each other");
+    if (parser.isSet(generateOpt)) {
+        const QStringList parts = parser.value(generateOpt).split(':');
+        bool ok = parts.size() >= 2 && parts.size() <= 4;
+        large.kind = parts.value(0).toLower();
+        if (ok) large.nodes = parts[1].toInt(&ok);
+        if (ok && parts.size() > 2) large.degree = parts[2].toInt(&ok);
+        if (ok && parts.size() > 3) large.rewire = parts[3].toDouble(&ok);
+        if (!ok || large.nodes < 5 || large.degree < 1 || large.rewire < 0.0 || large.rewire > 1.0)
+            return failWith("--generate expects kind:nodes[:degree[:rewire]], nodes >= 5, 0 <= rewire <= 1");
+    }
+    if (parser.isSet(edgeListOpt)) {
+        large.kind = "edgelist";
+        large.edgeListPath = QFileInfo(parser.value(edgeListOpt)).absoluteFilePath();
+    }
+    if (parser.isSet(seedOpt)) large.seed = parser.value(seedOpt).toULongLong();
+    if (parser.isSet(weightScaleOpt)) large.weightScale = parser.value(weightScaleOpt).toDouble();
+    if (parser.isSet(fnOpt)) large.fn = parser.value(fnOpt).toLower();
+    if (parser.isSet(orderingOpt)) large.ordering = parser.value(orderingOpt).toLower();
+
+    PararealConfig parareal;
+    if (parser.isSet(pararealOpt)) {
+        const QStringList parts = parser.value(pararealOpt).split(':');
+        bool ok = parts.size() <= 3;
+        parareal.enabled = true;
+        if (ok) parareal.slices = parts[0].toInt(&ok);
+        if (ok && parts.size() > 1) parareal.coarseRatio = parts[1].toInt(&ok);
+        if (ok && parts.size() > 2) parareal.tolerance = parts[2].toDouble(&ok);
+        if (!ok || parareal.slices < 2 || parareal.coarseRatio < 1 || parareal.tolerance < 0.0)
+            return failWith("--parareal expects slices[:ratio[:tol]], slices >= 2, ratio >= 1, tol >= 0");
+    }
+
+    GradedMeshOptions gradedMesh;
+    if (parser.isSet(gradedOpt)) {
+        const QStringList parts = parser.value(gradedOpt).split(':');
+        bool ok = parts.size() <= 2;
+        if (ok) gradedMesh.gradedIntervals = parts[0].toInt(&ok);
+        if (ok && parts.size() > 1) gradedMesh.exponent = parts[1].toDouble(&ok);
+        if (!ok || gradedMesh.gradedIntervals < 1 || (gradedMesh.exponent != 0.0 && gradedMesh.exponent < 1.0))
+            return failWith("--graded-mesh expects M[:r], M >= 1, r >= 1 (0: automatic)");
+    }
+
+    // ---- networks ----
+    QString input;
+    if (!parser.positionalArguments().isEmpty()) input = parser.positionalArguments().first();
+    else if (parser.isSet(runDirOpt)) input = parser.value(runDirOpt);
+    else if (!largeNetwork) {
+        err() << parser.helpText();
+        return 1;
+    }
+
+    QVector<LoadedNetwork> networks;
+    if (input.isEmpty()) {
+        // --generate / --edge-list alone: default parameters, the large network is applied below
+        LoadedNetwork n;
+        n.source = large.kind == "edgelist" ? large.edgeListPath : "generated:" + large.kind;
+        n.ok = true;
+        networks.push_back(n);
+    } else if (QFileInfo(input).isDir()) {
+        networks = loadNetworkDirectory(input, !parser.isSet(noRecurseOpt));
+    } else {
+        LoadedNetwork n;
+        n.source = input;
+        n.ok = loadNetworkFile(input, n.config, &n.error, &n.warnings);
+        networks.push_back(n);
+    }
+    if (networks.isEmpty()) return failWith("No network files in " + input);
+
+    if (parser.isSet(shardOpt)) {
+        const QStringList kn = parser.value(shardOpt).split('/');
+        const int k = kn.value(0).toInt();
+        const int n = (kn.size() == 2) ? kn[1].toInt() : 0;
+        if (n < 1 || k < 0 || k >= n) return failWith("--shard expects k/n with 0 <= k < n");
+        QVector<LoadedNetwork> mine;
+        for (int i = k; i < networks.size(); i += n) mine.push_back(networks[i]);
+        networks = mine;
+    }
+
+    const bool singleRunDir = parser.isSet(runDirOpt) || parser.isSet(resumeOpt) || parser.isSet(extendOpt);
+    if ((parser.isSet(resumeOpt) || parser.isSet(extendOpt)) && !parser.isSet(runDirOpt))
+        return failWith("--resume / --extend need --run-dir");
+    if (singleRunDir && networks.size() != 1)
+        return failWith("--run-dir / --resume / --extend take a single network");
+
+    QString equations;
+    if (parser.isSet(equationsOpt)) {
+        QFile f(parser.value(equationsOpt));
+        if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+            return failWith("Cannot open " + parser.value(equationsOpt));
+        equations = QString::fromUtf8(f.readAll());
+    }
+
+    auto applyOverrides = [&](SimulationConfig& config) {
+        if (parser.isSet(solverOpt)) {
+            config.solverMode = parser.value(solverOpt).toUpper();
+            if (config.solverMode != "ODE" && config.solverMode != "GAMMA" && config.solverMode != "GAMMA-ABM"
+                && config.solverMode != "GAMMA-GRADED") {
+                failWith("--solver must be ODE, GAMMA, GAMMA-ABM or GAMMA-GRADED");
+                return false;
+            }
+        }
+        if (parser.isSet(tMaxOpt)) config.tMax = parser.value(tMaxOpt).toInt();
+        if (parser.isSet(gradedOpt)) {
+            config.gradedMesh.gradedIntervals = gradedMesh.gradedIntervals;
+            config.gradedMesh.exponent = gradedMesh.exponent;
+        }
+        if (parser.isSet(hOpt)) config.setScanParameter("h", parser.value(hOpt).toDouble());
+        if (parser.isSet(nuOpt)) config.nu = parser.value(nuOpt).toDouble();
+        if (parser.isSet(kernelOpt)) {
+            config.fractionalKernel = parser.value(kernelOpt).toLower();
+            if (config.fractionalKernel != "pow" && config.fractionalKernel != "gamma") {
+                failWith("--kernel must be pow or gamma");
+                return false;
+            }
+        }
+        if (parser.isSet(nodeNuOpt) && !config.setNodeOrdersText(parser.value(nodeNuOpt))) {
+            failWith("--node-nu expects node=nu pairs, node >= 1, nu > 0");
+            return false;
+        }
+        if (parser.isSet(eventsOpt)) config.events = parser.value(eventsOpt);
+        if (parser.isSet(alpha1Opt)) config.alpha1 = parser.value(alpha1Opt).toDouble();
+        if (parser.isSet(alpha2Opt)) config.alpha2 = parser.value(alpha2Opt).toDouble();
+        if (parser.isSet(alpha3Opt)) config.alpha3 = parser.value(alpha3Opt).toDouble();
+        if (config.tMax < 1) {
+            failWith("tMax must be >= 1");
+            return false;
+        }
+        if (parser.isSet(equationsOpt)) config.equations = equations;
+        if (largeNetwork) config.large = large;
+        if (parser.isSet(pararealOpt)) config.parareal = parareal;
+        QString why;
+        if (!config.checkEquations(&why) || !config.checkLargeNetwork(&why) || !config.checkNodeOrders(&why)
+            || !config.checkEvents(0, &why)) {
+            failWith(why);
+            return false;
+        }
+        return true;
+    };
+
+    if (parser.isSet(listOpt)) {
+        QTextStream out(stdout);
+        for (const LoadedNetwork& n : networks) {
+            out << (n.ok ? "ok" : "error") << "\t" << n.source;
+            if (n.ok)
+                out << "\t" << n.config.solverMode << "\ttMax=" << n.config.tMax
+                    << "\tedges=" << int(n.config.networkSpec().edges.size());
+            else
+                out << "\t" << n.error;
+            out << Qt::endl;
+        }
+        return 0;
+    }
+
+    Alpha2ScanSettings scan;
+    const bool doScan = parser.isSet(scanOpt);
+    if (doScan && !parseScanRange(parser.value(scanOpt), scan))
+        return failWith("--scan-alpha2 expects min:max:step with step > 0 and max >= min");
+    scan.transientPercent = parser.value(transientOpt).toInt();
+    scan.sampleStride = parser.value(strideOpt).toInt();
+    if (scan.transientPercent < 0 || scan.transientPercent > 99) scan.transientPercent = 70;
+    if (scan.sampleStride < 1) scan.sampleStride = 20;
+
+    BasinSettings basin;
+    const bool doBasin = parser.isSet(basinOpt);
+    if (doBasin) {
+        const QStringList parts = parser.value(basinOpt).split(':');
+        bool ok = parts.size() == 6;
+        double v[6] = {0, 0, 0, 0, 0, 0};
+        for (int k = 0; ok && k < 6; ++k) v[k] = parts[k].toDouble(&ok);
+        const bool sizeOk = parseGridSize(parser.value(basinSizeOpt), basin.width, basin.height);
+        if (!ok || !sizeOk || v[0] < 1 || v[1] < 1 || v[0] == v[1] || !(v[3] > v[2]) || !(v[5] > v[4]))
+            return failWith("--basin expects i:j:xmin:xmax:ymin:ymax (nodes from 1, i != j), "
+                            "--basin-size n or WxH");
+        basin.xNode = int(v[0]) - 1;
+        basin.yNode = int(v[1]) - 1;
+        basin.xMin = v[2];
+        basin.xMax = v[3];
+        basin.yMin = v[4];
+        basin.yMax = v[5];
+    }
+
+    EquilibriumSettings equilibria;
+    const bool doEquilibria = parser.isSet(equilibriaOpt);
+    if (doEquilibria) {
+        bool ok = false;
+        equilibria.seeds = parser.value(equilibriaOpt).toInt(&ok);
+        if (!ok || equilibria.seeds < 1) return failWith("--equilibria expects the number of Newton seeds");
+    }
+
+    ContinuationSettings continuation;
+    QString continuationParameter;
+    const bool doContinuation = parser.isSet(continuationOpt);
+    if (doContinuation) {
+        const QStringList parts = parser.value(continuationOpt).split(':');
+        bool ok = parts.size() == 3;
+        if (ok) continuation.pMin = parts[1].toDouble(&ok);
+        if (ok) continuation.pMax = parts[2].toDouble(&ok);
+        if (!ok || !(continuation.pMax > continuation.pMin))
+            return failWith("--continuation expects param:min:max, e.g. alpha2:-10:10");
+        continuationParameter = parts[0];
+    }
+
+    FitSettings fit;
+    if (parser.isSet(fitOpt)) {
+        bool ok = false;
+        fit.starts = parser.value(fitStartsOpt).toInt(&ok);
+        if (!ok || fit.starts < 1) return failWith("--fit-starts expects a positive number");
+        if (parser.isSet(sensitivityOpt)) return failWith("--fit and --sensitivity are separate runs");
+    }
+
+    SdeSettings sde;
+    const bool doSde = parser.isSet(sdeOpt);
+    if (doSde) {
+        const QStringList parts = parser.value(sdeOpt).split(':');
+        bool ok = parts.size() <= 5;
+        if (ok) sde.paths = parts[0].toInt(&ok);
+        if (ok && parts.size() > 1) {
+            sde.sigma.clear();
+            for (const QString& s : parts[1].split(',', Qt::SkipEmptyParts)) {
+                sde.sigma.push_back(s.toDouble(&ok));
+                if (!ok || sde.sigma.back() < 0) break;
+            }
+            ok = ok && !sde.sigma.empty() && sde.sigma.back() >= 0;
+        }
+        if (ok && parts.size() > 2) {
+            ok = parts[2] == "add" || parts[2] == "mul";
+            sde.noise = parts[2] == "mul" ? NoiseKind::Multiplicative : NoiseKind::Additive;
+        }
+        if (ok && parts.size() > 3) {
+            ok = parts[3] == "em" || parts[3] == "milstein";
+            sde.scheme = parts[3] == "milstein" ? SdeScheme::Milstein : SdeScheme::EulerMaruyama;
+        }
+        if (ok && parts.size() > 4) sde.seed = parts[4].toULongLong(&ok);
+        if (!ok || sde.paths < 1)
+            return failWith("--sde expects paths[:sigma1,sigma2..[:add|mul[:em|milstein[:seed]]]], "
+                            "e.g. 1000:0.1:add:em:1");
+    }
+
+    UncertaintySettings uncertainty;
+    const bool doUncertainty = parser.isSet(uncertaintyOpt);
+    if (doUncertainty) {
+        const QStringList parts = parser.value(uncertaintyOpt).split(':');
+        bool ok = parts.size() <= 2;
+        if (ok) uncertainty.maxSamples = parts[0].toInt(&ok);
+        if (ok && parts.size() > 1) uncertainty.tolerance = parts[1].toDouble(&ok);
+        bool spreadOk = false;
+        uncertainty.relativeSpread = parser.value(uncertaintySpreadOpt).toDouble(&spreadOk);
+        if (!ok || uncertainty.maxSamples < 1 || !(uncertainty.tolerance >= 0) || !spreadOk
+            || !(uncertainty.relativeSpread >= 0))
+            return failWith("--uncertainty expects samples[:tol], e.g. 8192:0.01, --uncertainty-spread cv >= 0");
+        uncertainty.minSamples = qMin(uncertainty.minSamples, uncertainty.maxSamples);
+    }
+
+    PlaneScanSettings plane;
+    const bool doPlane = parser.isSet(planeOpt);
+    if (doPlane) {
+        const QStringList parts = parser.value(planeOpt).split(':');
+        bool ok = parts.size() == 6;
+        double v[4] = {0, 0, 0, 0};
+        const int at[4] = {1, 2, 4, 5};
+        for (int k = 0; ok && k < 4; ++k) v[k] = parts[at[k]].toDouble(&ok);
+        const QStringList names = SimulationConfig::scanParameterNames();
+        const bool sizeOk = parseGridSize(parser.value(planeSizeOpt), plane.width, plane.height);
+        if (!ok || !sizeOk || !names.contains(parts[0]) || !names.contains(parts[3]) || parts[0] == parts[3]
+            || !(v[1] > v[0]) || !(v[3] > v[2]))
+            return failWith("--plane expects x:xmin:xmax:y:ymin:ymax with two different parameters out of "
+                            + names.join(", ") + ", --plane-size n or WxH");
+        plane.xParam = parts[0].toStdString();
+        plane.xMin = v[0];
+        plane.xMax = v[1];
+        plane.yParam = parts[3].toStdString();
+        plane.yMin = v[2];
+        plane.yMax = v[3];
+    }
+
+    // ---- runner ----
+    SimulationRunner runner;
+    runner.baseResultDir = parser.value(outOpt);
+    runner.useCache = !parser.isSet(noCacheOpt);
+    runner.useNativeCode = parser.isSet(nativeOpt);
+    runner.rhsThreads = qMax(0, parser.value(threadsOpt).toInt());
+    runner.checkpointIntervalMs = qMax(1, parser.value(checkpointOpt).toInt()) * 1000;
+    runner.cancelRequested = []() { return stopRequested != 0; };
+    if (!parser.isSet(quietOpt))
+        runner.log = [](const QString& line) { err() << line << Qt::endl; };
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    // ---- work: one run folder per network ----
+    int code = 0;
+    for (const LoadedNetwork& network : networks) {
+        if (!network.ok) {
+            code = failWith(network.error);
+            continue;
+        }
+        if (!parser.isSet(quietOpt))
+            for (const QString& w : network.warnings) err() << "[warn] " << network.source << ": " << w << Qt::endl;
+
+        SimulationConfig config = network.config;
+        if (!applyOverrides(config)) return 1;
+
+        if (parser.isSet(runDirOpt)) {
+            runner.runDir = QDir(parser.value(runDirOpt)).absolutePath();
+            if (!QDir().mkpath(runner.runDir)) return failWith("Cannot create run folder " + runner.runDir);
+        } else if (!runner.createRunDir()) {
+            return failWith(runner.lastError());
+        }
+
+        QTextStream(stdout) << runner.runDir << Qt::endl;
+
+        SimulationRunner::Status status = SimulationRunner::Status::Done;
+        if (parser.isSet(resumeOpt)) {
+            if (runner.hasScanCheckpoint()) status = runner.resumeScan(config);
+            else if (runner.hasRunCheckpoint()) status = runner.resumeRun(config);
+            else return failWith("No checkpoint in " + runner.runDir);
+        } else if (parser.isSet(extendOpt)) {
+            status = runner.extendRun(config);
+        } else {
+            if (parser.isSet(scanOnlyOpt)) runner.writeRunHeaderFiles(config);
+            else if (parser.isSet(fitOpt))
+                status = runner.fitParameters(config, parser.value(fitOpt),
+                                              parser.value(fitParamsOpt).split(',', Qt::SkipEmptyParts), fit);
+            else if (parser.isSet(sensitivityOpt))
+                status = runner.computeSensitivities(config,
+                                                     parser.value(sensitivityOpt).split(',', Qt::SkipEmptyParts));
+            else status = runner.computeRun(config);
+
+            if (doScan && (status == SimulationRunner::Status::Done || status == SimulationRunner::Status::CacheHit))
+                status = runner.scanAlpha2(config, scan);
+            if (doBasin && (status == SimulationRunner::Status::Done || status == SimulationRunner::Status::CacheHit))
+                status = runner.mapBasins(config, basin);
+            if (doEquilibria && (status == SimulationRunner::Status::Done || status == SimulationRunner::Status::CacheHit))
+                status = runner.findEquilibria(config, equilibria);
+            if (doContinuation && (status == SimulationRunner::Status::Done || status == SimulationRunner::Status::CacheHit))
+                status = runner.continueBranches(config, continuationParameter, continuation);
+            if (doPlane && (status == SimulationRunner::Status::Done || status == SimulationRunner::Status::CacheHit))
+                status = runner.scanPlane(config, plane);
+            if (doSde && (status == SimulationRunner::Status::Done || status == SimulationRunner::Status::CacheHit))
+                status = runner.runEnsemble(config, sde);
+            if (doUncertainty && (status == SimulationRunner::Status::Done || status == SimulationRunner::Status::CacheHit))
+                status = runner.propagateUncertainty(config,
+                                                     parser.value(uncertaintyParamsOpt).split(',', Qt::SkipEmptyParts),
+                                                     uncertainty);
+
+            // where a replayed network came from
+            QFile info(runner.runPath("run_info.txt"));
+            if (!singleRunDir && info.open(QIODevice::Append | QIODevice::Text))
+                QTextStream(&info) << "\nReplayOf: " << network.source << "\n";
+        }
+
+        const int c = exitCode(status, runner);
+        if (c == 2) return 2;    // stop the batch, the checkpoint is in this run folder
+        if (c != 0) code = c;
+        else if (parser.isSet(plotOpt)) plot(runner);
+    }
+    return code;
+}
@@ -0,0 +1,58 @@
+# Solver core (Qt Core + std), shared by ButtonNetwork.pro and buttonnetwork-cli.pro
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/equationdsl.cpp \
+    $$PWD/nativekernel.cpp \
+    $$PWD/nativecompiler.cpp \
+    $$PWD/workerpool.cpp \
+    $$PWD/networkgenerator.cpp \
+    $$PWD/nodeordering.cpp \
+    $$PWD/sparsekernel.cpp \
+    $$PWD/rhskernel.cpp \
+    $$PWD/networksolver.cpp \
+    $$PWD/basinmapper.cpp \
+    $$PWD/planescan.cpp \
+    $$PWD/equilibrium.cpp \
+    $$PWD/continuation.cpp \
+    $$PWD/sensitivity.cpp \
+    $$PWD/parameterfit.cpp \
+    $$PWD/sdeensemble.cpp \
+    $$PWD/uncertainty.cpp \
+    $$PWD/eventdetector.cpp \
+    $$PWD/statearena.cpp \
+    $$PWD/resultcache.cpp \
+    $$PWD/runstate.cpp \
+    $$PWD/simulationconfig.cpp \
+    $$PWD/simulationrunner.cpp \
+    $$PWD/networkloader.cpp \
+    $$PWD/runoutput.cpp
+
+HEADERS += \
+    $$PWD/networkspec.h \
+    $$PWD/equationdsl.h \
+    $$PWD/nativekernel.h \
+    $$PWD/nativecompiler.h \
+    $$PWD/workerpool.h \
+    $$PWD/networkgenerator.h \
+    $$PWD/nodeordering.h \
+    $$PWD/sparsekernel.h \
+    $$PWD/rhskernel.h \
+    $$PWD/networksolver.h \
+    $$PWD/basinmapper.h \
+    $$PWD/planescan.h \
+    $$PWD/equilibrium.h \
+    $$PWD/continuation.h \
+    $$PWD/sensitivity.h \
+    $$PWD/parameterfit.h \
+    $$PWD/sdeensemble.h \
+    $$PWD/uncertainty.h \
+    $$PWD/eventdetector.h \
+    $$PWD/statearena.h \
+    $$PWD/resultcache.h \
+    $$PWD/runstate.h \
+    $$PWD/simulationconfig.h \
+    $$PWD/simulationrunner.h \
+    $$PWD/networkloader.h \
+    $$PWD/runoutput.h
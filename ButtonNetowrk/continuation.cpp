@@ -0,0 +1,410 @@
+#include "continuation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "rhskernel.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+class BranchSystem
+{
+public:
+    BranchSystem(const ParameterSpecFn& specAt, long long& evaluations) : specAt(specAt), evaluations(evaluations) {}
+
+    void rhs(double p, const std::vector<double>& y, std::vector<double>& f) const
+    {
+        eval(networkAt(p), y, f);
+    }
+
+    // Bordered matrix [[J, df/dp], [border]] of size (n + 1)^2, row-major
+    void bordered(double p, const std::vector<double>& y, const std::vector<double>& border,
+                  std::vector<double>& a, std::vector<double>& scratch) const
+    {
+        const int n = int(y.size());
+        const int m = n + 1;
+        rhsJacobian(networkAt(p), y.data(), scratch.data());
+        for (int i = 0; i < n; ++i)
+            std::copy(scratch.begin() + std::size_t(i) * n, scratch.begin() + std::size_t(i + 1) * n,
+                      a.begin() + std::size_t(i) * m);
+
+        // df/dp by central differences: the parameter enters through the spec builder.
+        // p -+ delta are used once, so they bypass the cached network at p.
+        const double delta = 1e-6 * (1.0 + std::fabs(p));
+        std::vector<double> fPlus(n), fMinus(n);
+        NetworkSpec shifted = specAt(p + delta);
+        shifted.threads = 1;
+        eval(shifted, y, fPlus);
+        shifted = specAt(p - delta);
+        shifted.threads = 1;
+        eval(shifted, y, fMinus);
+        for (int i = 0; i < n; ++i) a[std::size_t(i) * m + n] = (fPlus[i] - fMinus[i]) / (2.0 * delta);
+        std::copy(border.begin(), border.end(), a.begin() + std::size_t(n) * m);
+    }
+
+    void jacobian(double p, const std::vector<double>& y, std::vector<double>& jac) const
+    {
+        rhsJacobian(networkAt(p), y.data(), jac.data());
+    }
+
+private:
+    // The network at p, rebuilt only when p changes: a corrector step evaluates the
+    // residual, the Jacobian and (at the end) the eigenvalues at the same p.
+    const NetworkSpec& networkAt(double p) const
+    {
+        if (!hasCached || cachedP != p) {
+            cached = specAt(p);
+            cached.threads = 1;
+            cachedP = p;
+            hasCached = true;
+        }
+        return cached;
+    }
+
+    void eval(const NetworkSpec& spec, const std::vector<double>& y, std::vector<double>& f) const
+    {
+        visitRhsKernel(spec, [&](const auto& kernel) { kernel.eval(y.data(), f.data()); });
+        ++evaluations;
+    }
+
+    const ParameterSpecFn& specAt;
+    long long& evaluations;
+    mutable NetworkSpec cached;
+    mutable double cachedP = 0.0;
+    mutable bool hasCached = false;
+};
+
+double maxAbs(const std::vector<double>& v)
+{
+    double m = 0.0;
+    for (double x : v) m = std::max(m, std::fabs(x));
+    return m;
+}
+
+// x = (y, p) packed as n + 1 values
+std::vector<double> pack(const std::vector<double>& y, double p)
+{
+    std::vector<double> x(y);
+    x.push_back(p);
+    return x;
+}
+
+void normalise(std::vector<double>& t)
+{
+    double norm = 0.0;
+    for (double v : t) norm += v * v;
+    norm = std::sqrt(norm);
+    for (double& v : t) v /= norm;
+}
+
+double dot(const std::vector<double>& a, const std::vector<double>& b)
+{
+    double s = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i) s += a[i] * b[i];
+    return s;
+}
+
+// Unit tangent of the branch at x: [J, f_p; border] t = e_{n+1}, oriented along border.
+bool tangentAt(const BranchSystem& sys, const std::vector<double>& x, const std::vector<double>& border,
+               std::vector<double>& t)
+{
+    const int m = int(x.size());
+    const int n = m - 1;
+    const std::vector<double> y(x.begin(), x.end() - 1);
+    std::vector<double> a(std::size_t(m) * m), scratch(std::size_t(n) * n);
+    sys.bordered(x[n], y, border, a, scratch);
+    t.assign(m, 0.0);
+    t[n] = 1.0;
+    if (!solveDenseSystem(m, a, t)) return false;
+    normalise(t);
+    if (dot(t, border) < 0.0)
+        for (double& v : t) v = -v;
+    return true;
+}
+
+// Newton on f(y, p) = 0 plus t . (x - from) = ds, starting at the predicted point x
+bool correct(const BranchSystem& sys, const std::vector<double>& from, const std::vector<double>& t, double ds,
+             const ContinuationSettings& s, std::vector<double>& x, int& iterations)
+{
+    const int m = int(x.size());
+    const int n = m - 1;
+    std::vector<double> y(n), f(n), a(std::size_t(m) * m), scratch(std::size_t(n) * n), rhs(m);
+    for (iterations = 1; iterations <= s.maxCorrectorIterations; ++iterations) {
+        std::copy(x.begin(), x.end() - 1, y.begin());
+        sys.rhs(x[n], y, f);
+        double arc = -ds;
+        for (int i = 0; i < m; ++i) arc += t[i] * (x[i] - from[i]);
+        for (int i = 0; i < n; ++i) rhs[i] = -f[i];
+        rhs[n] = -arc;
+
+        sys.bordered(x[n], y, t, a, scratch);
+        if (!solveDenseSystem(m, a, rhs)) return false;
+        for (int i = 0; i < m; ++i) x[i] += rhs[i];
+        if (!(maxAbs(x) <= s.divergeLimit)) return false;
+
+        if (maxAbs(rhs) <= 1e-9 * (1.0 + maxAbs(x))) {
+            std::copy(x.begin(), x.end() - 1, y.begin());
+            sys.rhs(x[n], y, f);
+            if (maxAbs(f) <= s.tolerance) return true;
+        }
+    }
+    return false;
+}
+
+void analyse(const BranchSystem& sys, const ContinuationSettings& s, BranchPoint& point)
+{
+    const int n = int(point.y.size());
+    std::vector<double> jac(std::size_t(n) * n);
+    sys.jacobian(point.p, point.y, jac);
+    point.eigenvalues.clear();
+    if (matrixEigenvalues(n, jac, point.eigenvalues))
+        point.kind = classifyEquilibrium(point.eigenvalues, s.order, &point.unstableDirections);
+}
+
+// det J from the eigenvalues (complex pairs contribute |lambda|^2)
+double determinant(const BranchPoint& point)
+{
+    double det = 1.0;
+    for (const std::complex<double>& lambda : point.eigenvalues)
+        if (lambda.imag() == 0.0) det *= lambda.real();
+        else det *= std::abs(lambda); // each of the pair: |lambda|^2 overall
+    return det;
+}
+
+// Largest "distance into the unstable sector" of a complex pair, |lambda| sin(order pi/2 - |arg|)
+// (Re lambda for order 1); false when the point has no complex pair.
+bool hopfTest(const BranchPoint& point, double order, double& value, double& frequency)
+{
+    bool found = false;
+    double scale = 1.0;
+    for (const std::complex<double>& lambda : point.eigenvalues) scale = std::max(scale, std::abs(lambda));
+    for (const std::complex<double>& lambda : point.eigenvalues) {
+        if (std::fabs(lambda.imag()) <= 1e-8 * scale) continue;
+        const double v = std::abs(lambda) * std::sin(order * kPi / 2.0 - std::fabs(std::arg(lambda)));
+        if (!found || v > value) {
+            value = v;
+            frequency = std::fabs(lambda.imag());
+        }
+        found = true;
+    }
+    return found;
+}
+
+BifurcationPoint between(BifurcationKind kind, int after, const BranchPoint& a, const BranchPoint& b, double ta,
+                         double tb)
+{
+    BifurcationPoint point;
+    point.kind = kind;
+    point.after = after;
+    const double w = ta / (ta - tb);
+    point.p = a.p + w * (b.p - a.p);
+    point.y.resize(a.y.size());
+    for (std::size_t i = 0; i < a.y.size(); ++i) point.y[i] = a.y[i] + w * (b.y[i] - a.y[i]);
+    return point;
+}
+
+// Zero of a test function on the step from xPrev (arclength 0, value fa) to the next
+// point (arclength step, value fb) by regula falsi (Illinois); every probe is a corrected
+// branch point on the plane tPrev . (x - xPrev) = sigma. False leaves the interpolated point.
+template <class Test>
+bool locate(const BranchSystem& sys, const ContinuationSettings& s, const std::vector<double>& xPrev,
+            const std::vector<double>& tPrev, double step, double fa, double fb, const Test& test,
+            BifurcationPoint& point)
+{
+    const int m = int(xPrev.size());
+    double a = 0.0, b = step;
+    std::vector<double> x;
+    for (int it = 0; it < 40; ++it) {
+        const double c = b - fb * (b - a) / (fb - fa);
+        x = xPrev;
+        for (int i = 0; i < m; ++i) x[i] += c * tPrev[i];
+        int iterations = 0;
+        if (!correct(sys, xPrev, tPrev, c, s, x, iterations)) return false;
+        const double fc = test(x, point);
+        if (!std::isfinite(fc)) return false;
+        if (fc * fb < 0.0) {
+            a = b;
+            fa = fb;
+        } else {
+            fa *= 0.5;
+        }
+        b = c;
+        fb = fc;
+        if (fc == 0.0 || std::fabs(b - a) <= 1e-9 * step) break;
+    }
+    point.p = x[m - 1];
+    point.y.assign(x.begin(), x.end() - 1);
+    return true;
+}
+
+} // namespace
+
+bool continueEquilibrium(const ParameterSpecFn& specAt, double p0, const std::vector<double>& y0,
+                         const ContinuationSettings& settings, ContinuationResult& result,
+                         const ContinuationProgressFn& progress)
+{
+    const auto wallStart = std::chrono::steady_clock::now();
+    result = ContinuationResult();
+    result.settings = settings;
+    const ContinuationSettings& s = result.settings;
+    const BranchSystem sys(specAt, result.rhsEvaluations);
+    const int n = int(y0.size());
+    const int m = n + 1;
+    auto finish = [&](const std::string& reason, bool ok) {
+        result.stopReason = reason;
+        result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        return ok;
+    };
+
+    // first point: Newton with p held at p0 (border e_{n+1}, ds 0)
+    std::vector<double> axis(m, 0.0);
+    axis[n] = 1.0;
+    const std::vector<double> guess = pack(y0, p0);
+    std::vector<double> x = guess;
+    int iterations = 0;
+    ContinuationSettings start = s;
+    start.maxCorrectorIterations = std::max(50, s.maxCorrectorIterations);
+    if (!correct(sys, guess, axis, 0.0, start, x, iterations))
+        return finish("no equilibrium near the initial state at p = " + std::to_string(p0), false);
+
+    std::vector<double> border(axis);
+    if (s.direction < 0) border[n] = -1.0;
+    std::vector<double> t;
+    if (!tangentAt(sys, x, border, t)) return finish("singular Jacobian at the start", false);
+
+    BranchPoint first;
+    first.p = x[n];
+    first.y.assign(x.begin(), x.end() - 1);
+    analyse(sys, s, first);
+    result.branch.push_back(first);
+    if (progress && !progress(result)) return finish("cancelled", false);
+
+    double ds = std::clamp(s.ds, s.dsMin, s.dsMax);
+    std::vector<double> tNext;
+    while (int(result.branch.size()) < s.maxPoints) {
+        // predictor along the tangent, corrector on the arclength plane; smaller steps on failure
+        std::vector<double> next;
+        bool accepted = false;
+        while (ds >= s.dsMin) {
+            next = x;
+            for (int i = 0; i < m; ++i) next[i] += ds * t[i];
+            if (correct(sys, x, t, ds, s, next, iterations) && tangentAt(sys, next, t, tNext)
+                && dot(t, tNext) > 0.9) {
+                accepted = true;
+                break;
+            }
+            ds *= 0.5;
+        }
+        if (!accepted) return finish("step size below dsMin (no convergence)", true);
+
+        const std::vector<double> xPrev = x, tPrev = t;
+        const double tpPrev = t[n];
+        const double step = ds;
+        x = next;
+        t = tNext;
+        if (iterations <= 2) ds = std::min(ds * 1.5, s.dsMax);
+        else if (iterations >= 5) ds = std::max(ds * 0.7, s.dsMin);
+
+        BranchPoint point;
+        point.p = x[n];
+        point.y.assign(x.begin(), x.end() - 1);
+        point.arclength = result.branch.back().arclength + step;
+        analyse(sys, s, point);
+
+        const BranchPoint& prev = result.branch.back();
+        const int after = int(result.branch.size()) - 1;
+        const bool fold = tpPrev * t[n] < 0.0;
+        if (fold) {
+            BifurcationPoint found = between(BifurcationKind::Fold, after, prev, point, tpPrev, t[n]);
+            locate(sys, s, xPrev, tPrev, step, tpPrev, t[n], [&](const std::vector<double>& probe, BifurcationPoint&) {
+                std::vector<double> tangent;
+                return tangentAt(sys, probe, tPrev, tangent) ? tangent[n] : NAN;
+            }, found);
+            result.bifurcations.push_back(found);
+        }
+        const double detPrev = determinant(prev), det = determinant(point);
+        if (!fold && detPrev * det < 0.0) {
+            BifurcationPoint found = between(BifurcationKind::Branch, after, prev, point, detPrev, det);
+            locate(sys, s, xPrev, tPrev, step, detPrev, det, [&](const std::vector<double>& probe, BifurcationPoint&) {
+                BranchPoint bp;
+                bp.p = probe[n];
+                bp.y.assign(probe.begin(), probe.end() - 1);
+                analyse(sys, s, bp);
+                return determinant(bp);
+            }, found);
+            result.bifurcations.push_back(found);
+        }
+        double hPrev = 0.0, h = 0.0, wPrev = 0.0, w = 0.0;
+        if (hopfTest(prev, s.order, hPrev, wPrev) && hopfTest(point, s.order, h, w) && hPrev * h < 0.0) {
+            BifurcationPoint found = between(BifurcationKind::Hopf, after, prev, point, hPrev, h);
+            found.frequency = wPrev + hPrev / (hPrev - h) * (w - wPrev);
+            locate(sys, s, xPrev, tPrev, step, hPrev, h, [&](const std::vector<double>& probe, BifurcationPoint& hopf) {
+                BranchPoint bp;
+                bp.p = probe[n];
+                bp.y.assign(probe.begin(), probe.end() - 1);
+                analyse(sys, s, bp);
+                double value = NAN;
+                if (!hopfTest(bp, s.order, value, hopf.frequency)) return double(NAN);
+                return value;
+            }, found);
+            result.bifurcations.push_back(found);
+        }
+        result.branch.push_back(point);
+
+        if (progress && !progress(result)) return finish("cancelled", false);
+        if (point.p < s.pMin || point.p > s.pMax) return finish("left the parameter range", true);
+        if (!(maxAbs(point.y) <= s.divergeLimit)) return finish("diverged", true);
+        // back at the first point: a closed branch
+        if (result.branch.size() > 10) {
+            double distance = std::fabs(point.p - first.p);
+            for (int i = 0; i < n; ++i) distance = std::max(distance, std::fabs(point.y[i] - first.y[i]));
+            if (distance < 0.5 * ds) return finish("closed branch", true);
+        }
+    }
+    return finish("maxPoints reached", true);
+}
+
+ContinuationResult joinHalfBranches(const ContinuationResult& backward, const ContinuationResult& forward)
+{
+    ContinuationResult joined;
+    joined.settings = forward.settings;
+    joined.stopReason = "backward: " + backward.stopReason + ", forward: " + forward.stopReason;
+    joined.rhsEvaluations = backward.rhsEvaluations + forward.rhsEvaluations;
+    joined.wallSeconds = backward.wallSeconds + forward.wallSeconds;
+
+    const int back = int(backward.branch.size());
+    const double length = back > 0 ? backward.branch.back().arclength : 0.0;
+    for (int i = back - 1; i >= 0; --i) {
+        joined.branch.push_back(backward.branch[i]);
+        joined.branch.back().arclength = length - backward.branch[i].arclength;
+    }
+    for (BifurcationPoint b : backward.bifurcations) {
+        b.after = back - 2 - b.after;
+        joined.bifurcations.push_back(b);
+    }
+    // forward starts at the same point as backward
+    const int skip = back > 0 ? 1 : 0;
+    const int offset = back > 0 ? back - 1 : 0;
+    for (int i = skip; i < int(forward.branch.size()); ++i) {
+        joined.branch.push_back(forward.branch[i]);
+        joined.branch.back().arclength = length + forward.branch[i].arclength;
+    }
+    for (BifurcationPoint b : forward.bifurcations) {
+        b.after += offset;
+        joined.bifurcations.push_back(b);
+    }
+    return joined;
+}
+
+const char* bifurcationKindName(BifurcationKind kind)
+{
+    switch (kind) {
+    case BifurcationKind::Fold:   return "fold";
+    case BifurcationKind::Branch: return "branch";
+    case BifurcationKind::Hopf:   return "hopf";
+    }
+    return "?";
+}
@@ -0,0 +1,84 @@
+#ifndef CONTINUATION_H
+#define CONTINUATION_H
+
+#include <complex>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "equilibrium.h"
+#include "networkspec.h"
+
+// Pseudo-arclength continuation of an equilibrium branch f(y, p) = 0 in one parameter p
+// (alpha2 by default). Each step predicts along the unit tangent of the curve in (y, p)
+// and corrects with Newton on the system bordered by the arclength condition, so the
+// branch is followed around folds where p turns back; unstable parts come for free.
+// Along the way the Jacobian eigenvalues give the stability and mark
+//   fold:   the p component of the tangent changes sign (a real eigenvalue crosses 0)
+//   branch: det J changes sign without a fold (transcritical / pitchfork)
+//   hopf:   a complex pair crosses the stability boundary (a limit cycle is born there)
+// Special points are refined on the branch by regula falsi on the arclength step between
+// the two points around the sign change of their test function.
+
+enum class BifurcationKind { Fold, Branch, Hopf };
+
+struct ContinuationSettings {
+    double pMin = -10.0;           // stop once the branch leaves [pMin, pMax]
+    double pMax = 10.0;
+    int direction = 1;             // initial direction of p: +1 or -1
+    double ds = 0.02;              // arclength step in (y, p), adapted between dsMin and dsMax
+    double dsMin = 1e-6;
+    double dsMax = 0.2;
+    int maxPoints = 5000;
+    double tolerance = 1e-10;      // max |f| of a corrected point
+    int maxCorrectorIterations = 8;
+    double divergeLimit = 1e6;     // |y_i| above it: stop
+    double order = 1.0;            // stability sector as in EquilibriumSettings::order
+};
+
+struct BranchPoint {
+    double p = 0.0;
+    std::vector<double> y;
+    std::vector<std::complex<double>> eigenvalues; // largest real part first
+    EquilibriumKind kind = EquilibriumKind::NonHyperbolic;
+    int unstableDirections = 0;
+    double arclength = 0.0;
+};
+
+struct BifurcationPoint {
+    BifurcationKind kind = BifurcationKind::Fold;
+    int after = 0;                 // between branch points after and after + 1
+    double p = 0.0;
+    std::vector<double> y;
+    double frequency = 0.0;        // hopf: |Im lambda| of the crossing pair
+};
+
+struct ContinuationResult {
+    ContinuationSettings settings;
+    std::vector<BranchPoint> branch;
+    std::vector<BifurcationPoint> bifurcations;
+    std::string stopReason;
+    long long rhsEvaluations = 0;
+    double wallSeconds = 0.0;
+};
+
+// The network at parameter value p. Called whenever p changes (the residual, Jacobian and
+// eigenvalues at one p share a build) and twice more per Jacobian for df/dp, so it should
+// patch a prebuilt spec rather than rebuild it.
+using ParameterSpecFn = std::function<NetworkSpec(double p)>;
+// Called after every accepted point; false cancels.
+using ContinuationProgressFn = std::function<bool(const ContinuationResult& result)>;
+
+// y0 is a guess of the equilibrium at p0; it is first corrected with p fixed.
+// Returns false when that fails (result.stopReason says why) or when cancelled.
+bool continueEquilibrium(const ParameterSpecFn& specAt, double p0, const std::vector<double>& y0,
+                         const ContinuationSettings& settings, ContinuationResult& result,
+                         const ContinuationProgressFn& progress = ContinuationProgressFn());
+
+// One branch through the start point: backward (run with direction -1) reversed, then
+// forward; indices and arclengths are renumbered from the backward end.
+ContinuationResult joinHalfBranches(const ContinuationResult& backward, const ContinuationResult& forward);
+
+const char* bifurcationKindName(BifurcationKind kind);
+
+#endif // CONTINUATION_H
@@ -0,0 +1,655 @@
+#include "equationdsl.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+inline double applyOp(EquationOp op, double x, double y)
+{
+    switch (op) {
+    case EquationOp::Add:  return x + y;
+    case EquationOp::Sub:  return x - y;
+    case EquationOp::Mul:  return x * y;
+    case EquationOp::Div:  return x / y;
+    case EquationOp::Pow:  return std::pow(x, y);
+    case EquationOp::Neg:  return -x;
+    case EquationOp::Sin:  return std::sin(x);
+    case EquationOp::Cos:  return std::cos(x);
+    case EquationOp::Tanh: return std::tanh(x);
+    case EquationOp::Exp:  return std::exp(x);
+    case EquationOp::Log:  return std::log(x);
+    case EquationOp::Sqrt: return std::sqrt(x);
+    case EquationOp::Abs:  return std::fabs(x);
+    case EquationOp::Relu: return (x > 0.0) ? x : 0.0;
+    case EquationOp::Store: break;
+    }
+    return 0.0;
+}
+
+bool isBinary(EquationOp op)
+{
+    return op == EquationOp::Add || op == EquationOp::Sub || op == EquationOp::Mul
+        || op == EquationOp::Div || op == EquationOp::Pow;
+}
+
+const char* opName(EquationOp op)
+{
+    switch (op) {
+    case EquationOp::Add:  return "add";
+    case EquationOp::Sub:  return "sub";
+    case EquationOp::Mul:  return "mul";
+    case EquationOp::Div:  return "div";
+    case EquationOp::Pow:  return "pow";
+    case EquationOp::Neg:  return "neg";
+    case EquationOp::Sin:  return "sin";
+    case EquationOp::Cos:  return "cos";
+    case EquationOp::Tanh: return "tanh";
+    case EquationOp::Exp:  return "exp";
+    case EquationOp::Log:  return "log";
+    case EquationOp::Sqrt: return "sqrt";
+    case EquationOp::Abs:  return "abs";
+    case EquationOp::Relu: return "relu";
+    case EquationOp::Store: break;
+    }
+    return "store";
+}
+
+struct FunctionName {
+    const char* name;
+    EquationOp op;
+    int args;
+};
+
+// "sin_exp" is the connection function name the canvas uses for sin
+const FunctionName kFunctions[] = {
+    {"sin", EquationOp::Sin, 1},   {"sin_exp", EquationOp::Sin, 1}, {"cos", EquationOp::Cos, 1},
+    {"tanh", EquationOp::Tanh, 1}, {"exp", EquationOp::Exp, 1},     {"log", EquationOp::Log, 1},
+    {"sqrt", EquationOp::Sqrt, 1}, {"abs", EquationOp::Abs, 1},     {"relu", EquationOp::Relu, 1},
+    {"pow", EquationOp::Pow, 2},
+};
+
+// ================= Expression DAG =================
+
+enum class NodeKind { Constant, State, Op };
+
+struct ExprNode {
+    NodeKind kind;
+    EquationOp op;
+    int a;
+    int b;
+    double value;  // Constant
+    int index;     // State (0-based)
+};
+
+// Hash-consed: building the same (op, operands) twice returns the same node, which
+// is the common-subexpression elimination. Nodes are created children-first, so
+// node order is a valid evaluation order.
+class ExprGraph
+{
+public:
+    std::vector<ExprNode> nodes;
+
+    int constant(double v)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        return intern({NodeKind::Constant, EquationOp::Add, -1, -1, v, -1}, bits);
+    }
+
+    int state(int index) { return intern({NodeKind::State, EquationOp::Add, -1, -1, 0.0, index}, 0); }
+
+    int unary(EquationOp op, int a)
+    {
+        const ExprNode& x = nodes[a];
+        if (x.kind == NodeKind::Constant) return constant(applyOp(op, x.value, 0.0));
+        if (op == EquationOp::Neg && x.kind == NodeKind::Op && x.op == EquationOp::Neg) return x.a;
+        return intern({NodeKind::Op, op, a, -1, 0.0, -1}, 0);
+    }
+
+    int binary(EquationOp op, int a, int b)
+    {
+        const bool ca = isConst(a), cb = isConst(b);
+        if (ca && cb) return constant(applyOp(op, nodes[a].value, nodes[b].value));
+
+        // only identities that hold for every double, signed zeros, inf and NaN included:
+        // x + (-0), x - (+0), x * 1, x / 1, pow(x, 1). Not 0 * x (inf, NaN), x + (+0) or
+        // 0 - x (signed zero), so zero-weight terms stay and round like the other kernels.
+        switch (op) {
+        case EquationOp::Add:
+            if (isZero(a, true)) return b;
+            if (isZero(b, true)) return a;
+            break;
+        case EquationOp::Sub:
+            if (isZero(b, false)) return a;
+            break;
+        case EquationOp::Mul:
+            if (isOne(a)) return b;
+            if (isOne(b)) return a;
+            break;
+        case EquationOp::Div:
+            if (isOne(b)) return a;
+            break;
+        case EquationOp::Pow:
+            if (isOne(b)) return a;
+            break;
+        default:
+            break;
+        }
+
+        // a+b == b+a and a*b == b*a exactly, so commutative operands get one order
+        if ((op == EquationOp::Add || op == EquationOp::Mul) && b < a) std::swap(a, b);
+        return intern({NodeKind::Op, op, a, b, 0.0, -1}, 0);
+    }
+
+    bool isConst(int id) const { return nodes[id].kind == NodeKind::Constant; }
+
+private:
+    using Key = std::tuple<int, int, int, int, int, std::uint64_t>;
+    std::map<Key, int> memo;
+
+    bool isZero(int id, bool negative) const
+    {
+        return isConst(id) && nodes[id].value == 0.0 && std::signbit(nodes[id].value) == negative;
+    }
+    bool isOne(int id) const { return isConst(id) && nodes[id].value == 1.0; }
+
+    int intern(const ExprNode& n, std::uint64_t bits)
+    {
+        const Key key(int(n.kind), int(n.op), n.a, n.b, n.index, bits);
+        auto it = memo.find(key);
+        if (it != memo.end()) return it->second;
+        nodes.push_back(n);
+        const int id = int(nodes.size()) - 1;
+        memo.emplace(key, id);
+        return id;
+    }
+};
+
+// ================= Parser =================
+
+// One statement: "Dy<i>[(w)] = expr" or "name = expr" (a constant).
+class LineParser
+{
+public:
+    LineParser(const std::string& text, int lineNo, ExprGraph& graph, const EquationParameters& params)
+        : s(text), line(lineNo), g(graph), params(params)
+    {
+    }
+
+    std::string error;
+    int maxState = 0; // highest y<j> seen, 1-based
+
+    int parseExpression()
+    {
+        const int e = expr();
+        if (!ok()) return -1;
+        skipSpace();
+        if (pos < s.size()) return fail("unexpected '" + s.substr(pos, 1) + "'");
+        return e;
+    }
+
+    bool ok() const { return error.empty(); }
+
+    int fail(const std::string& msg)
+    {
+        if (error.empty()) error = "line " + std::to_string(line) + ": " + msg;
+        return -1;
+    }
+
+private:
+    const std::string& s;
+    std::size_t pos = 0;
+    int line;
+    ExprGraph& g;
+    const EquationParameters& params;
+
+    void skipSpace()
+    {
+        while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\r')) ++pos;
+    }
+
+    bool accept(char c)
+    {
+        skipSpace();
+        if (pos < s.size() && s[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    int expr()
+    {
+        int left = term();
+        while (ok()) {
+            EquationOp op;
+            if (accept('+')) op = EquationOp::Add;
+            else if (accept('-')) op = EquationOp::Sub;
+            else break;
+            const int right = term();
+            if (!ok()) return -1;
+            left = g.binary(op, left, right);
+        }
+        return ok() ? left : -1;
+    }
+
+    int term()
+    {
+        int left = unaryExpr();
+        while (ok()) {
+            EquationOp op;
+            if (accept('*')) op = EquationOp::Mul;
+            else if (accept('/')) op = EquationOp::Div;
+            else break;
+            const int right = unaryExpr();
+            if (!ok()) return -1;
+            left = g.binary(op, left, right);
+        }
+        return ok() ? left : -1;
+    }
+
+    // unary minus binds tighter than * (as in C), looser than ^: -y^2 == -(y^2)
+    int unaryExpr()
+    {
+        if (accept('-')) {
+            const int x = unaryExpr();
+            return ok() ? g.unary(EquationOp::Neg, x) : -1;
+        }
+        if (accept('+')) return unaryExpr();
+        const int base = primary();
+        if (ok() && accept('^')) {
+            const int exponent = unaryExpr();
+            return ok() ? g.binary(EquationOp::Pow, base, exponent) : -1;
+        }
+        return base;
+    }
+
+    int primary()
+    {
+        skipSpace();
+        if (!ok()) return -1;
+        if (pos >= s.size()) return fail("expression ends early");
+
+        if (accept('(')) {
+            const int e = expr();
+            if (!ok()) return -1;
+            if (!accept(')')) return fail("missing ')'");
+            return e;
+        }
+
+        const char c = s[pos];
+        if ((c >= '0' && c <= '9') || c == '.') {
+            const char* begin = s.c_str() + pos;
+            char* end = nullptr;
+            const double v = std::strtod(begin, &end);
+            if (end == begin) return fail("bad number");
+            pos += std::size_t(end - begin);
+            return g.constant(v);
+        }
+
+        const std::string name = identifier();
+        if (name.empty()) return fail("unexpected '" + s.substr(pos, 1) + "'");
+
+        if (accept('(')) return call(name);
+
+        const int index = stateIndex(name);
+        if (index == 0) return fail("nodes are numbered from 1");
+        if (index > 0) {
+            maxState = std::max(maxState, index);
+            return g.state(index - 1);
+        }
+
+        auto it = params.find(name);
+        if (it == params.end()) return fail("unknown name '" + name + "'");
+        return g.constant(it->second);
+    }
+
+    int call(const std::string& name)
+    {
+        for (const FunctionName& f : kFunctions) {
+            if (name != f.name) continue;
+            const int a = expr();
+            if (!ok()) return -1;
+            int b = -1;
+            if (f.args == 2) {
+                if (!accept(',')) return fail(name + " takes two arguments");
+                b = expr();
+                if (!ok()) return -1;
+            }
+            if (!accept(')')) return fail("missing ')' after " + name);
+            return f.args == 2 ? g.binary(f.op, a, b) : g.unary(f.op, a);
+        }
+        return fail("unknown function '" + name + "'");
+    }
+
+public:
+    // Letters/digits/_ ; UTF-8 "α" (as in graph.txt) reads as "alpha".
+    std::string identifier()
+    {
+        skipSpace();
+        std::string out;
+        while (pos < s.size()) {
+            const unsigned char c = static_cast<unsigned char>(s[pos]);
+            if (c == 0xCE && pos + 1 < s.size() && static_cast<unsigned char>(s[pos + 1]) == 0xB1) {
+                out += "alpha";
+                pos += 2;
+            } else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'
+                       || (!out.empty() && c >= '0' && c <= '9')) {
+                out += char(c);
+                ++pos;
+            } else {
+                break;
+            }
+        }
+        return out;
+    }
+
+    bool atEnd()
+    {
+        skipSpace();
+        return pos >= s.size();
+    }
+
+    // Optional "(w)" after Dy<i>.
+    void skipTag()
+    {
+        const std::size_t save = pos;
+        if (accept('(')) {
+            identifier();
+            if (accept(')')) return;
+        }
+        pos = save;
+    }
+
+    // "y3" / "y_3" -> 3; -1 for any other name
+    static int stateIndex(const std::string& name)
+    {
+        if (name.size() < 2 || name[0] != 'y') return -1;
+        std::size_t k = (name[1] == '_') ? 2 : 1;
+        if (k >= name.size()) return -1;
+        int v = 0;
+        for (; k < name.size(); ++k) {
+            if (name[k] < '0' || name[k] > '9') return -1;
+            v = v * 10 + (name[k] - '0');
+            if (v > 1000000) return -1;
+        }
+        return v;
+    }
+};
+
+struct Statement {
+    int line;
+    std::string lhs;
+    std::string rhs;
+};
+
+std::string trim(const std::string& s)
+{
+    std::size_t b = 0, e = s.size();
+    while (b < e && std::isspace(static_cast<unsigned char>(s[b]))) ++b;
+    while (e > b && std::isspace(static_cast<unsigned char>(s[e - 1]))) --e;
+    return s.substr(b, e - b);
+}
+
+std::string fmtDouble(double v)
+{
+    char buf[40];
+    std::snprintf(buf, sizeof buf, "%.17g", v);
+    return buf;
+}
+
+} // namespace
+
+// ================= EquationProgram =================
+
+int EquationProgram::operationCount() const
+{
+    int ops = 0;
+    for (const EquationInstr& in : code)
+        if (in.op != EquationOp::Store) ++ops;
+    return ops;
+}
+
+std::string EquationProgram::disassemble() const
+{
+    std::string out;
+    for (std::size_t k = 0; k < constants.size(); ++k)
+        out += "r" + std::to_string(k) + " = " + fmtDouble(constants[k]) + "\n";
+    return out + structure();
+}
+
+std::string EquationProgram::structure() const
+{
+    std::string out = "nodes=" + std::to_string(nodeCount) + " registers=" + std::to_string(registerCount)
+                    + " state=r" + std::to_string(stateBase) + "\n";
+    for (const EquationInstr& in : code) {
+        if (in.op == EquationOp::Store) {
+            out += "dy" + std::to_string(in.dst + 1) + " = r" + std::to_string(in.a) + "\n";
+            continue;
+        }
+        out += "r" + std::to_string(in.dst) + " = " + opName(in.op) + " r" + std::to_string(in.a);
+        if (isBinary(in.op)) out += " r" + std::to_string(in.b);
+        out += "\n";
+    }
+    return out;
+}
+
+// ================= Compiler =================
+
+std::shared_ptr<const EquationProgram> compileEquations(const std::string& text, int nodeCount,
+                                                        const EquationParameters& params,
+                                                        std::string* error)
+{
+    auto failWith = [&](const std::string& msg) -> std::shared_ptr<const EquationProgram> {
+        if (error) *error = msg;
+        return nullptr;
+    };
+
+    // split into statements; "=== ... ===" headers and '#' comments are skipped
+    std::vector<Statement> equations, definitions;
+    std::size_t start = 0;
+    for (int lineNo = 1; start <= text.size(); ++lineNo) {
+        std::size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+
+        const std::size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        line = trim(line);
+        if (line.empty() || line.compare(0, 3, "===") == 0) continue;
+
+        const std::size_t eq = line.find('=');
+        if (eq == std::string::npos) return failWith("line " + std::to_string(lineNo) + ": expected '='");
+        Statement st{lineNo, trim(line.substr(0, eq)), line.substr(eq + 1)};
+        if (st.lhs.compare(0, 2, "Dy") == 0) equations.push_back(st);
+        else definitions.push_back(st);
+    }
+    if (equations.empty()) return failWith("no Dy<i> = ... equations");
+
+    ExprGraph graph;
+    EquationParameters names = params;
+    int maxState = std::max(nodeCount, 1);
+
+    // "s23 = 0.5", "α1 = 2.2": constants, in file order, before any equation uses them
+    for (const Statement& st : definitions) {
+        LineParser lhs(st.lhs, st.line, graph, names);
+        const std::string name = lhs.identifier();
+        if (name.empty() || !lhs.atEnd()) return failWith("line " + std::to_string(st.line) + ": bad name '" + st.lhs + "'");
+        if (LineParser::stateIndex(name) >= 0)
+            return failWith("line " + std::to_string(st.line) + ": cannot assign to " + name);
+
+        LineParser rhs(st.rhs, st.line, graph, names);
+        const int e = rhs.parseExpression();
+        if (!rhs.ok()) return failWith(rhs.error);
+        if (!graph.isConst(e))
+            return failWith("line " + std::to_string(st.line) + ": " + name + " must be a constant");
+        names[name] = graph.nodes[e].value;
+    }
+
+    std::map<int, int> outputs; // 0-based node -> expression
+    for (const Statement& st : equations) {
+        LineParser lhs(st.lhs, st.line, graph, names);
+        const std::string name = lhs.identifier(); // "Dy3" / "Dy_3"
+        const int node = LineParser::stateIndex(name.substr(1));
+        if (node < 1) return failWith("line " + std::to_string(st.line) + ": expected Dy<i> with i >= 1");
+        lhs.skipTag();
+        if (!lhs.atEnd()) return failWith("line " + std::to_string(st.line) + ": expected Dy<i> = ...");
+
+        LineParser rhs(st.rhs, st.line, graph, names);
+        const int e = rhs.parseExpression();
+        if (!rhs.ok()) return failWith(rhs.error);
+        if (!outputs.emplace(node - 1, e).second)
+            return failWith("line " + std::to_string(st.line) + ": Dy" + std::to_string(node) + " given twice");
+        maxState = std::max({maxState, node, rhs.maxState});
+    }
+
+    auto prog = std::make_shared<EquationProgram>();
+    prog->nodeCount = maxState;
+
+    std::vector<int> out(maxState);
+    for (int i = 0; i < maxState; ++i) {
+        auto it = outputs.find(i);
+        out[i] = (it != outputs.end()) ? it->second : graph.unary(EquationOp::Neg, graph.state(i));
+    }
+
+    // live nodes (reachable from an output); ids are already in evaluation order
+    const int count = int(graph.nodes.size());
+    std::vector<char> live(count, 0);
+    for (int id : out) live[id] = 1;
+    for (int id = count - 1; id >= 0; --id) {
+        if (!live[id] || graph.nodes[id].kind != NodeKind::Op) continue;
+        live[graph.nodes[id].a] = 1;
+        if (graph.nodes[id].b >= 0) live[graph.nodes[id].b] = 1;
+    }
+
+    std::vector<int> reg(count, -1);
+    for (int id = 0; id < count; ++id) {
+        if (!live[id] || graph.nodes[id].kind != NodeKind::Constant) continue;
+        reg[id] = int(prog->constants.size());
+        prog->constants.push_back(graph.nodes[id].value);
+    }
+    prog->stateBase = int(prog->constants.size());
+    for (int id = 0; id < count; ++id)
+        if (live[id] && graph.nodes[id].kind == NodeKind::State) reg[id] = prog->stateBase + graph.nodes[id].index;
+
+    // last use of each temporary; outputs stay live until the stores at the end
+    const int kForever = std::numeric_limits<int>::max();
+    std::vector<int> lastUse(count, -1);
+    for (int id = 0; id < count; ++id) {
+        if (!live[id] || graph.nodes[id].kind != NodeKind::Op) continue;
+        lastUse[graph.nodes[id].a] = id;
+        if (graph.nodes[id].b >= 0) lastUse[graph.nodes[id].b] = id;
+    }
+    for (int id : out) lastUse[id] = kForever;
+
+    int nextReg = prog->stateBase + maxState;
+    std::vector<int> freeRegs;
+    for (int id = 0; id < count; ++id) {
+        const ExprNode& n = graph.nodes[id];
+        if (!live[id] || n.kind != NodeKind::Op) continue;
+
+        EquationInstr in{n.op, 0, std::uint32_t(reg[n.a]), std::uint32_t(n.b >= 0 ? reg[n.b] : 0)};
+        // operands read before dst is written, so a dying operand's register can be dst
+        for (int operand : {n.a, n.b}) {
+            if (operand < 0 || graph.nodes[operand].kind != NodeKind::Op) continue;
+            if (lastUse[operand] == id && reg[operand] >= 0) {
+                freeRegs.push_back(reg[operand]);
+                lastUse[operand] = -1; // a*a: free once
+            }
+        }
+        if (!freeRegs.empty()) {
+            reg[id] = freeRegs.back();
+            freeRegs.pop_back();
+        } else {
+            reg[id] = nextReg++;
+        }
+        in.dst = std::uint32_t(reg[id]);
+        prog->code.push_back(in);
+    }
+    for (int i = 0; i < maxState; ++i)
+        prog->code.push_back({EquationOp::Store, std::uint32_t(i), std::uint32_t(reg[out[i]]), 0});
+    prog->registerCount = nextReg;
+
+    if (error) error->clear();
+    return prog;
+}
+
+std::shared_ptr<const EquationProgram> programFromNetwork(const NetworkSpec& spec)
+{
+    auto fnName = [](ActivationKind fn) -> const char* {
+        switch (fn) {
+        case ActivationKind::Sin:  return "sin";
+        case ActivationKind::Tanh: return "tanh";
+        case ActivationKind::Relu: return "relu";
+        case ActivationKind::None: break;
+        }
+        return nullptr;
+    };
+    auto y = [](int i) { return "y" + std::to_string(i + 1); };
+    auto inRange = [&](int i) { return i >= 0 && i < spec.nodeCount; };
+
+    // numbers in parentheses, %.17g: they read back to the same doubles
+    std::string text;
+    for (int i = 0; i < spec.nodeCount; ++i) {
+        text += "Dy" + std::to_string(i + 1) + " = -" + y(i);
+        for (const EdgeSpec& e : spec.edges) {
+            if (e.to != i || !inRange(e.from) || !fnName(e.fn)) continue;
+            text += " + (" + fmtDouble(e.weight) + ")*" + fnName(e.fn) + "(" + y(e.from) + ")";
+        }
+        for (const GateTermSpec& g : spec.gates) {
+            if (g.node != i || !inRange(g.source) || !fnName(g.fn)) continue;
+            text += " + ((" + fmtDouble(g.base) + ") - (" + fmtDouble(g.coeff) + ")*" + fnName(g.fn)
+                  + "(" + y(g.source) + "))*tanh(" + y(i) + ")";
+        }
+        text += "\n";
+    }
+    return compileEquations(text, spec.nodeCount, EquationParameters());
+}
+
+// ================= BytecodeRhsKernel =================
+
+BytecodeRhsKernel::BytecodeRhsKernel(std::shared_ptr<const EquationProgram> program)
+    : prog(std::move(program)), regs(prog->registerCount, 0.0)
+{
+    std::copy(prog->constants.begin(), prog->constants.end(), regs.begin());
+}
+
+std::string BytecodeRhsKernel::name() const
+{
+    return "bytecode(" + std::to_string(prog->operationCount()) + " ops)";
+}
+
+void BytecodeRhsKernel::eval(const double* y, double* dy) const
+{
+    double* r = regs.data();
+    std::copy(y, y + prog->nodeCount, r + prog->stateBase);
+
+    for (const EquationInstr& in : prog->code) {
+        switch (in.op) {
+        case EquationOp::Add:  r[in.dst] = r[in.a] + r[in.b]; break;
+        case EquationOp::Sub:  r[in.dst] = r[in.a] - r[in.b]; break;
+        case EquationOp::Mul:  r[in.dst] = r[in.a] * r[in.b]; break;
+        case EquationOp::Div:  r[in.dst] = r[in.a] / r[in.b]; break;
+        case EquationOp::Pow:  r[in.dst] = std::pow(r[in.a], r[in.b]); break;
+        case EquationOp::Neg:  r[in.dst] = -r[in.a]; break;
+        case EquationOp::Sin:  r[in.dst] = std::sin(r[in.a]); break;
+        case EquationOp::Cos:  r[in.dst] = std::cos(r[in.a]); break;
+        case EquationOp::Tanh: r[in.dst] = std::tanh(r[in.a]); break;
+        case EquationOp::Exp:  r[in.dst] = std::exp(r[in.a]); break;
+        case EquationOp::Log:  r[in.dst] = std::log(r[in.a]); break;
+        case EquationOp::Sqrt: r[in.dst] = std::sqrt(r[in.a]); break;
+        case EquationOp::Abs:  r[in.dst] = std::fabs(r[in.a]); break;
+        case EquationOp::Relu: r[in.dst] = (r[in.a] > 0.0) ? r[in.a] : 0.0; break;
+        case EquationOp::Store: dy[in.dst] = r[in.a]; break;
+        }
+    }
+}
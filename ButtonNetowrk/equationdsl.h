@@ -0,0 +1,80 @@
+#ifndef EQUATIONDSL_H
+#define EQUATIONDSL_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "networkspec.h"
+
+// Custom right-hand sides typed in the graph.txt syntax:
+//   Dy1 = -y1 + 0.5*sin(y2) + (1 - alpha1*tanh(y3))*tanh(y1)
+//   Dy_4(w) = -y4 + s14*tanh(y1)     # comments after '#'
+// Names other than y<j> (alpha1, nu, s<ij>, ...) are constants looked up at compile
+// time, so they fold away. A node without a Dy line gets the leak term -y_i.
+//
+// The text is compiled once: expression DAG with hash-consing (common subexpressions
+// share one register), constant folding, dead-code removal, then linear register
+// code with register reuse. Folding never reassociates, so an equation evaluates
+// bit-for-bit like the same expression written in C++.
+
+enum class EquationOp : std::uint8_t {
+    Add, Sub, Mul, Div, Pow,
+    Neg, Sin, Cos, Tanh, Exp, Log, Sqrt, Abs, Relu,
+    Store  // dy[dst] = r[a]
+};
+
+struct EquationInstr {
+    EquationOp op;
+    std::uint32_t dst;
+    std::uint32_t a;
+    std::uint32_t b;
+};
+
+// Register file layout: [constants | y_0 .. y_{n-1} | temporaries].
+struct EquationProgram {
+    int nodeCount = 0;
+    int stateBase = 0;             // first y register
+    int registerCount = 0;
+    std::vector<double> constants; // preloaded into r[0 .. constants.size())
+    std::vector<EquationInstr> code;
+
+    int operationCount() const;    // instructions without the stores
+    // Listing without the constant values: programs that differ only in weights/alphas
+    // share native code (nativekernel.h).
+    std::string structure() const;
+    // Stable listing of the compiled code; used for cache keys and "show bytecode".
+    std::string disassemble() const;
+};
+
+using EquationParameters = std::map<std::string, double>;
+
+// nodeCount is raised to the highest y/Dy index used. Returns nullptr and fills
+// error ("line 3: unknown name 'alpah1'") when the text does not compile.
+std::shared_ptr<const EquationProgram> compileEquations(const std::string& text, int nodeCount,
+                                                        const EquationParameters& params,
+                                                        std::string* error = nullptr);
+
+// Edges and gates of a spec as a program (same summation order as GenericRhsKernel);
+// used to hand drawn networks to the native code generator.
+std::shared_ptr<const EquationProgram> programFromNetwork(const NetworkSpec& spec);
+
+// Kernel over a compiled program (see rhskernel.h for the interface). eval() uses
+// a private register file, so one instance must not be shared between threads.
+class BytecodeRhsKernel
+{
+public:
+    explicit BytecodeRhsKernel(std::shared_ptr<const EquationProgram> program);
+
+    int nodeCount() const { return prog->nodeCount; }
+    std::string name() const;
+    void eval(const double* y, double* dy) const;
+
+private:
+    std::shared_ptr<const EquationProgram> prog;
+    mutable std::vector<double> regs;
+};
+
+#endif // EQUATIONDSL_H
@@ -0,0 +1,581 @@
+#include "equilibrium.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#include "rhskernel.h"
+#include "workerpool.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+double maxAbs(const std::vector<double>& v)
+{
+    double m = 0.0;
+    for (double x : v) m = std::max(m, std::fabs(x));
+    return m;
+}
+
+double sumSquares(const std::vector<double>& v)
+{
+    double s = 0.0;
+    for (double x : v) s += x * x;
+    return s;
+}
+
+// Seed k: 0 the initial state, 1 the origin, then splitmix64 per (randomSeed, k, node)
+void seedState(const std::vector<double>& y0, const EquilibriumSettings& s, int k, std::vector<double>& y)
+{
+    const int n = int(y.size());
+    if (k == 0) {
+        std::copy(y0.begin(), y0.begin() + n, y.begin());
+        return;
+    }
+    for (int i = 0; i < n; ++i) {
+        if (k == 1) {
+            y[i] = 0.0;
+            continue;
+        }
+        std::uint64_t z = s.randomSeed * 0x9E3779B97F4A7C15ULL + std::uint64_t(k) * 0xD1B54A32D192ED03ULL
+                          + std::uint64_t(i) * 0x8CB92BA72F3D8DD7ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        y[i] = s.seedRange * (2.0 * (double(z >> 11) * (1.0 / 9007199254740992.0)) - 1.0);
+    }
+}
+
+// analytic when the spec allows it, else central differences through the kernel
+template <class Kernel>
+void jacobianAt(const Kernel& kernel, const NetworkSpec& spec, bool analytic, const std::vector<double>& y,
+                std::vector<double>& jac, std::vector<double>& probe, std::vector<double>& fPlus,
+                std::vector<double>& fMinus)
+{
+    const int n = int(y.size());
+    if (analytic) {
+        networkJacobian(spec, y.data(), jac.data());
+        return;
+    }
+    probe = y;
+    for (int j = 0; j < n; ++j) {
+        const double step = 1e-6 * (1.0 + std::fabs(y[j]));
+        probe[j] = y[j] + step;
+        kernel.eval(probe.data(), fPlus.data());
+        probe[j] = y[j] - step;
+        kernel.eval(probe.data(), fMinus.data());
+        probe[j] = y[j];
+        for (int i = 0; i < n; ++i) jac[std::size_t(i) * n + j] = (fPlus[i] - fMinus[i]) / (2.0 * step);
+    }
+}
+
+} // namespace
+
+bool solveDenseSystem(int n, std::vector<double>& a, std::vector<double>& b)
+{
+    double scale = 0.0;
+    for (double v : a) scale = std::max(scale, std::fabs(v));
+    if (scale == 0.0) return false;
+
+    for (int k = 0; k < n; ++k) {
+        int p = k;
+        for (int i = k + 1; i < n; ++i)
+            if (std::fabs(a[std::size_t(i) * n + k]) > std::fabs(a[std::size_t(p) * n + k])) p = i;
+        if (!(std::fabs(a[std::size_t(p) * n + k]) > 1e-14 * scale)) return false;
+        if (p != k) {
+            std::swap_ranges(a.begin() + std::size_t(k) * n, a.begin() + std::size_t(k + 1) * n,
+                             a.begin() + std::size_t(p) * n);
+            std::swap(b[k], b[p]);
+        }
+        const double* rowK = &a[std::size_t(k) * n];
+        for (int i = k + 1; i < n; ++i) {
+            double* rowI = &a[std::size_t(i) * n];
+            const double m = rowI[k] / rowK[k];
+            if (m == 0.0) continue;
+            for (int j = k + 1; j < n; ++j) rowI[j] -= m * rowK[j];
+            b[i] -= m * b[k];
+        }
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        const double* rowI = &a[std::size_t(i) * n];
+        double sum = b[i];
+        for (int j = i + 1; j < n; ++j) sum -= rowI[j] * b[j];
+        b[i] = sum / rowI[i];
+    }
+    return true;
+}
+
+namespace {
+
+struct SeedResult {
+    bool converged = false;
+    int iterations = 0;
+    double residual = 0.0;
+    std::vector<double> y;
+};
+
+struct NewtonScratch {
+    std::vector<double> f, jac, dx, trial, fTrial, probe, fMinus;
+    explicit NewtonScratch(int n)
+        : f(n), jac(std::size_t(n) * n), dx(n), trial(n), fTrial(n), probe(n), fMinus(n) {}
+};
+
+// Damped Newton: full step first, halved until |f|^2 decreases enough (Armijo, 1e-4).
+// Converged when |f| is below tolerance and the last step was well inside mergeTolerance:
+// near a singular Jacobian Newton is only linear, and stopping on |f| alone would leave
+// one equilibrium as a cloud of points that do not merge.
+template <class Kernel>
+SeedResult newton(const Kernel& kernel, const NetworkSpec& spec, bool analytic, const EquilibriumSettings& s,
+                  std::vector<double> y, NewtonScratch& w)
+{
+    const int n = int(y.size());
+    SeedResult seed;
+    kernel.eval(y.data(), w.f.data());
+    double phi = sumSquares(w.f);
+    double lastStep = HUGE_VAL;
+
+    for (int it = 0; it <= s.maxIterations; ++it) {
+        seed.iterations = it;
+        seed.residual = maxAbs(w.f);
+        if (!std::isfinite(phi)) break;
+        const bool small = seed.residual <= s.tolerance;
+        if (small && lastStep <= 0.01 * s.mergeTolerance * (1.0 + maxAbs(y))) {
+            seed.converged = true;
+            break;
+        }
+        if (it == s.maxIterations) {
+            seed.converged = small;
+            break;
+        }
+
+        jacobianAt(kernel, spec, analytic, y, w.jac, w.probe, w.fTrial, w.fMinus);
+        for (int i = 0; i < n; ++i) w.dx[i] = -w.f[i];
+        if (!solveDenseSystem(n, w.jac, w.dx)) {
+            seed.converged = small;
+            break;
+        }
+        if (small && phi == 0.0) {
+            seed.converged = true;
+            break;
+        }
+
+        bool accepted = false;
+        for (double lambda = 1.0; lambda > 1e-10; lambda *= 0.5) {
+            bool inside = true;
+            for (int i = 0; i < n; ++i) {
+                w.trial[i] = y[i] + lambda * w.dx[i];
+                if (!(std::fabs(w.trial[i]) <= s.divergeLimit)) inside = false;
+            }
+            if (!inside) continue;
+            kernel.eval(w.trial.data(), w.fTrial.data());
+            const double phiTrial = sumSquares(w.fTrial);
+            if (phiTrial <= (1.0 - 2e-4 * lambda) * phi || (small && phiTrial <= phi)) {
+                lastStep = lambda * maxAbs(w.dx);
+                y.swap(w.trial);
+                w.f.swap(w.fTrial);
+                phi = phiTrial;
+                accepted = true;
+                break;
+            }
+        }
+        if (!accepted) {
+            seed.converged = small; // |f| at rounding level, no decrease left
+            break;
+        }
+    }
+    seed.y = std::move(y);
+    return seed;
+}
+
+// Parlett-Reinsch balancing by powers of two (exact), then Gaussian reduction to
+// upper Hessenberg form; eigenvalues are unchanged by both.
+void balanceAndReduce(int n, std::vector<double>& a)
+{
+    auto at = [&](int i, int j) -> double& { return a[std::size_t(i) * n + j]; };
+
+    for (bool done = false; !done;) {
+        done = true;
+        for (int i = 0; i < n; ++i) {
+            double r = 0.0, c = 0.0;
+            for (int j = 0; j < n; ++j) {
+                if (j == i) continue;
+                c += std::fabs(at(j, i));
+                r += std::fabs(at(i, j));
+            }
+            if (c == 0.0 || r == 0.0) continue;
+            const double s = c + r;
+            double f = 1.0;
+            double g = r / 2.0;
+            while (c < g) {
+                f *= 2.0;
+                c *= 4.0;
+            }
+            g = r * 2.0;
+            while (c > g) {
+                f /= 2.0;
+                c /= 4.0;
+            }
+            if ((c + r) / f < 0.95 * s) {
+                done = false;
+                for (int j = 0; j < n; ++j) at(i, j) /= f;
+                for (int j = 0; j < n; ++j) at(j, i) *= f;
+            }
+        }
+    }
+
+    for (int m = 1; m < n - 1; ++m) {
+        double x = 0.0;
+        int p = m;
+        for (int j = m; j < n; ++j)
+            if (std::fabs(at(j, m - 1)) > std::fabs(x)) {
+                x = at(j, m - 1);
+                p = j;
+            }
+        if (p != m) {
+            for (int j = m - 1; j < n; ++j) std::swap(at(p, j), at(m, j));
+            for (int j = 0; j < n; ++j) std::swap(at(j, p), at(j, m));
+        }
+        if (x == 0.0) continue;
+        for (int i = m + 1; i < n; ++i) {
+            double y = at(i, m - 1);
+            if (y == 0.0) continue;
+            y /= x;
+            at(i, m - 1) = 0.0;
+            for (int j = m; j < n; ++j) at(i, j) -= y * at(m, j);
+            for (int j = 0; j < n; ++j) at(j, m) += y * at(j, i);
+        }
+    }
+}
+
+// Francis double-shift QR on an upper Hessenberg matrix with deflation (EISPACK hqr)
+bool hessenbergQr(int n, std::vector<double>& a, std::vector<double>& wr, std::vector<double>& wi)
+{
+    auto at = [&](int i, int j) -> double& { return a[std::size_t(i) * n + j]; };
+    const double eps = 2.220446049250313e-16;
+
+    double norm = 0.0;
+    for (int i = 0; i < n; ++i)
+        for (int j = std::max(i - 1, 0); j < n; ++j) norm += std::fabs(at(i, j));
+
+    int nn = n - 1;
+    double t = 0.0;
+    while (nn >= 0) {
+        int its = 0;
+        int l = 0;
+        do {
+            for (l = nn; l > 0; --l) {
+                double s = std::fabs(at(l - 1, l - 1)) + std::fabs(at(l, l));
+                if (s == 0.0) s = norm;
+                if (std::fabs(at(l, l - 1)) <= eps * s) {
+                    at(l, l - 1) = 0.0;
+                    break;
+                }
+            }
+            double x = at(nn, nn);
+            if (l == nn) {
+                // one real root
+                wr[nn] = x + t;
+                wi[nn] = 0.0;
+                --nn;
+                continue;
+            }
+            double y = at(nn - 1, nn - 1);
+            double w = at(nn, nn - 1) * at(nn - 1, nn);
+            if (l == nn - 1) {
+                // a 2 x 2 block: two real roots or a complex pair
+                const double p = 0.5 * (y - x);
+                const double q = p * p + w;
+                double z = std::sqrt(std::fabs(q));
+                x += t;
+                if (q >= 0.0) {
+                    z = p + (p >= 0.0 ? z : -z);
+                    wr[nn - 1] = wr[nn] = x + z;
+                    if (z != 0.0) wr[nn] = x - w / z;
+                    wi[nn - 1] = wi[nn] = 0.0;
+                } else {
+                    wr[nn - 1] = wr[nn] = x + p;
+                    wi[nn - 1] = -z;
+                    wi[nn] = z;
+                }
+                nn -= 2;
+                continue;
+            }
+
+            if (its == 60) return false;
+            if (its == 10 || its == 20) {
+                // exceptional shift
+                t += x;
+                for (int i = 0; i <= nn; ++i) at(i, i) -= x;
+                const double s = std::fabs(at(nn, nn - 1)) + std::fabs(at(nn - 1, nn - 2));
+                y = x = 0.75 * s;
+                w = -0.4375 * s * s;
+            }
+            ++its;
+
+            int m = nn - 2;
+            double p = 0.0, q = 0.0, r = 0.0, z = 0.0;
+            for (; m >= l; --m) {
+                z = at(m, m);
+                r = x - z;
+                const double s0 = y - z;
+                p = (r * s0 - w) / at(m + 1, m) + at(m, m + 1);
+                q = at(m + 1, m + 1) - z - r - s0;
+                r = at(m + 2, m + 1);
+                const double s = std::fabs(p) + std::fabs(q) + std::fabs(r);
+                p /= s;
+                q /= s;
+                r /= s;
+                if (m == l) break;
+                const double u = std::fabs(at(m, m - 1)) * (std::fabs(q) + std::fabs(r));
+                const double v = std::fabs(p) * (std::fabs(at(m - 1, m - 1)) + std::fabs(z) + std::fabs(at(m + 1, m + 1)));
+                if (u <= eps * v) break;
+            }
+            for (int i = m; i < nn - 1; ++i) {
+                at(i + 2, i) = 0.0;
+                if (i != m) at(i + 2, i - 1) = 0.0;
+            }
+            for (int k = m; k < nn; ++k) {
+                if (k != m) {
+                    p = at(k, k - 1);
+                    q = at(k + 1, k - 1);
+                    r = (k + 1 != nn) ? at(k + 2, k - 1) : 0.0;
+                    x = std::fabs(p) + std::fabs(q) + std::fabs(r);
+                    if (x != 0.0) {
+                        p /= x;
+                        q /= x;
+                        r /= x;
+                    }
+                }
+                double s = std::sqrt(p * p + q * q + r * r);
+                if (p < 0.0) s = -s;
+                if (s == 0.0) continue;
+                if (k == m) {
+                    if (l != m) at(k, k - 1) = -at(k, k - 1);
+                } else {
+                    at(k, k - 1) = -s * x;
+                }
+                p += s;
+                x = p / s;
+                y = q / s;
+                z = r / s;
+                q /= p;
+                r /= p;
+                for (int j = k; j <= nn; ++j) {
+                    double pj = at(k, j) + q * at(k + 1, j);
+                    if (k + 1 != nn) {
+                        pj += r * at(k + 2, j);
+                        at(k + 2, j) -= pj * z;
+                    }
+                    at(k + 1, j) -= pj * y;
+                    at(k, j) -= pj * x;
+                }
+                const int last = std::min(nn, k + 3);
+                for (int i = l; i <= last; ++i) {
+                    double pi = x * at(i, k) + y * at(i, k + 1);
+                    if (k + 1 != nn) {
+                        pi += z * at(i, k + 2);
+                        at(i, k + 2) -= pi * r;
+                    }
+                    at(i, k + 1) -= pi * q;
+                    at(i, k) -= pi;
+                }
+            }
+        } while (l + 1 < nn);
+    }
+    return true;
+}
+
+bool isStable(EquilibriumKind kind)
+{
+    return kind == EquilibriumKind::StableNode || kind == EquilibriumKind::StableFocus;
+}
+
+} // namespace
+
+bool networkJacobian(const NetworkSpec& spec, const double* y, double* jacobian)
+{
+    // native code carries its own forward-mode Jacobian, whatever the spec was built from
+    if (spec.native) {
+        if (!spec.native->jacobian) return false;
+        NativeRhsKernel(spec.native).jacobian(y, jacobian);
+        return true;
+    }
+    if (spec.equations) return false;
+    const int n = spec.nodeCount;
+    std::fill(jacobian, jacobian + std::size_t(n) * n, 0.0);
+    for (int i = 0; i < n; ++i) jacobian[std::size_t(i) * n + i] = -1.0;
+    // only what the kernels integrate: edges / gates outside the network are skipped
+    for (const EdgeSpec& e : spec.edges)
+        if (edgeInRange(e, n))
+            jacobian[std::size_t(e.to) * n + e.from] += e.weight * activationSlope(e.fn, y[e.from]);
+    // G * tanh(y_i), G = base - coeff * fn(y_source)
+    for (const GateTermSpec& g : spec.gates) {
+        if (!gateInRange(g, n)) continue;
+        const double t = std::tanh(y[g.node]);
+        const double gate = g.base - g.coeff * applyActivation(g.fn, y[g.source]);
+        jacobian[std::size_t(g.node) * n + g.node] += gate * (1.0 - t * t);
+        jacobian[std::size_t(g.node) * n + g.source] -= g.coeff * activationSlope(g.fn, y[g.source]) * t;
+    }
+    return true;
+}
+
+void rhsJacobian(const NetworkSpec& spec, const double* y, double* jacobian)
+{
+    if (networkJacobian(spec, y, jacobian)) return;
+    const int n = spec.nodeCount;
+    NetworkSpec single = spec;
+    single.threads = 1;
+    visitRhsKernel(single, [&](const auto& kernel) {
+        std::vector<double> at(y, y + n), jac(std::size_t(n) * n), probe(n), fPlus(n), fMinus(n);
+        jacobianAt(kernel, single, false, at, jac, probe, fPlus, fMinus);
+        std::copy(jac.begin(), jac.end(), jacobian);
+    });
+}
+
+bool matrixEigenvalues(int n, std::vector<double>& a, std::vector<std::complex<double>>& eigenvalues)
+{
+    eigenvalues.clear();
+    if (n <= 0) return true;
+    balanceAndReduce(n, a);
+    std::vector<double> wr(n), wi(n);
+    if (!hessenbergQr(n, a, wr, wi)) return false;
+    for (int i = 0; i < n; ++i) eigenvalues.emplace_back(wr[i], wi[i]);
+    std::sort(eigenvalues.begin(), eigenvalues.end(), [](const std::complex<double>& p, const std::complex<double>& q) {
+        return p.real() != q.real() ? p.real() > q.real() : p.imag() > q.imag();
+    });
+    return true;
+}
+
+EquilibriumKind classifyEquilibrium(const std::vector<std::complex<double>>& eigenvalues, double order,
+                                    int* unstableDirections)
+{
+    const double boundary = order * kPi / 2.0;
+    // eigenvalues closer than this to the sector boundary count as on it
+    double scale = 1.0;
+    for (const std::complex<double>& lambda : eigenvalues) scale = std::max(scale, std::abs(lambda));
+    const double closeTo = 1e-8 * scale;
+
+    int unstable = 0;
+    bool onBoundary = false;
+    bool rotating = false;
+    for (const std::complex<double>& lambda : eigenvalues) {
+        const double size = std::abs(lambda);
+        if (size <= closeTo) {
+            onBoundary = true;
+            continue;
+        }
+        if (std::fabs(lambda.imag()) > closeTo) rotating = true;
+        const double margin = std::fabs(std::arg(lambda)) - boundary;
+        if (std::fabs(margin) * size <= closeTo) onBoundary = true;
+        else if (margin < 0.0) ++unstable;
+    }
+    if (unstableDirections) *unstableDirections = unstable;
+    if (onBoundary) return EquilibriumKind::NonHyperbolic;
+    if (unstable == 0) return rotating ? EquilibriumKind::StableFocus : EquilibriumKind::StableNode;
+    if (unstable == int(eigenvalues.size()))
+        return rotating ? EquilibriumKind::UnstableFocus : EquilibriumKind::UnstableNode;
+    return EquilibriumKind::Saddle;
+}
+
+bool findEquilibria(const NetworkSpec& spec, const std::vector<double>& y0, const EquilibriumSettings& settings,
+                    EquilibriumResult& result, const EquilibriumProgressFn& progress)
+{
+    const auto wallStart = std::chrono::steady_clock::now();
+    const int n = spec.nodeCount;
+
+    result = EquilibriumResult();
+    result.settings = settings;
+    result.settings.seeds = std::max(1, settings.seeds);
+    result.nodeCount = n;
+    result.analyticJacobian = spec.native ? bool(spec.native->jacobian) : !spec.equations;
+    const EquilibriumSettings& s = result.settings;
+    const bool analytic = result.analyticJacobian;
+
+    // workers build their own kernel: bytecode / sparse kernels keep scratch state
+    NetworkSpec workerSpec = spec;
+    workerSpec.threads = 1;
+    WorkerPool pool(std::min(s.threads > 0 ? s.threads : WorkerPool::hardwareThreads(), s.seeds));
+
+    std::vector<SeedResult> seeds(s.seeds);
+    std::atomic<int> nextSeed(0);
+    std::atomic<int> seedsDone(0);
+    std::atomic<bool> stop(false);
+
+    auto job = [&](int k) {
+        visitRhsKernel(workerSpec, [&](const auto& kernel) {
+            NewtonScratch scratch(n);
+            std::vector<double> start(n);
+            for (;;) {
+                const int seed = nextSeed++;
+                if (seed >= s.seeds || stop) break;
+                seedState(y0, s, seed, start);
+                seeds[seed] = newton(kernel, workerSpec, analytic, s, start, scratch);
+                ++seedsDone;
+                if (k == 0 && progress && !progress(seedsDone)) stop = true;
+            }
+        });
+    };
+    pool.run(job);
+    if (stop) return false;
+
+    // merge in seed order
+    for (int seed = 0; seed < s.seeds; ++seed) {
+        SeedResult& r = seeds[seed];
+        result.newtonIterations += r.iterations;
+        if (!r.converged) {
+            ++result.failedSeeds;
+            continue;
+        }
+        bool known = false;
+        for (Equilibrium& e : result.equilibria) {
+            double distance = 0.0, size = 0.0;
+            for (int i = 0; i < n; ++i) {
+                distance = std::max(distance, std::fabs(r.y[i] - e.y[i]));
+                size = std::max(size, std::fabs(e.y[i]));
+            }
+            if (distance <= s.mergeTolerance * (1.0 + size)) {
+                ++e.seeds;
+                known = true;
+                break;
+            }
+        }
+        if (known) continue;
+        Equilibrium e;
+        e.y = std::move(r.y);
+        e.residual = r.residual;
+        e.seeds = 1;
+        e.firstSeed = seed;
+        e.iterations = r.iterations;
+        result.equilibria.push_back(std::move(e));
+    }
+
+    visitRhsKernel(workerSpec, [&](const auto& kernel) {
+        std::vector<double> jac(std::size_t(n) * n), probe(n), fPlus(n), fMinus(n);
+        for (Equilibrium& e : result.equilibria) {
+            jacobianAt(kernel, workerSpec, analytic, e.y, jac, probe, fPlus, fMinus);
+            e.eigenvaluesOk = matrixEigenvalues(n, jac, e.eigenvalues);
+            e.kind = e.eigenvaluesOk ? classifyEquilibrium(e.eigenvalues, s.order, &e.unstableDirections)
+                                     : EquilibriumKind::NonHyperbolic;
+        }
+    });
+    std::stable_sort(result.equilibria.begin(), result.equilibria.end(),
+                     [](const Equilibrium& a, const Equilibrium& b) { return isStable(a.kind) && !isStable(b.kind); });
+
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    return true;
+}
+
+const char* equilibriumKindName(EquilibriumKind kind)
+{
+    switch (kind) {
+    case EquilibriumKind::StableNode:    return "stable-node";
+    case EquilibriumKind::StableFocus:   return "stable-focus";
+    case EquilibriumKind::UnstableNode:  return "unstable-node";
+    case EquilibriumKind::UnstableFocus: return "unstable-focus";
+    case EquilibriumKind::Saddle:        return "saddle";
+    case EquilibriumKind::NonHyperbolic: return "non-hyperbolic";
+    }
+    return "?";
+}
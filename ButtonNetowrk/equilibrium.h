@@ -0,0 +1,88 @@
+#ifndef EQUILIBRIUM_H
+#define EQUILIBRIUM_H
+
+#include <complex>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "networkspec.h"
+
+// Steady states f(y) = 0 of a network, found directly instead of by integrating to tMax:
+// damped Newton (backtracking on |f|^2) from many seeds, one LU solve of the Jacobian per
+// iteration. Drawn / GAMMA / large networks use the analytic Jacobian of the edges and
+// gates, custom equations central differences. Every distinct equilibrium gets the
+// eigenvalues of its Jacobian (balanced, Hessenberg form, shifted QR) and a stability
+// class; Newton also lands on the unstable ones a simulation never settles on.
+// Seeds are independent and merged in seed order, so the result does not depend on
+// the thread count.
+
+enum class EquilibriumKind { StableNode, StableFocus, UnstableNode, UnstableFocus, Saddle, NonHyperbolic };
+
+struct EquilibriumSettings {
+    int seeds = 64;                // Newton starts: the initial state, the origin, then random ones
+    double seedRange = 2.0;        // random seeds uniform in [-seedRange, seedRange] per node
+    std::uint64_t randomSeed = 1;
+    int maxIterations = 100;
+    double tolerance = 1e-10;      // max |f(y)| at an equilibrium
+    double mergeTolerance = 1e-6;  // max |y_a - y_b| / (1 + max |y|): the same equilibrium
+    double divergeLimit = 1e6;     // |y_i| above it: the seed is given up
+    // Stability sector: stable when every eigenvalue has |arg lambda| > order * pi / 2.
+    // 1 for the ODE (Re lambda < 0), nu for the fractional solver (Matignon's condition).
+    double order = 1.0;
+    int threads = 0;               // 0: all cores
+};
+
+struct Equilibrium {
+    std::vector<double> y;
+    std::vector<std::complex<double>> eigenvalues; // largest real part first
+    bool eigenvaluesOk = true;     // false: QR did not converge, kind is NonHyperbolic
+    EquilibriumKind kind = EquilibriumKind::NonHyperbolic;
+    int unstableDirections = 0;    // eigenvalues outside the stable sector
+    double residual = 0.0;         // max |f(y)|
+    int seeds = 0;                 // Newton starts that ended here
+    int firstSeed = 0;
+    int iterations = 0;            // Newton iterations from firstSeed
+};
+
+struct EquilibriumResult {
+    EquilibriumSettings settings;
+    int nodeCount = 0;
+    bool analyticJacobian = true;
+    std::vector<Equilibrium> equilibria; // stable ones first, then by first seed
+    int failedSeeds = 0;                 // singular Jacobian, iteration limit or diverged
+    long long newtonIterations = 0;
+    double wallSeconds = 0.0;
+};
+
+// Dense Jacobian (n x n, O(n^3) per Newton step) bounds the network size.
+constexpr int kEquilibriumMaxNodes = 2000;
+
+// Row-major J[i * n + j] = d f_i / d y_j for edges and gates, or from the native code's
+// bn_jacobian; false for custom equations run by the interpreter (no analytic form).
+bool networkJacobian(const NetworkSpec& spec, const double* y, double* jacobian);
+
+// networkJacobian when it applies, else central differences through the RHS kernel.
+void rhsJacobian(const NetworkSpec& spec, const double* y, double* jacobian);
+
+// Solves a x = b in place (LU with partial pivoting; a is destroyed, b becomes x).
+// False when a is singular to working precision.
+bool solveDenseSystem(int n, std::vector<double>& a, std::vector<double>& b);
+
+// Eigenvalues of the row-major n x n matrix a (destroyed), largest real part first.
+// False when the QR iteration does not converge.
+bool matrixEigenvalues(int n, std::vector<double>& a, std::vector<std::complex<double>>& eigenvalues);
+
+EquilibriumKind classifyEquilibrium(const std::vector<std::complex<double>>& eigenvalues, double order,
+                                    int* unstableDirections = nullptr);
+
+// Called on the calling thread with the number of finished seeds; false cancels.
+using EquilibriumProgressFn = std::function<bool(int seedsDone)>;
+
+// Returns false when cancelled. y0 is the first seed.
+bool findEquilibria(const NetworkSpec& spec, const std::vector<double>& y0, const EquilibriumSettings& settings,
+                    EquilibriumResult& result, const EquilibriumProgressFn& progress = EquilibriumProgressFn());
+
+const char* equilibriumKindName(EquilibriumKind kind);
+
+#endif // EQUILIBRIUM_H
@@ -0,0 +1,247 @@
+#include "eventdetector.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+#include "rhskernel.h"
+
+namespace {
+
+const double kRootTolerance = 1e-12; // in steps
+const int kRootIterations = 100;
+
+// Cubic Hermite interpolant on s in [0, 1] and its derivative.
+inline double hermite(double p0, double m0, double p1, double m1, double s)
+{
+    const double s2 = s * s, s3 = s2 * s;
+    return (2.0 * s3 - 3.0 * s2 + 1.0) * p0 + (s3 - 2.0 * s2 + s) * m0
+           + (3.0 * s2 - 2.0 * s3) * p1 + (s3 - s2) * m1;
+}
+
+inline double hermiteSlope(double p0, double m0, double p1, double m1, double s)
+{
+    const double s2 = s * s;
+    return (6.0 * s2 - 6.0 * s) * (p0 - p1) + (3.0 * s2 - 4.0 * s + 1.0) * m0 + (3.0 * s2 - 2.0 * s) * m1;
+}
+
+// Root of g in [0, 1] with g(0) = g0, g(1) = g1 of opposite signs (or g1 = 0):
+// regula falsi with the Illinois modification, bisection when the secant leaves the bracket.
+template <class G>
+double findRoot(const G& g, double g0, double g1)
+{
+    if (g1 == 0.0) return 1.0;
+    double a = 0.0, b = 1.0, fa = g0, fb = g1;
+    double c = 0.5;
+    int side = 0;
+    for (int it = 0; it < kRootIterations && b - a > kRootTolerance; ++it) {
+        c = (a * fb - b * fa) / (fb - fa);
+        if (!(c > a && c < b)) c = 0.5 * (a + b);
+        const double fc = g(c);
+        if (fc == 0.0) return c;
+        if ((fc > 0.0) == (fb > 0.0)) {
+            b = c;
+            fb = fc;
+            if (side == -1) fa *= 0.5;
+            side = -1;
+        } else {
+            a = c;
+            fa = fc;
+            if (side == 1) fb *= 0.5;
+            side = 1;
+        }
+    }
+    return c;
+}
+
+std::string trimmed(const std::string& s)
+{
+    std::size_t a = 0, b = s.size();
+    while (a < b && std::isspace((unsigned char)s[a])) ++a;
+    while (b > a && std::isspace((unsigned char)s[b - 1])) --b;
+    return s.substr(a, b - a);
+}
+
+// shortest text that reads back to the same double
+std::string numberText(double v)
+{
+    for (int digits = 6; digits <= 17; ++digits) {
+        std::ostringstream out;
+        out.precision(digits);
+        out << v;
+        if (std::strtod(out.str().c_str(), nullptr) == v) return out.str();
+    }
+    return std::to_string(v);
+}
+
+} // namespace
+
+// ================= Event list =================
+
+bool parseEventSpecs(const std::string& text, std::vector<EventSpec>& specs, std::string* error)
+{
+    auto fail = [&](const std::string& item, const char* why) {
+        if (error) *error = "event \"" + item + "\": " + why;
+        return false;
+    };
+
+    std::vector<EventSpec> parsed;
+    std::string list = text;
+    std::replace(list.begin(), list.end(), ';', ',');
+    std::istringstream items(list);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        item = trimmed(item);
+        if (item.empty()) continue;
+
+        std::istringstream words(item);
+        std::string node, kind, level, extra;
+        words >> node >> kind >> level >> extra;
+        if (!extra.empty()) return fail(item, "too many words");
+
+        EventSpec spec;
+        char* end = nullptr;
+        const long index = (node.size() > 1 && node[0] == 'y') ? std::strtol(node.c_str() + 1, &end, 10) : 0;
+        if (index < 1 || !end || *end != '\0') return fail(item, "expected y<node> first");
+        spec.node = int(index - 1);
+
+        if (kind == "max" || kind == "min") {
+            if (!level.empty()) return fail(item, "max / min take no level");
+            spec.kind = (kind == "max") ? EventKind::Maximum : EventKind::Minimum;
+        } else if (kind == "up" || kind == "down" || kind == "cross") {
+            spec.kind = EventKind::Crossing;
+            spec.direction = (kind == "up") ? CrossingDirection::Up
+                             : (kind == "down") ? CrossingDirection::Down : CrossingDirection::Both;
+            if (!level.empty()) {
+                spec.level = std::strtod(level.c_str(), &end);
+                if (*end != '\0' || !std::isfinite(spec.level)) return fail(item, "bad level");
+            }
+        } else {
+            return fail(item, "expected up, down, cross, max or min");
+        }
+        parsed.push_back(spec);
+    }
+    specs = parsed;
+    return true;
+}
+
+std::string eventSpecsText(const std::vector<EventSpec>& specs)
+{
+    std::string text;
+    for (const EventSpec& s : specs) {
+        if (!text.empty()) text += ", ";
+        text += "y" + std::to_string(s.node + 1);
+        if (s.kind == EventKind::Maximum) text += " max";
+        else if (s.kind == EventKind::Minimum) text += " min";
+        else {
+            text += (s.direction == CrossingDirection::Up) ? " up "
+                    : (s.direction == CrossingDirection::Down) ? " down " : " cross ";
+            text += numberText(s.level);
+        }
+    }
+    return text;
+}
+
+void EventLog::reset(int observedNodes)
+{
+    nodes = observedNodes;
+    spec.clear();
+    step.clear();
+    value.clear();
+    state.clear();
+}
+
+// ================= Detector =================
+
+EventDetector::EventDetector(const std::vector<EventSpec>& specs, int observedNodes)
+    : specs(specs), observed(std::max(0, observedNodes)), needed(observed)
+{
+    for (const EventSpec& s : specs) needed = std::max(needed, s.node + 1);
+}
+
+void EventDetector::step(int t, const double* y0, const double* m0, const double* y1, const double* m1,
+                         EventLog& log)
+{
+    hits.clear();
+    for (int e = 0; e < int(specs.size()); ++e) {
+        const EventSpec& s = specs[e];
+        const int i = s.node;
+        const double p0 = y0[i], d0 = m0[i], p1 = y1[i], d1 = m1[i];
+
+        double g0, g1;
+        if (s.kind == EventKind::Crossing) {
+            g0 = p0 - s.level;
+            g1 = p1 - s.level;
+            const bool up = g0 < 0.0 && g1 >= 0.0;
+            const bool down = g0 > 0.0 && g1 <= 0.0;
+            if (!(s.direction == CrossingDirection::Up ? up
+                  : s.direction == CrossingDirection::Down ? down : (up || down)))
+                continue;
+            const double level = s.level;
+            hits.emplace_back(findRoot([&](double x) { return hermite(p0, d0, p1, d1, x) - level; }, g0, g1), e);
+        } else {
+            g0 = d0;
+            g1 = d1;
+            const bool found = (s.kind == EventKind::Maximum) ? (g0 > 0.0 && g1 <= 0.0) : (g0 < 0.0 && g1 >= 0.0);
+            if (!found) continue;
+            hits.emplace_back(findRoot([&](double x) { return hermiteSlope(p0, d0, p1, d1, x); }, g0, g1), e);
+        }
+    }
+    if (hits.empty()) return;
+
+    std::sort(hits.begin(), hits.end());
+    for (const auto& hit : hits) {
+        const double s = hit.first;
+        const int i = specs[hit.second].node;
+        log.spec.push_back(hit.second);
+        log.step.push_back(t + s);
+        log.value.push_back(hermite(y0[i], m0[i], y1[i], m1[i], s));
+        for (int n = 0; n < log.nodes; ++n)
+            log.state.push_back(n < observed ? hermite(y0[n], m0[n], y1[n], m1[n], s) : 0.0);
+    }
+}
+
+// ================= Trajectory =================
+
+void detectEvents(const NetworkSpec& spec, const StateArena& y, double h, int fromRow,
+                  const std::vector<EventSpec>& specs, EventLog& log)
+{
+    const int steps = y.steps();
+    const int n = y.nodeCount();
+    fromRow = std::min(std::max(fromRow, 0), steps);
+    if (specs.empty() || fromRow >= steps) return;
+    for (const EventSpec& s : specs)
+        if (s.node >= n) return;
+
+    EventDetector detector(specs, std::min(log.nodes, n));
+    const int k = std::min(detector.nodesNeeded(), n);
+
+    // f of the last row: the rhs rows stop one short of the trajectory
+    std::vector<double> last;
+    if (h > 0.0) {
+        last.resize(n);
+        NetworkSpec single = spec;
+        single.threads = 1;
+        visitRhsKernel(single, [&](const auto& kernel) { kernel.eval(y.state(steps), last.data()); });
+    }
+
+    auto slopes = [&](int t, double* m) {
+        if (h > 0.0) {
+            const double* f = (t < steps) ? y.rhs(t) : last.data();
+            for (int i = 0; i < k; ++i) m[i] = h * f[i];
+            return;
+        }
+        const int a = std::max(t - 1, 0), b = std::min(t + 1, steps);
+        for (int i = 0; i < k; ++i) m[i] = (y.at(b, i) - y.at(a, i)) / double(b - a);
+    };
+
+    std::vector<double> m0(std::max(k, 1)), m1(std::max(k, 1));
+    slopes(fromRow, m0.data());
+    for (int t = fromRow; t < steps; ++t) {
+        slopes(t + 1, m1.data());
+        detector.step(t, y.state(t), m0.data(), y.state(t + 1), m1.data(), log);
+        std::swap(m0, m1);
+    }
+}
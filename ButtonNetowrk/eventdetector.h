@@ -0,0 +1,74 @@
+#ifndef EVENTDETECTOR_H
+#define EVENTDETECTOR_H
+
+#include <string>
+#include <vector>
+
+#include "networkspec.h"
+#include "statearena.h"
+
+// Events along a trajectory instead of every k-th sample: crossings of a level by one
+// node (a Poincare section such as y3 = 0 upwards) and local maxima / minima of a node.
+// Between rows t and t+1 every observed node follows the cubic Hermite interpolant of
+// its values and slopes at both rows (the dense output of the step); a crossing is the
+// root of that cubic minus the level, an extremum the root of its derivative where the
+// slope changes sign. Roots are polished to ~1e-12 of a step, so event times and states
+// do not alias with the sampling stride, and the event states lie on the trajectory
+// between the stored rows. Each event fires at most once per step (the sign test uses the
+// two rows), which is fine as long as steps are short against the oscillation period.
+
+enum class EventKind { Crossing, Maximum, Minimum };
+enum class CrossingDirection { Up, Down, Both };
+
+struct EventSpec {
+    EventKind kind = EventKind::Crossing;
+    int node = 0;                  // 0-based
+    double level = 0.0;            // Crossing only
+    CrossingDirection direction = CrossingDirection::Up;
+};
+
+// Comma or ';' separated list, 1-based nodes: "y3 up 0", "y3 down 0.5", "y3 cross 0",
+// "y2 max", "y5 min".
+bool parseEventSpecs(const std::string& text, std::vector<EventSpec>& specs, std::string* error = nullptr);
+// The canonical list ("y3 up 0, y2 max"), parsed back to the same specs.
+std::string eventSpecsText(const std::vector<EventSpec>& specs);
+
+struct EventLog {
+    int nodes = 0;                 // state values per event (nodes 1..nodes)
+    std::vector<int> spec;         // index into the spec list
+    std::vector<double> step;      // time in steps (rows), between two rows
+    std::vector<double> value;     // the event's node there (the extremum, or the level)
+    std::vector<double> state;     // event e, node i at [e * nodes + i]
+
+    void reset(int observedNodes);
+    std::size_t size() const { return step.size(); }
+};
+
+// Streaming detector: feed it the steps in order, it appends their events in time order.
+class EventDetector
+{
+public:
+    EventDetector(const std::vector<EventSpec>& specs, int observedNodes);
+
+    // Nodes the caller must give values and slopes for: the observed ones and every
+    // node an event refers to.
+    int nodesNeeded() const { return needed; }
+
+    // The step from row t to t + 1; slopes per step (dy/dt times the step).
+    void step(int t, const double* y0, const double* m0, const double* y1, const double* m1, EventLog& log);
+
+private:
+    std::vector<EventSpec> specs;
+    int observed = 0;
+    int needed = 0;
+    std::vector<std::pair<double, int>> hits; // (s in the step, spec) of the current step
+};
+
+// Events over rows fromRow..y.steps() of one trajectory, appended to log. h > 0: an Euler
+// trajectory, slopes h f(y_t) from the stored rhs rows (f of the last row is evaluated);
+// h <= 0: GAMMA trajectories, whose f is not dy/dt, slopes from central differences of the
+// rows. log.nodes must be set (reset) by the caller; event nodes must be below y.nodeCount().
+void detectEvents(const NetworkSpec& spec, const StateArena& y, double h, int fromRow,
+                  const std::vector<EventSpec>& specs, EventLog& log);
+
+#endif // EVENTDETECTOR_H
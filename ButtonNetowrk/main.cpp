@@ -11,6 +11,7 @@
 #include <QSpinBox>
 #include <QComboBox>
 #include <QDoubleSpinBox>
+#include <QCheckBox>
 
 int main(int argc, char *argv[])
 {
@@ -41,6 +42,12 @@ int main(int argc, char *argv[])
     auto *solverCombo = new QComboBox();
     solverCombo->addItem("ODE");
     solverCombo->addItem("GAMMA");
+    solverCombo->addItem("GAMMA-ABM");
+    solverCombo->addItem("GAMMA-GRADED");
+
+    auto *kernelCombo = new QComboBox(); // GAMMA 가중치: pow-difference / gamma-ratio (solver.c)
+    kernelCombo->addItem("pow");
+    kernelCombo->addItem("gamma");
 
     auto *stepsSpin = new QSpinBox();
     stepsSpin->setRange(10, 50000);
@@ -53,15 +60,36 @@ int main(int argc, char *argv[])
     auto *transientSpin = new QSpinBox(); transientSpin->setRange(0, 99); transientSpin->setValue(70);
     auto *strideSpin    = new QSpinBox(); strideSpin->setRange(1, 10000); strideSpin->setValue(20);
 
+    auto *nativeCheck = new QCheckBox("Native code (host compiler)");
+
     auto *btnCompute = new QPushButton("Compute");
+    auto *btnExtend  = new QPushButton("Extend Run (to tMax)");
+    auto *btnCancel  = new QPushButton("Cancel (save checkpoint)");
+    auto *btnResume  = new QPushButton("Resume from Checkpoint");
     auto *btnGraph   = new QPushButton("Graph (y_all.png)");
     auto *btnTable   = new QPushButton("Show Table");
     auto *btnScanA2  = new QPushButton("Alpha2 Scan (PNG)");
     auto *btnAuto    = new QPushButton("AUTO Test Preset");
     auto *btnClear   = new QPushButton("Clear Network");
+    auto *btnLoad    = new QPushButton("Load Network...");
+    auto *btnEqs     = new QPushButton("Equations...");
+    auto *btnLarge   = new QPushButton("Large Network...");
+    auto *btnPara    = new QPushButton("Parareal...");
+    auto *btnOrders  = new QPushButton("Node Orders...");
+    auto *btnEvents  = new QPushButton("Events...");
+    auto *btnBasin   = new QPushButton("Basin Map...");
+    auto *btnPlane   = new QPushButton("Plane Scan...");
+    auto *btnEquil   = new QPushButton("Equilibria...");
+    auto *btnCont    = new QPushButton("Continuation...");
+    auto *btnSens    = new QPushButton("Sensitivities...");
+    auto *btnFit     = new QPushButton("Fit Parameters...");
+    auto *btnSde     = new QPushButton("Noisy Ensemble...");
+    auto *btnMc      = new QPushButton("Weight Uncertainty...");
 
     boxL->addWidget(new QLabel("Solver"));
     boxL->addWidget(solverCombo);
+    boxL->addWidget(new QLabel("GAMMA kernel"));
+    boxL->addWidget(kernelCombo);
 
     boxL->addWidget(new QLabel("tMax (steps)"));
     boxL->addWidget(stepsSpin);
@@ -76,12 +104,30 @@ int main(int argc, char *argv[])
     boxL->addWidget(strideSpin);
 
     boxL->addSpacing(8);
+    boxL->addWidget(nativeCheck);
     boxL->addWidget(btnCompute);
+    boxL->addWidget(btnExtend);
+    boxL->addWidget(btnCancel);
+    boxL->addWidget(btnResume);
     boxL->addWidget(btnGraph);
     boxL->addWidget(btnTable);
     boxL->addWidget(btnScanA2);
     boxL->addWidget(btnAuto);
     boxL->addWidget(btnClear);
+    boxL->addWidget(btnLoad);
+    boxL->addWidget(btnEqs);
+    boxL->addWidget(btnLarge);
+    boxL->addWidget(btnPara);
+    boxL->addWidget(btnOrders);
+    boxL->addWidget(btnEvents);
+    boxL->addWidget(btnBasin);
+    boxL->addWidget(btnPlane);
+    boxL->addWidget(btnEquil);
+    boxL->addWidget(btnCont);
+    boxL->addWidget(btnSens);
+    boxL->addWidget(btnFit);
+    boxL->addWidget(btnSde);
+    boxL->addWidget(btnMc);
 
     right->addWidget(box);
     right->addWidget(log, 1);
@@ -92,6 +138,8 @@ int main(int argc, char *argv[])
     // Wiring
     QObject::connect(solverCombo, &QComboBox::currentTextChanged,
                      net, &ButtonNetwork::setSolverMode);
+    QObject::connect(kernelCombo, &QComboBox::currentTextChanged,
+                     net, &ButtonNetwork::setFractionalKernel);
     QObject::connect(stepsSpin, QOverload<int>::of(&QSpinBox::valueChanged),
                      net, &ButtonNetwork::setTimeLimit);
 
@@ -108,12 +156,37 @@ int main(int argc, char *argv[])
 
     applyScanSettings();
 
+    QObject::connect(nativeCheck, &QCheckBox::toggled, net, &ButtonNetwork::setNativeCode);
     QObject::connect(btnCompute, &QPushButton::clicked, net, &ButtonNetwork::computeResults);
+    QObject::connect(btnExtend,  &QPushButton::clicked, net, &ButtonNetwork::extendCurrentRun);
+    QObject::connect(btnCancel,  &QPushButton::clicked, net, &ButtonNetwork::cancelComputation);
+    QObject::connect(btnResume,  &QPushButton::clicked, net, &ButtonNetwork::resumeFromCheckpoint);
     QObject::connect(btnGraph,   &QPushButton::clicked, net, &ButtonNetwork::showGraph);
     QObject::connect(btnTable,   &QPushButton::clicked, net, &ButtonNetwork::showTable);
     QObject::connect(btnScanA2,  &QPushButton::clicked, net, &ButtonNetwork::scanAlpha2);
     QObject::connect(btnAuto,    &QPushButton::clicked, net, &ButtonNetwork::runAutoTestNode5Preset);
     QObject::connect(btnClear,   &QPushButton::clicked, net, &ButtonNetwork::clearNetwork);
+    QObject::connect(btnLoad,    &QPushButton::clicked, net, &ButtonNetwork::loadNetwork);
+    QObject::connect(btnEqs,     &QPushButton::clicked, net, &ButtonNetwork::editEquations);
+    QObject::connect(btnLarge,   &QPushButton::clicked, net, &ButtonNetwork::editLargeNetwork);
+    QObject::connect(btnPara,    &QPushButton::clicked, net, &ButtonNetwork::editParareal);
+    QObject::connect(btnOrders,  &QPushButton::clicked, net, &ButtonNetwork::editNodeOrders);
+    QObject::connect(btnEvents,  &QPushButton::clicked, net, &ButtonNetwork::editEvents);
+    QObject::connect(btnBasin,   &QPushButton::clicked, net, &ButtonNetwork::mapBasins);
+    QObject::connect(btnPlane,   &QPushButton::clicked, net, &ButtonNetwork::scanPlane);
+    QObject::connect(btnEquil,   &QPushButton::clicked, net, &ButtonNetwork::findEquilibria);
+    QObject::connect(btnCont,    &QPushButton::clicked, net, &ButtonNetwork::continueBranches);
+    QObject::connect(btnSens,    &QPushButton::clicked, net, &ButtonNetwork::computeSensitivities);
+    QObject::connect(btnFit,     &QPushButton::clicked, net, &ButtonNetwork::fitParameters);
+    QObject::connect(btnSde,     &QPushButton::clicked, net, &ButtonNetwork::runEnsemble);
+    QObject::connect(btnMc,      &QPushButton::clicked, net, &ButtonNetwork::propagateUncertainty);
+
+    // keep the controls in sync with a loaded network
+    QObject::connect(net, &ButtonNetwork::networkLoaded, [&](const QString& mode, int tMax, const QString& kernel){
+        solverCombo->setCurrentText(mode);
+        kernelCombo->setCurrentText(kernel);
+        stepsSpin->setValue(tMax);
+    });
 
     QObject::connect(net, &ButtonNetwork::fileSaved, [&](const QString& p){
         log->append("[saved] " + p);
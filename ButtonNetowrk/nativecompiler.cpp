@@ -0,0 +1,151 @@
+#include "nativecompiler.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLibrary>
+#include <QProcess>
+#include <QStringList>
+
+namespace {
+
+const int kCompileTimeoutMs = 120000;
+
+} // namespace
+
+NativeCodeCache::NativeCodeCache(const QString& dir)
+    : dir(dir)
+{
+    compiler = qEnvironmentVariable("BUTTONNETWORK_CXX");
+    if (compiler.isEmpty()) compiler = qEnvironmentVariable("CXX");
+    if (compiler.isEmpty()) compiler = "c++";
+}
+
+//-ffp-contract=off: FMA 로 합쳐지면 interpreter 와 결과가 달라지므로 금지
+QStringList NativeCodeCache::compilerFlags() const
+{
+    return QStringList() << "-O2" << "-fPIC" << "-shared" << "-ffp-contract=off" << "-fno-fast-math" << "-w";
+}
+
+std::shared_ptr<const NativeRhs> NativeCodeCache::load(const EquationProgram& program, QString* message)
+{
+    if (message) message->clear();
+
+    const QByteArray source = QByteArray::fromStdString(emitNativeSource(program));
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData((compiler + "\n" + compilerFlags().join(" ") + "\n").toUtf8());
+    hash.addData(source);
+    const QString key = QString::fromLatin1(hash.result().toHex());
+
+    QMutexLocker lock(&mutex);
+    if (failed.contains(key)) return nullptr;
+
+    if (!loaded.contains(key)) {
+        Loaded lib;
+        QString error;
+        bool compiled = false;
+        if (!open(key, program, lib, nullptr)) {
+            if (!build(key, source, &error) || !open(key, program, lib, &error)) {
+                failed.insert(key, error);
+                if (message) *message = "native code unavailable: " + error;
+                return nullptr;
+            }
+            compiled = true;
+        }
+        loaded.insert(key, lib);
+        if (message && compiled)
+            *message = QString("compiled %1 (%2 operations)").arg(key.left(12)).arg(program.operationCount());
+    }
+
+    const Loaded& lib = loaded[key];
+    auto native = std::make_shared<NativeRhs>();
+    native->nodeCount = program.nodeCount;
+    native->key = key.toStdString();
+    native->rhs = lib.rhs;
+    native->jacobian = lib.jacobian;
+    native->constants = program.constants;
+    native->library = lib.library;
+    return native;
+}
+
+//<key>.cpp 작성 후 임시 이름으로 compile, 끝나면 rename (다른 process 가 같은 key 를 쓰고 있어도 안전)
+bool NativeCodeCache::build(const QString& key, const QByteArray& source, QString* error) const
+{
+#ifdef Q_OS_WIN
+    Q_UNUSED(key);
+    Q_UNUSED(source);
+    if (error) *error = "native code needs a Unix host compiler";
+    return false;
+#else
+    if (!QDir().mkpath(dir)) {
+        if (error) *error = "cannot create " + dir;
+        return false;
+    }
+
+    const QString src = dir + "/" + key + ".cpp";
+    const QString tmp = dir + "/" + key + ".so.tmp" + QString::number(QCoreApplication::applicationPid());
+    const QString object = dir + "/" + key + ".so";
+
+    QFile f(src);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = "cannot write " + src;
+        return false;
+    }
+    f.write(source);
+    f.close();
+
+    QProcess proc;
+    proc.setProcessChannelMode(QProcess::MergedChannels);
+    proc.start(compiler, compilerFlags() << "-o" << tmp << src);
+    if (!proc.waitForStarted()) {
+        if (error) *error = "cannot start " + compiler;
+        return false;
+    }
+    const bool finished = proc.waitForFinished(kCompileTimeoutMs);
+    if (!finished || proc.exitStatus() != QProcess::NormalExit || proc.exitCode() != 0) {
+        if (!finished) proc.kill();
+        const QString log = QString::fromLocal8Bit(proc.readAllStandardOutput()).trimmed();
+        if (error) *error = compiler + " failed" + (log.isEmpty() ? QString() : ": " + log.left(400));
+        QFile::remove(tmp);
+        return false;
+    }
+
+    if (!QFile::rename(tmp, object)) QFile::remove(tmp); // another process won the race
+    return QFileInfo::exists(object);
+#endif
+}
+
+bool NativeCodeCache::open(const QString& key, const EquationProgram& program, Loaded& out,
+                           QString* error) const
+{
+    const QString object = dir + "/" + key + ".so";
+    if (!QFileInfo::exists(object)) {
+        if (error) *error = "no " + object;
+        return false;
+    }
+
+    auto library = std::make_shared<QLibrary>(object);
+    if (!library->load()) {
+        if (error) *error = library->errorString();
+        return false;
+    }
+
+    using IntFn = int (*)();
+    const auto abi = reinterpret_cast<IntFn>(library->resolve("bn_abi"));
+    const auto nodes = reinterpret_cast<IntFn>(library->resolve("bn_nodes"));
+    const auto constants = reinterpret_cast<IntFn>(library->resolve("bn_constants"));
+    out.rhs = reinterpret_cast<NativeRhsFn>(library->resolve("bn_rhs"));
+    out.jacobian = reinterpret_cast<NativeJacobianFn>(library->resolve("bn_jacobian"));
+
+    if (!abi || !nodes || !constants || !out.rhs || !out.jacobian || abi() != kNativeAbiVersion
+        || nodes() != program.nodeCount || constants() != int(program.constants.size())) {
+        library->unload();
+        if (error) *error = object + " does not match the network";
+        return false;
+    }
+
+    out.library = library;
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef NATIVECOMPILER_H
+#define NATIVECOMPILER_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+#include "nativekernel.h"
+
+// Builds and loads native right-hand sides (nativekernel.h) with the host compiler.
+// Shared objects live in <dir>/<key>.so, key = SHA-256 of the generated source and
+// the compiler command; the source only depends on the program structure, so a
+// weight/alpha change or an alpha2 scan point reuses the same object. Loaded
+// objects stay loaded for the lifetime of the cache (and of any kernel using them).
+// Any failure (no compiler, compile error, bad symbols) returns nullptr and the
+// caller keeps the interpreter. load() may be called from several threads; a
+// structure being compiled blocks the other callers until it is loaded.
+class NativeCodeCache
+{
+public:
+    explicit NativeCodeCache(const QString& dir);
+
+    const QString& directory() const { return dir; }
+
+    // $BUTTONNETWORK_CXX, else $CXX, else "c++"
+    QString compiler;
+
+    // message is set when something worth logging happened: an object was
+    // compiled, or this structure failed for the first time (later calls fail quietly).
+    std::shared_ptr<const NativeRhs> load(const EquationProgram& program, QString* message = nullptr);
+
+private:
+    struct Loaded {
+        NativeRhsFn rhs = nullptr;
+        NativeJacobianFn jacobian = nullptr;
+        std::shared_ptr<void> library;
+    };
+
+    bool build(const QString& key, const QByteArray& source, QString* error) const;
+    bool open(const QString& key, const EquationProgram& program, Loaded& out, QString* error) const;
+    QStringList compilerFlags() const;
+
+    QString dir;
+    QMutex mutex; // guards loaded / failed
+    QMap<QString, Loaded> loaded;
+    QMap<QString, QString> failed;
+};
+
+#endif // NATIVECOMPILER_H
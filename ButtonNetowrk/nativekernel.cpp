@@ -0,0 +1,188 @@
+#include "nativekernel.h"
+
+#include <map>
+
+namespace {
+
+std::string num(int v) { return std::to_string(v); }
+
+// Value and sparse gradient (by state index) of one register while emitting.
+struct Slot {
+    std::string value;
+    std::map<int, std::string> grad;
+};
+
+// Scalar derivative of a unary op at argument a with result v.
+std::string unaryDerivative(EquationOp op, const std::string& a, const std::string& v)
+{
+    switch (op) {
+    case EquationOp::Neg:  return "-1.0";
+    case EquationOp::Sin:  return "std::cos(" + a + ")";
+    case EquationOp::Cos:  return "-std::sin(" + a + ")";
+    case EquationOp::Tanh: return "(1.0 - " + v + " * " + v + ")";
+    case EquationOp::Exp:  return v;
+    case EquationOp::Log:  return "(1.0 / " + a + ")";
+    case EquationOp::Sqrt: return "(0.5 / " + v + ")";
+    case EquationOp::Abs:  return "((" + a + " > 0.0) ? 1.0 : ((" + a + " < 0.0) ? -1.0 : 0.0))";
+    case EquationOp::Relu: return "((" + a + " > 0.0) ? 1.0 : 0.0)";
+    default: break;
+    }
+    return "0.0";
+}
+
+std::string unaryValue(EquationOp op, const std::string& a)
+{
+    switch (op) {
+    case EquationOp::Neg:  return "-" + a;
+    case EquationOp::Sin:  return "std::sin(" + a + ")";
+    case EquationOp::Cos:  return "std::cos(" + a + ")";
+    case EquationOp::Tanh: return "std::tanh(" + a + ")";
+    case EquationOp::Exp:  return "std::exp(" + a + ")";
+    case EquationOp::Log:  return "std::log(" + a + ")";
+    case EquationOp::Sqrt: return "std::sqrt(" + a + ")";
+    case EquationOp::Abs:  return "std::fabs(" + a + ")";
+    case EquationOp::Relu: return "((" + a + " > 0.0) ? " + a + " : 0.0)";
+    default: break;
+    }
+    return "0.0";
+}
+
+std::string binaryValue(EquationOp op, const std::string& a, const std::string& b)
+{
+    switch (op) {
+    case EquationOp::Add: return a + " + " + b;
+    case EquationOp::Sub: return a + " - " + b;
+    case EquationOp::Mul: return a + " * " + b;
+    case EquationOp::Div: return a + " / " + b;
+    case EquationOp::Pow: return "std::pow(" + a + ", " + b + ")";
+    default: break;
+    }
+    return "0.0";
+}
+
+// Emits the body of bn_rhs (withJacobian = false) or bn_jacobian (forward mode:
+// every register carries its nonzero partials d/dy_j as locals).
+std::string emitBody(const EquationProgram& p, bool withJacobian)
+{
+    const int n = p.nodeCount;
+    std::vector<Slot> regs(p.registerCount);
+    for (std::size_t k = 0; k < p.constants.size(); ++k) regs[k].value = "c[" + num(int(k)) + "]";
+    for (int j = 0; j < n; ++j) {
+        regs[p.stateBase + j].value = "y[" + num(j) + "]";
+        regs[p.stateBase + j].grad[j] = "1.0";
+    }
+
+    std::string out;
+    if (withJacobian) out += "    for (int k = 0; k < " + num(n * n) + "; ++k) jac[k] = 0.0;\n";
+
+    int id = 0;
+    for (const EquationInstr& in : p.code) {
+        if (in.op == EquationOp::Store) {
+            const Slot& s = regs[in.a];
+            if (!withJacobian) {
+                out += "    dy[" + num(int(in.dst)) + "] = " + s.value + ";\n";
+            } else {
+                for (const auto& g : s.grad)
+                    out += "    jac[" + num(int(in.dst) * n + g.first) + "] = " + g.second + ";\n";
+            }
+            continue;
+        }
+
+        // copies: the interpreter may reuse a source register as destination
+        const Slot a = regs[in.a];
+        const Slot b = regs[in.b];
+        const std::string v = "v" + num(id);
+        Slot result;
+        result.value = v;
+
+        const bool binary = in.op == EquationOp::Add || in.op == EquationOp::Sub || in.op == EquationOp::Mul
+                         || in.op == EquationOp::Div || in.op == EquationOp::Pow;
+        out += "    const double " + v + " = "
+             + (binary ? binaryValue(in.op, a.value, b.value) : unaryValue(in.op, a.value)) + ";\n";
+
+        if (withJacobian) {
+            std::map<int, std::string> grad;
+            auto partial = [&](int j, const std::string& expr) {
+                const std::string d = "d" + num(id) + "_" + num(j);
+                out += "    const double " + d + " = " + expr + ";\n";
+                grad[j] = d;
+            };
+
+            if (!binary) {
+                if (!a.grad.empty()) {
+                    const std::string f = "f" + num(id);
+                    out += "    const double " + f + " = " + unaryDerivative(in.op, a.value, v) + ";\n";
+                    for (const auto& g : a.grad) partial(g.first, f + " * " + g.second);
+                }
+            } else {
+                std::map<int, std::pair<std::string, std::string>> both;
+                for (const auto& g : a.grad) both[g.first].first = g.second;
+                for (const auto& g : b.grad) both[g.first].second = g.second;
+                for (const auto& e : both) {
+                    const std::string& da = e.second.first;
+                    const std::string& db = e.second.second;
+                    std::string expr;
+                    switch (in.op) {
+                    case EquationOp::Add:
+                        expr = da.empty() ? db : db.empty() ? da : da + " + " + db;
+                        break;
+                    case EquationOp::Sub:
+                        expr = da.empty() ? "-" + db : db.empty() ? da : da + " - " + db;
+                        break;
+                    case EquationOp::Mul:
+                        if (da.empty()) expr = a.value + " * " + db;
+                        else if (db.empty()) expr = da + " * " + b.value;
+                        else expr = da + " * " + b.value + " + " + a.value + " * " + db;
+                        break;
+                    case EquationOp::Div:
+                        if (db.empty()) expr = da + " / " + b.value;
+                        else expr = "(" + (da.empty() ? std::string("0.0") : da) + " - " + v + " * " + db + ") / " + b.value;
+                        break;
+                    case EquationOp::Pow:
+                        if (db.empty())
+                            expr = b.value + " * std::pow(" + a.value + ", " + b.value + " - 1.0) * " + da;
+                        else
+                            expr = v + " * (" + db + " * std::log(" + a.value + ")"
+                                 + (da.empty() ? std::string() : " + " + b.value + " * " + da + " / " + a.value) + ")";
+                        break;
+                    default:
+                        break;
+                    }
+                    partial(e.first, expr);
+                }
+            }
+            result.grad = grad;
+        }
+
+        regs[in.dst] = result;
+        ++id;
+    }
+    return out;
+}
+
+} // namespace
+
+std::string emitNativeSource(const EquationProgram& program)
+{
+    std::string src;
+    src += "// generated by ButtonNetwork (nativekernel.cpp), do not edit\n";
+    src += "// " + std::to_string(program.operationCount()) + " operations\n";
+    src += "#include <cmath>\n\n";
+    src += "extern \"C\" {\n\n";
+    src += "int bn_abi() { return " + num(kNativeAbiVersion) + "; }\n";
+    src += "int bn_nodes() { return " + num(program.nodeCount) + "; }\n";
+    src += "int bn_constants() { return " + num(int(program.constants.size())) + "; }\n\n";
+
+    src += "void bn_rhs(const double* y, double* dy, const double* c)\n{\n";
+    src += "    (void)y; (void)c;\n";
+    src += emitBody(program, false);
+    src += "}\n\n";
+
+    src += "void bn_jacobian(const double* y, double* jac, const double* c)\n{\n";
+    src += "    (void)y; (void)c;\n";
+    src += emitBody(program, true);
+    src += "}\n\n";
+
+    src += "} // extern \"C\"\n";
+    return src;
+}
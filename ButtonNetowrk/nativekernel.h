@@ -0,0 +1,56 @@
+#ifndef NATIVEKERNEL_H
+#define NATIVEKERNEL_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "equationdsl.h"
+
+// Native right-hand side: a compiled EquationProgram emitted as straight-line C++
+// (one local per instruction, constants read from a runtime array), built into a
+// shared object by nativecompiler.h. The emitted code keeps the program's operation
+// order and is compiled without FP contraction, so results match the bytecode
+// interpreter bit for bit; only the interpretation overhead goes away.
+//
+// Exported symbols (extern "C"):
+//   int  bn_abi();                                   kNativeAbiVersion
+//   int  bn_nodes();
+//   int  bn_constants();
+//   void bn_rhs(const double* y, double* dy, const double* c);
+//   void bn_jacobian(const double* y, double* jac, const double* c);  row-major n x n
+
+constexpr int kNativeAbiVersion = 1;
+
+using NativeRhsFn = void (*)(const double* y, double* dy, const double* c);
+using NativeJacobianFn = void (*)(const double* y, double* jac, const double* c);
+
+struct NativeRhs {
+    int nodeCount = 0;
+    std::string key;                 // structure hash, names the shared object
+    NativeRhsFn rhs = nullptr;
+    NativeJacobianFn jacobian = nullptr;
+    std::vector<double> constants;   // this program's weights/alphas, passed as c
+    std::shared_ptr<void> library;   // keeps the shared object loaded
+};
+
+// Source for bn_* above. Depends only on program.structure(), never on constant values.
+std::string emitNativeSource(const EquationProgram& program);
+
+class NativeRhsKernel
+{
+public:
+    explicit NativeRhsKernel(std::shared_ptr<const NativeRhs> native) : nat(std::move(native)) {}
+
+    int nodeCount() const { return nat->nodeCount; }
+    std::string name() const { return "native(" + nat->key.substr(0, 12) + ")"; }
+    void eval(const double* y, double* dy) const { nat->rhs(y, dy, nat->constants.data()); }
+
+    // d(dy_i)/d(y_j) at y, row-major nodeCount x nodeCount
+    void jacobian(const double* y, double* jac) const { nat->jacobian(y, jac, nat->constants.data()); }
+
+private:
+    std::shared_ptr<const NativeRhs> nat;
+};
+
+#endif // NATIVEKERNEL_H
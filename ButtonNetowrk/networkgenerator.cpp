@@ -0,0 +1,180 @@
+#include "networkgenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <locale>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// mt19937_64 output is fixed by the standard, the distributions are not
+class GraphRng
+{
+public:
+    explicit GraphRng(std::uint64_t seed) : engine(seed) {}
+
+    double uniform() { return double(engine() >> 11) * (1.0 / 9007199254740992.0); } // [0, 1)
+    double symmetric() { return 2.0 * uniform() - 1.0; }                               // [-1, 1)
+    int below(int n) { return std::min(int(uniform() * n), n - 1); }
+
+private:
+    std::mt19937_64 engine;
+};
+
+// weights of one target row, drawn after its sources so the row is self-contained
+void addRow(NetworkSpec& spec, int target, const std::vector<int>& sources,
+            const SparseGraphSettings& s, GraphRng& rng)
+{
+    const double scale = sources.empty() ? 0.0 : s.weightScale / std::sqrt(double(sources.size()));
+    for (int from : sources) spec.edges.push_back({from, target, rng.symmetric() * scale, s.fn});
+}
+
+bool activationFromName(const std::string& name, ActivationKind& fn)
+{
+    if (name == "sin" || name == "sin_exp") fn = ActivationKind::Sin;
+    else if (name == "tanh") fn = ActivationKind::Tanh;
+    else if (name == "relu") fn = ActivationKind::Relu;
+    else return false;
+    return true;
+}
+
+} // namespace
+
+NetworkSpec generateSparseNetwork(const SparseGraphSettings& settings)
+{
+    SparseGraphSettings s = settings;
+    s.nodes = std::max(s.nodes, 5);
+
+    NetworkSpec spec;
+    GraphRng rng(s.seed);
+    std::vector<int> sources;
+
+    if (s.kind == SparseGraphKind::Lattice) {
+        const int side = std::max(3, int(std::ceil(std::sqrt(double(s.nodes)))));
+        spec.nodeCount = side * side;
+        spec.edges.reserve(std::size_t(spec.nodeCount) * 4);
+        for (int r = 0; r < side; ++r) {
+            for (int c = 0; c < side; ++c) {
+                sources = {r * side + (c + side - 1) % side, r * side + (c + 1) % side,
+                           ((r + side - 1) % side) * side + c, ((r + 1) % side) * side + c};
+                addRow(spec, r * side + c, sources, s, rng);
+            }
+        }
+        return spec;
+    }
+
+    const int n = s.nodes;
+    spec.nodeCount = n;
+    const int degree = std::min(std::max(s.degree, 1), n - 1);
+    spec.edges.reserve(std::size_t(n) * degree);
+
+    // marked[j] == i: j is already a source of row i (or j == i)
+    std::vector<int> marked(n, -1);
+    auto randomSource = [&](int i) {
+        int j;
+        do { j = rng.below(n); } while (marked[j] == i);
+        marked[j] = i;
+        return j;
+    };
+
+    for (int i = 0; i < n; ++i) {
+        marked[i] = i;
+        sources.clear();
+        if (s.kind == SparseGraphKind::Random) {
+            for (int k = 0; k < degree; ++k) sources.push_back(randomSource(i));
+        } else {
+            // ring neighbours i-1, i+1, i-2, i+2, ...; the rewired ones are drawn afterwards so
+            // they cannot collide with a ring neighbour that is still kept
+            const int half = std::max(std::min(degree / 2, (n - 1) / 2), 1);
+            std::vector<bool> rewired;
+            for (int d = 1; d <= half; ++d) {
+                for (int side = -1; side <= 1; side += 2) {
+                    const int j = ((i + side * d) % n + n) % n;
+                    const bool move = rng.uniform() < s.rewire;
+                    rewired.push_back(move);
+                    sources.push_back(j);
+                    if (!move) marked[j] = i;
+                }
+            }
+            for (std::size_t k = 0; k < sources.size(); ++k)
+                if (rewired[k]) sources[k] = randomSource(i);
+        }
+        addRow(spec, i, sources, s, rng);
+    }
+    return spec;
+}
+
+bool parseEdgeList(const std::string& text, ActivationKind defaultFn, NetworkSpec& spec,
+                   std::string* error)
+{
+    spec = NetworkSpec();
+    int maxNode = 5;
+
+    std::istringstream in(text);
+    std::string line;
+    int lineNo = 0;
+    auto fail = [&](const std::string& why) {
+        if (error) *error = "line " + std::to_string(lineNo) + ": " + why;
+        return false;
+    };
+
+    while (std::getline(in, line)) {
+        ++lineNo;
+        const std::size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream fields(line);
+        fields.imbue(std::locale::classic());
+        long long from = 0, to = 0;
+        if (!(fields >> from)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            return fail("expected \"from to [weight [fn]]\"");
+        }
+        if (!(fields >> to)) return fail("missing target node");
+        if (from < 1 || to < 1 || from > 100000000 || to > 100000000) return fail("node numbers start at 1");
+
+        EdgeSpec e;
+        e.from = int(from - 1);
+        e.to = int(to - 1);
+        e.weight = 1.0;
+        e.fn = defaultFn;
+
+        std::string word;
+        if (fields >> word) {
+            std::istringstream number(word);
+            number.imbue(std::locale::classic());
+            char rest;
+            if (!(number >> e.weight) || (number >> rest)) return fail("bad weight \"" + word + "\"");
+            if (fields >> word && !activationFromName(word, e.fn)) return fail("unknown function \"" + word + "\"");
+            if (fields >> word) return fail("unexpected \"" + word + "\"");
+        }
+
+        maxNode = std::max(maxNode, int(std::max(from, to)));
+        spec.edges.push_back(e);
+    }
+
+    spec.nodeCount = maxNode;
+    if (error) error->clear();
+    return true;
+}
+
+const char* sparseGraphKindName(SparseGraphKind kind)
+{
+    switch (kind) {
+    case SparseGraphKind::Random:     return "random";
+    case SparseGraphKind::SmallWorld: return "smallworld";
+    case SparseGraphKind::Lattice:    return "lattice";
+    }
+    return "random";
+}
+
+bool sparseGraphKindFromName(const std::string& name, SparseGraphKind& kind)
+{
+    if (name == "random") kind = SparseGraphKind::Random;
+    else if (name == "smallworld" || name == "small-world") kind = SparseGraphKind::SmallWorld;
+    else if (name == "lattice") kind = SparseGraphKind::Lattice;
+    else return false;
+    return true;
+}
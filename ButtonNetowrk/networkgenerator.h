@@ -0,0 +1,40 @@
+#ifndef NETWORKGENERATOR_H
+#define NETWORKGENERATOR_H
+
+#include <cstdint>
+#include <string>
+
+#include "networkspec.h"
+
+// Large networks that are not drawn on the canvas: generated graphs and
+// edge-list files. No gates; every node follows dy_i = -y_i + sum w * fn(y_j).
+// Generation is deterministic in the settings (own RNG conversion, no
+// std::uniform_*_distribution), so the same seed gives the same network everywhere.
+
+enum class SparseGraphKind { Random, SmallWorld, Lattice };
+
+struct SparseGraphSettings {
+    SparseGraphKind kind = SparseGraphKind::Random;
+    int nodes = 10000;
+    int degree = 8;            // incoming edges per node (random, small-world); lattice: always 4
+    double rewire = 0.1;       // small-world: probability that an edge gets a random source
+    double weightScale = 1.0;  // w ~ U(-1, 1) * weightScale / sqrt(in-degree)
+    std::uint64_t seed = 1;
+    ActivationKind fn = ActivationKind::Tanh;
+};
+
+// random:     `degree` distinct random sources per node, no self loops
+// smallworld: Watts-Strogatz ring (degree/2 neighbours on each side), each edge rewired with p = rewire
+// lattice:    2-D periodic grid, side = ceil(sqrt(nodes)), 4 neighbours (nodes is rounded up to side^2)
+NetworkSpec generateSparseNetwork(const SparseGraphSettings& settings);
+
+// "from to [weight [fn]]" per line, 1-based nodes, '#' comments; weight defaults
+// to 1, fn to defaultFn. nodeCount is the largest node number (at least 5).
+// Returns false with *error set ("line N: ...") on a malformed line.
+bool parseEdgeList(const std::string& text, ActivationKind defaultFn, NetworkSpec& spec,
+                   std::string* error = nullptr);
+
+const char* sparseGraphKindName(SparseGraphKind kind);
+bool sparseGraphKindFromName(const std::string& name, SparseGraphKind& kind);
+
+#endif // NETWORKGENERATOR_H
@@ -0,0 +1,722 @@
+#include "networkloader.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+// ================= Text helpers (no QString per line: archives are large) =================
+
+std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\r')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+bool startsWith(std::string_view s, std::string_view prefix)
+{
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool toDouble(std::string_view s, double& v)
+{
+    s = trim(s);
+    char buf[64];
+    if (s.empty() || s.size() >= sizeof(buf)) return false;
+    std::memcpy(buf, s.data(), s.size());
+    buf[s.size()] = '\0';
+    char* end = nullptr;
+    v = std::strtod(buf, &end);
+    return end == buf + s.size();
+}
+
+bool toInt(std::string_view s, int& v)
+{
+    double d = 0.0;
+    if (!toDouble(s, d) || d != double(int(d))) return false;
+    v = int(d);
+    return true;
+}
+
+QString qs(std::string_view s) { return QString::fromUtf8(s.data(), int(s.size())); }
+
+class LineReader
+{
+public:
+    explicit LineReader(const QByteArray& text) : p(text.constData()), end(p + text.size()) {}
+
+    bool next(std::string_view& line)
+    {
+        if (p >= end) return false;
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        const char* stop = nl ? nl : end;
+        line = trim(std::string_view(p, size_t(stop - p)));
+        p = nl ? nl + 1 : end;
+        ++lineNo;
+        return true;
+    }
+
+    int lineNo = 0;
+
+private:
+    const char* p;
+    const char* end;
+};
+
+// "s14" -> (1, 4); node numbers are single digits (weightKey() concatenates them)
+bool parseWeightKey(std::string_view key, int& from, int& to)
+{
+    key = trim(key);
+    if (key.size() != 3 || key[0] != 's') return false;
+    if (key[1] < '1' || key[1] > '9' || key[2] < '1' || key[2] > '9') return false;
+    from = key[1] - '0';
+    to = key[2] - '0';
+    return true;
+}
+
+// GUI name for an activation ("sin" in equations/gates is "sin_exp" on edges)
+QString edgeFunctionName(std::string_view fn)
+{
+    if (fn == "sin" || fn == "sin_exp") return "sin_exp";
+    if (fn == "tanh") return "tanh";
+    if (fn == "relu") return "relu";
+    return QString();
+}
+
+struct Parse {
+    SimulationConfig& config;
+    QString* error;
+    QStringList* warnings;
+    int lineNo = 0;
+    bool unmappedTerms = false; // graph.txt term that is not w*fn(y_j)
+
+    bool fail(const QString& why) const
+    {
+        if (error) *error = QString("line %1: %2").arg(lineNo).arg(why);
+        return false;
+    }
+    void warn(const QString& why) const
+    {
+        if (warnings) warnings->append(QString("line %1: %2").arg(lineNo).arg(why));
+    }
+};
+
+bool setGateField(GateConfig& gate, std::string_view field, std::string_view value)
+{
+    double d = 0.0;
+    if (field == "enabled") gate.enabled = (value == "1" || value == "true");
+    else if (field == "baseType") gate.baseType = qs(value);
+    else if (field == "baseConst") { if (!toDouble(value, d)) return false; gate.baseConst = d; }
+    else if (field == "coeff") { if (!toDouble(value, d)) return false; gate.coeff = d; }
+    else if (field == "fn") gate.fn = qs(value);
+    else return false;
+    return true;
+}
+
+// params.txt "parareal.<field>=", run_info.txt "Parareal: <field>=..."
+bool setPararealField(PararealConfig& p, std::string_view field, std::string_view value)
+{
+    if (field == "enabled") { p.enabled = (value == "1" || value == "true"); return true; }
+    if (field == "slices") return toInt(value, p.slices) && p.slices >= 1;
+    if (field == "coarseRatio") return toInt(value, p.coarseRatio) && p.coarseRatio >= 1;
+    if (field == "tolerance") return toDouble(value, p.tolerance);
+    if (field == "maxIterations") return toInt(value, p.maxIterations);
+    return false;
+}
+
+// params.txt "gradedMesh.<field>=", the same tokens on the run_info.txt "Scheme:" line
+bool setGradedMeshField(GradedMeshOptions& mesh, std::string_view field, std::string_view value)
+{
+    if (field == "intervals") return toInt(value, mesh.gradedIntervals) && mesh.gradedIntervals >= 1;
+    if (field == "exponent") return toDouble(value, mesh.exponent) && mesh.exponent >= 0.0;
+    if (field == "maxStep") return toDouble(value, mesh.maxStep) && mesh.maxStep > 0.0;
+    return false;
+}
+
+bool setScalar(SimulationConfig& c, std::string_view key, std::string_view value, bool& known)
+{
+    known = true;
+    if (startsWith(key, "parareal.")) return setPararealField(c.parareal, key.substr(9), value);
+    if (startsWith(key, "gradedMesh.")) return setGradedMeshField(c.gradedMesh, key.substr(11), value);
+    if (key == "solverMode" || key == "Solver") {
+        if (value != "ODE" && value != "GAMMA" && value != "GAMMA-ABM" && value != "GAMMA-GRADED") return false;
+        c.solverMode = qs(value);
+        return true;
+    }
+    if (key == "tMax") return toInt(value, c.tMax);
+    if (key == "odeStep") return toDouble(value, c.odeStep);
+    if (key == "fractionalStep") return toDouble(value, c.fractionalStep);
+    if (key == "fractionalKernel") {
+        if (value != "pow" && value != "gamma") return false;
+        c.fractionalKernel = qs(value);
+        return true;
+    }
+    if (key == "alpha1") return toDouble(value, c.alpha1);
+    if (key == "alpha2") return toDouble(value, c.alpha2);
+    if (key == "alpha3") return toDouble(value, c.alpha3);
+    if (key == "nu") return toDouble(value, c.nu);
+    if (key == "events" || key == "Events") {
+        std::vector<EventSpec> specs;
+        if (!parseEventSpecs(std::string(value), specs)) return false;
+        c.events = QString::fromStdString(eventSpecsText(specs));
+        return true;
+    }
+    known = false;
+    return true;
+}
+
+// [large] in params.txt, "LargeNetwork: kind=... nodes=..." in run_info.txt
+bool setLargeField(LargeNetworkConfig& large, std::string_view key, std::string_view value)
+{
+    if (key == "kind") {
+        if (value != "random" && value != "smallworld" && value != "lattice" && value != "edgelist") return false;
+        large.kind = qs(value);
+        return true;
+    }
+    if (key == "nodes") return toInt(value, large.nodes);
+    if (key == "degree") return toInt(value, large.degree);
+    if (key == "rewire") return toDouble(value, large.rewire);
+    if (key == "weightScale") return toDouble(value, large.weightScale);
+    if (key == "seed") {
+        const std::string digits(trim(value));
+        char* end = nullptr;
+        large.seed = std::strtoull(digits.c_str(), &end, 10);
+        return !digits.empty() && *end == '\0';
+    }
+    if (key == "fn") {
+        if (edgeFunctionName(value).isEmpty()) return false;
+        large.fn = qs(value);
+        return true;
+    }
+    if (key == "ordering") {
+        if (value != "none" && value != "rcm" && value != "community") return false;
+        large.ordering = qs(value);
+        return true;
+    }
+    if (key == "edgeList" || key == "file") {
+        large.edgeListPath = qs(value);
+        return true;
+    }
+    return key == "edges"; // run_info only, derived
+}
+
+// "3=0.5" of [orders] in params.txt and of the run_info.txt "NodeOrders:" line
+bool setNodeOrder(QMap<int, double>& orders, std::string_view node, std::string_view value)
+{
+    int i = 0;
+    double order = 0.0;
+    if (!toInt(node, i) || i < 1 || !toDouble(value, order)) return false;
+    orders[i] = order;
+    return true;
+}
+
+// ================= params.txt =================
+
+bool parseParams(const QByteArray& text, Parse& ps)
+{
+    SimulationConfig& c = ps.config;
+    std::string_view section;
+    bool sawConnections = false;
+    QVector<ConnectionConfig> loadedConnections;
+    QString loadedEquations;
+    LargeNetworkConfig loadedLarge;
+    QMap<int, double> loadedOrders;
+
+    LineReader in(text);
+    std::string_view line;
+    while (in.next(line)) {
+        ps.lineNo = in.lineNo;
+        if (line.empty() || line.front() == '#') continue;
+
+        if (line.front() == '[' && line.back() == ']') {
+            section = line.substr(1, line.size() - 2);
+            if (section == "connections") sawConnections = true;
+            continue;
+        }
+
+        // raw "Dy1 = ..." lines, compiled later by equationdsl.h
+        if (section == "equations") {
+            loadedEquations += qs(line) + "\n";
+            continue;
+        }
+
+        const size_t eq = line.find('=');
+        if (eq == std::string_view::npos || eq == 0) return ps.fail("expected key=value");
+        const std::string_view key = trim(line.substr(0, eq));
+        const std::string_view value = trim(line.substr(eq + 1));
+
+        if (section == "large") {
+            if (!setLargeField(loadedLarge, key, value)) return ps.fail("bad value for " + qs(key));
+        } else if (section == "orders") {
+            if (!setNodeOrder(loadedOrders, key, value)) return ps.fail("expected <node>=<nu>");
+        } else if (section == "weights") {
+            double w = 0.0;
+            if (!toDouble(value, w)) return ps.fail("bad weight " + qs(value));
+            c.weightValues[qs(key)] = w;
+        } else if (section == "connections") {
+            const size_t gt = key.find('>');
+            ConnectionConfig conn;
+            if (gt == std::string_view::npos || !toInt(key.substr(0, gt), conn.from)
+                || !toInt(key.substr(gt + 1), conn.to))
+                return ps.fail("expected <from>><to>=<function>");
+            conn.function = edgeFunctionName(value);
+            if (conn.function.isEmpty()) return ps.fail("unknown function " + qs(value));
+            loadedConnections.push_back(conn);
+        } else if (startsWith(key, "GateNode4.") || startsWith(key, "GateNode5.")) {
+            GateConfig& gate = (key[8] == '4') ? c.gateNode4 : c.gateNode5;
+            if (!setGateField(gate, key.substr(10), value)) ps.warn("ignored " + qs(key));
+        } else {
+            bool known = false;
+            if (!setScalar(c, key, value, known)) return ps.fail("bad value for " + qs(key));
+            // unknown keys are ignored so newer files still load
+        }
+    }
+
+    if (sawConnections) c.connections = loadedConnections;
+    c.equations = loadedEquations; // no [equations]: the drawn network
+    c.large = loadedLarge;         // no [large]: the drawn network
+    c.nodeOrders = loadedOrders;   // no [orders]: every node uses nu
+    return true;
+}
+
+// ================= run_info.txt =================
+
+// "Gate4(G2): enabled=1 base=alpha2(1) coeff=1.2 fn=sin"
+bool parseGateInfo(std::string_view rest, GateConfig& gate)
+{
+    size_t pos = 0;
+    while (pos < rest.size()) {
+        const size_t sp = rest.find(' ', pos);
+        const std::string_view tok = rest.substr(pos, (sp == std::string_view::npos ? rest.size() : sp) - pos);
+        pos = (sp == std::string_view::npos) ? rest.size() : sp + 1;
+        if (tok.empty()) continue;
+
+        const size_t eq = tok.find('=');
+        if (eq == std::string_view::npos) return false;
+        const std::string_view key = tok.substr(0, eq);
+        const std::string_view value = tok.substr(eq + 1);
+
+        if (key == "base") {
+            const size_t open = value.find('(');
+            if (open == std::string_view::npos || value.back() != ')') return false;
+            gate.baseType = qs(value.substr(0, open));
+            if (!toDouble(value.substr(open + 1, value.size() - open - 2), gate.baseConst)) return false;
+        } else if (!setGateField(gate, key, value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseRunInfo(const QByteArray& text, Parse& ps)
+{
+    SimulationConfig& c = ps.config;
+    bool inConnections = false;
+    bool inEquations = false;
+    QVector<ConnectionConfig> loadedConnections;
+    QString loadedEquations;
+    LargeNetworkConfig loadedLarge;
+    QMap<int, double> loadedOrders;
+    c.parareal.enabled = false; // written only for Parareal runs
+
+    LineReader in(text);
+    std::string_view line;
+    while (in.next(line)) {
+        ps.lineNo = in.lineNo;
+        if (line.empty()) { inConnections = inEquations = false; continue; }
+
+        if (inEquations) {
+            loadedEquations += qs(line) + "\n";
+            continue;
+        }
+        if (line == "Equations:") { inEquations = true; continue; }
+
+        if (inConnections && line.front() == 's') {
+            // "s14 = -0.6 fn=sin_exp"
+            const size_t eq = line.find('=');
+            const size_t fnPos = line.find(" fn=");
+            int from = 0, to = 0;
+            double w = 0.0;
+            if (eq == std::string_view::npos || fnPos == std::string_view::npos || fnPos < eq
+                || !parseWeightKey(line.substr(0, eq), from, to)
+                || !toDouble(line.substr(eq + 1, fnPos - eq - 1), w)) {
+                ps.warn("ignored connection " + qs(line));
+                continue;
+            }
+            ConnectionConfig conn;
+            conn.from = from;
+            conn.to = to;
+            conn.function = edgeFunctionName(trim(line.substr(fnPos + 4)));
+            if (conn.function.isEmpty()) { ps.warn("unknown function in " + qs(line)); continue; }
+            c.weightValues[SimulationConfig::weightKey(from, to)] = w;
+            loadedConnections.push_back(conn);
+            continue;
+        }
+        inConnections = false;
+
+        if (line == "Connections:") { inConnections = true; continue; }
+        if (startsWith(line, "Parareal:")) {
+            c.parareal.enabled = true;
+            const std::string_view rest = trim(line.substr(9));
+            size_t pos = 0;
+            while (pos < rest.size()) {
+                const size_t sp = rest.find(' ', pos);
+                const std::string_view tok = rest.substr(pos, (sp == std::string_view::npos ? rest.size() : sp) - pos);
+                pos = (sp == std::string_view::npos) ? rest.size() : sp + 1;
+                const size_t eq = tok.find('=');
+                if (!tok.empty() && (eq == std::string_view::npos
+                                     || !setPararealField(c.parareal, tok.substr(0, eq), tok.substr(eq + 1))))
+                    ps.warn("ignored " + qs(tok));
+            }
+            continue;
+        }
+        if (startsWith(line, "NodeOrders:")) {
+            const std::string_view rest = trim(line.substr(11));
+            size_t pos = 0;
+            while (pos < rest.size()) {
+                const size_t sp = rest.find(' ', pos);
+                const std::string_view tok = rest.substr(pos, (sp == std::string_view::npos ? rest.size() : sp) - pos);
+                pos = (sp == std::string_view::npos) ? rest.size() : sp + 1;
+                const size_t eq = tok.find('=');
+                if (!tok.empty() && (eq == std::string_view::npos
+                                     || !setNodeOrder(loadedOrders, tok.substr(0, eq), tok.substr(eq + 1))))
+                    ps.warn("ignored " + qs(tok));
+            }
+            continue;
+        }
+        if (startsWith(line, "LargeNetwork:")) {
+            // "kind=edgelist nodes=.. edges=.. file=<path, may contain spaces> fn=tanh"
+            std::string_view rest = trim(line.substr(13));
+            const size_t file = rest.find(" file=");
+            if (file != std::string_view::npos) {
+                const size_t fn = rest.rfind(" fn=");
+                const size_t stop = (fn != std::string_view::npos && fn > file) ? fn : rest.size();
+                loadedLarge.edgeListPath = qs(rest.substr(file + 6, stop - file - 6));
+                if (stop < rest.size() && !setLargeField(loadedLarge, "fn", rest.substr(stop + 4)))
+                    ps.warn("ignored " + qs(line));
+                rest = rest.substr(0, file);
+            }
+            size_t pos = 0;
+            while (pos < rest.size()) {
+                const size_t sp = rest.find(' ', pos);
+                const std::string_view tok = rest.substr(pos, (sp == std::string_view::npos ? rest.size() : sp) - pos);
+                pos = (sp == std::string_view::npos) ? rest.size() : sp + 1;
+                const size_t eq = tok.find('=');
+                if (!tok.empty() && (eq == std::string_view::npos
+                                     || !setLargeField(loadedLarge, tok.substr(0, eq), tok.substr(eq + 1))))
+                    ps.warn("ignored " + qs(tok));
+            }
+            continue;
+        }
+        if (startsWith(line, "Gate4(G2):") || startsWith(line, "Gate5(G1):")) {
+            GateConfig& gate = (line[4] == '4') ? c.gateNode4 : c.gateNode5;
+            if (!parseGateInfo(trim(line.substr(10)), gate)) ps.warn("ignored " + qs(line));
+            continue;
+        }
+
+        // "Solver: ODE", "tMax: 800", "alpha1=1 alpha2=1 alpha3=1", "nu=0.9"
+        const size_t colon = line.find(": ");
+        if (colon != std::string_view::npos && line.find('=') == std::string_view::npos) {
+            bool known = false;
+            if (!setScalar(c, line.substr(0, colon), trim(line.substr(colon + 2)), known))
+                return ps.fail("bad value in " + qs(line));
+            continue;
+        }
+        size_t pos = 0;
+        while (pos < line.size()) {
+            const size_t sp = line.find(' ', pos);
+            const std::string_view tok = line.substr(pos, (sp == std::string_view::npos ? line.size() : sp) - pos);
+            pos = (sp == std::string_view::npos) ? line.size() : sp + 1;
+            const size_t eq = tok.find('=');
+            if (eq == std::string_view::npos) continue;
+            bool known = false;
+            if (!setScalar(c, tok.substr(0, eq), tok.substr(eq + 1), known))
+                return ps.fail("bad value in " + qs(line));
+        }
+    }
+
+    c.connections = loadedConnections;
+    c.equations = loadedEquations;
+    c.large = loadedLarge;
+    c.nodeOrders = loadedOrders;
+    return true;
+}
+
+// ================= graph.txt =================
+
+// One term of "Dy3(w) = -y3 + 0*tanh(y2) + -0.5*sin(y1)" (sign already applied).
+bool parseEquationTerm(std::string_view term, double sign, int node, Parse& ps, QVector<ConnectionConfig>& conns)
+{
+    // leak term -y_i
+    if (term == "y" + std::to_string(node) && sign < 0) return true;
+
+    double weight = 1.0;
+    const size_t star = term.find('*');
+    std::string_view call = term;
+    if (star != std::string_view::npos) {
+        if (!toDouble(term.substr(0, star), weight)) return false;
+        call = term.substr(star + 1);
+    }
+
+    const size_t open = call.find('(');
+    if (open == std::string_view::npos || call.back() != ')') return false;
+    const QString fn = edgeFunctionName(call.substr(0, open));
+    const std::string_view arg = call.substr(open + 1, call.size() - open - 2);
+    int from = 0;
+    if (fn.isEmpty() || arg.size() < 2 || arg[0] != 'y' || !toInt(arg.substr(1), from)) return false;
+
+    ConnectionConfig conn;
+    conn.from = from;
+    conn.to = node;
+    conn.function = fn;
+    ps.config.weightValues[SimulationConfig::weightKey(from, node)] = sign * weight;
+    conns.push_back(conn);
+    return true;
+}
+
+bool parseEquation(std::string_view line, Parse& ps, QVector<ConnectionConfig>& conns)
+{
+    // "Dy<i>(w) = ..."
+    const size_t paren = line.find('(');
+    const size_t eq = line.find('=');
+    int node = 0;
+    if (paren == std::string_view::npos || eq == std::string_view::npos || !toInt(line.substr(2, paren - 2), node))
+        return ps.fail("expected Dy<i>(w) = ...");
+
+    std::string rhs;
+    for (char ch : line.substr(eq + 1))
+        if (ch != ' ' && ch != '\t') rhs.push_back(ch);
+
+    // split at binary + / - (a '-' right after '*', '(', 'e' or another sign belongs to a number)
+    size_t start = 0;
+    double sign = 1.0;
+    for (size_t i = 0; i <= rhs.size(); ++i) {
+        const bool atEnd = (i == rhs.size());
+        const bool isSep = !atEnd && (rhs[i] == '+' || rhs[i] == '-') && i > start
+                           && std::strchr("*(eE+-", rhs[i - 1]) == nullptr;
+        if (!atEnd && !isSep) continue;
+
+        std::string_view term(rhs.data() + start, i - start);
+        double termSign = sign;
+        while (!term.empty() && (term.front() == '+' || term.front() == '-')) {
+            if (term.front() == '-') termSign = -termSign;
+            term.remove_prefix(1);
+        }
+        if (!term.empty() && !parseEquationTerm(term, termSign, node, ps, conns))
+            ps.unmappedTerms = true;
+
+        if (!atEnd) {
+            sign = (rhs[i] == '-') ? -1.0 : 1.0;
+            start = i + 1;
+        }
+    }
+    return true;
+}
+
+bool parseGraph(const QByteArray& text, Parse& ps)
+{
+    SimulationConfig& c = ps.config;
+    std::string_view section;
+    QVector<ConnectionConfig> loadedConnections;
+    QString equationLines;
+
+    LineReader in(text);
+    std::string_view line;
+    while (in.next(line)) {
+        ps.lineNo = in.lineNo;
+        if (line.empty()) continue;
+
+        if (startsWith(line, "===")) {
+            section = trim(line.substr(3, line.size() > 6 ? line.size() - 6 : 0));
+            continue;
+        }
+
+        if (startsWith(section, "Differential Equations")) {
+            if (!startsWith(line, "Dy")) continue;
+            if (!parseEquation(line, ps, loadedConnections)) return false;
+            equationLines += qs(line) + "\n";
+        } else if (startsWith(section, "Weight Values")) {
+            const size_t eq = line.find('=');
+            double w = 0.0;
+            if (eq == std::string_view::npos || !toDouble(line.substr(eq + 1), w)) {
+                ps.warn("ignored " + qs(line));
+                continue;
+            }
+            c.weightValues[qs(trim(line.substr(0, eq)))] = w;
+        } else if (startsWith(section, "Alpha Constants")) {
+            // "α1 = 2.2" (UTF-8 alpha) or "alpha1 = 2.2"
+            const size_t eq = line.find('=');
+            if (eq == std::string_view::npos) continue;
+            std::string_view name = trim(line.substr(0, eq));
+            if (startsWith(name, "\xCE\xB1")) name.remove_prefix(2);
+            else if (startsWith(name, "alpha")) name.remove_prefix(5);
+            std::string key = "alpha";
+            key += name;
+            bool known = false;
+            if (!setScalar(c, key, trim(line.substr(eq + 1)), known) || !known) ps.warn("ignored " + qs(line));
+        } else {
+            bool known = false;
+            const size_t eq = line.find('=');
+            if (eq != std::string_view::npos) setScalar(c, trim(line.substr(0, eq)), trim(line.substr(eq + 1)), known);
+        }
+    }
+
+    c.connections = loadedConnections;
+
+    // terms the canvas cannot draw (gates, products, other functions): keep the
+    // equations as written; weights and alphas read above are still used by name
+    c.equations.clear();
+    if (ps.unmappedTerms) {
+        SimulationConfig custom = c;
+        custom.equations = equationLines;
+        QString why;
+        if (!custom.checkEquations(&why)) return ps.fail(why);
+        c.equations = equationLines;
+        ps.warn("terms beyond w*fn(y_j): loaded as custom equations");
+    }
+    return true;
+}
+
+} // namespace
+
+// ================= Public API =================
+
+NetworkFileKind detectNetworkFileKind(const QByteArray& text)
+{
+    LineReader in(text);
+    std::string_view line;
+    while (in.next(line)) {
+        if (line.empty() || line.front() == '#') continue;
+        if (startsWith(line, "=== Hopfield")) return NetworkFileKind::RunInfo;
+        if (startsWith(line, "=== Differential Equations")) return NetworkFileKind::Graph;
+        if (startsWith(line, "solverMode=") || line == "[weights]" || line == "[connections]")
+            return NetworkFileKind::Params;
+        if (in.lineNo > 40) break;
+    }
+    return NetworkFileKind::Unknown;
+}
+
+bool parseNetworkText(const QByteArray& text, NetworkFileKind kind, SimulationConfig& config,
+                      QString* error, QStringList* warnings)
+{
+    Parse ps{config, error, warnings};
+    switch (kind) {
+    case NetworkFileKind::Params:  return parseParams(text, ps);
+    case NetworkFileKind::RunInfo: return parseRunInfo(text, ps);
+    case NetworkFileKind::Graph:   return parseGraph(text, ps);
+    case NetworkFileKind::Unknown: break;
+    }
+    if (error) *error = "not a params.txt / run_info.txt / graph.txt file";
+    return false;
+}
+
+bool loadNetworkFile(const QString& path, SimulationConfig& config, QString* error, QStringList* warnings)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        if (error) *error = "Cannot open " + path;
+        return false;
+    }
+    const QByteArray text = f.readAll();
+
+    QString why;
+    if (!parseNetworkText(text, detectNetworkFileKind(text), config, &why, warnings)) {
+        if (error) *error = path + ": " + why;
+        return false;
+    }
+    return true;
+}
+
+bool isRunFolder(const QString& dir)
+{
+    return QFileInfo::exists(dir + "/params.txt") || QFileInfo::exists(dir + "/run_info.txt");
+}
+
+bool loadRunFolder(const QString& dir, SimulationConfig& config, QString* error, QStringList* warnings)
+{
+    const QString params = dir + "/params.txt";
+    const QString info = dir + "/run_info.txt";
+
+    if (!QFileInfo::exists(params)) return loadNetworkFile(info, config, error, warnings);
+    if (!loadNetworkFile(params, config, error, warnings)) return false;
+
+    // params.txt from before [connections]: take the edge functions from run_info.txt
+    QFile f(params);
+    const bool hasConnections = f.open(QIODevice::ReadOnly) && f.readAll().contains("[connections]");
+    if (!hasConnections && QFileInfo::exists(info)) {
+        SimulationConfig fromInfo = config;
+        if (loadNetworkFile(info, fromInfo, nullptr, warnings)) config.connections = fromInfo.connections;
+    }
+    return true;
+}
+
+QVector<LoadedNetwork> loadNetworkDirectory(const QString& dir, bool recursive, int threads)
+{
+    // sources: run folders (params.txt / run_info.txt inside) and loose .txt files
+    struct Source { QString path; bool folder; };
+    QVector<Source> sources;
+
+    if (isRunFolder(dir)) {
+        sources.push_back({dir, true});
+    } else {
+        auto addFiles = [&](const QString& d) {
+            const QFileInfoList files = QDir(d).entryInfoList(QStringList() << "*.txt", QDir::Files, QDir::Name);
+            for (const QFileInfo& fi : files) sources.push_back({fi.absoluteFilePath(), false});
+        };
+        addFiles(dir);
+
+        if (recursive) {
+            QDirIterator it(dir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                const QString sub = it.next();
+                if (QFileInfo(sub).fileName() == "cache") continue;
+                if (isRunFolder(sub)) sources.push_back({sub, true});
+            }
+        }
+    }
+
+    std::sort(sources.begin(), sources.end(),
+              [](const Source& a, const Source& b) { return a.path < b.path; });
+
+    QVector<LoadedNetwork> loaded(sources.size());
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int i = next++; i < sources.size(); i = next++) {
+            LoadedNetwork& n = loaded[i];
+            n.source = sources[i].path;
+            if (sources[i].folder) {
+                n.ok = loadRunFolder(n.source, n.config, &n.error, &n.warnings);
+            } else {
+                QFile f(n.source);
+                if (!f.open(QIODevice::ReadOnly)) { n.error = "Cannot open " + n.source; continue; }
+                const QByteArray text = f.readAll();
+                const NetworkFileKind kind = detectNetworkFileKind(text);
+                if (kind == NetworkFileKind::Unknown) continue; // not a network file
+                n.ok = parseNetworkText(text, kind, n.config, &n.error, &n.warnings);
+            }
+        }
+    };
+
+    int count = (threads > 0) ? threads : int(std::thread::hardware_concurrency());
+    count = std::max(1, std::min(count, int(sources.size())));
+    std::vector<std::thread> pool;
+    for (int t = 1; t < count; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool) t.join();
+
+    // drop loose files that turned out not to be networks
+    QVector<LoadedNetwork> result;
+    for (const LoadedNetwork& n : loaded)
+        if (n.ok || !n.error.isEmpty()) result.push_back(n);
+    return result;
+}
@@ -0,0 +1,46 @@
+#ifndef NETWORKLOADER_H
+#define NETWORKLOADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "simulationconfig.h"
+
+// Rebuilds a SimulationConfig from the files runs leave behind:
+//   params.txt   key=value, [weights], [connections], [equations], [large] (SimulationConfig::saveParams)
+//   run_info.txt "=== Hopfield ... Run Info ===" block    (SimulationConfig::writeRunInfo)
+//   graph.txt    "=== Differential Equations ===", Dy_i(w) = -y_i + w*fn(y_j) + ...
+// Fields a file does not mention keep the value already in the config.
+
+enum class NetworkFileKind { Unknown, Params, RunInfo, Graph };
+
+NetworkFileKind detectNetworkFileKind(const QByteArray& text);
+
+bool parseNetworkText(const QByteArray& text, NetworkFileKind kind, SimulationConfig& config,
+                      QString* error = nullptr, QStringList* warnings = nullptr);
+
+bool loadNetworkFile(const QString& path, SimulationConfig& config,
+                     QString* error = nullptr, QStringList* warnings = nullptr);
+
+// Run folder: params.txt, then run_info.txt for what params.txt lacks
+// (connection functions in files written before [connections] existed).
+bool isRunFolder(const QString& dir);
+bool loadRunFolder(const QString& dir, SimulationConfig& config,
+                   QString* error = nullptr, QStringList* warnings = nullptr);
+
+struct LoadedNetwork {
+    QString source;        // run folder or file
+    bool ok = false;
+    QString error;
+    QStringList warnings;
+    SimulationConfig config;
+};
+
+// dir itself if it is a run folder; otherwise every run folder below it and every
+// params/graph file in it. Files are parsed on `threads` threads (0 = all cores);
+// the result is sorted by source path, independent of the thread count.
+QVector<LoadedNetwork> loadNetworkDirectory(const QString& dir, bool recursive = true, int threads = 0);
+
+#endif // NETWORKLOADER_H
@@ -0,0 +1,526 @@
+#include "networksolver.h"
+#include "rhskernel.h"
+#include "workerpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+const int kEulerProgressInterval = 400;
+const int kFractionalProgressInterval = 100;
+
+void prepareArena(StateArena& arena, const NetworkSpec& spec, const std::vector<double>& y0, int steps)
+{
+    arena.prepare(spec.nodeCount, steps);
+    double* first = arena.state(0);
+    for (int i = 0; i < spec.nodeCount; ++i) first[i] = y0[i];
+}
+
+// Steps fromStep+1..toStep; state(fromStep) must be valid.
+template <class Kernel>
+bool eulerLoop(const Kernel& kernel, int fromStep, int toStep, double h, StateArena& arena,
+               const SolverProgressFn& progress)
+{
+    const int n = kernel.nodeCount();
+
+    for (int t = fromStep + 1; t <= toStep; ++t) {
+        if (progress && t % kEulerProgressInterval == 0 && !progress(t)) return false;
+
+        const double* prev = arena.state(t - 1);
+        double* dy = arena.rhs(t - 1);
+        double* next = arena.state(t);
+
+        kernel.eval(prev, dy);
+        for (int i = 0; i < n; ++i) next[i] = prev[i] + h * dy[i];
+    }
+    return true;
+}
+
+// Steps fromStep+1..toStep; state(0..fromStep) and rhs(0..fromStep-1) must be valid.
+template <class Kernel>
+bool fractionalLoop(const Kernel& kernel, int fromStep, int toStep, double nu, FractionalKernel weights,
+                    StateArena& arena, const SolverProgressFn& progress)
+{
+    const int n = kernel.nodeCount();
+    const double* b = arena.historyWeights(weights, nu);
+    const double* first = arena.state(0);
+
+    for (int om = fromStep + 1; om <= toStep; ++om) {
+        if (progress && om % kFractionalProgressInterval == 0 && !progress(om)) return false;
+
+        kernel.eval(arena.state(om - 1), arena.rhs(om - 1));
+
+        // history rows are contiguous across nodes; per node the sum still runs r = 1..om
+        double* acc = arena.state(om);
+        for (int i = 0; i < n; ++i) acc[i] = 0.0;
+        for (int r = 1; r <= om; ++r) {
+            const double* f = arena.rhs(r - 1);
+            const double bg = b[om - r];
+            for (int i = 0; i < n; ++i) acc[i] += f[i] * bg;
+        }
+        for (int i = 0; i < n; ++i) acc[i] += first[i];
+    }
+    return true;
+}
+
+// Distinct orders in first-seen order and the table of every node; nu holds one order per node.
+struct OrderTables {
+    std::vector<double> orders;
+    std::vector<int> table;
+};
+
+OrderTables orderTables(const std::vector<double>& nu, int nodeCount)
+{
+    OrderTables t;
+    t.table.resize(nodeCount);
+    for (int i = 0; i < nodeCount; ++i) {
+        const double order = nu[i];
+        const auto it = std::find(t.orders.begin(), t.orders.end(), order);
+        t.table[i] = int(it - t.orders.begin());
+        if (it == t.orders.end()) t.orders.push_back(order);
+    }
+    return t;
+}
+
+// fractionalLoop with one weight table per distinct order; the arena must hold
+// orders.size() tables.
+template <class Kernel>
+bool fractionalMixedLoop(const Kernel& kernel, int fromStep, int toStep, const OrderTables& orders,
+                         FractionalKernel weights, StateArena& arena, const SolverProgressFn& progress)
+{
+    const int n = kernel.nodeCount();
+    const int tableCount = int(orders.orders.size());
+    std::vector<const double*> tables(tableCount);
+    for (int g = 0; g < tableCount; ++g) tables[g] = arena.historyWeights(weights, orders.orders[g], g);
+    std::vector<double> w(tableCount);
+    const int* table = orders.table.data();
+    const double* first = arena.state(0);
+
+    for (int om = fromStep + 1; om <= toStep; ++om) {
+        if (progress && om % kFractionalProgressInterval == 0 && !progress(om)) return false;
+
+        kernel.eval(arena.state(om - 1), arena.rhs(om - 1));
+
+        double* acc = arena.state(om);
+        for (int i = 0; i < n; ++i) acc[i] = 0.0;
+        for (int r = 1; r <= om; ++r) {
+            const double* f = arena.rhs(r - 1);
+            for (int g = 0; g < tableCount; ++g) w[g] = tables[g][om - r];
+            for (int i = 0; i < n; ++i) acc[i] += f[i] * w[table[i]];
+        }
+        for (int i = 0; i < n; ++i) acc[i] += first[i];
+    }
+    return true;
+}
+
+// a_n of the corrector: weight of f(y_0), n^nu (nu - (n-nu) ((1 + 1/n)^nu - 1))
+double abmStartWeight(int n, double nu)
+{
+    if (n == 0) return nu;
+    const double k = n;
+    return std::pow(k, nu) * (nu - (k - nu) * std::expm1(nu * std::log1p(1.0 / k)));
+}
+
+// Steps fromStep+1..toStep of the predictor-corrector; same history layout as fractionalLoop.
+template <class Kernel>
+bool fractionalAbmLoop(const Kernel& kernel, int fromStep, int toStep, double nu, double h, StateArena& arena,
+                       const SolverProgressFn& progress)
+{
+    const int n = kernel.nodeCount();
+    const double* b = arena.powWeights(nu);
+    const double* c = arena.correctorWeights(nu);
+    const double* first = arena.state(0);
+    const double hNu = std::pow(h, nu);
+    const double hCorrector = hNu / (nu + 1.0);
+    std::vector<double> predicted(n), fPredicted(n);
+
+    for (int om = fromStep + 1; om <= toStep; ++om) {
+        if (progress && om % kFractionalProgressInterval == 0 && !progress(om)) return false;
+
+        kernel.eval(arena.state(om - 1), arena.rhs(om - 1));
+
+        // one sweep over the history feeds both sums
+        const int last = om - 1;
+        double* acc = arena.state(om);
+        const double* f0 = arena.rhs(0);
+        const double a0 = abmStartWeight(last, nu);
+        for (int i = 0; i < n; ++i) {
+            predicted[i] = f0[i] * b[last];
+            acc[i] = f0[i] * a0;
+        }
+        for (int j = 1; j <= last; ++j) {
+            const double* f = arena.rhs(j);
+            const double bj = b[last - j];
+            const double cj = c[last - j];
+            for (int i = 0; i < n; ++i) {
+                predicted[i] += f[i] * bj;
+                acc[i] += f[i] * cj;
+            }
+        }
+        for (int i = 0; i < n; ++i) predicted[i] = first[i] + hNu * predicted[i];
+
+        kernel.eval(predicted.data(), fPredicted.data());
+        for (int i = 0; i < n; ++i) acc[i] = first[i] + hCorrector * (acc[i] + fPredicted[i]);
+    }
+    return true;
+}
+
+// Predictor-corrector over the mesh times t (gradedMeshTimes). Mesh history is kept in
+// local rows; arena rows 0..steps are interpolated as the mesh passes them.
+template <class Kernel>
+bool fractionalGradedLoop(const Kernel& kernel, int steps, double nu, const std::vector<double>& t,
+                          StateArena& arena, const SolverProgressFn& progress)
+{
+    const int n = kernel.nodeCount();
+    const int intervals = int(t.size()) - 1;
+    std::vector<double> ys(std::size_t(intervals + 1) * n), fs(std::size_t(intervals + 1) * n);
+    std::vector<double> predicted(n), fPredicted(n);
+    const double* first = arena.state(0);
+    const double ratio = nu / (nu + 1.0);
+
+    std::copy(first, first + n, ys.begin());
+    kernel.eval(first, fs.data());
+    if (steps > 0) std::copy(fs.begin(), fs.begin() + n, arena.rhs(0));
+    int nextRow = 1;
+
+    for (int m = 1; m <= intervals; ++m) {
+        if (progress && m % kFractionalProgressInterval == 0 && !progress(nextRow)) return false;
+
+        // weights of f_j over [t_j, t_j+1] against (t_m - s)^(nu-1): rectangle d1 for the
+        // predictor, hat functions for the corrector (A^p - B^p via expm1 / log1p)
+        double* acc = &ys[std::size_t(m) * n];
+        for (int i = 0; i < n; ++i) predicted[i] = acc[i] = 0.0;
+        double carry = 0.0;                   // right-end weight of the previous interval
+        for (int j = 0; j < m; ++j) {
+            const double a = t[m] - t[j];
+            const double b = t[m] - t[j + 1];
+            const double width = t[j + 1] - t[j];
+            const double aNu = std::pow(a, nu);
+            const double l = std::log1p(-width / a);
+            const double d1 = -aNu * std::expm1(nu * l);
+            const double d2 = -a * aNu * std::expm1((nu + 1.0) * l);
+            const double left = (ratio * d2 - b * d1) / width;
+            const double cj = left + carry;
+            carry = (a * d1 - ratio * d2) / width;
+
+            const double* f = &fs[std::size_t(j) * n];
+            for (int i = 0; i < n; ++i) {
+                predicted[i] += f[i] * d1;
+                acc[i] += f[i] * cj;
+            }
+        }
+        for (int i = 0; i < n; ++i) predicted[i] += first[i];
+
+        kernel.eval(predicted.data(), fPredicted.data());
+        for (int i = 0; i < n; ++i) acc[i] = first[i] + acc[i] + carry * fPredicted[i];
+        kernel.eval(acc, &fs[std::size_t(m) * n]);
+
+        // reporting rows in (t_m-1, t_m]: linear interpolation between the mesh points
+        const double* prev = &ys[std::size_t(m - 1) * n];
+        for (; nextRow <= steps && (nextRow <= t[m] || m == intervals); ++nextRow) {
+            const double w = (nextRow - t[m - 1]) / (t[m] - t[m - 1]);
+            double* row = arena.state(nextRow);
+            for (int i = 0; i < n; ++i) row[i] = prev[i] + w * (acc[i] - prev[i]);
+            if (nextRow < steps) kernel.eval(row, arena.rhs(nextRow));
+        }
+    }
+    return true;
+}
+
+// Euler over rows from+1..to starting from `start` (not read from the arena, so
+// neighbouring slices can run at the same time); same arithmetic as eulerLoop.
+template <class Kernel>
+void eulerSlice(const Kernel& kernel, const double* start, int from, int to, double h, StateArena& arena)
+{
+    const int n = kernel.nodeCount();
+    const double* prev = start;
+    for (int t = from + 1; t <= to; ++t) {
+        double* dy = arena.rhs(t - 1);
+        double* next = arena.state(t);
+        kernel.eval(prev, dy);
+        for (int i = 0; i < n; ++i) next[i] = prev[i] + h * dy[i];
+        prev = next;
+    }
+}
+
+// count Euler steps of size span*h/count from in to out
+template <class Kernel>
+void eulerCoarse(const Kernel& kernel, const double* in, double* out, int count, double step,
+                 std::vector<double>& dy)
+{
+    const int n = kernel.nodeCount();
+    for (int i = 0; i < n; ++i) out[i] = in[i];
+    for (int c = 0; c < count; ++c) {
+        kernel.eval(out, dy.data());
+        for (int i = 0; i < n; ++i) out[i] += step * dy[i];
+    }
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+bool integrateEuler(const NetworkSpec& spec, const std::vector<double>& y0,
+                    int steps, double h, StateArena& arena,
+                    const SolverProgressFn& progress)
+{
+    prepareArena(arena, spec, y0, steps);
+    bool done = false;
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        done = eulerLoop(kernel, 0, steps, h, arena, progress);
+    });
+    return done;
+}
+
+bool integrateEulerParareal(const NetworkSpec& spec, const std::vector<double>& y0,
+                            int steps, double h, const PararealOptions& options, StateArena& arena,
+                            PararealStats* stats, const SolverProgressFn& progress)
+{
+    const auto wallStart = std::chrono::steady_clock::now();
+    prepareArena(arena, spec, y0, steps);
+
+    const int n = spec.nodeCount;
+    const int slices = std::max(1, std::min(options.slices, steps));
+    const int maxIterations = options.maxIterations > 0 ? std::min(options.maxIterations, slices) : slices;
+    const int coarseRatio = std::max(1, options.coarseRatio);
+
+    std::vector<int> bound(slices + 1);
+    std::vector<int> coarseCount(slices);
+    for (int j = 0; j <= slices; ++j) bound[j] = int(std::int64_t(steps) * j / slices);
+    for (int j = 0; j < slices; ++j)
+        coarseCount[j] = std::max(1, (bound[j + 1] - bound[j] + coarseRatio - 1) / coarseRatio);
+    auto coarseStep = [&](int j) { return h * (bound[j + 1] - bound[j]) / coarseCount[j]; };
+
+    // slice starts U_j, coarse ends G(U_j) and fine ends F(U_j), one row of n per slice
+    std::vector<double> u(std::size_t(slices + 1) * n), uNext(u.size());
+    std::vector<double> gOld(std::size_t(slices) * n), gNew(n), fEnd(std::size_t(slices) * n);
+    auto row = [n](std::vector<double>& v, int j) { return v.data() + std::size_t(j) * n; };
+
+    // workers build their own kernel: bytecode / sparse kernels keep scratch state
+    NetworkSpec workerSpec = spec;
+    workerSpec.threads = 1;
+    WorkerPool pool(std::min(options.threads > 0 ? options.threads : WorkerPool::hardwareThreads(), slices));
+    std::vector<double> workerSeconds(pool.size(), 0.0);
+    std::vector<long long> workerSteps(pool.size(), 0);
+
+    PararealStats st;
+    st.slices = slices;
+    int exact = 0; // slices 0..exact-1 start from the serial solution
+    bool cancelled = false;
+
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        std::vector<double> dy(n);
+
+        // iteration 0: coarse sweep. Coarse steps cost what fine steps cost and run alone on
+        // this thread, so they also time one serial step (threads may share cores)
+        const auto coarseStart = std::chrono::steady_clock::now();
+        std::copy(y0.begin(), y0.begin() + n, row(u, 0));
+        long long coarseSteps = 0;
+        for (int j = 0; j < slices; ++j) {
+            eulerCoarse(kernel, row(u, j), row(gOld, j), coarseCount[j], coarseStep(j), dy);
+            std::copy(row(gOld, j), row(gOld, j) + n, row(u, j + 1));
+            coarseSteps += coarseCount[j];
+        }
+        st.serialSeconds = steps * (secondsSince(coarseStart) / double(coarseSteps));
+
+        while (st.iterations < maxIterations && exact < slices) {
+            if (progress && !progress(bound[exact] + 1)) {
+                cancelled = true;
+                return;
+            }
+
+            // F on every slice that is not final yet, in parallel
+            const int firstOpen = exact;
+            auto fine = [&](int k) {
+                const auto start = std::chrono::steady_clock::now();
+                visitRhsKernel(workerSpec, [&](const auto& workerKernel) {
+                    for (int j = firstOpen + k; j < slices; j += pool.size()) {
+                        eulerSlice(workerKernel, row(u, j), bound[j], bound[j + 1], h, arena);
+                        std::copy(arena.state(bound[j + 1]), arena.state(bound[j + 1]) + n, row(fEnd, j));
+                        workerSteps[k] += bound[j + 1] - bound[j];
+                    }
+                });
+                workerSeconds[k] += secondsSince(start);
+            };
+            pool.run(fine);
+            ++st.iterations;
+
+            // serial correction sweep; the first open slice started exact, so its F end is exact too
+            double change = 0.0;
+            std::copy(row(u, 0), row(u, firstOpen + 1), uNext.begin());
+            std::copy(row(fEnd, firstOpen), row(fEnd, firstOpen) + n, row(uNext, firstOpen + 1));
+            for (int j = firstOpen + 1; j < slices; ++j) {
+                eulerCoarse(kernel, row(uNext, j), gNew.data(), coarseCount[j], coarseStep(j), dy);
+                double* next = row(uNext, j + 1);
+                for (int i = 0; i < n; ++i) next[i] = gNew[i] + row(fEnd, j)[i] - row(gOld, j)[i];
+                std::copy(gNew.begin(), gNew.end(), row(gOld, j));
+            }
+            for (int j = firstOpen + 1; j <= slices; ++j)
+                for (int i = 0; i < n; ++i) {
+                    const double a = row(uNext, j)[i];
+                    change = std::max(change, std::fabs(a - row(u, j)[i]) / (1.0 + std::fabs(a)));
+                }
+            u.swap(uNext);
+            exact = firstOpen + 1;
+
+            // arena rows come from F on the previous starts: within tolerance of the new ones
+            if (change <= options.tolerance) {
+                st.converged = true;
+                break;
+            }
+        }
+        if (exact == slices) st.converged = true;
+    });
+
+    st.exactSlices = exact;
+    for (int k = 0; k < pool.size(); ++k) {
+        st.fineSeconds += workerSeconds[k];
+        st.fineSteps += workerSteps[k];
+    }
+    st.wallSeconds = secondsSince(wallStart);
+    if (stats) *stats = st;
+    return !cancelled;
+}
+
+bool integrateFractional(const NetworkSpec& spec, const std::vector<double>& y0,
+                         int steps, double nu, StateArena& arena,
+                         const SolverProgressFn& progress, FractionalKernel weights)
+{
+    prepareArena(arena, spec, y0, steps);
+    bool done = false;
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        done = fractionalLoop(kernel, 0, steps, nu, weights, arena, progress);
+    });
+    return done;
+}
+
+bool integrateFractional(const NetworkSpec& spec, const std::vector<double>& y0,
+                         int steps, const std::vector<double>& nu, StateArena& arena,
+                         const SolverProgressFn& progress, FractionalKernel weights)
+{
+    if (nu.size() != std::size_t(spec.nodeCount)) return false;
+    const OrderTables orders = orderTables(nu, spec.nodeCount);
+    if (orders.orders.size() <= 1)
+        return integrateFractional(spec, y0, steps, orders.orders.empty() ? 1.0 : orders.orders[0], arena,
+                                   progress, weights);
+
+    prepareArena(arena, spec, y0, steps);
+    arena.setWeightTables(int(orders.orders.size()));
+    bool done = false;
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        done = fractionalMixedLoop(kernel, 0, steps, orders, weights, arena, progress);
+    });
+    return done;
+}
+
+bool integrateFractionalAbm(const NetworkSpec& spec, const std::vector<double>& y0,
+                            int steps, double nu, double h, StateArena& arena,
+                            const SolverProgressFn& progress)
+{
+    prepareArena(arena, spec, y0, steps);
+    bool done = false;
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        done = fractionalAbmLoop(kernel, 0, steps, nu, h, arena, progress);
+    });
+    return done;
+}
+
+double gradedMeshExponent(double nu, double exponent)
+{
+    if (exponent >= 1.0) return exponent;
+    return std::min(kMaxGradedExponent, std::max(1.0, fractionalAbmOrder(nu) / nu));
+}
+
+std::vector<double> gradedMeshTimes(int steps, const GradedMeshOptions& mesh, double exponent)
+{
+    const int graded = std::max(1, mesh.gradedIntervals);
+    const double maxStep = (mesh.maxStep > 0.0) ? mesh.maxStep : 1.0;
+    const double gradedEnd = std::min<double>(steps, graded * maxStep / exponent);
+    const int uniform = int(std::ceil((steps - gradedEnd) / maxStep - 1e-9));
+
+    std::vector<double> t;
+    t.reserve(graded + uniform + 1);
+    for (int m = 0; m < graded; ++m) t.push_back(gradedEnd * std::pow(double(m) / graded, exponent));
+    t.push_back(gradedEnd);
+    for (int k = 1; k < uniform; ++k) t.push_back(gradedEnd + (steps - gradedEnd) * k / uniform);
+    if (uniform > 0) t.push_back(steps);
+    return t;
+}
+
+bool integrateFractionalGraded(const NetworkSpec& spec, const std::vector<double>& y0,
+                               int steps, double nu, const GradedMeshOptions& mesh, StateArena& arena,
+                               const SolverProgressFn& progress)
+{
+    prepareArena(arena, spec, y0, steps);
+    if (steps == 0) return true;
+    const std::vector<double> t = gradedMeshTimes(steps, mesh, gradedMeshExponent(nu, mesh.exponent));
+    bool done = false;
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        done = fractionalGradedLoop(kernel, steps, nu, t, arena, progress);
+    });
+    return done;
+}
+
+bool extendEuler(const NetworkSpec& spec, int toSteps, double h, StateArena& arena,
+                 const SolverProgressFn& progress)
+{
+    const int fromSteps = arena.steps();
+    if (toSteps <= fromSteps) return true;
+    arena.extend(toSteps);
+    bool done = false;
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        done = eulerLoop(kernel, fromSteps, toSteps, h, arena, progress);
+    });
+    return done;
+}
+
+bool extendFractional(const NetworkSpec& spec, int toSteps, double nu, StateArena& arena,
+                      const SolverProgressFn& progress, FractionalKernel weights)
+{
+    const int fromSteps = arena.steps();
+    if (toSteps <= fromSteps) return true;
+    arena.extend(toSteps);
+    bool done = false;
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        done = fractionalLoop(kernel, fromSteps, toSteps, nu, weights, arena, progress);
+    });
+    return done;
+}
+
+bool extendFractional(const NetworkSpec& spec, int toSteps, const std::vector<double>& nu, StateArena& arena,
+                      const SolverProgressFn& progress, FractionalKernel weights)
+{
+    if (nu.size() != std::size_t(spec.nodeCount)) return false;
+    const OrderTables orders = orderTables(nu, spec.nodeCount);
+    if (orders.orders.size() <= 1)
+        return extendFractional(spec, toSteps, orders.orders.empty() ? 1.0 : orders.orders[0], arena,
+                                progress, weights);
+
+    const int fromSteps = arena.steps();
+    if (toSteps <= fromSteps) return true;
+    arena.extend(toSteps);
+    arena.setWeightTables(int(orders.orders.size()));
+    bool done = false;
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        done = fractionalMixedLoop(kernel, fromSteps, toSteps, orders, weights, arena, progress);
+    });
+    return done;
+}
+
+bool extendFractionalAbm(const NetworkSpec& spec, int toSteps, double nu, double h, StateArena& arena,
+                         const SolverProgressFn& progress)
+{
+    const int fromSteps = arena.steps();
+    if (toSteps <= fromSteps) return true;
+    arena.extend(toSteps);
+    bool done = false;
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        done = fractionalAbmLoop(kernel, fromSteps, toSteps, nu, h, arena, progress);
+    });
+    return done;
+}
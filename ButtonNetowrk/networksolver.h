@@ -0,0 +1,138 @@
+#ifndef NETWORKSOLVER_H
+#define NETWORKSOLVER_H
+
+#include "networkspec.h"
+#include "statearena.h"
+
+#include <functional>
+#include <vector>
+
+// Bump whenever a change alters numerical output; it is part of the result cache key.
+constexpr int kSolverVersion = 1;
+
+// Called every few hundred steps at the start of step `step`, i.e. with
+// state(0..step-1) and rhs(0..step-2) complete, so a GUI caller can keep its
+// event loop alive or write a checkpoint. Returning false stops the run.
+using SolverProgressFn = std::function<bool(int step)>;
+
+// Both integrators prepare() the arena for (nodeCount, steps) and leave
+// arena.state(t) = y(t), arena.rhs(t) = f(y(t)) for t < steps.
+// They return false when the progress callback cancelled the run.
+
+// Explicit Euler: y_t = y_{t-1} + h * f(y_{t-1}).
+bool integrateEuler(const NetworkSpec& spec, const std::vector<double>& y0,
+                    int steps, double h, StateArena& arena,
+                    const SolverProgressFn& progress = SolverProgressFn());
+
+// Fractional (GAMMA) rectangle rule: y_om = y_0 + sum_{r=1..om} f(y_{r-1}) * b_{om-r},
+// b_k = (k+1)^nu - k^nu, or the gamma-ratio weights of solver.c (statearena.h). f(y_r) is
+// evaluated once per step and kept as history.
+bool integrateFractional(const NetworkSpec& spec, const std::vector<double>& y0,
+                         int steps, double nu, StateArena& arena,
+                         const SolverProgressFn& progress = SolverProgressFn(),
+                         FractionalKernel kernel = FractionalKernel::PowDifference);
+
+// Mixed orders: node i uses nu[i] (nu = 1 is the ODE y_om = y_om-1 + f(y_om-1) in the GAMMA
+// time unit) in one pass over the shared history. nu must hold exactly spec.nodeCount
+// orders; anything else returns false without integrating. Nodes with the same order share one
+// weight table in the arena, so memory and set-up grow with the number of distinct orders,
+// not with the node count; with a single distinct order this is the function above, bit
+// for bit.
+bool integrateFractional(const NetworkSpec& spec, const std::vector<double>& y0,
+                         int steps, const std::vector<double>& nu, StateArena& arena,
+                         const SolverProgressFn& progress = SolverProgressFn(),
+                         FractionalKernel kernel = FractionalKernel::PowDifference);
+
+// Fractional Adams-Bashforth-Moulton predictor-corrector (Diethelm, PECE) for the same
+// equation as the rectangle rule, on steps of size h in its time unit (h = 1: one GAMMA step):
+//   predictor  y^P_om = y_0 + h^nu sum_{j=0..om-1} b_{om-1-j} f(y_j)
+//   corrector  y_om   = y_0 + h^nu / (nu+1) (f(y^P_om) + a_{om-1} f(y_0) + sum_{j=1..om-1} c_{om-1-j} f(y_j))
+// with the rectangle weights b_k (predictor), the corrector weights c_k of
+// StateArena::correctorWeights and a_n = n^(nu+1) - (n-nu) (n+1)^nu. Both sums run over
+// the same rhs history rows as the rectangle rule. Error O(h^min(2, 1+nu)) against O(h)
+// for the rectangle rule, so far fewer steps reach the same accuracy.
+bool integrateFractionalAbm(const NetworkSpec& spec, const std::vector<double>& y0,
+                            int steps, double nu, double h, StateArena& arena,
+                            const SolverProgressFn& progress = SolverProgressFn());
+
+// Convergence order of integrateFractionalAbm for smooth solutions.
+inline double fractionalAbmOrder(double nu) { return (nu < 1.0) ? 1.0 + nu : 2.0; }
+
+// The same predictor-corrector on a graded mesh: t_m = T0 (m/M)^r for m = 0..M, fine
+// near t = 0 where the solution behaves like t^nu, then steps of about maxStep up to
+// `steps`. T0 = M maxStep / r makes the last graded step about maxStep. The scheme is
+// explicit, so maxStep is bounded by stability like the GAMMA step (maxStep = 1 is one
+// GAMMA step); the gain is that accuracy near t = 0 no longer needs a small step over
+// the whole run. The weights of the history sums depend on both mesh points, so they are
+// evaluated per step (O(N^2) powers) instead of read from the arena. Arena rows
+// t = 0..steps (one per time unit, as for GAMMA) are interpolated linearly between mesh
+// points, and arena.rhs(t) = f(y(t)) as for the other solvers. r = 1 with maxStep = 1 is
+// integrateFractionalAbm with h = 1.
+struct GradedMeshOptions {
+    int gradedIntervals = 128; // M
+    double exponent = 0.0;     // r >= 1; 0: gradedMeshExponent(nu)
+    double maxStep = 1.0;
+};
+
+constexpr double kMaxGradedExponent = 4.0;
+
+// r for an exponent setting: the given r, or min(2, 1+nu) / nu (first step ~ N^-r, so the
+// t^nu start is resolved to the order of the scheme), at most kMaxGradedExponent.
+double gradedMeshExponent(double nu, double exponent);
+// t_0 .. t_N of the mesh over 0..steps for a resolved exponent (t_N exactly steps).
+std::vector<double> gradedMeshTimes(int steps, const GradedMeshOptions& mesh, double exponent);
+
+bool integrateFractionalGraded(const NetworkSpec& spec, const std::vector<double>& y0,
+                               int steps, double nu, const GradedMeshOptions& mesh, StateArena& arena,
+                               const SolverProgressFn& progress = SolverProgressFn());
+
+// Parareal (parallel in time) for the Euler solver: steps are split into `slices`
+// time slices; a coarse Euler propagator G (step coarseRatio * h) runs serially over
+// the slice starts and the fine propagator F (the Euler solver itself) runs on all
+// slices at once, iterating
+//   U_{j+1}^{k+1} = G(U_j^{k+1}) + F(U_j^k) - G(U_j^k)
+// until the slice starts move less than `tolerance`. Slices whose start is already
+// exact are taken from F directly and not solved again, so after `slices` iterations
+// the result is the serial one bit for bit. Results depend on slices / coarseRatio /
+// tolerance, never on the thread count.
+struct PararealOptions {
+    int slices = 16;
+    int coarseRatio = 10;
+    double tolerance = 1e-9;  // max |U_j^k - U_j^(k-1)| / (1 + |U_j^k|) over slice starts
+    int maxIterations = 0;    // 0: slices
+    int threads = 0;          // 0: all cores
+};
+
+struct PararealStats {
+    int slices = 0;
+    int iterations = 0;
+    int exactSlices = 0;      // slices identical to the serial solution
+    bool converged = false;
+    long long fineSteps = 0;  // Euler steps done by F, all iterations
+    double wallSeconds = 0.0;
+    double fineSeconds = 0.0;   // summed over threads
+    double serialSeconds = 0.0; // estimate for integrateEuler: steps * time of one coarse step
+    double speedup() const { return wallSeconds > 0.0 ? serialSeconds / wallSeconds : 0.0; }
+};
+
+// Like integrateEuler; the progress callback runs once per iteration with the exact prefix.
+bool integrateEulerParareal(const NetworkSpec& spec, const std::vector<double>& y0,
+                            int steps, double h, const PararealOptions& options, StateArena& arena,
+                            PararealStats* stats = nullptr,
+                            const SolverProgressFn& progress = SolverProgressFn());
+
+// Continue a finished integration held in the arena from arena.steps() to toSteps.
+// Only the new steps are integrated; the fractional sum reuses the stored rhs
+// history, and the result is identical to integrating 0..toSteps in one go.
+bool extendEuler(const NetworkSpec& spec, int toSteps, double h, StateArena& arena,
+                 const SolverProgressFn& progress = SolverProgressFn());
+bool extendFractional(const NetworkSpec& spec, int toSteps, double nu, StateArena& arena,
+                      const SolverProgressFn& progress = SolverProgressFn(),
+                      FractionalKernel kernel = FractionalKernel::PowDifference);
+bool extendFractional(const NetworkSpec& spec, int toSteps, const std::vector<double>& nu, StateArena& arena,
+                      const SolverProgressFn& progress = SolverProgressFn(),
+                      FractionalKernel kernel = FractionalKernel::PowDifference);
+bool extendFractionalAbm(const NetworkSpec& spec, int toSteps, double nu, double h, StateArena& arena,
+                         const SolverProgressFn& progress = SolverProgressFn());
+
+#endif // NETWORKSOLVER_H
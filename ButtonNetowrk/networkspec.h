@@ -0,0 +1,102 @@
+#ifndef NETWORKSPEC_H
+#define NETWORKSPEC_H
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Plain description of the network the solvers integrate:
+//   dy_i = -y_i + sum_{edges e into i} w_e * fn_e(y_from) + sum_{gates g on i} G_g * tanh(y_i)
+//   G_g  = base - coeff * fn_g(y_source)
+// It has no Qt dependency so the numerics can run without the widget.
+// A spec carrying compiled equations (equationdsl.h) uses those instead of edges/gates;
+// one carrying native code (nativekernel.h) runs that, whatever else it holds.
+
+enum class ActivationKind { Sin, Tanh, Relu, None };
+
+inline double applyActivation(ActivationKind fn, double x)
+{
+    switch (fn) {
+    case ActivationKind::Sin:  return std::sin(x);
+    case ActivationKind::Tanh: return std::tanh(x);
+    case ActivationKind::Relu: return (x > 0.0) ? x : 0.0;
+    case ActivationKind::None: break;
+    }
+    return 0.0;
+}
+
+// d applyActivation / dx (relu: 0 at x = 0)
+inline double activationSlope(ActivationKind fn, double x)
+{
+    switch (fn) {
+    case ActivationKind::Sin:  return std::cos(x);
+    case ActivationKind::Tanh: { const double t = std::tanh(x); return 1.0 - t * t; }
+    case ActivationKind::Relu: return (x > 0.0) ? 1.0 : 0.0;
+    case ActivationKind::None: break;
+    }
+    return 0.0;
+}
+
+struct EdgeSpec {
+    int from = 0;   // 0-based source node
+    int to = 0;     // 0-based target node
+    double weight = 0.0;
+    ActivationKind fn = ActivationKind::None;
+};
+
+struct GateTermSpec {
+    int node = 0;    // node whose equation gets G * tanh(y_node)
+    int source = 0;  // node fed into fn inside G
+    double base = 1.0;
+    double coeff = 1.0;
+    ActivationKind fn = ActivationKind::Tanh;
+};
+
+// Edges / gates touching a node outside [0, nodeCount) are skipped by every kernel
+// (a drawn connection to node 6 of a 5-node network); derived quantities skip them too.
+inline bool edgeInRange(const EdgeSpec& e, int nodeCount)
+{
+    return e.from >= 0 && e.from < nodeCount && e.to >= 0 && e.to < nodeCount;
+}
+
+inline bool gateInRange(const GateTermSpec& g, int nodeCount)
+{
+    return g.node >= 0 && g.node < nodeCount && g.source >= 0 && g.source < nodeCount;
+}
+
+// Memory order of the nodes inside the sparse kernel (nodeordering.h); never changes results.
+enum class NodeOrdering { None, Rcm, Community };
+
+struct EquationProgram;
+struct NativeRhs;
+
+struct NetworkSpec {
+    int nodeCount = 5;
+    std::vector<EdgeSpec> edges;       // summed in this order per target node
+    std::vector<GateTermSpec> gates;   // added after the edges of their node
+    std::shared_ptr<const EquationProgram> equations; // custom Dy_i = ..., replaces edges/gates
+    std::shared_ptr<const NativeRhs> native;          // compiled form of the above, same results
+    int threads = 0; // RHS threads for large networks (sparsekernel.h), 0: all cores; never changes results
+    NodeOrdering ordering = NodeOrdering::None; // large networks only
+};
+
+// Initial state used by every solver path: (0.8, 0.3, 0.4, 0.6, 0.7), then for large
+// networks a fixed pseudo-random value in [-1, 1) per node (splitmix64 of the index),
+// so every node starts somewhere different but runs stay reproducible.
+inline std::vector<double> defaultInitialState(int nodeCount)
+{
+    static const double y0[5] = {0.8, 0.3, 0.4, 0.6, 0.7};
+    std::vector<double> y(nodeCount, 0.0);
+    for (int i = 0; i < nodeCount && i < 5; ++i) y[i] = y0[i];
+    for (int i = 5; i < nodeCount; ++i) {
+        std::uint64_t z = std::uint64_t(i) * 0x9E3779B97F4A7C15ULL + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        y[i] = 2.0 * (double(z >> 11) * (1.0 / 9007199254740992.0)) - 1.0;
+    }
+    return y;
+}
+
+#endif // NETWORKSPEC_H
@@ -0,0 +1,218 @@
+#include "nodeordering.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+const int kLabelPropagationSweeps = 20;
+const int kNearDistance = 512; // doubles per 4 KiB page
+
+// undirected adjacency without self loops
+struct Graph {
+    std::vector<int> start;
+    std::vector<int> adj;
+
+    int degree(int i) const { return start[i + 1] - start[i]; }
+};
+
+bool liveEdge(const EdgeSpec& e, int n)
+{
+    return e.fn != ActivationKind::None && e.from >= 0 && e.from < n && e.to >= 0 && e.to < n
+           && e.from != e.to;
+}
+
+Graph symmetrised(const NetworkSpec& spec)
+{
+    const int n = spec.nodeCount;
+    Graph g;
+    g.start.assign(n + 1, 0);
+    for (const EdgeSpec& e : spec.edges) {
+        if (!liveEdge(e, n)) continue;
+        ++g.start[e.from + 1];
+        ++g.start[e.to + 1];
+    }
+    for (int i = 0; i < n; ++i) g.start[i + 1] += g.start[i];
+    g.adj.resize(g.start[n]);
+    std::vector<int> fill(g.start.begin(), g.start.end() - 1);
+    for (const EdgeSpec& e : spec.edges) {
+        if (!liveEdge(e, n)) continue;
+        g.adj[fill[e.from]++] = e.to;
+        g.adj[fill[e.to]++] = e.from;
+    }
+    return g;
+}
+
+// asynchronous label propagation in node order; ties keep the current label, else the smallest
+std::vector<int> communities(const Graph& g, int n)
+{
+    std::vector<int> label(n);
+    for (int i = 0; i < n; ++i) label[i] = i;
+
+    std::vector<int> count(n, 0);
+    std::vector<int> seen;
+    for (int sweep = 0; sweep < kLabelPropagationSweeps; ++sweep) {
+        bool changed = false;
+        for (int i = 0; i < n; ++i) {
+            if (g.degree(i) == 0) continue;
+            seen.clear();
+            for (int k = g.start[i]; k < g.start[i + 1]; ++k) {
+                const int l = label[g.adj[k]];
+                if (count[l]++ == 0) seen.push_back(l);
+            }
+            int best = label[i];
+            int bestCount = count[best]; // 0 when no neighbour has it
+            for (int l : seen) {
+                if (count[l] > bestCount || (count[l] == bestCount && best != label[i] && l < best)) {
+                    best = l;
+                    bestCount = count[l];
+                }
+            }
+            for (int l : seen) count[l] = 0;
+            if (best != label[i]) {
+                label[i] = best;
+                changed = true;
+            }
+        }
+        if (!changed) break;
+    }
+    return label;
+}
+
+// BFS levels from s inside the nodes allowed by keep(); returns the last level
+template <class Keep>
+std::vector<int> lastLevel(const Graph& g, int s, std::vector<int>& mark, int stamp, const Keep& keep, int& depth)
+{
+    std::vector<int> level{s}, next;
+    mark[s] = stamp;
+    depth = 0;
+    for (;;) {
+        next.clear();
+        for (int v : level)
+            for (int k = g.start[v]; k < g.start[v + 1]; ++k) {
+                const int w = g.adj[k];
+                if (mark[w] != stamp && keep(v, w)) {
+                    mark[w] = stamp;
+                    next.push_back(w);
+                }
+            }
+        if (next.empty()) return level;
+        level.swap(next);
+        ++depth;
+    }
+}
+
+// Cuthill-McKee over the components of the graph restricted by keep(); reversed at the end.
+template <class Keep>
+std::vector<int> cuthillMcKee(const Graph& g, int n, const Keep& keep)
+{
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<char> placed(n, 0);
+    std::vector<int> mark(n, -1);
+    int stamp = 0;
+    std::vector<int> neighbours;
+
+    for (int s = 0; s < n; ++s) {
+        if (placed[s]) continue;
+
+        // pseudo-peripheral start: move to a min-degree node of the last BFS level while it gets deeper
+        int root = s;
+        int depth = -1;
+        for (int tries = 0; tries < 4; ++tries) {
+            int d = 0;
+            const std::vector<int> last = lastLevel(g, root, mark, stamp++, keep, d);
+            if (d <= depth) break;
+            depth = d;
+            root = *std::min_element(last.begin(), last.end(), [&](int a, int b) {
+                return g.degree(a) != g.degree(b) ? g.degree(a) < g.degree(b) : a < b;
+            });
+        }
+
+        std::size_t head = order.size();
+        order.push_back(root);
+        placed[root] = 1;
+        while (head < order.size()) {
+            const int v = order[head++];
+            neighbours.clear();
+            for (int k = g.start[v]; k < g.start[v + 1]; ++k) {
+                const int w = g.adj[k];
+                if (!placed[w] && keep(v, w)) {
+                    placed[w] = 1;
+                    neighbours.push_back(w);
+                }
+            }
+            std::sort(neighbours.begin(), neighbours.end(), [&](int a, int b) {
+                return g.degree(a) != g.degree(b) ? g.degree(a) < g.degree(b) : a < b;
+            });
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+} // namespace
+
+std::vector<int> computeNodeOrdering(const NetworkSpec& spec, NodeOrdering ordering)
+{
+    const int n = spec.nodeCount;
+    std::vector<int> newIndex(n);
+    for (int i = 0; i < n; ++i) newIndex[i] = i;
+    if (ordering == NodeOrdering::None || n < 3) return newIndex;
+
+    const Graph g = symmetrised(spec);
+    std::vector<int> order;
+    if (ordering == NodeOrdering::Rcm) {
+        order = cuthillMcKee(g, n, [](int, int) { return true; });
+    } else {
+        const std::vector<int> label = communities(g, n);
+        order = cuthillMcKee(g, n, [&](int v, int w) { return label[v] == label[w]; });
+    }
+
+    for (int r = 0; r < n; ++r) newIndex[order[r]] = r;
+    return newIndex;
+}
+
+OrderingMetrics orderingMetrics(const NetworkSpec& spec, const std::vector<int>& newIndex)
+{
+    const int n = spec.nodeCount;
+    OrderingMetrics m;
+    long long count = 0, near = 0;
+    double total = 0.0;
+    for (const EdgeSpec& e : spec.edges) {
+        if (e.fn == ActivationKind::None || e.from < 0 || e.from >= n || e.to < 0 || e.to >= n) continue;
+        const int a = newIndex.empty() ? e.from : newIndex[e.from];
+        const int b = newIndex.empty() ? e.to : newIndex[e.to];
+        const int d = std::abs(a - b);
+        m.bandwidth = std::max(m.bandwidth, d);
+        total += d;
+        if (d < kNearDistance) ++near;
+        ++count;
+    }
+    if (count > 0) {
+        m.meanDistance = total / double(count);
+        m.nearFraction = double(near) / double(count);
+    }
+    return m;
+}
+
+const char* nodeOrderingName(NodeOrdering ordering)
+{
+    switch (ordering) {
+    case NodeOrdering::None:      return "none";
+    case NodeOrdering::Rcm:       return "rcm";
+    case NodeOrdering::Community: return "community";
+    }
+    return "none";
+}
+
+bool nodeOrderingFromName(const std::string& name, NodeOrdering& ordering)
+{
+    if (name == "none" || name.empty()) ordering = NodeOrdering::None;
+    else if (name == "rcm") ordering = NodeOrdering::Rcm;
+    else if (name == "community") ordering = NodeOrdering::Community;
+    else return false;
+    return true;
+}
@@ -0,0 +1,31 @@
+#ifndef NODEORDERING_H
+#define NODEORDERING_H
+
+#include <string>
+#include <vector>
+
+#include "networkspec.h"
+
+// Internal node order for the sparse kernel. Only the memory layout changes: the
+// kernel gathers fn(y_j) from a buffer in this order, so rows that share sources
+// read neighbouring cache lines. y, dy and every output keep the user's numbering,
+// and results are identical to the unordered run.
+//   rcm:       Reverse Cuthill-McKee on the symmetrised graph (small bandwidth)
+//   community: label propagation, then RCM inside each community, communities back to back
+
+// newIndex[i] = position of node i in the chosen order (identity for NodeOrdering::None)
+std::vector<int> computeNodeOrdering(const NetworkSpec& spec, NodeOrdering ordering);
+
+struct OrderingMetrics {
+    int bandwidth = 0;          // max |pos(from) - pos(to)| over edges
+    double meanDistance = 0.0;  // mean |pos(from) - pos(to)|
+    double nearFraction = 0.0;  // edges with |pos(from) - pos(to)| < 512 (within one 4 KiB page of y)
+};
+
+// newIndex empty: the user's order
+OrderingMetrics orderingMetrics(const NetworkSpec& spec, const std::vector<int>& newIndex = {});
+
+const char* nodeOrderingName(NodeOrdering ordering);
+bool nodeOrderingFromName(const std::string& name, NodeOrdering& ordering);
+
+#endif // NODEORDERING_H
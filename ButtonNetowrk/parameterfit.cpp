@@ -0,0 +1,281 @@
+#include "parameterfit.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+
+#include "equilibrium.h"
+#include "networksolver.h"
+#include "workerpool.h"
+
+namespace {
+
+// whole token as a double ("nan" included)
+bool parseNumber(const std::string& token, double& value)
+{
+    const char* begin = token.c_str();
+    char* end = nullptr;
+    value = std::strtod(begin, &end);
+    return end != begin && *end == '\0';
+}
+
+// Start 0: p0; start s: p0 * (1 + u) + u per parameter, u from splitmix64 of (seed, s, k)
+void startValues(const std::vector<double>& p0, const FitSettings& s, int start, std::vector<double>& p)
+{
+    p = p0;
+    if (start == 0) return;
+    for (std::size_t k = 0; k < p.size(); ++k) {
+        std::uint64_t z = s.randomSeed * 0x9E3779B97F4A7C15ULL + std::uint64_t(start) * 0xD1B54A32D192ED03ULL
+                          + std::uint64_t(k) * 0x8CB92BA72F3D8DD7ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        const double u = s.startSpread * (2.0 * (double(z >> 11) * (1.0 / 9007199254740992.0)) - 1.0);
+        p[k] = p0[k] * (1.0 + u) + u;
+    }
+}
+
+// Levenberg-Marquardt for one start; worker-local scratch
+class StartFitter
+{
+public:
+    StartFitter(const FitModelFn& model, const std::vector<double>& y0, int steps, double h,
+                const FitTarget& target, const FitSettings& settings, const std::atomic<bool>& stop)
+        : model(model), y0(y0), steps(steps), h(h), target(target), s(settings), stop(stop) {}
+
+    FitStart run(const std::vector<double>& start)
+    {
+        const int m = int(start.size());
+        FitStart r;
+        r.initial = start;
+        std::vector<double> p = start, trial(m), a, step;
+        double cost = linearise(p);
+        r.initialCost = cost;
+        double lambda = s.lambda;
+
+        while (r.iterations < s.maxIterations && !stop && std::isfinite(cost)) {
+            if (poll) poll();
+            double trialCost = std::numeric_limits<double>::infinity();
+            double stepSize = 0.0;
+            bool accepted = false;
+            for (int attempt = 0; attempt < 16 && !accepted; ++attempt) {
+                // (J^T J + lambda diag(J^T J)) step = -J^T r
+                double diagMax = 0.0;
+                for (int k = 0; k < m; ++k) diagMax = std::max(diagMax, jtj[std::size_t(k) * m + k]);
+                a = jtj;
+                step.assign(m, 0.0);
+                for (int k = 0; k < m; ++k) {
+                    a[std::size_t(k) * m + k] += lambda * std::max(jtj[std::size_t(k) * m + k], 1e-12 * diagMax);
+                    step[k] = -jtr[k];
+                }
+                if (diagMax == 0.0 || !solveDenseSystem(m, a, step)) break;
+                stepSize = 0.0;
+                for (int k = 0; k < m; ++k) {
+                    trial[k] = p[k] + step[k];
+                    stepSize = std::max(stepSize, std::fabs(step[k]) / (1.0 + std::fabs(p[k])));
+                }
+                trialCost = costAt(trial);
+                if (trialCost < cost) accepted = true;
+                else lambda *= 4.0;
+            }
+            if (!accepted) {
+                // no decrease left at working precision: a minimum
+                r.converged = stepSize < 1e-8 || lambda > 1e8;
+                break;
+            }
+            ++r.iterations;
+            lambda = std::max(lambda / 3.0, 1e-12);
+            const double decrease = (cost - trialCost) / std::max(cost, 1e-300);
+            p = trial;
+            cost = linearise(p);
+            if (decrease < s.tolerance || cost == 0.0) {
+                r.converged = true;
+                break;
+            }
+        }
+        r.fitted = p;
+        r.cost = cost;
+        return r;
+    }
+
+    long long runs = 0;
+    std::function<void()> poll; // worker 0: progress / cancel between iterations
+
+private:
+    // cost of a plain run at p
+    double costAt(const std::vector<double>& p)
+    {
+        model(p, spec, shifted);
+        spec.threads = 1;
+        ++runs;
+        integrateEuler(spec, y0, steps, h, arena);
+        double cost = 0.0;
+        for (int t = 0; t <= steps; ++t)
+            for (int i = 0; i < target.columns; ++i) {
+                const double want = target.at(t, i);
+                if (!std::isfinite(want)) continue;
+                const double r = arena.at(t, i) - want;
+                cost += 0.5 * r * r;
+            }
+        return std::isfinite(cost) ? cost : std::numeric_limits<double>::infinity();
+    }
+
+    // cost, J^T J and J^T r at p from one sensitivity run
+    double linearise(const std::vector<double>& p)
+    {
+        const int m = int(p.size());
+        model(p, spec, shifted);
+        spec.threads = 1;
+        ++runs;
+        integrateEulerSensitivity(spec, y0, steps, h, shifted, arena, sens);
+        jtj.assign(std::size_t(m) * m, 0.0);
+        jtr.assign(m, 0.0);
+        double cost = 0.0;
+        for (int t = 0; t <= steps; ++t)
+            for (int i = 0; i < target.columns; ++i) {
+                const double want = target.at(t, i);
+                if (!std::isfinite(want)) continue;
+                const double r = arena.at(t, i) - want;
+                cost += 0.5 * r * r;
+                for (int k = 0; k < m; ++k) {
+                    const double jk = sens.at(t, k, i);
+                    jtr[k] += jk * r;
+                    for (int l = 0; l <= k; ++l) jtj[std::size_t(k) * m + l] += jk * sens.at(t, l, i);
+                }
+            }
+        for (int k = 0; k < m; ++k)
+            for (int l = 0; l < k; ++l) jtj[std::size_t(l) * m + k] = jtj[std::size_t(k) * m + l];
+        return std::isfinite(cost) ? cost : std::numeric_limits<double>::infinity();
+    }
+
+    const FitModelFn& model;
+    const std::vector<double>& y0;
+    const int steps;
+    const double h;
+    const FitTarget& target;
+    const FitSettings& s;
+    const std::atomic<bool>& stop;
+
+    NetworkSpec spec;
+    std::vector<SensitivityParameter> shifted;
+    StateArena arena;
+    SensitivityResult sens;
+    std::vector<double> jtj, jtr;
+};
+
+} // namespace
+
+bool parseFitTarget(const std::string& text, FitTarget& target, std::string* error)
+{
+    target = FitTarget();
+    std::istringstream in(text);
+    std::string line;
+    bool timeColumn = false;
+    bool seenData = false;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        const std::size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        std::vector<std::string> tokens;
+        std::string token;
+        while (fields >> token) tokens.push_back(token);
+        if (tokens.empty()) continue;
+
+        std::vector<double> row;
+        bool numeric = true;
+        for (const std::string& t : tokens) {
+            double v = 0.0;
+            if (!parseNumber(t, v)) {
+                numeric = false;
+                break;
+            }
+            row.push_back(v);
+        }
+        if (!numeric) {
+            // header: "t,y1,y2,..." drops the step column
+            if (!seenData && (tokens[0] == "t" || tokens[0] == "step")) timeColumn = true;
+            continue;
+        }
+        if (timeColumn) row.erase(row.begin());
+        if (row.empty()) continue;
+        if (!seenData) target.columns = int(row.size());
+        seenData = true;
+        if (int(row.size()) != target.columns) {
+            if (error) *error = "line " + std::to_string(lineNo) + ": " + std::to_string(row.size())
+                                + " columns, expected " + std::to_string(target.columns);
+            target = FitTarget();
+            return false;
+        }
+        target.values.insert(target.values.end(), row.begin(), row.end());
+        ++target.rows;
+    }
+    if (target.rows == 0) {
+        if (error) *error = "no numeric rows";
+        return false;
+    }
+    return true;
+}
+
+double FitResult::rmsError(int start) const
+{
+    if (start < 0 || start >= int(starts.size()) || residuals == 0) return 0.0;
+    return std::sqrt(2.0 * starts[start].cost / double(residuals));
+}
+
+bool fitParameters(const FitModelFn& model, const std::vector<std::string>& names, const std::vector<double>& p0,
+                   const std::vector<double>& y0, int steps, double h, const FitTarget& target,
+                   const FitSettings& settings, FitResult& result, const FitProgressFn& progress)
+{
+    const auto wallStart = std::chrono::steady_clock::now();
+    result = FitResult();
+    result.settings = settings;
+    result.settings.starts = std::max(1, settings.starts);
+    result.names = names;
+    const FitSettings& s = result.settings;
+    for (int t = 0; t <= steps; ++t)
+        for (int i = 0; i < target.columns; ++i)
+            if (std::isfinite(target.at(t, i))) ++result.residuals;
+
+    WorkerPool pool(std::min(s.threads > 0 ? s.threads : WorkerPool::hardwareThreads(), s.starts));
+    std::vector<FitStart> starts(s.starts);
+    std::vector<long long> runs(pool.size(), 0);
+    std::atomic<int> nextStart(0);
+    std::atomic<int> startsDone(0);
+    std::atomic<bool> stop(false);
+
+    auto job = [&](int k) {
+        StartFitter fitter(model, y0, steps, h, target, s, stop);
+        if (k == 0 && progress)
+            fitter.poll = [&]() {
+                if (!progress(startsDone)) stop = true;
+            };
+        std::vector<double> p;
+        for (;;) {
+            const int start = nextStart++;
+            if (start >= s.starts || stop) break;
+            startValues(p0, s, start, p);
+            starts[start] = fitter.run(p);
+            ++startsDone;
+            if (k == 0 && progress && !progress(startsDone)) stop = true;
+        }
+        runs[k] = fitter.runs;
+    };
+    pool.run(job);
+    if (stop) return false;
+
+    result.starts = std::move(starts);
+    for (long long r : runs) result.runs += r;
+    for (int i = 0; i < int(result.starts.size()); ++i)
+        if (std::isfinite(result.starts[i].cost)
+            && (result.best < 0 || result.starts[i].cost < result.starts[result.best].cost))
+            result.best = i;
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef PARAMETERFIT_H
+#define PARAMETERFIT_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "networkspec.h"
+#include "sensitivity.h"
+
+// Least-squares fit of network parameters (weights, alphas, gate coefficients) to a
+// recorded trajectory of an ODE (Euler) run:
+//   minimise C(p) = 1/2 sum_{t, i} (y_i(t; p) - target_i(t))^2
+// over the target rows t = 0..rows-1 (row t = step t) and its columns i (nodes 1..columns);
+// non-finite target entries are missing values. Levenberg-Marquardt: the residual Jacobian
+// d y_i(t) / d p_k comes from one sensitivity run per iteration (sensitivity.h), whose
+// J^T J and J^T r are accumulated directly, so a step costs one augmented run plus one
+// plain run per trial damping. Several start points (the given values, then random
+// relative perturbations of them) run in parallel; the lowest cost wins. The result does
+// not depend on the thread count.
+
+struct FitTarget {
+    int rows = 0;
+    int columns = 0;
+    std::vector<double> values;    // row-major, rows x columns
+
+    double at(int t, int i) const { return values[std::size_t(t) * columns + i]; }
+};
+
+// result.dat / table.txt style text: one row per step, columns separated by spaces, tabs
+// or commas. '#' comments and non-numeric lines (headers) are skipped; "nan" marks a
+// missing value. With a leading "t" header column (result_stream.csv) that column is dropped.
+bool parseFitTarget(const std::string& text, FitTarget& target, std::string* error = nullptr);
+
+struct FitSettings {
+    int starts = 8;                // start points: the given values, then random ones
+    double startSpread = 0.5;      // random starts: p * (1 + u) + u, u uniform in [-spread, spread]
+    std::uint64_t randomSeed = 1;
+    int maxIterations = 100;       // accepted Levenberg-Marquardt steps per start
+    double tolerance = 1e-10;      // stop when the cost drops by less than this (relative)
+    double lambda = 1e-3;          // initial damping, relative to diag(J^T J)
+    int threads = 0;               // 0: all cores
+};
+
+struct FitStart {
+    std::vector<double> initial;
+    std::vector<double> fitted;
+    double initialCost = 0.0;
+    double cost = 0.0;
+    int iterations = 0;
+    bool converged = false;        // false: iteration limit, or the damping ran away
+};
+
+struct FitResult {
+    FitSettings settings;
+    std::vector<std::string> names;
+    std::vector<FitStart> starts;
+    int best = -1;                 // start with the lowest cost
+    long long residuals = 0;       // finite target entries
+    long long runs = 0;            // plain + sensitivity runs, all starts
+    double wallSeconds = 0.0;
+
+    double rmsError(int start) const;
+};
+
+// The network with parameter values p (built on worker threads, so it must not share
+// mutable state), and for each parameter the network at p_k -+ delta (sensitivity.h).
+using FitModelFn = std::function<void(const std::vector<double>& p, NetworkSpec& spec,
+                                      std::vector<SensitivityParameter>& shifted)>;
+// Called on the calling thread between iterations with the number of finished starts;
+// false cancels.
+using FitProgressFn = std::function<bool(int startsDone)>;
+
+// steps + 1 rows of the target are fitted (target.rows >= steps + 1, target.columns <= nodes).
+// Returns false when cancelled.
+bool fitParameters(const FitModelFn& model, const std::vector<std::string>& names, const std::vector<double>& p0,
+                   const std::vector<double>& y0, int steps, double h, const FitTarget& target,
+                   const FitSettings& settings, FitResult& result, const FitProgressFn& progress = FitProgressFn());
+
+#endif // PARAMETERFIT_H
@@ -0,0 +1,365 @@
+#include "planescan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "rhskernel.h"
+#include "workerpool.h"
+
+namespace {
+
+const int kCoarsestStride = 8;
+const int kLyapunovRenormalise = 8; // steps between renormalisations of the perturbation
+const double kLyapunovDelta = 1e-8;
+const double kDriftRatio = 0.1;     // tail halves whose ranges differ more than this are still moving
+
+// Largest Lyapunov exponent along rows start..steps of an Euler trajectory: a copy
+// perturbed by kLyapunovDelta is stepped next to it and pulled back every few steps.
+template <class Kernel>
+double lyapunovExponent(const Kernel& kernel, const StateArena& y, int start, double h)
+{
+    const int n = kernel.nodeCount();
+    const int steps = y.steps();
+    std::vector<double> z(n), dz(n);
+    const double* y0 = y.state(start);
+    for (int i = 0; i < n; ++i) z[i] = y0[i] + kLyapunovDelta / std::sqrt(double(n));
+
+    double sum = 0.0;
+    for (int t = start; t < steps; ++t) {
+        kernel.eval(z.data(), dz.data());
+        for (int i = 0; i < n; ++i) z[i] += h * dz[i];
+        if ((t - start + 1) % kLyapunovRenormalise != 0 && t + 1 < steps) continue;
+
+        const double* ref = y.state(t + 1);
+        double d2 = 0.0;
+        for (int i = 0; i < n; ++i) d2 += (z[i] - ref[i]) * (z[i] - ref[i]);
+        const double d = std::max(std::sqrt(d2), 1e-300);
+        sum += std::log(d / kLyapunovDelta);
+        for (int i = 0; i < n; ++i) z[i] = ref[i] + (z[i] - ref[i]) * (kLyapunovDelta / d);
+    }
+    return sum / (double(steps - start) * h);
+}
+
+// Work-stealing tile queues: the owner pops from the front, thieves take from the back.
+class TileQueues
+{
+public:
+    TileQueues(int workers, int tiles) : queues(workers)
+    {
+        for (int k = 0; k < workers; ++k) {
+            queues[k].reset(new Queue);
+            for (int t = int(std::int64_t(tiles) * k / workers); t < int(std::int64_t(tiles) * (k + 1) / workers); ++t)
+                queues[k]->tiles.push_back(t);
+        }
+    }
+
+    bool take(int worker, int& tile)
+    {
+        const int count = int(queues.size());
+        for (int j = 0; j < count; ++j) {
+            Queue& q = *queues[(worker + j) % count];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tiles.empty()) continue;
+            if (j == 0) {
+                tile = q.tiles.front();
+                q.tiles.pop_front();
+            } else {
+                tile = q.tiles.back();
+                q.tiles.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<int> tiles;
+    };
+    std::vector<std::unique_ptr<Queue>> queues;
+};
+
+void putU32(std::string& out, std::uint32_t v)
+{
+    for (int k = 0; k < 4; ++k) out.push_back(char((v >> (8 * k)) & 0xff));
+}
+
+void putF64(std::string& out, double v)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof bits);
+    for (int k = 0; k < 8; ++k) out.push_back(char((bits >> (8 * k)) & 0xff));
+}
+
+void putF32(std::string& out, float v)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &v, sizeof bits);
+    putU32(out, bits);
+}
+
+void putName(std::string& out, const std::string& name)
+{
+    std::string field = name.substr(0, 16);
+    field.resize(16, '\0');
+    out += field;
+}
+
+void regimeColour(const PlaneCell& cell, unsigned char rgb[3])
+{
+    static const unsigned char periodColour[][3] = {
+        {44, 160, 44},  {255, 127, 14}, {148, 103, 189}, {23, 190, 207},
+        {227, 119, 194}, {188, 189, 34}, {140, 86, 75},   {127, 127, 127},
+    };
+    auto set = [&](int r, int g, int b) {
+        rgb[0] = (unsigned char)r;
+        rgb[1] = (unsigned char)g;
+        rgb[2] = (unsigned char)b;
+    };
+    switch (cell.regime) {
+    case PlaneRegime::Pending:       set(255, 255, 255); return;
+    case PlaneRegime::Fixed:         set(31, 119, 180); return;
+    case PlaneRegime::Periodic: {
+        const int k = std::min(std::max(int(cell.period), 1), 8) - 1;
+        set(periodColour[k][0], periodColour[k][1], periodColour[k][2]);
+        return;
+    }
+    case PlaneRegime::Quasiperiodic: set(255, 221, 87); return;
+    case PlaneRegime::Chaotic:       set(214, 39, 40); return;
+    case PlaneRegime::Irregular:     set(255, 152, 150); return;
+    case PlaneRegime::Drifting:      set(199, 199, 199); return;
+    case PlaneRegime::Diverged:      set(0, 0, 0); return;
+    }
+    set(255, 255, 255);
+}
+
+} // namespace
+
+double PlaneGrid::cellX(int c) const
+{
+    if (settings.width < 2) return settings.xMin;
+    return settings.xMin + (settings.xMax - settings.xMin) * c / double(settings.width - 1);
+}
+
+double PlaneGrid::cellY(int r) const
+{
+    if (settings.height < 2) return settings.yMin;
+    return settings.yMin + (settings.yMax - settings.yMin) * r / double(settings.height - 1);
+}
+
+const PlaneCell& PlaneGrid::preview(int r, int c) const
+{
+    const PlaneCell& own = cells[std::size_t(r) * settings.width + c];
+    if (own.regime != PlaneRegime::Pending || stride == 0) return own;
+    return cells[std::size_t(r - r % stride) * settings.width + (c - c % stride)];
+}
+
+PlaneCell classifyTrajectory(const NetworkSpec& spec, const StateArena& y, double h,
+                             const PlaneScanSettings& s)
+{
+    PlaneCell cell;
+    const int n = y.nodeCount();
+    const int steps = y.steps();
+    const int start = std::min(std::max(int(std::floor(steps * (s.transientPercent / 100.0))), 0), steps);
+
+    // range of every node over the tail; the widest one is observed
+    std::vector<double> lo(y.state(start), y.state(start) + n), hi = lo;
+    for (int t = start; t <= steps; ++t) {
+        const double* row = y.state(t);
+        for (int i = 0; i < n; ++i) {
+            if (!(std::fabs(row[i]) <= s.divergeLimit)) {
+                cell.regime = PlaneRegime::Diverged;
+                return cell;
+            }
+            lo[i] = std::min(lo[i], row[i]);
+            hi[i] = std::max(hi[i], row[i]);
+        }
+    }
+    int o = 0;
+    bool still = true;
+    for (int i = 0; i < n; ++i) {
+        if (hi[i] - lo[i] > hi[o] - lo[o]) o = i;
+        if (hi[i] - lo[i] > s.fixedTolerance * (1.0 + std::fabs(hi[i]))) still = false;
+    }
+    const double amplitude = hi[o] - lo[o];
+    cell.amplitude = float(amplitude);
+    if (still) {
+        cell.regime = PlaneRegime::Fixed;
+        return cell;
+    }
+
+    // maxima of the observed node, refined by a parabola through the three samples
+    std::vector<double> peaks;
+    for (int t = start + 1; t < steps; ++t) {
+        const double a = y.at(t - 1, o), b = y.at(t, o), c = y.at(t + 1, o);
+        if (!(b > a && b >= c)) continue;
+        const double curve = a - 2.0 * b + c;
+        peaks.push_back(curve < 0.0 ? b - (c - a) * (c - a) / (8.0 * curve) : b);
+    }
+
+    // a decaying or growing oscillation has different ranges in the two tail halves
+    const int middle = start + (steps - start) / 2;
+    double lo1 = y.at(start, o), hi1 = lo1, lo2 = y.at(middle, o), hi2 = lo2;
+    for (int t = start; t <= middle; ++t) {
+        lo1 = std::min(lo1, y.at(t, o));
+        hi1 = std::max(hi1, y.at(t, o));
+    }
+    for (int t = middle; t <= steps; ++t) {
+        lo2 = std::min(lo2, y.at(t, o));
+        hi2 = std::max(hi2, y.at(t, o));
+    }
+    const bool settledRange = std::fabs((hi2 - lo2) - (hi1 - lo1)) <= kDriftRatio * (hi1 - lo1);
+
+    if (peaks.size() < 2) {
+        cell.regime = PlaneRegime::Drifting;
+        return cell;
+    }
+
+    std::sort(peaks.begin(), peaks.end());
+    int levels = 1;
+    for (std::size_t k = 1; k < peaks.size(); ++k)
+        if (peaks[k] - peaks[k - 1] > s.maximaTolerance * amplitude) ++levels;
+
+    if (levels <= s.maxPeriod) {
+        cell.regime = settledRange ? PlaneRegime::Periodic : PlaneRegime::Drifting;
+        cell.period = std::uint8_t(levels);
+        if (!settledRange) cell.period = 0;
+        return cell;
+    }
+
+    if (h <= 0.0) {
+        cell.regime = settledRange ? PlaneRegime::Irregular : PlaneRegime::Drifting;
+        return cell;
+    }
+
+    NetworkSpec single = spec;
+    single.threads = 1;
+    double lambda = 0.0;
+    visitRhsKernel(single, [&](const auto& kernel) { lambda = lyapunovExponent(kernel, y, start, h); });
+    cell.lyapunov = float(lambda);
+    if (lambda > s.lyapunovThreshold) cell.regime = PlaneRegime::Chaotic;
+    else if (lambda < -s.lyapunovThreshold) cell.regime = PlaneRegime::Drifting; // still converging
+    else cell.regime = PlaneRegime::Quasiperiodic;
+    return cell;
+}
+
+int planeScanThreads(const PlaneScanSettings& settings)
+{
+    return settings.threads > 0 ? settings.threads : WorkerPool::hardwareThreads();
+}
+
+bool scanPlane(const PlaneScanSettings& settings, PlaneGrid& grid, const PlaneCellFn& cell,
+               const PlaneProgressFn& progress)
+{
+    const auto wallStart = std::chrono::steady_clock::now();
+
+    grid = PlaneGrid();
+    grid.settings = settings;
+    grid.settings.width = std::max(1, settings.width);
+    grid.settings.height = std::max(1, settings.height);
+    grid.settings.tileSize = std::max(1, settings.tileSize);
+    const PlaneScanSettings& s = grid.settings;
+    const int width = s.width;
+    const int height = s.height;
+    grid.cells.assign(std::size_t(width) * height, PlaneCell());
+
+    const int tilesX = (width + s.tileSize - 1) / s.tileSize;
+    const int tilesY = (height + s.tileSize - 1) / s.tileSize;
+    WorkerPool pool(planeScanThreads(s));
+    std::atomic<bool> stop(false);
+    std::atomic<long long> computed(0);
+
+    for (int stride = kCoarsestStride; stride >= 1; stride /= 2) {
+        // cells of this pass: on the stride lattice, not on the previous (coarser) one
+        auto inPass = [&](int r, int c) {
+            if (r % stride || c % stride) return false;
+            return stride == kCoarsestStride || (r % (2 * stride)) || (c % (2 * stride));
+        };
+
+        TileQueues queues(pool.size(), tilesX * tilesY);
+        auto job = [&](int k) {
+            int tile;
+            while (!stop && queues.take(k, tile)) {
+                const int r0 = (tile / tilesX) * s.tileSize, c0 = (tile % tilesX) * s.tileSize;
+                for (int r = r0; r < std::min(r0 + s.tileSize, height); ++r)
+                    for (int c = c0; c < std::min(c0 + s.tileSize, width); ++c) {
+                        if (!inPass(r, c)) continue;
+                        grid.cells[std::size_t(r) * width + c] = cell(k, r, c);
+                        ++computed;
+                    }
+                if (k == 0 && progress) {
+                    grid.computed = computed;
+                    if (!progress(grid, false)) stop = true;
+                }
+            }
+        };
+        pool.run(job);
+        grid.computed = computed;
+        if (stop) return false;
+
+        grid.stride = stride;
+        grid.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        if (progress && !progress(grid, true)) return false;
+    }
+    return true;
+}
+
+std::string planeGridBinary(const PlaneGrid& grid)
+{
+    const PlaneScanSettings& s = grid.settings;
+    std::string out = "BNPLANE1";
+    putU32(out, std::uint32_t(s.width));
+    putU32(out, std::uint32_t(s.height));
+    putU32(out, std::uint32_t(grid.stride));
+    putF64(out, s.xMin);
+    putF64(out, s.xMax);
+    putF64(out, s.yMin);
+    putF64(out, s.yMax);
+    putName(out, s.xParam);
+    putName(out, s.yParam);
+    out.reserve(out.size() + grid.cells.size() * 10);
+    for (const PlaneCell& c : grid.cells) {
+        out.push_back(char(c.regime));
+        out.push_back(char(c.period));
+        putF32(out, c.lyapunov);
+        putF32(out, c.amplitude);
+    }
+    return out;
+}
+
+std::string planeImagePpm(const PlaneGrid& grid)
+{
+    const int width = grid.settings.width;
+    const int height = grid.settings.height;
+    std::string image = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    const std::size_t header = image.size();
+    image.resize(header + std::size_t(width) * height * 3);
+    unsigned char* px = reinterpret_cast<unsigned char*>(&image[header]);
+    for (int row = 0; row < height; ++row) {
+        const int r = height - 1 - row; // yMax on top
+        for (int c = 0; c < width; ++c, px += 3) regimeColour(grid.preview(r, c), px);
+    }
+    return image;
+}
+
+const char* planeRegimeName(PlaneRegime regime)
+{
+    switch (regime) {
+    case PlaneRegime::Pending:       return "pending";
+    case PlaneRegime::Fixed:         return "fixed";
+    case PlaneRegime::Periodic:      return "periodic";
+    case PlaneRegime::Quasiperiodic: return "quasiperiodic";
+    case PlaneRegime::Chaotic:       return "chaotic";
+    case PlaneRegime::Irregular:     return "irregular";
+    case PlaneRegime::Drifting:      return "drifting";
+    case PlaneRegime::Diverged:      return "diverged";
+    }
+    return "pending";
+}
@@ -0,0 +1,96 @@
+#ifndef PLANESCAN_H
+#define PLANESCAN_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "networkspec.h"
+#include "statearena.h"
+
+// Two-parameter regime map (alpha2 x alpha3, alpha2 x nu, ...). The plane is computed
+// coarse to fine: every 8th cell first, then 4th, 2nd and all of them, so a preview of
+// the whole plane exists early and sharpens pass by pass. Inside a pass the cells are
+// grouped into square tiles; each worker starts on its own block of tiles and steals
+// from the back of the others' queues when it runs dry. Cells are independent, so the
+// grid never depends on the thread count or on who computed what.
+
+enum class PlaneRegime : std::uint8_t {
+    Pending,       // not computed yet
+    Fixed,         // every node still after the transient
+    Periodic,      // `period` distinct maxima levels of the observed node
+    Quasiperiodic, // many maxima levels, largest Lyapunov exponent ~ 0 (ODE)
+    Chaotic,       // many maxima levels, positive Lyapunov exponent (ODE)
+    Irregular,     // many maxima levels, no exponent (GAMMA: the history is part of the state)
+    Drifting,      // moving without a maximum: still converging at tMax
+    Diverged,
+};
+
+struct PlaneCell {
+    PlaneRegime regime = PlaneRegime::Pending;
+    std::uint8_t period = 0;  // Periodic: 1..maxPeriod
+    float lyapunov = 0.0f;    // Quasiperiodic / Chaotic only, per unit time
+    float amplitude = 0.0f;   // max - min of the observed node after the transient
+};
+
+struct PlaneScanSettings {
+    std::string xParam = "alpha2"; // names understood by the caller's cell function
+    std::string yParam = "alpha3";
+    double xMin = -10.0;
+    double xMax = 10.0;
+    double yMin = -10.0;
+    double yMax = 10.0;
+    int width = 256;               // grid points, the ranges include both ends
+    int height = 256;
+    int tileSize = 16;             // cells per tile side (in grid units, every pass)
+    int transientPercent = 70;
+    double fixedTolerance = 1e-6;  // max - min below it (relative to 1 + |y|): fixed
+    double maximaTolerance = 1e-3; // maxima closer than this * amplitude are one level
+    int maxPeriod = 8;             // more maxima levels: quasi-periodic / chaotic
+    double lyapunovThreshold = 0.01;
+    double divergeLimit = 1e6;
+    int threads = 0;               // 0: all cores
+};
+
+struct PlaneGrid {
+    PlaneScanSettings settings;
+    std::vector<PlaneCell> cells; // row-major, row 0 = yMin
+    int stride = 0;               // finest finished pass (1: complete), 0: nothing yet
+    long long computed = 0;
+    double wallSeconds = 0.0;
+
+    double cellX(int c) const;
+    double cellY(int r) const;
+    // The cell itself once computed, else the nearest cell of the finest finished pass.
+    const PlaneCell& preview(int r, int c) const;
+};
+
+// Classifies rows 0..y.steps() of one trajectory. h > 0: an Euler trajectory, cells
+// with many maxima levels get a Lyapunov estimate from a perturbed copy of the tail.
+PlaneCell classifyTrajectory(const NetworkSpec& spec, const StateArena& y, double h,
+                             const PlaneScanSettings& settings);
+
+// Integrates and classifies one cell; called on worker threads (worker in 0..threads-1).
+using PlaneCellFn = std::function<PlaneCell(int worker, int row, int col)>;
+// Called on the calling thread after its tiles (passFinished false: other workers are
+// still writing cells, only poll) and after every pass (grid complete up to grid.stride,
+// safe to render); false cancels.
+using PlaneProgressFn = std::function<bool(const PlaneGrid& grid, bool passFinished)>;
+
+// Returns false when cancelled; grid then holds the passes finished so far.
+bool scanPlane(const PlaneScanSettings& settings, PlaneGrid& grid, const PlaneCellFn& cell,
+               const PlaneProgressFn& progress = PlaneProgressFn());
+
+int planeScanThreads(const PlaneScanSettings& settings);
+
+// "BNPLANE1", int32 width, height, stride, double xMin, xMax, yMin, yMax, x / y
+// parameter names (16 bytes each, zero padded), then per cell: uint8 regime, uint8
+// period, float lyapunov, float amplitude (little endian, packed).
+std::string planeGridBinary(const PlaneGrid& grid);
+// Binary PPM (P6), yMax at the top; pending cells show their preview cell.
+std::string planeImagePpm(const PlaneGrid& grid);
+
+const char* planeRegimeName(PlaneRegime regime);
+
+#endif // PLANESCAN_H
@@ -0,0 +1,222 @@
+#include "resultcache.h"
+#include "equationdsl.h"
+#include "networksolver.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char* kLastUsedFile = ".last_used";
+const char* kConfigFile = "config.txt";
+
+QString num(double v) { return QString::number(v, 'g', 17); }
+
+const char* activationName(ActivationKind fn)
+{
+    switch (fn) {
+    case ActivationKind::Sin:  return "sin";
+    case ActivationKind::Tanh: return "tanh";
+    case ActivationKind::Relu: return "relu";
+    case ActivationKind::None: break;
+    }
+    return "none";
+}
+
+// above this, y0 and edges enter config.txt as a SHA-256 of their binary form
+const int kInlineNodes = 64;
+const std::size_t kInlineEdges = 1000;
+
+template <class T>
+void appendRaw(QByteArray& buf, const T& v) { buf.append(reinterpret_cast<const char*>(&v), int(sizeof v)); }
+
+QString largeNetworkDigest(const NetworkSpec& spec, const std::vector<double>& y0)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    QByteArray buf;
+    for (double v : y0) appendRaw(buf, v);
+    hash.addData(buf);
+    for (std::size_t k = 0; k < spec.edges.size(); ++k) {
+        if (buf.size() > (1 << 20)) {
+            hash.addData(buf);
+            buf.clear();
+        }
+        const EdgeSpec& e = spec.edges[k];
+        appendRaw(buf, qint32(e.from));
+        appendRaw(buf, qint32(e.to));
+        appendRaw(buf, qint32(e.fn));
+        appendRaw(buf, e.weight);
+    }
+    hash.addData(buf);
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+qint64 dirSize(const QString& path)
+{
+    qint64 total = 0;
+    const QFileInfoList files = QDir(path).entryInfoList(QDir::Files | QDir::Hidden);
+    for (const QFileInfo& fi : files) total += fi.size();
+    return total;
+}
+
+qint64 lastUsed(const QString& dir)
+{
+    QFile f(dir + "/" + kLastUsedFile);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return 0;
+    return QString::fromLatin1(f.readAll()).trimmed().toLongLong();
+}
+
+} // namespace
+
+ResultCache::ResultCache(const QString& rootDir, qint64 maxBytes)
+    : root(rootDir), maxBytes(maxBytes)
+{
+}
+
+QString ResultCache::canonicalRunConfig(const QString& solver, const NetworkSpec& spec,
+                                        const std::vector<double>& y0, int steps,
+                                        double h, double nu)
+{
+    QString text;
+    QTextStream out(&text);
+    out << "solverVersion=" << kSolverVersion << "\n";
+    out << "solver=" << solver << "\n";
+    out << "steps=" << steps << "\n";
+    out << "h=" << num(h) << "\n";
+    out << "nu=" << num(nu) << "\n";
+    out << "nodes=" << spec.nodeCount << "\n";
+
+    // edge order is kept: it fixes the per-node summation order
+    if (spec.nodeCount > kInlineNodes || spec.edges.size() > kInlineEdges) {
+        out << "y0,edges=" << spec.edges.size() << " sha256=" << largeNetworkDigest(spec, y0) << "\n";
+    } else {
+        out << "y0=";
+        for (std::size_t i = 0; i < y0.size(); ++i) out << (i ? "," : "") << num(y0[i]);
+        out << "\n";
+        for (const EdgeSpec& e : spec.edges)
+            out << "edge " << e.from << ">" << e.to << " " << activationName(e.fn)
+                << " " << num(e.weight) << "\n";
+    }
+    for (const GateTermSpec& g : spec.gates)
+        out << "gate " << g.node << "<" << g.source << " " << activationName(g.fn)
+            << " base=" << num(g.base) << " coeff=" << num(g.coeff) << "\n";
+    // compiled code, not the source text: equations that fold to the same program share results
+    if (spec.equations)
+        out << "equations\n" << QString::fromStdString(spec.equations->disassemble());
+    return text;
+}
+
+QString ResultCache::keyFor(const QString& canonicalConfig)
+{
+    return QString::fromLatin1(
+        QCryptographicHash::hash(canonicalConfig.toUtf8(), QCryptographicHash::Sha256).toHex());
+}
+
+QString ResultCache::entryDir(const QString& key) const
+{
+    return root + "/" + key;
+}
+
+void ResultCache::touch(const QString& dir)
+{
+    QFile f(dir + "/" + kLastUsedFile);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return;
+    f.write(QByteArray::number(QDateTime::currentMSecsSinceEpoch()));
+}
+
+bool ResultCache::linkOrCopy(const QString& src, const QString& dst)
+{
+    QFile::remove(dst);
+#ifdef Q_OS_UNIX
+    // hard link: shares the data and survives eviction of either side
+    if (::link(QFile::encodeName(src).constData(), QFile::encodeName(dst).constData()) == 0)
+        return true;
+#endif
+    return QFile::copy(src, dst);
+}
+
+bool ResultCache::restore(const QString& key, const QStringList& files, const QString& runDir)
+{
+    const QString dir = entryDir(key);
+    for (const QString& name : files)
+        if (!QFileInfo::exists(dir + "/" + name)) return false;
+
+    for (const QString& name : files)
+        if (!linkOrCopy(dir + "/" + name, runDir + "/" + name)) return false;
+
+    touch(dir);
+    return true;
+}
+
+void ResultCache::store(const QString& key, const QStringList& files, const QString& runDir,
+                        const QString& canonicalConfig)
+{
+    const QString dir = entryDir(key);
+    if (QFileInfo::exists(dir)) {
+        touch(dir);
+        return;
+    }
+
+    for (const QString& name : files)
+        if (!QFileInfo::exists(runDir + "/" + name)) return;
+
+    // fill a temp folder, then rename: readers never see a half-written entry
+    const QString tmp = root + "/.tmp_" + key;
+    QDir(tmp).removeRecursively();
+    if (!QDir().mkpath(tmp)) return;
+
+    for (const QString& name : files) {
+        if (!linkOrCopy(runDir + "/" + name, tmp + "/" + name)) {
+            QDir(tmp).removeRecursively();
+            return;
+        }
+    }
+
+    QFile cfg(tmp + "/" + kConfigFile);
+    if (cfg.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        cfg.write(canonicalConfig.toUtf8());
+        cfg.close();
+    }
+    touch(tmp);
+
+    if (!QDir().rename(tmp, dir)) {
+        QDir(tmp).removeRecursively();
+        return;
+    }
+    evict();
+}
+
+void ResultCache::evict()
+{
+    struct Entry { QString path; qint64 size; qint64 used; };
+
+    QVector<Entry> entries;
+    qint64 total = 0;
+    const QFileInfoList dirs = QDir(root).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QFileInfo& d : dirs) {
+        if (d.fileName().startsWith(".")) continue;
+        const Entry e{d.absoluteFilePath(), dirSize(d.absoluteFilePath()), lastUsed(d.absoluteFilePath())};
+        total += e.size;
+        entries.append(e);
+    }
+    if (total <= maxBytes) return;
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.used < b.used; });
+
+    for (const Entry& e : entries) {
+        if (total <= maxBytes) break;
+        if (QDir(e.path).removeRecursively()) total -= e.size;
+    }
+}
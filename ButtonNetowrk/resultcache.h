@@ -0,0 +1,46 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+#include "networkspec.h"
+
+// Content-addressed cache of run outputs under <baseResultDir>/cache/<sha256>/.
+// The key is the SHA-256 of a canonical text of everything the integration
+// depends on; a hit hard-links (or copies) the cached files into the new run
+// folder instead of integrating. Entries are evicted least-recently-used
+// first once the cache exceeds maxBytes.
+// Restored files may be hard links shared with the cache: replace them
+// (remove + write) rather than writing into them in place.
+class ResultCache
+{
+public:
+    explicit ResultCache(const QString& rootDir, qint64 maxBytes = 512LL * 1024 * 1024);
+
+    // Canonical description of one integration (spec as resolved for the solver).
+    static QString canonicalRunConfig(const QString& solver, const NetworkSpec& spec,
+                                      const std::vector<double>& y0, int steps,
+                                      double h, double nu);
+    static QString keyFor(const QString& canonicalConfig);
+
+    // Hit: files are linked into runDir, the entry is marked used, returns true.
+    bool restore(const QString& key, const QStringList& files, const QString& runDir);
+    // Publishes files from runDir under key (all-or-nothing), then evicts.
+    void store(const QString& key, const QStringList& files, const QString& runDir,
+               const QString& canonicalConfig);
+
+    void evict();
+
+private:
+    QString entryDir(const QString& key) const;
+    static void touch(const QString& dir);
+    static bool linkOrCopy(const QString& src, const QString& dst);
+
+    QString root;
+    qint64 maxBytes;
+};
+
+#endif // RESULTCACHE_H
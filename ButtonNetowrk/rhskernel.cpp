@@ -0,0 +1,64 @@
+#include "rhskernel.h"
+
+GenericRhsKernel::GenericRhsKernel(const NetworkSpec& spec)
+    : n(spec.nodeCount)
+{
+    edgeStart.assign(n + 1, 0);
+    gateStart.assign(n + 1, 0);
+
+    // counting sort by target (stable, so per-node summation order == spec order)
+    for (const EdgeSpec& e : spec.edges) {
+        if (e.fn == ActivationKind::None) continue;
+        if (e.to < 0 || e.to >= n || e.from < 0 || e.from >= n) continue;
+        ++edgeStart[e.to + 1];
+    }
+    for (const GateTermSpec& g : spec.gates) {
+        if (g.node < 0 || g.node >= n || g.source < 0 || g.source >= n) continue;
+        ++gateStart[g.node + 1];
+    }
+    for (int i = 0; i < n; ++i) {
+        edgeStart[i + 1] += edgeStart[i];
+        gateStart[i + 1] += gateStart[i];
+    }
+
+    edgesByTarget.resize(edgeStart[n]);
+    gatesByNode.resize(gateStart[n]);
+    std::vector<int> edgeFill(edgeStart.begin(), edgeStart.end() - 1);
+    std::vector<int> gateFill(gateStart.begin(), gateStart.end() - 1);
+
+    for (const EdgeSpec& e : spec.edges) {
+        if (e.fn == ActivationKind::None) continue;
+        if (e.to < 0 || e.to >= n || e.from < 0 || e.from >= n) continue;
+        edgesByTarget[edgeFill[e.to]++] = e;
+    }
+    for (const GateTermSpec& g : spec.gates) {
+        if (g.node < 0 || g.node >= n || g.source < 0 || g.source >= n) continue;
+        gatesByNode[gateFill[g.node]++] = g;
+    }
+}
+
+void GenericRhsKernel::eval(const double* y, double* dy) const
+{
+    for (int i = 0; i < n; ++i) {
+        double sum = -y[i];
+
+        for (int k = edgeStart[i]; k < edgeStart[i + 1]; ++k) {
+            const EdgeSpec& e = edgesByTarget[k];
+            sum += e.weight * applyActivation(e.fn, y[e.from]);
+        }
+
+        for (int k = gateStart[i]; k < gateStart[i + 1]; ++k) {
+            const GateTermSpec& g = gatesByNode[k];
+            sum += (g.base - g.coeff * applyActivation(g.fn, y[g.source])) * std::tanh(y[i]);
+        }
+
+        dy[i] = sum;
+    }
+}
+
+std::string rhsKernelName(const NetworkSpec& spec)
+{
+    std::string name;
+    visitRhsKernel(spec, [&](const auto& kernel) { name = kernel.name(); });
+    return name;
+}
@@ -0,0 +1,320 @@
+#ifndef RHSKERNEL_H
+#define RHSKERNEL_H
+
+#include "equationdsl.h"
+#include "nativekernel.h"
+#include "networkspec.h"
+#include "sparsekernel.h"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Right-hand side kernels. Every kernel exposes
+//   int nodeCount() const;
+//   std::string name() const;
+//   void eval(const double* y, double* dy) const;
+// and the solvers are templated on the kernel type, so a fixed-topology kernel is
+// inlined into the stepping loop. visitRhsKernel() picks the kernel for a spec.
+
+// ================= Generic kernel =================
+
+class GenericRhsKernel
+{
+public:
+    explicit GenericRhsKernel(const NetworkSpec& spec);
+
+    int nodeCount() const { return n; }
+    std::string name() const { return "generic"; }
+    void eval(const double* y, double* dy) const;
+
+private:
+    int n = 0;
+    // Edges/gates bucketed by target node, keeping the spec order inside a bucket.
+    std::vector<int> edgeStart;
+    std::vector<EdgeSpec> edgesByTarget;
+    std::vector<int> gateStart;
+    std::vector<GateTermSpec> gatesByNode;
+};
+
+// ================= Fixed-topology kernels =================
+
+template <class... Ts>
+struct TypeList { static constexpr std::size_t size = sizeof...(Ts); };
+
+template <std::size_t K, class List> struct TypeAt;
+template <std::size_t K, class... Ts>
+struct TypeAt<K, TypeList<Ts...>> { using type = std::tuple_element_t<K, std::tuple<Ts...>>; };
+
+template <int From, int To, ActivationKind Fn>
+struct FixedEdge {
+    static constexpr int from = From;
+    static constexpr int to = To;
+    static constexpr ActivationKind fn = Fn;
+};
+
+template <int Node, int Source, ActivationKind Fn>
+struct FixedGate {
+    static constexpr int node = Node;
+    static constexpr int source = Source;
+    static constexpr ActivationKind fn = Fn;
+};
+
+template <ActivationKind Fn>
+inline double activate(double x)
+{
+    if constexpr (Fn == ActivationKind::Sin) return std::sin(x);
+    else if constexpr (Fn == ActivationKind::Tanh) return std::tanh(x);
+    else if constexpr (Fn == ActivationKind::Relu) return (x > 0.0) ? x : 0.0;
+    else return 0.0;
+}
+
+// Node count, edge list, gate structure and activation kinds are compile-time
+// constants; only weights and gate base/coeff are runtime values. Each node sums its
+// edges, then its gates, in TypeList order; a spec only matches when its edges / gates
+// into every node come in that same order, so the sums round exactly as in
+// GenericRhsKernel (which keeps the spec order per node).
+template <class EdgeSet, class GateSet>
+class FixedRhsKernel
+{
+    using Edges = typename EdgeSet::Edges;
+    using Gates = typename GateSet::Gates;
+    static constexpr std::size_t E = Edges::size;
+    static constexpr std::size_t G = Gates::size;
+
+public:
+    static constexpr int N = EdgeSet::nodeCount;
+    using State = std::array<double, N>;
+
+    int nodeCount() const { return N; }
+    std::string name() const { return std::string(EdgeSet::name) + "+" + GateSet::name; }
+
+    // Fills weights/gate params from spec; false if the spec is a different topology
+    // or lists the terms of some node in a different order.
+    bool match(const NetworkSpec& spec)
+    {
+        if (spec.nodeCount != N) return false;
+
+        std::vector<const EdgeSpec*> liveEdges;
+        for (const EdgeSpec& e : spec.edges)
+            if (e.fn != ActivationKind::None) liveEdges.push_back(&e);
+        if (liveEdges.size() != E || spec.gates.size() != G) return false;
+
+        std::vector<int> edgeSlot(liveEdges.size(), -1);
+        if (!matchEdges(liveEdges, edgeSlot, std::make_index_sequence<E>{})) return false;
+        std::vector<int> gateSlot(G, -1);
+        if (!matchGates(spec.gates, gateSlot, std::make_index_sequence<G>{})) return false;
+
+        // slots of one node must rise along the spec, i.e. follow the summation order
+        for (std::size_t a = 0; a < liveEdges.size(); ++a)
+            for (std::size_t b = a + 1; b < liveEdges.size(); ++b)
+                if (liveEdges[a]->to == liveEdges[b]->to && edgeSlot[a] > edgeSlot[b]) return false;
+        for (std::size_t a = 0; a < G; ++a)
+            for (std::size_t b = a + 1; b < G; ++b)
+                if (spec.gates[a].node == spec.gates[b].node && gateSlot[a] > gateSlot[b]) return false;
+        return true;
+    }
+
+    void eval(const double* y, double* dy) const
+    {
+        State s;
+        for (int i = 0; i < N; ++i) s[i] = y[i];
+        State d;
+        evalNodes(s, d, std::make_index_sequence<N>{});
+        for (int i = 0; i < N; ++i) dy[i] = d[i];
+    }
+
+private:
+    std::array<double, E> weights{};
+    std::array<double, G> gateBase{};
+    std::array<double, G> gateCoeff{};
+
+    // slot[j]: the TypeList index spec term j was matched to (-1: not yet)
+    template <std::size_t... K>
+    bool matchEdges(const std::vector<const EdgeSpec*>& live, std::vector<int>& slot,
+                    std::index_sequence<K...>)
+    {
+        return (matchEdge<K>(live, slot) && ...);
+    }
+
+    template <std::size_t K>
+    bool matchEdge(const std::vector<const EdgeSpec*>& live, std::vector<int>& slot)
+    {
+        using Edge = typename TypeAt<K, Edges>::type;
+        for (std::size_t j = 0; j < live.size(); ++j) {
+            if (slot[j] >= 0) continue;
+            if (live[j]->from == Edge::from && live[j]->to == Edge::to && live[j]->fn == Edge::fn) {
+                slot[j] = int(K);
+                weights[K] = live[j]->weight;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <std::size_t... K>
+    bool matchGates(const std::vector<GateTermSpec>& gates, std::vector<int>& slot,
+                    std::index_sequence<K...>)
+    {
+        return (matchGate<K>(gates, slot) && ...);
+    }
+
+    template <std::size_t K>
+    bool matchGate(const std::vector<GateTermSpec>& gates, std::vector<int>& slot)
+    {
+        using Gate = typename TypeAt<K, Gates>::type;
+        for (std::size_t j = 0; j < gates.size(); ++j) {
+            if (slot[j] >= 0) continue;
+            if (gates[j].node == Gate::node && gates[j].source == Gate::source && gates[j].fn == Gate::fn) {
+                slot[j] = int(K);
+                gateBase[K] = gates[j].base;
+                gateCoeff[K] = gates[j].coeff;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <std::size_t... I>
+    void evalNodes(const State& y, State& dy, std::index_sequence<I...>) const
+    {
+        (evalNode<I>(y, dy), ...);
+    }
+
+    template <std::size_t I>
+    void evalNode(const State& y, State& dy) const
+    {
+        double sum = -y[I];
+        addEdges<I>(sum, y, std::make_index_sequence<E>{});
+        addGates<I>(sum, y, std::make_index_sequence<G>{});
+        dy[I] = sum;
+    }
+
+    template <std::size_t I, std::size_t... K>
+    void addEdges(double& sum, const State& y, std::index_sequence<K...>) const
+    {
+        (addEdge<I, K>(sum, y), ...);
+    }
+
+    template <std::size_t I, std::size_t K>
+    void addEdge(double& sum, const State& y) const
+    {
+        using Edge = typename TypeAt<K, Edges>::type;
+        if constexpr (Edge::to == int(I))
+            sum += weights[K] * activate<Edge::fn>(y[Edge::from]);
+    }
+
+    template <std::size_t I, std::size_t... K>
+    void addGates(double& sum, const State& y, std::index_sequence<K...>) const
+    {
+        (addGate<I, K>(sum, y), ...);
+    }
+
+    template <std::size_t I, std::size_t K>
+    void addGate(double& sum, const State& y) const
+    {
+        using Gate = typename TypeAt<K, Gates>::type;
+        if constexpr (Gate::node == int(I))
+            sum += (gateBase[K] - gateCoeff[K] * activate<Gate::fn>(y[Gate::source])) * std::tanh(y[I]);
+    }
+};
+
+// ================= Registered fixed topologies =================
+
+// Hard-coded GAMMA / solver.c equations: s_ij feeds y_j into dy_i.
+struct Paper5Edges {
+    static constexpr const char* name = "paper5";
+    static constexpr int nodeCount = 5;
+    using Edges = TypeList<
+        FixedEdge<1, 0, ActivationKind::Tanh>, FixedEdge<2, 0, ActivationKind::Sin>,
+        FixedEdge<3, 0, ActivationKind::Sin>,
+        FixedEdge<0, 1, ActivationKind::Sin>, FixedEdge<2, 1, ActivationKind::Sin>,
+        FixedEdge<4, 1, ActivationKind::Sin>,
+        FixedEdge<0, 2, ActivationKind::Tanh>, FixedEdge<1, 2, ActivationKind::Tanh>,
+        FixedEdge<2, 2, ActivationKind::Sin>,
+        FixedEdge<0, 3, ActivationKind::Tanh>,
+        FixedEdge<1, 4, ActivationKind::Tanh>>;
+};
+
+// runAutoTestNode5Preset() as drawn (start -> end), in preset order.
+struct AutoPreset5Edges {
+    static constexpr const char* name = "autoPreset5";
+    static constexpr int nodeCount = 5;
+    using Edges = TypeList<
+        FixedEdge<0, 3, ActivationKind::Sin>, FixedEdge<3, 0, ActivationKind::Tanh>,
+        FixedEdge<0, 2, ActivationKind::Sin>, FixedEdge<2, 0, ActivationKind::Tanh>,
+        FixedEdge<1, 2, ActivationKind::Sin>, FixedEdge<2, 1, ActivationKind::Tanh>,
+        FixedEdge<0, 1, ActivationKind::Tanh>, FixedEdge<1, 0, ActivationKind::Sin>,
+        FixedEdge<1, 4, ActivationKind::Sin>, FixedEdge<4, 1, ActivationKind::Tanh>>;
+};
+
+// Default G2/G1 self gates (node4: sin(y4), node5: tanh(y5)).
+struct DefaultGates5 {
+    static constexpr const char* name = "selfGates";
+    using Gates = TypeList<FixedGate<3, 3, ActivationKind::Sin>, FixedGate<4, 4, ActivationKind::Tanh>>;
+};
+
+// Gates disabled: (alpha2 - alpha3*sin(y5)) on node4, (1 - alpha1*tanh(y3)) on node5.
+struct ClassicGates5 {
+    static constexpr const char* name = "classicGates";
+    using Gates = TypeList<FixedGate<3, 4, ActivationKind::Sin>, FixedGate<4, 2, ActivationKind::Tanh>>;
+};
+
+using RegisteredRhsKernels = TypeList<
+    FixedRhsKernel<Paper5Edges, DefaultGates5>,
+    FixedRhsKernel<Paper5Edges, ClassicGates5>,
+    FixedRhsKernel<AutoPreset5Edges, DefaultGates5>,
+    FixedRhsKernel<AutoPreset5Edges, ClassicGates5>>;
+
+// ================= Dispatch =================
+
+template <class Kernel, class Visitor>
+bool tryVisitFixedKernel(const NetworkSpec& spec, Visitor& visit)
+{
+    Kernel kernel;
+    if (!kernel.match(spec)) return false;
+    visit(kernel);
+    return true;
+}
+
+template <class Visitor, class... Kernels>
+bool visitFixedKernels(const NetworkSpec& spec, Visitor& visit, TypeList<Kernels...>)
+{
+    return (tryVisitFixedKernel<Kernels>(spec, visit) || ...);
+}
+
+// Large networks (generated / edge lists) get the multithreaded CSR kernel above this size.
+constexpr int kSparseKernelMinNodes = 256;
+
+// Calls visit(kernel) with the native kernel when the spec carries one, the bytecode
+// kernel for custom equations, the sparse kernel for large networks, a registered
+// fixed kernel when the spec matches one, otherwise with the generic kernel.
+template <class Visitor>
+void visitRhsKernel(const NetworkSpec& spec, Visitor&& visit)
+{
+    if (spec.native) {
+        NativeRhsKernel native(spec.native);
+        visit(native);
+        return;
+    }
+    if (spec.equations) {
+        BytecodeRhsKernel bytecode(spec.equations);
+        visit(bytecode);
+        return;
+    }
+    if (spec.nodeCount >= kSparseKernelMinNodes) {
+        SparseRhsKernel sparse(spec, spec.threads);
+        visit(sparse);
+        return;
+    }
+    if (visitFixedKernels(spec, visit, RegisteredRhsKernels{})) return;
+    GenericRhsKernel generic(spec);
+    visit(generic);
+}
+
+std::string rhsKernelName(const NetworkSpec& spec);
+
+#endif // RHSKERNEL_H
@@ -0,0 +1,645 @@
+#include "runoutput.h"
+
+#include <QFile>
+#include <QMap>
+#include <QProcess>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+
+bool writeResultFiles(const QString& runDir, const StateArena& y, int steps)
+{
+    QFile f(runDir + "/result.dat");
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+    QTextStream out(&f);
+    for (int t = 0; t <= steps; ++t) {
+        out << y.at(t, 0) << " " << y.at(t, 1) << " " << y.at(t, 2) << " " << y.at(t, 3) << " " << y.at(t, 4) << "\n";
+    }
+    f.close();
+
+    QFile stream(runDir + "/result_stream.csv");
+    if (stream.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QTextStream s(&stream);
+        s << "t,y1,y2,y3,y4,y5\n";
+        for (int t = 0; t <= steps; ++t) {
+            s << t << "," << y.at(t, 0) << "," << y.at(t, 1) << "," << y.at(t, 2) << "," << y.at(t, 3) << "," << y.at(t, 4) << "\n";
+        }
+        stream.close();
+    }
+
+    // every node (large networks: the only file with all of them)
+    QFile fin(runDir + "/result_final.csv");
+    if (fin.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QTextStream s(&fin);
+        for (int i = 0; i < y.nodeCount(); ++i) s << (i ? ",y" : "y") << (i + 1);
+        s << "\n";
+        for (int i = 0; i < y.nodeCount(); ++i) s << (i ? "," : "") << y.at(steps, i);
+        s << "\n";
+        fin.close();
+    }
+
+    QFile summary(runDir + "/result_summary.dat");
+    if (summary.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QTextStream s(&summary);
+        s << "# t mean rms min max over " << y.nodeCount() << " nodes\n";
+        for (int t = 0; t <= steps; ++t) {
+            const double* row = y.state(t);
+            double sum = 0.0, sq = 0.0, lo = row[0], hi = row[0];
+            for (int i = 0; i < y.nodeCount(); ++i) {
+                sum += row[i];
+                sq += row[i] * row[i];
+                lo = std::min(lo, row[i]);
+                hi = std::max(hi, row[i]);
+            }
+            s << t << " " << sum / y.nodeCount() << " " << std::sqrt(sq / y.nodeCount()) << " "
+              << lo << " " << hi << "\n";
+        }
+        summary.close();
+    }
+
+    QFile table(runDir + "/table.txt");
+    if (table.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QTextStream t(&table);
+        t << "Output Table (result.dat)\n";
+        t << "Rows: " << (steps + 1) << "\n\n";
+        t << "y1 y2 y3 y4 y5\n";
+        for (int i = 0; i <= steps; ++i) {
+            t << y.at(i, 0) << " " << y.at(i, 1) << " " << y.at(i, 2) << " " << y.at(i, 3) << " " << y.at(i, 4) << "\n";
+        }
+        table.close();
+    }
+    return true;
+}
+
+// ================= Events =================
+
+bool writeEventFile(const QString& runDir, const EventLog& log, const std::vector<EventSpec>& specs)
+{
+    QFile f(runDir + "/events.dat");
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream out(&f);
+    out.setRealNumberPrecision(12);
+    out << "# events: " << QString::fromStdString(eventSpecsText(specs)) << " (" << qint64(log.size()) << " found)\n";
+    out << "# event step value";
+    for (int i = 0; i < log.nodes; ++i) out << " y" << (i + 1);
+    out << "\n";
+    for (std::size_t e = 0; e < log.size(); ++e) {
+        out << log.spec[e] + 1 << " " << log.step[e] << " " << log.value[e];
+        for (int i = 0; i < log.nodes; ++i) out << " " << log.state[e * log.nodes + i];
+        out << "\n";
+    }
+    return true;
+}
+
+// ================= Basin map =================
+
+namespace {
+
+bool writeBasinGnuplotScript(const QString& runDir, const BasinMap& map)
+{
+    QFile script(runDir + "/basin.gnu");
+    if (!script.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+    QTextStream g(&script);
+    const int basins = std::max(1, int(map.attractors.size()));
+
+    g << "set term pngcairo size 900,800\n";
+    g << "set output 'basin.png'\n";
+    g << "set xlabel 'y" << map.settings.xNode + 1 << "(0)'\n";
+    g << "set ylabel 'y" << map.settings.yNode + 1 << "(0)'\n";
+    g << "set size ratio -1\n";
+    g << "set cbrange [-0.5:" << basins - 0.5 << "]\n";
+    g << "set cbtics 1\n";
+    g << "set palette maxcolors " << basins << "\n";
+    // same colours as basin.ppm; a single basin still needs two palette points
+    QStringList colours;
+    for (int k = 0; k < basins; ++k) {
+        unsigned char rgb[3] = {0, 0, 0};
+        if (k < int(map.attractors.size())) basinColour(map, k, rgb);
+        colours << QString::asprintf("'#%02x%02x%02x'", rgb[0], rgb[1], rgb[2]);
+    }
+    if (basins == 1) colours << colours[0];
+    g << "set palette defined (";
+    for (int k = 0; k < colours.size(); ++k) g << (k ? ", " : "") << k << " " << colours[k];
+    g << ")\n";
+    g << "unset key\n";
+    g << "plot 'basin_labels.dat' using 1:2:3 with image\n";
+    g << "set output\n";
+    script.close();
+    return true;
+}
+
+} // namespace
+
+bool writeBasinFiles(const QString& runDir, const BasinMap& map)
+{
+    const BasinSettings& s = map.settings;
+
+    QFile image(runDir + "/basin.ppm");
+    if (!image.open(QIODevice::WriteOnly)) return false;
+    const std::string ppm = basinImagePpm(map);
+    image.write(ppm.data(), qint64(ppm.size()));
+    image.close();
+
+    QFile labels(runDir + "/basin_labels.dat");
+    if (!labels.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream l(&labels);
+    l << "# y" << s.xNode + 1 << "(0) y" << s.yNode + 1 << "(0) basin\n";
+    for (int r = 0; r < s.height; ++r) {
+        for (int c = 0; c < s.width; ++c)
+            l << map.cellX(c) << " " << map.cellY(r) << " " << map.label[std::size_t(r) * s.width + c] << "\n";
+        l << "\n";
+    }
+    labels.close();
+
+    QFile summary(runDir + "/basin_summary.txt");
+    if (!summary.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream out(&summary);
+    const double cells = double(s.width) * s.height;
+    out << "# basin map: y" << s.xNode + 1 << "(0) in [" << s.xMin << ", " << s.xMax << "], y" << s.yNode + 1
+        << "(0) in [" << s.yMin << ", " << s.yMax << "], " << s.width << "x" << s.height << " cells, "
+        << map.steps << " steps of h=" << map.h << "\n";
+    out << "# settle |dy| < " << s.settleTolerance << ", diverge |y| > " << s.divergeLimit
+        << ", transient " << s.transientPercent << "%, radius " << s.clusterRadius << "\n";
+    out << "# " << map.eulerSteps << " Euler steps (" << QString::number(map.eulerSteps / cells, 'f', 1)
+        << " per cell), " << QString::number(map.wallSeconds, 'f', 2) << " s\n";
+    out << "# basin cells fraction kind unsettled meanSteps, then min and max of y1..y" << map.descriptorNodes
+        << " after the transient\n";
+    for (int k = 0; k < int(map.attractors.size()); ++k) {
+        const BasinAttractor& a = map.attractors[k];
+        out << k << " " << a.cells << " " << QString::number(a.cells / cells, 'f', 6) << " "
+            << (a.diverged ? "diverged" : a.fixedPoint ? "fixed" : "oscillating") << " "
+            << a.unsettledCells << " " << QString::number(a.meanSteps, 'f', 1);
+        for (double v : a.low) out << " " << v;
+        for (double v : a.high) out << " " << v;
+        out << "\n";
+    }
+    summary.close();
+    return writeBasinGnuplotScript(runDir, map);
+}
+
+// ================= Plane scan =================
+
+bool writePlaneScanFiles(const QString& runDir, const PlaneGrid& grid)
+{
+    // written next to the old files and renamed, so a viewer never sees half an image
+    auto save = [&](const QString& name, const std::string& bytes) {
+        QSaveFile f(runDir + "/" + name);
+        if (!f.open(QIODevice::WriteOnly)) return false;
+        f.write(bytes.data(), qint64(bytes.size()));
+        return f.commit();
+    };
+    if (!save("plane_scan.bin", planeGridBinary(grid))) return false;
+    if (!save("plane_scan.ppm", planeImagePpm(grid))) return false;
+
+    const PlaneScanSettings& s = grid.settings;
+    QMap<QString, int> count;
+    QMap<int, int> periods;
+    double lyapunovMax = 0.0;
+    for (const PlaneCell& c : grid.cells) {
+        ++count[planeRegimeName(c.regime)];
+        if (c.regime == PlaneRegime::Periodic) ++periods[c.period];
+        if (c.regime == PlaneRegime::Chaotic) lyapunovMax = std::max(lyapunovMax, double(c.lyapunov));
+    }
+
+    QString text;
+    QTextStream out(&text);
+    out << "# plane scan: " << QString::fromStdString(s.xParam) << " in [" << s.xMin << ", " << s.xMax << "] x "
+        << QString::fromStdString(s.yParam) << " in [" << s.yMin << ", " << s.yMax << "], " << s.width << "x"
+        << s.height << " cells, tiles " << s.tileSize << "x" << s.tileSize << "\n";
+    out << "# pass stride " << grid.stride << (grid.stride == 1 ? " (complete)" : " (preview)") << ", "
+        << grid.computed << " cells computed, " << QString::number(grid.wallSeconds, 'f', 2) << " s\n";
+    out << "# transient " << s.transientPercent << "%, fixed tol " << s.fixedTolerance << ", maxima tol "
+        << s.maximaTolerance << ", period <= " << s.maxPeriod << ", lyapunov threshold " << s.lyapunovThreshold << "\n";
+    out << "# colours: fixed blue, period 1..8 green/orange/purple/cyan/pink/olive/brown/grey, quasiperiodic "
+           "yellow, chaotic red, irregular pink, drifting light grey, diverged black\n";
+    for (auto it = count.begin(); it != count.end(); ++it)
+        out << it.key() << " " << it.value() << "\n";
+    for (auto it = periods.begin(); it != periods.end(); ++it)
+        out << "period" << it.key() << " " << it.value() << "\n";
+    if (count.value("chaotic") > 0) out << "# largest Lyapunov exponent " << lyapunovMax << "\n";
+    out.flush();
+    return save("plane_scan_summary.txt", text.toStdString());
+}
+
+// ================= Equilibria =================
+
+bool writeEquilibriumFiles(const QString& runDir, const EquilibriumResult& result)
+{
+    const EquilibriumSettings& s = result.settings;
+
+    QFile table(runDir + "/equilibria.txt");
+    if (!table.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream out(&table);
+    out.setRealNumberPrecision(12);
+    out << "# equilibria f(y) = 0: " << result.equilibria.size() << " found from " << s.seeds << " Newton seeds ("
+        << result.failedSeeds << " did not converge), " << result.newtonIterations << " iterations, "
+        << QString::number(result.wallSeconds, 'f', 4) << " s\n";
+    out << "# Jacobian " << (result.analyticJacobian ? "analytic" : "central differences") << ", |f| < "
+        << s.tolerance << ", seeds in [" << -s.seedRange << ", " << s.seedRange << "]\n";
+    out << "# stable when every eigenvalue has |arg| > " << s.order << " * pi/2"
+        << (s.order < 1.0 ? " (fractional order)" : " (Re < 0)") << "\n";
+    out << "# equilibrium kind unstable residual seeds iterations y1..y" << result.nodeCount << "\n";
+    for (int k = 0; k < int(result.equilibria.size()); ++k) {
+        const Equilibrium& e = result.equilibria[k];
+        out << k << " " << equilibriumKindName(e.kind) << (e.eigenvaluesOk ? "" : "(qr-failed)") << " "
+            << e.unstableDirections << " " << e.residual << " " << e.seeds << " " << e.iterations;
+        for (double v : e.y) out << " " << v;
+        out << "\n";
+    }
+    table.close();
+
+    QFile eig(runDir + "/equilibria_eigenvalues.dat");
+    if (!eig.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream ev(&eig);
+    ev.setRealNumberPrecision(12);
+    ev << "# equilibrium re im\n";
+    for (int k = 0; k < int(result.equilibria.size()); ++k) {
+        for (const std::complex<double>& lambda : result.equilibria[k].eigenvalues)
+            ev << k << " " << lambda.real() << " " << lambda.imag() << "\n";
+        ev << "\n";
+    }
+    return true;
+}
+
+// ================= Continuation =================
+
+bool writeContinuationFiles(const QString& runDir, const QString& parameter,
+                            const std::vector<ContinuationResult>& branches)
+{
+    int nodes = 0;
+    int specialPoints = 0;
+    for (const ContinuationResult& b : branches) {
+        if (!b.branch.empty()) nodes = int(b.branch.front().y.size());
+        specialPoints += int(b.bifurcations.size());
+    }
+
+    QFile data(runDir + "/continuation.dat");
+    if (!data.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream out(&data);
+    out.setRealNumberPrecision(12);
+    out << "# " << parameter << " stable unstable maxRe y1..y" << nodes << "\n";
+    for (int k = 0; k < int(branches.size()); ++k) {
+        out << (k ? "\n\n" : "") << "# branch " << k << " (" << QString::fromStdString(branches[k].stopReason)
+            << ")\n";
+        for (const BranchPoint& p : branches[k].branch) {
+            const bool stable = p.kind == EquilibriumKind::StableNode || p.kind == EquilibriumKind::StableFocus;
+            out << p.p << " " << (stable ? 1 : 0) << " " << p.unstableDirections << " "
+                << (p.eigenvalues.empty() ? 0.0 : p.eigenvalues.front().real());
+            for (double v : p.y) out << " " << v;
+            out << "\n";
+        }
+    }
+    data.close();
+
+    QFile points(runDir + "/continuation_points.txt");
+    if (!points.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream pt(&points);
+    pt.setRealNumberPrecision(12);
+    pt << "# branch kind " << parameter << " frequency y1..y" << nodes << "\n";
+    for (int k = 0; k < int(branches.size()); ++k)
+        for (const BifurcationPoint& b : branches[k].bifurcations) {
+            pt << k << " " << bifurcationKindName(b.kind) << " " << b.p << " " << b.frequency;
+            for (double v : b.y) pt << " " << v;
+            pt << "\n";
+        }
+    points.close();
+
+    QFile script(runDir + "/continuation.gnu");
+    if (!script.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream g(&script);
+    g << "set term pngcairo size 900,700\n";
+    g << "set grid\n";
+    g << "set xlabel '" << parameter << "'\n";
+    g << "set key outside bottom\n";
+    for (int i = 1; i <= std::min(nodes, 5); ++i) {
+        const int col = 4 + i;
+        g << "set output 'continuation_y" << i << ".png'\n";
+        g << "set ylabel 'y" << i << "'\n";
+        g << "plot 'continuation.dat' using 1:($2==1 ? $" << col << " : 1/0) with lines lw 2 lc rgb '#1f77b4' "
+          << "title 'stable', \\\n     'continuation.dat' using 1:($2==0 ? $" << col
+          << " : 1/0) with lines dt 2 lc rgb '#d62728' title 'unstable'";
+        if (specialPoints > 0)
+            g << ", \\\n     'continuation_points.txt' using 3:" << col
+              << " with points pt 7 ps 1.2 lc rgb 'black' title 'fold / branch / hopf'";
+        g << "\n\n";
+    }
+    g << "set output\n";
+    script.close();
+    return true;
+}
+
+// ================= Sensitivities =================
+
+bool writeSensitivityFiles(const QString& runDir, const SensitivityResult& result)
+{
+    const int parameters = int(result.names.size());
+    const int shown = std::min(result.nodeCount, 5);
+
+    for (int k = 0; k < parameters; ++k) {
+        const QString name = QString::fromStdString(result.names[k]);
+        QFile f(runDir + "/sensitivity_" + name + ".dat");
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+        QTextStream out(&f);
+        for (int t = 0; t <= result.steps; ++t) {
+            for (int i = 0; i < shown; ++i) out << (i ? " " : "") << result.at(t, k, i);
+            out << "\n";
+        }
+        f.close();
+    }
+
+    // every node (large networks: the only file with all of them)
+    QFile fin(runDir + "/sensitivity_final.csv");
+    if (fin.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QTextStream s(&fin);
+        s << "parameter";
+        for (int i = 0; i < result.nodeCount; ++i) s << ",dy" << (i + 1);
+        s << "\n";
+        for (int k = 0; k < parameters; ++k) {
+            s << QString::fromStdString(result.names[k]);
+            for (int i = 0; i < result.nodeCount; ++i) s << "," << result.at(result.steps, k, i);
+            s << "\n";
+        }
+        fin.close();
+    }
+
+    QFile script(runDir + "/sensitivity.gnu");
+    if (!script.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream g(&script);
+    g << "set term pngcairo size 1000,700\n";
+    g << "set grid\n";
+    g << "set key left\n";
+    g << "set xlabel 't (step)'\n";
+    g << "set xrange [0:*]\n";
+    for (int k = 0; k < parameters; ++k) {
+        const QString name = QString::fromStdString(result.names[k]);
+        g << "set output 'sensitivity_" << name << ".png'\n";
+        g << "set ylabel 'd y / d " << name << "'\n";
+        g << "plot ";
+        for (int i = 1; i <= shown; ++i)
+            g << (i > 1 ? ", \\\n     " : "") << "'sensitivity_" << name << ".dat' using 0:" << i
+              << " with lines linewidth 2 title 'd y" << i << " / d " << name << "'";
+        g << "\n\n";
+    }
+    g << "set output\n";
+    script.close();
+    return true;
+}
+
+// ================= Parameter fit =================
+
+bool writeFitFiles(const QString& runDir, const FitResult& fit, const FitTarget& target)
+{
+    QFile summary(runDir + "/fit_summary.txt");
+    if (!summary.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream s(&summary);
+    s << "# Levenberg-Marquardt fit, " << fit.starts.size() << " starts, " << fit.residuals << " target values, "
+      << fit.runs << " runs, " << fit.wallSeconds << " s\n";
+    s << "# best start " << fit.best << ", its values are in params.txt\n";
+    s << "# start initialCost cost rms iterations converged";
+    for (const std::string& name : fit.names) s << " " << QString::fromStdString(name) << "0";
+    for (const std::string& name : fit.names) s << " " << QString::fromStdString(name);
+    s << "\n";
+    for (int k = 0; k < int(fit.starts.size()); ++k) {
+        const FitStart& st = fit.starts[k];
+        s << k << " " << st.initialCost << " " << st.cost << " " << fit.rmsError(k) << " " << st.iterations << " "
+          << (st.converged ? 1 : 0);
+        for (double v : st.initial) s << " " << v;
+        for (double v : st.fitted) s << " " << v;
+        s << "\n";
+    }
+    summary.close();
+
+    QFile data(runDir + "/fit_target.dat");
+    if (!data.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream d(&data);
+    for (int t = 0; t < target.rows; ++t) {
+        for (int i = 0; i < target.columns; ++i) d << (i ? " " : "") << target.at(t, i);
+        d << "\n";
+    }
+    data.close();
+
+    QFile script(runDir + "/fit.gnu");
+    if (!script.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream g(&script);
+    const int shown = std::min(target.columns, 5);
+    g << "set terminal pngcairo size 1200," << 180 * shown + 100 << "\n";
+    g << "set output 'fit.png'\n";
+    g << "set multiplot layout " << shown << ",1 title 'Fitted network (blue) over the target (grey)'\n";
+    g << "set grid\n";
+    g << "set key left\n";
+    g << "set xlabel 't (step)'\n";
+    g << "set xrange [0:" << target.rows - 1 << "]\n";
+    for (int i = 1; i <= shown; ++i) {
+        g << "set ylabel 'y" << i << "'\n";
+        g << "plot 'fit_target.dat' using 0:" << i
+          << " with lines linewidth 5 lc rgb '#bbbbbb' title 'target', \\\n     'result.dat' using 0:" << i
+          << " with lines linewidth 2 lc rgb '#1f77b4' title 'fit'\n";
+    }
+    g << "unset multiplot\n";
+    g << "set output\n";
+    script.close();
+    return true;
+}
+
+// ================= Noisy ensemble / uncertainty bands =================
+
+namespace {
+
+// <name>.dat ("step", then per node: mean, std, quantiles) and <name>.gnu (<name>_y1..y5.png)
+bool writeBandFiles(const QString& runDir, const QString& name, const std::vector<int>& rowSteps, int nodes,
+                    const std::vector<double>& quantiles, const std::vector<double>& mean,
+                    const std::vector<double>& variance, const std::vector<double>& quantile)
+{
+    const int qs = int(quantiles.size());
+    const int width = 2 + qs; // columns per node
+
+    QFile data(runDir + "/" + name + ".dat");
+    if (!data.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream out(&data);
+    out << "# step";
+    for (int i = 1; i <= nodes; ++i) {
+        out << " mean" << i << " std" << i;
+        for (double p : quantiles) out << " q" << QString::number(p, 'g', 4) << "_" << i;
+    }
+    out << "\n";
+    for (int r = 0; r < int(rowSteps.size()); ++r) {
+        out << rowSteps[r];
+        for (int i = 0; i < nodes; ++i) {
+            const std::size_t c = std::size_t(r) * nodes + i;
+            out << " " << mean[c] << " " << std::sqrt(variance[c]);
+            for (int k = 0; k < qs; ++k) out << " " << quantile[c * qs + k];
+        }
+        out << "\n";
+    }
+    data.close();
+
+    QFile script(runDir + "/" + name + ".gnu");
+    if (!script.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream g(&script);
+    g << "set term pngcairo size 1000,600\n";
+    g << "set grid\n";
+    g << "set key left\n";
+    g << "set xlabel 't (step)'\n";
+    g << "set style fill transparent solid 0.25 noborder\n";
+    int median = -1;
+    for (int k = 0; k < qs; ++k)
+        if (quantiles[k] == 0.5) median = k;
+    for (int i = 0; i < std::min(nodes, 5); ++i) {
+        const int meanColumn = 2 + i * width;
+        g << "set output '" << name << "_y" << i + 1 << ".png'\n";
+        g << "set ylabel 'y" << i + 1 << "'\n";
+        g << "plot ";
+        // nested bands: outermost pair first, lighter
+        for (int k = 0; k < qs / 2; ++k)
+            g << "'" << name << ".dat' using 1:" << meanColumn + 2 + k << ":" << meanColumn + 1 + qs - k
+              << " with filledcurves lc rgb '#1f77b4' title 'q" << QString::number(quantiles[k], 'g', 4) << " .. q"
+              << QString::number(quantiles[qs - 1 - k], 'g', 4) << "', \\\n     ";
+        if (median >= 0)
+            g << "'" << name << ".dat' using 1:" << meanColumn + 2 + median
+              << " with lines dt 2 lw 2 lc rgb '#d62728' title 'median', \\\n     ";
+        g << "'" << name << ".dat' using 1:" << meanColumn << " with lines lw 2 lc rgb '#1f77b4' title 'mean'\n\n";
+    }
+    g << "set output\n";
+    script.close();
+    return true;
+}
+
+} // namespace
+
+bool writeEnsembleFiles(const QString& runDir, const EnsembleStats& stats, double h)
+{
+    const SdeSettings& s = stats.settings;
+    if (!writeBandFiles(runDir, "ensemble", stats.rowSteps, stats.nodes, s.quantiles, stats.mean, stats.variance,
+                        stats.quantile))
+        return false;
+
+    QFile summary(runDir + "/ensemble_summary.txt");
+    if (!summary.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream m(&summary);
+    QStringList sigma;
+    for (double v : s.sigma) sigma << QString::number(v, 'g', 10);
+    m << "Paths: " << stats.paths << " (" << stats.divergedPaths << " dropped, |y| > "
+      << s.divergeLimit << ")\n";
+    m << "Noise: " << (s.noise == NoiseKind::Additive ? "additive" : "multiplicative")
+      << " sigma=" << sigma.join(",") << " scheme="
+      << (s.scheme == SdeScheme::EulerMaruyama ? "euler-maruyama" : "milstein") << " h=" << h << "\n";
+    m << "Seed: " << s.seed << " (Philox4x32-10, counter = step, node pair, path)\n";
+    m << "Recorded: every " << s.recordStride << " steps, nodes 1.." << stats.nodes << "\n";
+    m << "Wall: " << stats.wallSeconds << " s\n";
+    summary.close();
+    return true;
+}
+
+bool writeUncertaintyFiles(const QString& runDir, const UncertaintyBands& bands)
+{
+    const UncertaintySettings& s = bands.settings;
+    if (!writeBandFiles(runDir, "uncertainty", bands.rowSteps, bands.nodes, s.quantiles, bands.mean, bands.variance,
+                        bands.quantile))
+        return false;
+
+    QFile summary(runDir + "/uncertainty_summary.txt");
+    if (!summary.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream m(&summary);
+    m << "Samples: " << bands.samples << " (" << bands.divergedSamples << " dropped, |y| > " << s.divergeLimit
+      << "), " << (s.sobol ? "Sobol" : "pseudo-random") << " seed " << s.seed << "\n";
+    m << "Stopped: "
+      << (bands.converged ? QString("quantiles converged (tolerance %1)").arg(s.tolerance)
+                          : QString("sample limit %1").arg(s.maxSamples))
+      << "\n";
+    m << "Recorded: every " << s.recordStride << " steps, nodes 1.." << bands.nodes << "\n";
+    m << "Wall: " << bands.wallSeconds << " s\n\n";
+    m << "# parameter distribution a b (normal: mean sd, uniform: low high)\n";
+    for (const ParameterDistribution& p : bands.parameters)
+        m << QString::fromStdString(p.name) << " " << (p.kind == DistributionKind::Normal ? "normal" : "uniform")
+          << " " << QString::number(p.a, 'g', 10) << " " << QString::number(p.b, 'g', 10) << "\n";
+    m << "\n# samples max_quantile_change/widest_band\n";
+    for (const UncertaintyCheck& c : bands.checks) m << c.samples << " " << c.change << "\n";
+    summary.close();
+    return true;
+}
+
+// ================= gnuplot: y_all =================
+
+bool writeGnuplotScript(const QString& runDir)
+{
+    QFile script(runDir + "/plot.gnu");
+    if (!script.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+    QTextStream out(&script);
+
+    out << "set terminal pngcairo size 1200,900\n";
+    out << "set output 'y_all.png'\n";
+    out << "set multiplot layout 5,1 title 'Hopfield Network Results'\n";
+    out << "set grid\n";
+    out << "set key left\n";
+    out << "set xlabel 't (step)'\n";
+    out << "set xrange [0:*]\n";
+
+    out << "set ylabel 'y1'\n";
+    out << "plot 'result.dat' using 0:1 with lines linewidth 2 title 'y1'\n\n";
+    out << "set ylabel 'y2'\n";
+    out << "plot 'result.dat' using 0:2 with lines linewidth 2 title 'y2'\n\n";
+    out << "set ylabel 'y3'\n";
+    out << "plot 'result.dat' using 0:3 with lines linewidth 2 title 'y3'\n\n";
+    out << "set ylabel 'y4'\n";
+    out << "plot 'result.dat' using 0:4 with lines linewidth 2 title 'y4'\n\n";
+    out << "set ylabel 'y5'\n";
+    out << "plot 'result.dat' using 0:5 with lines linewidth 2 title 'y5'\n\n";
+
+    out << "unset multiplot\n";
+    out << "set output\n";
+
+    script.close();
+    return true;
+}
+
+// ================= gnuplot: alpha2 scan =================
+
+bool writeAlpha2ScanGnuplotScript(const QString& runDir)
+{
+    QFile script(runDir + "/alpha2_scan.gnu");
+    if (!script.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+    QTextStream g(&script);
+
+    g << "set term pngcairo size 900,700\n";
+    g << "set grid\n";
+    g << "set xlabel 'alpha2'\n";
+    g << "unset key\n";
+    g << "set pointsize 0.6\n";
+
+    const char* yNames[5] = {"y1","y2","y3","y4","y5"};
+    const int col2d[5] = {2,3,4,5,6};
+
+    for (int i = 0; i < 5; ++i) {
+        g << "set output 'alpha2_" << yNames[i] << ".png'\n";
+        g << "set ylabel '" << yNames[i] << "'\n";
+        g << "plot 'alpha2_scan_2d.dat' using 1:" << col2d[i]
+          << " with points pt 7 ps 0.4\n\n";
+    }
+
+    g << "set output\n";
+    script.close();
+    return true;
+}
+
+bool runGnuplot(const QString& runDir, const QString& script, bool* started,
+                QString* stdOut, QString* stdErr)
+{
+    QProcess proc;
+    proc.setWorkingDirectory(runDir);
+    proc.start("gnuplot", QStringList() << script);
+
+    const bool ok = proc.waitForStarted();
+    if (started) *started = ok;
+    if (!ok) return false;
+
+    const bool finished = proc.waitForFinished(-1);
+    if (stdOut) *stdOut = QString::fromLocal8Bit(proc.readAllStandardOutput());
+    if (stdErr) *stdErr = QString::fromLocal8Bit(proc.readAllStandardError());
+    return finished && proc.exitStatus() == QProcess::NormalExit && proc.exitCode() == 0;
+}
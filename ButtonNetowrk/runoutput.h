@@ -0,0 +1,78 @@
+#ifndef RUNOUTPUT_H
+#define RUNOUTPUT_H
+
+#include <QString>
+#include <QStringList>
+
+#include "basinmapper.h"
+#include "continuation.h"
+#include "equilibrium.h"
+#include "eventdetector.h"
+#include "parameterfit.h"
+#include "planescan.h"
+#include "sdeensemble.h"
+#include "sensitivity.h"
+#include "statearena.h"
+#include "uncertainty.h"
+
+// Standard files of a run folder, shared by the GUI and buttonnetwork-cli.
+
+// result.dat, result_stream.csv, table.txt (y1..y5), result_final.csv (all nodes at
+// the last step) and result_summary.dat (mean/rms/min/max over all nodes per step)
+// from rows 0..steps.
+bool writeResultFiles(const QString& runDir, const StateArena& y, int steps);
+
+// events.dat: the event list as a comment, then "event step value y1..yn" per event
+// (event: 1-based position in the list, step: fractional step of the event, value: the
+// event's node there).
+bool writeEventFile(const QString& runDir, const EventLog& log, const std::vector<EventSpec>& specs);
+
+// basin.ppm (one pixel per cell), basin_labels.dat ("x y label", blank line between
+// grid rows), basin_summary.txt (one line per attractor) and basin.gnu (basin.png in
+// the colours of basin.ppm).
+bool writeBasinFiles(const QString& runDir, const BasinMap& map);
+
+// plane_scan.bin (planescan.h layout), plane_scan.ppm (regime heatmap, pending cells
+// drawn from the finest finished pass) and plane_scan_summary.txt (cells per regime).
+// Rewritten after every pass, so the heatmap sharpens while the scan runs.
+bool writePlaneScanFiles(const QString& runDir, const PlaneGrid& grid);
+
+// equilibria.txt (one line per equilibrium: kind, unstable directions, residual,
+// seeds, y1..yn) and equilibria_eigenvalues.dat ("equilibrium re im", largest real
+// part first, blank line between equilibria).
+bool writeEquilibriumFiles(const QString& runDir, const EquilibriumResult& result);
+
+// continuation.dat ("p stable unstable maxRe y1..yn", branches separated by two blank
+// lines), continuation_points.txt ("branch kind p frequency y1..yn" per fold / branch /
+// hopf point) and continuation.gnu (continuation_y1..y5.png, stable solid, unstable dashed).
+bool writeContinuationFiles(const QString& runDir, const QString& parameter,
+                            const std::vector<ContinuationResult>& branches);
+
+// sensitivity_<param>.dat (d y1/dp .. d y5/dp per step, laid out like result.dat),
+// sensitivity_final.csv (every node at the last step, one row per parameter) and
+// sensitivity.gnu (sensitivity_<param>.png).
+bool writeSensitivityFiles(const QString& runDir, const SensitivityResult& result);
+
+// fit_summary.txt (per start: costs, rms error, iterations, start and fitted values),
+// fit_target.dat (the target rows, result.dat layout) and fit.gnu (fit.png: result.dat
+// of the fitted network over the target).
+bool writeFitFiles(const QString& runDir, const FitResult& fit, const FitTarget& target);
+
+// ensemble.dat ("step" then per observed node: mean, std, one column per quantile),
+// ensemble_summary.txt (paths, dropped paths, noise settings) and ensemble.gnu
+// (ensemble_y1..y5.png: mean, median and the quantile bands).
+bool writeEnsembleFiles(const QString& runDir, const EnsembleStats& stats, double h);
+
+// uncertainty.dat (same columns as ensemble.dat), uncertainty_summary.txt (distributions,
+// samples, convergence checks) and uncertainty.gnu (uncertainty_y1..y5.png: nested quantile bands).
+bool writeUncertaintyFiles(const QString& runDir, const UncertaintyBands& bands);
+
+// plot.gnu (y_all.png) and alpha2_scan.gnu (alpha2_y1..y5.png).
+bool writeGnuplotScript(const QString& runDir);
+bool writeAlpha2ScanGnuplotScript(const QString& runDir);
+
+// Runs gnuplot on script inside runDir. started is false when gnuplot could not be launched.
+bool runGnuplot(const QString& runDir, const QString& script, bool* started = nullptr,
+                QString* stdOut = nullptr, QString* stdErr = nullptr);
+
+#endif // RUNOUTPUT_H
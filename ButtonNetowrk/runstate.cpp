@@ -0,0 +1,135 @@
+#include "runstate.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kMagic[8] = {'B', 'N', 'S', 'T', 'A', 'T', 'E', '2'};
+
+bool writeBytes(std::FILE* out, const void* data, std::size_t bytes)
+{
+    return std::fwrite(data, 1, bytes, out) == bytes;
+}
+
+template <class T>
+bool writePod(std::FILE* out, const T& v)
+{
+    return writeBytes(out, &v, sizeof(T));
+}
+
+// The file's data on disk before the rename publishes it: otherwise a crash right
+// after the rename can leave an empty or partial file under the final name.
+bool syncFile(std::FILE* f)
+{
+    if (std::fflush(f) != 0) return false;
+#if defined(_WIN32)
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// The rename itself on disk (POSIX: fsync the directory holding path).
+void syncDirectoryOf(const std::string& path)
+{
+#if !defined(_WIN32)
+    const std::size_t slash = path.find_last_of('/');
+    const std::string dir = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    const int fd = open(dir.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fsync(fd);
+    close(fd);
+#else
+    (void)path;
+#endif
+}
+
+template <class T>
+bool readPod(std::ifstream& in, T& v)
+{
+    return bool(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+}
+
+bool readHeader(std::ifstream& in, RunStateHeader& header)
+{
+    char magic[8];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + 8, kMagic)) return false;
+
+    std::int32_t solver = 0, nodes = 0, steps = 0, target = 0, keyLen = 0;
+    if (!readPod(in, solver) || !readPod(in, nodes) || !readPod(in, steps) || !readPod(in, target))
+        return false;
+    if (!readPod(in, header.h) || !readPod(in, header.nu)) return false;
+    if (!readPod(in, keyLen) || keyLen < 0 || keyLen > 4096) return false;
+    if (nodes <= 0 || steps < 0 || (solver < 0 || solver > 3)) return false;
+
+    header.configKey.assign(std::size_t(keyLen), '\0');
+    if (keyLen > 0 && !in.read(&header.configKey[0], keyLen)) return false;
+
+    header.solver = RunSolverKind(solver);
+    header.nodeCount = nodes;
+    header.steps = steps;
+    header.targetSteps = target;
+    return true;
+}
+
+} // namespace
+
+bool saveRunState(const std::string& path, const RunStateHeader& header, const StateArena& arena)
+{
+    const std::string tmp = path + ".tmp";
+    std::FILE* out = std::fopen(tmp.c_str(), "wb");
+    if (!out) return false;
+
+    bool ok = writeBytes(out, kMagic, sizeof(kMagic))
+              && writePod(out, std::int32_t(header.solver))
+              && writePod(out, std::int32_t(header.nodeCount))
+              && writePod(out, std::int32_t(header.steps))
+              && writePod(out, std::int32_t(header.targetSteps))
+              && writePod(out, header.h)
+              && writePod(out, header.nu)
+              && writePod(out, std::int32_t(header.configKey.size()))
+              && writeBytes(out, header.configKey.data(), header.configKey.size());
+
+    const std::size_t rowBytes = std::size_t(header.nodeCount) * sizeof(double);
+    for (int t = 0; ok && t <= header.steps; ++t) ok = writeBytes(out, arena.state(t), rowBytes);
+    for (int r = 0; ok && r < header.steps; ++r) ok = writeBytes(out, arena.rhs(r), rowBytes);
+
+    ok = ok && syncFile(out);
+    ok = (std::fclose(out) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    syncDirectoryOf(path);
+    return true;
+}
+
+bool readRunStateHeader(const std::string& path, RunStateHeader& header)
+{
+    std::ifstream in(path, std::ios::binary);
+    return in && readHeader(in, header);
+}
+
+bool loadRunState(const std::string& path, RunStateHeader& header, StateArena& arena)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in || !readHeader(in, header)) return false;
+
+    arena.prepare(header.nodeCount, header.steps);
+    const std::streamsize rowBytes = std::streamsize(header.nodeCount * sizeof(double));
+    for (int t = 0; t <= header.steps; ++t)
+        if (!in.read(reinterpret_cast<char*>(arena.state(t)), rowBytes)) return false;
+    for (int r = 0; r < header.steps; ++r)
+        if (!in.read(reinterpret_cast<char*>(arena.rhs(r)), rowBytes)) return false;
+    return true;
+}
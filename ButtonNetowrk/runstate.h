@@ -0,0 +1,35 @@
+#ifndef RUNSTATE_H
+#define RUNSTATE_H
+
+#include "statearena.h"
+
+#include <string>
+
+// Binary snapshot of an integration: header, trajectory rows 0..steps and rhs
+// history rows 0..steps-1, unpadded doubles. state.bin (finished run) is what
+// "extend run" continues from; checkpoint.bin (steps < targetSteps) is what
+// "resume" continues from.
+
+enum class RunSolverKind { Euler = 0, Fractional = 1, FractionalAbm = 2, FractionalGraded = 3 };
+
+struct RunStateHeader {
+    RunSolverKind solver = RunSolverKind::Euler;
+    int nodeCount = 0;
+    int steps = 0;        // completed steps stored in the file
+    int targetSteps = 0;  // steps the run was asked for
+    double h = 0.01;      // Euler step, the GAMMA-ABM step or the graded mesh's maxStep
+    double nu = 1.0;
+    std::string configKey; // network + parameters except the step count
+};
+
+// Writes <path>.tmp, syncs it to disk and renames it over path (then syncs the
+// directory), so after a crash path holds either the old or the complete new snapshot.
+bool saveRunState(const std::string& path, const RunStateHeader& header, const StateArena& arena);
+
+// Loads header and fills the arena (prepare()d for header.nodeCount/steps).
+bool loadRunState(const std::string& path, RunStateHeader& header, StateArena& arena);
+
+// Header only, without touching an arena.
+bool readRunStateHeader(const std::string& path, RunStateHeader& header);
+
+#endif // RUNSTATE_H
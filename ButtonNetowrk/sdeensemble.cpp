@@ -0,0 +1,285 @@
+#include "sdeensemble.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#include "rhskernel.h"
+#include "workerpool.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Paths per batch: bounded by the recorded values a batch holds (64 MB), never by the
+// thread count; results do not depend on it either, paths are fed in path order.
+int batchSize(std::size_t valuesPerPath)
+{
+    const std::size_t budget = (64u << 20) / sizeof(double);
+    return int(std::max<std::size_t>(1, std::min<std::size_t>(1024, budget / std::max<std::size_t>(1, valuesPerPath))));
+}
+
+inline void mulHiLo(std::uint32_t a, std::uint32_t b, std::uint32_t& hi, std::uint32_t& lo)
+{
+    const std::uint64_t product = std::uint64_t(a) * b;
+    hi = std::uint32_t(product >> 32);
+    lo = std::uint32_t(product);
+}
+
+// One path: Euler-Maruyama / Milstein steps, observed nodes copied into `record` per
+// recorded row. False when the path diverged.
+template <class Kernel>
+bool integratePath(const Kernel& kernel, const std::vector<double>& y0, int steps, double h,
+                   const SdeSettings& s, const std::vector<int>& rowSteps, int observed, int path,
+                   std::vector<double>& y, std::vector<double>& dy, double* record)
+{
+    const int n = kernel.nodeCount();
+    const double sqrtH = std::sqrt(h);
+    const bool multiplicative = (s.noise == NoiseKind::Multiplicative);
+    const bool milstein = (s.scheme == SdeScheme::Milstein) && multiplicative;
+
+    std::copy(y0.begin(), y0.begin() + n, y.begin());
+    std::copy(y.begin(), y.begin() + observed, record);
+    std::size_t row = 1;
+
+    for (int t = 1; t <= steps; ++t) {
+        kernel.eval(y.data(), dy.data());
+        for (int j = 0; 2 * j < n; ++j) {
+            double z[2];
+            sdeNormals(s.seed, t, j, path, z);
+            for (int i = 2 * j; i < n && i < 2 * j + 2; ++i) {
+                const double dW = sqrtH * z[i - 2 * j];
+                const double sigma = s.sigmaOf(i);
+                const double g = multiplicative ? y[i] : 1.0;
+                double next = y[i] + h * dy[i] + sigma * g * dW;
+                // g g' = y_i for multiplicative noise
+                if (milstein) next += 0.5 * sigma * sigma * y[i] * (dW * dW - h);
+                y[i] = next;
+            }
+        }
+        for (int i = 0; i < n; ++i)
+            if (!(std::fabs(y[i]) <= s.divergeLimit)) return false;
+        if (row < rowSteps.size() && rowSteps[row] == t) {
+            std::copy(y.begin(), y.begin() + observed, record + row * observed);
+            ++row;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+double SdeSettings::sigmaOf(int node) const
+{
+    if (sigma.empty()) return 0.0;
+    return sigma[std::min<std::size_t>(node, sigma.size() - 1)];
+}
+
+// ================= Philox =================
+
+std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> c, std::array<std::uint32_t, 2> key)
+{
+    for (int round = 0; round < 10; ++round) {
+        std::uint32_t hi0, lo0, hi1, lo1;
+        mulHiLo(0xD2511F53u, c[0], hi0, lo0);
+        mulHiLo(0xCD9E8D57u, c[2], hi1, lo1);
+        c = {hi1 ^ c[1] ^ key[0], lo1, hi0 ^ c[3] ^ key[1], lo0};
+        key[0] += 0x9E3779B9u;
+        key[1] += 0xBB67AE85u;
+    }
+    return c;
+}
+
+void sdeNormals(std::uint64_t seed, int step, int nodePair, int path, double z[2])
+{
+    const std::array<std::uint32_t, 4> x = philox4x32(
+        {std::uint32_t(step), std::uint32_t(nodePair), std::uint32_t(path), 0u},
+        {std::uint32_t(seed), std::uint32_t(seed >> 32)});
+    // two 53-bit uniforms in (0, 1)
+    const double u1 = (double((std::uint64_t(x[0] >> 5) << 26) | (x[1] >> 6)) + 0.5) * (1.0 / 9007199254740992.0);
+    const double u2 = (double((std::uint64_t(x[2] >> 5) << 26) | (x[3] >> 6)) + 0.5) * (1.0 / 9007199254740992.0);
+    const double r = std::sqrt(-2.0 * std::log(u1));
+    z[0] = r * std::cos(2.0 * kPi * u2);
+    z[1] = r * std::sin(2.0 * kPi * u2);
+}
+
+// ================= P^2 quantile =================
+
+void P2Quantile::add(double x)
+{
+    if (n < 5) {
+        q[n++] = x;
+        if (n == 5) {
+            std::sort(q.begin(), q.end());
+            pos = {1.0, 2.0, 3.0, 4.0, 5.0};
+            want = {1.0, 1.0 + 2.0 * p, 1.0 + 4.0 * p, 3.0 + 2.0 * p, 5.0};
+        }
+        return;
+    }
+    ++n;
+
+    int k = 0;
+    if (x < q[0]) {
+        q[0] = x;
+    } else if (x >= q[4]) {
+        q[4] = x;
+        k = 3;
+    } else {
+        while (k < 3 && x >= q[k + 1]) ++k;
+    }
+    for (int i = k + 1; i < 5; ++i) pos[i] += 1.0;
+    const double step[5] = {0.0, p / 2.0, p, (1.0 + p) / 2.0, 1.0};
+    for (int i = 0; i < 5; ++i) want[i] += step[i];
+
+    // move the middle markers towards their desired positions
+    for (int i = 1; i <= 3; ++i) {
+        const double d = want[i] - pos[i];
+        if ((d >= 1.0 && pos[i + 1] - pos[i] > 1.0) || (d <= -1.0 && pos[i - 1] - pos[i] < -1.0)) {
+            const double ds = (d > 0.0) ? 1.0 : -1.0;
+            const double parabolic =
+                q[i] + ds / (pos[i + 1] - pos[i - 1])
+                           * ((pos[i] - pos[i - 1] + ds) * (q[i + 1] - q[i]) / (pos[i + 1] - pos[i])
+                              + (pos[i + 1] - pos[i] - ds) * (q[i] - q[i - 1]) / (pos[i] - pos[i - 1]));
+            if (q[i - 1] < parabolic && parabolic < q[i + 1]) {
+                q[i] = parabolic;
+            } else {
+                const int j = i + int(ds);
+                q[i] += ds * (q[j] - q[i]) / (pos[j] - pos[i]);
+            }
+            pos[i] += ds;
+        }
+    }
+}
+
+double P2Quantile::value() const
+{
+    if (n >= 5) return q[2];
+    if (n == 0) return 0.0;
+    const int count = int(n);
+    std::array<double, 5> sorted = q;
+    for (int i = 1; i < count; ++i)
+        for (int j = i; j > 0 && sorted[j - 1] > sorted[j]; --j) std::swap(sorted[j - 1], sorted[j]);
+    const double at = p * double(count - 1);
+    const int lo = int(at);
+    const int hi = std::min(lo + 1, count - 1);
+    return sorted[lo] + (at - lo) * (sorted[hi] - sorted[lo]);
+}
+
+// ================= Accumulator =================
+
+void EnsembleAccumulator::reset(std::size_t cellCount, const std::vector<double>& quantiles)
+{
+    cells = cellCount;
+    qs = int(quantiles.size());
+    samples = 0;
+    runningMean.assign(cells, 0.0);
+    m2.assign(cells, 0.0);
+    estimators.clear();
+    estimators.reserve(cells * qs);
+    for (std::size_t c = 0; c < cells; ++c)
+        for (double p : quantiles) estimators.emplace_back(p);
+}
+
+void EnsembleAccumulator::add(const std::vector<double>& records, const std::vector<int>& kept, WorkerPool& pool)
+{
+    std::atomic<std::size_t> nextCell(0);
+    const std::size_t chunk = 256;
+    auto feedJob = [&](int) {
+        for (;;) {
+            const std::size_t begin = nextCell.fetch_add(chunk);
+            if (begin >= cells) break;
+            for (std::size_t c = begin; c < std::min(cells, begin + chunk); ++c) {
+                long long seen = samples;
+                for (int b : kept) {
+                    const double x = records[std::size_t(b) * cells + c];
+                    ++seen;
+                    const double delta = x - runningMean[c];
+                    runningMean[c] += delta / double(seen);
+                    m2[c] += delta * (x - runningMean[c]);
+                    for (int k = 0; k < qs; ++k) estimators[c * qs + k].add(x);
+                }
+            }
+        }
+    };
+    pool.run(feedJob);
+    samples += static_cast<long long>(kept.size());
+}
+
+void EnsembleAccumulator::finish(std::vector<double>& mean, std::vector<double>& variance,
+                                 std::vector<double>& quantile) const
+{
+    mean = runningMean;
+    variance.assign(cells, 0.0);
+    quantile.assign(cells * qs, 0.0);
+    for (std::size_t c = 0; c < cells; ++c) {
+        if (samples > 1) variance[c] = m2[c] / double(samples - 1);
+        for (int k = 0; k < qs; ++k) quantile[c * qs + k] = estimators[c * qs + k].value();
+    }
+}
+
+// ================= Ensemble =================
+
+bool runSdeEnsemble(const NetworkSpec& spec, const std::vector<double>& y0, int steps, double h,
+                    const SdeSettings& settings, EnsembleStats& stats, const SdeProgressFn& progress)
+{
+    const auto wallStart = std::chrono::steady_clock::now();
+    stats = EnsembleStats();
+    stats.settings = settings;
+    stats.settings.paths = std::max(1, settings.paths);
+    stats.settings.recordStride = std::max(1, settings.recordStride);
+    const SdeSettings& s = stats.settings;
+
+    for (int t = 0; t <= steps; t += s.recordStride) stats.rowSteps.push_back(t);
+    if (stats.rowSteps.back() != steps) stats.rowSteps.push_back(steps);
+    const int rows = int(stats.rowSteps.size());
+    const int observed = std::max(1, std::min(s.observedNodes, spec.nodeCount));
+    stats.nodes = observed;
+
+    const std::size_t cells = std::size_t(rows) * observed;
+    EnsembleAccumulator accumulator;
+    accumulator.reset(cells, s.quantiles);
+
+    // workers build their own kernel: bytecode / sparse kernels keep scratch state
+    NetworkSpec workerSpec = spec;
+    workerSpec.threads = 1;
+    WorkerPool pool(s.threads > 0 ? s.threads : WorkerPool::hardwareThreads());
+
+    const int batch = batchSize(cells);
+    std::vector<double> records(std::size_t(batch) * cells);
+    std::vector<char> ok(batch);
+    std::atomic<bool> stop(false);
+    std::atomic<int> pathsDone(0);
+
+    for (int first = 0; first < s.paths && !stop; first += batch) {
+        const int count = std::min(batch, s.paths - first);
+        std::atomic<int> nextPath(0);
+        auto integrateJob = [&](int k) {
+            visitRhsKernel(workerSpec, [&](const auto& kernel) {
+                std::vector<double> y(kernel.nodeCount()), dy(kernel.nodeCount());
+                for (;;) {
+                    const int b = nextPath++;
+                    if (b >= count || stop) break;
+                    ok[b] = integratePath(kernel, y0, steps, h, s, stats.rowSteps, observed, first + b, y, dy,
+                                          &records[std::size_t(b) * cells]);
+                    ++pathsDone;
+                    if (k == 0 && progress && !progress(pathsDone)) stop = true;
+                }
+            });
+        };
+        pool.run(integrateJob);
+        if (stop) break;
+
+        // feed in path order
+        std::vector<int> kept;
+        for (int b = 0; b < count; ++b)
+            if (ok[b]) kept.push_back(b);
+            else ++stats.divergedPaths;
+        accumulator.add(records, kept, pool);
+    }
+
+    stats.paths = int(accumulator.count());
+    accumulator.finish(stats.mean, stats.variance, stats.quantile);
+    stats.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    return !stop;
+}
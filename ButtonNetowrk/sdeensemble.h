@@ -0,0 +1,110 @@
+#ifndef SDEENSEMBLE_H
+#define SDEENSEMBLE_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "networkspec.h"
+
+class WorkerPool;
+
+// Noisy network dynamics averaged over many realisations (ODE time step h):
+//   dy_i = f_i(y) dt + sigma_i g(y_i) dW_i,   g = 1 (additive) or y_i (multiplicative)
+// Euler-Maruyama, or Milstein, which adds 1/2 sigma_i^2 g g' (dW_i^2 - dt) and is of strong
+// order 1 for this diagonal noise (the same as Euler-Maruyama for additive noise).
+// dW_i of path p at step t comes from a counter-based generator (Philox4x32-10) keyed by the
+// seed with counter (t, i / 2, p): no generator state is carried, so paths run on any
+// thread in any order and every path is the same whatever the thread count.
+// Paths are integrated in batches and their observed nodes fed into the statistics in
+// path order: running mean / variance (Welford) and P^2 quantile estimates (Jain &
+// Chlamtac) per recorded step and node, so memory does not grow with the path count and
+// the statistics are bitwise reproducible too.
+
+enum class NoiseKind { Additive, Multiplicative };
+enum class SdeScheme { EulerMaruyama, Milstein };
+
+struct SdeSettings {
+    int paths = 1000;
+    std::vector<double> sigma = {0.1};  // per node; a shorter list repeats its last value
+    NoiseKind noise = NoiseKind::Additive;
+    SdeScheme scheme = SdeScheme::EulerMaruyama;
+    std::uint64_t seed = 1;
+    int recordStride = 1;               // statistics at steps 0, stride, 2 stride, ... and the last step
+    int observedNodes = 5;              // statistics for nodes 1..observedNodes
+    std::vector<double> quantiles = {0.05, 0.5, 0.95};
+    double divergeLimit = 1e6;          // |y_i| above it (or not finite): the path is dropped
+    int threads = 0;                    // 0: all cores
+
+    double sigmaOf(int node) const;
+};
+
+// Streaming p-quantile estimate without storing the samples (P^2 algorithm, five markers).
+class P2Quantile
+{
+public:
+    explicit P2Quantile(double p = 0.5) : p(p) {}
+    void add(double x);
+    double value() const;               // exact for fewer than five samples
+    long long count() const { return n; }
+
+private:
+    double p;
+    long long n = 0;
+    std::array<double, 5> q{};          // marker heights
+    std::array<double, 5> pos{};        // marker positions
+    std::array<double, 5> want{};       // desired positions
+};
+
+// Per-cell running mean / variance (Welford) and P^2 quantiles. Records (one value per
+// cell) are fed in record order and the cells updated in parallel, so the statistics do
+// not depend on the thread count. Also used by the weight uncertainty runs (uncertainty.h).
+class EnsembleAccumulator
+{
+public:
+    void reset(std::size_t cells, const std::vector<double>& quantiles);
+    // records[b * cells + c] for every b in `kept`, in that order
+    void add(const std::vector<double>& records, const std::vector<int>& kept, WorkerPool& pool);
+    long long count() const { return samples; }
+    double quantile(std::size_t cell, int k) const { return estimators[cell * qs + k].value(); }
+    // unbiased variance; quantile k of cell c at [c * quantiles + k]
+    void finish(std::vector<double>& mean, std::vector<double>& variance, std::vector<double>& quantile) const;
+
+private:
+    std::size_t cells = 0;
+    int qs = 0;
+    long long samples = 0;
+    std::vector<double> runningMean, m2;
+    std::vector<P2Quantile> estimators;
+};
+
+struct EnsembleStats {
+    SdeSettings settings;
+    std::vector<int> rowSteps;          // step of each recorded row
+    int nodes = 0;                      // observed nodes
+    // row r, node i at [r * nodes + i]; quantile k of it at [(r * nodes + i) * quantiles + k]
+    std::vector<double> mean;
+    std::vector<double> variance;       // unbiased (n - 1)
+    std::vector<double> quantile;
+    int paths = 0;                      // paths in the statistics
+    int divergedPaths = 0;
+    double wallSeconds = 0.0;
+};
+
+// Philox4x32-10 block for (counter, key); four independent uniform 32-bit words.
+std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key);
+
+// Standard normals z[0], z[1] for nodes 2j and 2j+1 of path p at step t (Box-Muller on the
+// Philox block).
+void sdeNormals(std::uint64_t seed, int step, int nodePair, int path, double z[2]);
+
+// Called on the calling thread with the number of finished paths; false cancels.
+using SdeProgressFn = std::function<bool(int pathsDone)>;
+
+// Returns false when cancelled; stats then covers the batches finished so far.
+bool runSdeEnsemble(const NetworkSpec& spec, const std::vector<double>& y0, int steps, double h,
+                    const SdeSettings& settings, EnsembleStats& stats,
+                    const SdeProgressFn& progress = SdeProgressFn());
+
+#endif // SDEENSEMBLE_H
@@ -0,0 +1,224 @@
+#include "sensitivity.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+
+#include "rhskernel.h"
+
+namespace {
+
+const int kSensitivityProgressInterval = 400;
+
+using RhsFunction = std::function<void(const double* y, double* dy)>;
+
+// Serial kernel of a parameter-shifted network (only for the difference quotient of f)
+RhsFunction rhsFunction(const NetworkSpec& spec)
+{
+    if (spec.equations) {
+        auto kernel = std::make_shared<BytecodeRhsKernel>(spec.equations);
+        return [kernel](const double* y, double* dy) { kernel->eval(y, dy); };
+    }
+    auto kernel = std::make_shared<GenericRhsKernel>(spec);
+    return [kernel](const double* y, double* dy) { kernel->eval(y, dy); };
+}
+
+// Edges and gates can be differentiated by hand when the shifted networks have the same shape
+bool analyticParameters(const NetworkSpec& spec, const std::vector<SensitivityParameter>& parameters)
+{
+    if (spec.equations) return false;
+    for (const SensitivityParameter& p : parameters) {
+        for (const NetworkSpec* s : {&p.low, &p.high}) {
+            if (s->equations || s->edges.size() != spec.edges.size() || s->gates.size() != spec.gates.size())
+                return false;
+            for (std::size_t e = 0; e < spec.edges.size(); ++e)
+                if (s->edges[e].from != spec.edges[e].from || s->edges[e].to != spec.edges[e].to
+                    || s->edges[e].fn != spec.edges[e].fn)
+                    return false;
+            for (std::size_t g = 0; g < spec.gates.size(); ++g)
+                if (s->gates[g].node != spec.gates[g].node || s->gates[g].source != spec.gates[g].source
+                    || s->gates[g].fn != spec.gates[g].fn)
+                    return false;
+        }
+    }
+    return true;
+}
+
+// d weight / dp per edge, d base / dp and d coeff / dp per gate
+struct SpecDerivative {
+    std::vector<double> weight, base, coeff;
+};
+
+SpecDerivative specDerivative(const SensitivityParameter& p)
+{
+    SpecDerivative d;
+    const double scale = 1.0 / (2.0 * p.delta);
+    for (std::size_t e = 0; e < p.low.edges.size(); ++e)
+        d.weight.push_back((p.high.edges[e].weight - p.low.edges[e].weight) * scale);
+    for (std::size_t g = 0; g < p.low.gates.size(); ++g) {
+        d.base.push_back((p.high.gates[g].base - p.low.gates[g].base) * scale);
+        d.coeff.push_back((p.high.gates[g].coeff - p.low.gates[g].coeff) * scale);
+    }
+    return d;
+}
+
+// s_next = s + h * (J s + f_p) with the activations of y evaluated once for all parameters
+class AnalyticStep
+{
+public:
+    AnalyticStep(const NetworkSpec& spec, const std::vector<SensitivityParameter>& parameters)
+        : spec(spec), edgeValue(spec.edges.size()), edgeSlope(spec.edges.size()),
+          gateTanh(spec.gates.size()), gateValue(spec.gates.size()), gateSlope(spec.gates.size())
+    {
+        for (const SensitivityParameter& p : parameters) derivatives.push_back(specDerivative(p));
+        // as in the kernels: edges / gates outside the network do not contribute
+        for (std::size_t e = 0; e < spec.edges.size(); ++e)
+            if (edgeInRange(spec.edges[e], spec.nodeCount)) edges.push_back(e);
+        for (std::size_t k = 0; k < spec.gates.size(); ++k)
+            if (gateInRange(spec.gates[k], spec.nodeCount)) gates.push_back(k);
+    }
+
+    void operator()(int n, const double* y, const double* s, double* sNext, double h, std::vector<double>& g)
+    {
+        for (std::size_t e : edges) {
+            const EdgeSpec& edge = spec.edges[e];
+            edgeValue[e] = applyActivation(edge.fn, y[edge.from]);
+            edgeSlope[e] = edge.weight * activationSlope(edge.fn, y[edge.from]);
+        }
+        // G * tanh(y_node), G = base - coeff * fn(y_source)
+        for (std::size_t k : gates) {
+            const GateTermSpec& gate = spec.gates[k];
+            gateTanh[k] = std::tanh(y[gate.node]);
+            gateValue[k] = applyActivation(gate.fn, y[gate.source]);
+            gateSlope[k] = gate.coeff * activationSlope(gate.fn, y[gate.source]);
+        }
+
+        for (std::size_t k = 0; k < derivatives.size(); ++k) {
+            const SpecDerivative& d = derivatives[k];
+            const double* sk = s + k * n;
+            for (int i = 0; i < n; ++i) g[i] = -sk[i];
+            for (std::size_t e : edges) {
+                const EdgeSpec& edge = spec.edges[e];
+                g[edge.to] += edgeSlope[e] * sk[edge.from] + d.weight[e] * edgeValue[e];
+            }
+            for (std::size_t q : gates) {
+                const GateTermSpec& gate = spec.gates[q];
+                const double t = gateTanh[q];
+                const double gateG = gate.base - gate.coeff * gateValue[q];
+                g[gate.node] += gateG * (1.0 - t * t) * sk[gate.node] - gateSlope[q] * t * sk[gate.source]
+                                + (d.base[q] - d.coeff[q] * gateValue[q]) * t;
+            }
+            double* out = sNext + k * n;
+            for (int i = 0; i < n; ++i) out[i] = sk[i] + h * g[i];
+        }
+    }
+
+private:
+    const NetworkSpec& spec;
+    std::vector<SpecDerivative> derivatives;
+    std::vector<std::size_t> edges, gates; // the ones inside the network
+    std::vector<double> edgeValue, edgeSlope, gateTanh, gateValue, gateSlope;
+};
+
+// J s by a central difference along s, f_p by the shifted networks
+class DifferenceStep
+{
+public:
+    explicit DifferenceStep(const std::vector<SensitivityParameter>& parameters)
+        : parameters(parameters)
+    {
+        for (const SensitivityParameter& p : parameters) {
+            low.push_back(rhsFunction(p.low));
+            high.push_back(rhsFunction(p.high));
+        }
+    }
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel, int n, const double* y, const double* s, double* sNext, double h,
+                    std::vector<double>& g)
+    {
+        probe.resize(n);
+        fPlus.resize(n);
+        fMinus.resize(n);
+        double yScale = 0.0;
+        for (int i = 0; i < n; ++i) yScale = std::max(yScale, std::fabs(y[i]));
+
+        for (std::size_t k = 0; k < parameters.size(); ++k) {
+            const double* sk = s + k * n;
+            double sScale = 0.0;
+            for (int i = 0; i < n; ++i) sScale = std::max(sScale, std::fabs(sk[i]));
+            for (int i = 0; i < n; ++i) g[i] = 0.0;
+            if (sScale > 0.0) {
+                const double eps = 1e-6 * (1.0 + yScale) / sScale;
+                for (int i = 0; i < n; ++i) probe[i] = y[i] + eps * sk[i];
+                kernel.eval(probe.data(), fPlus.data());
+                for (int i = 0; i < n; ++i) probe[i] = y[i] - eps * sk[i];
+                kernel.eval(probe.data(), fMinus.data());
+                for (int i = 0; i < n; ++i) g[i] = (fPlus[i] - fMinus[i]) / (2.0 * eps);
+            }
+            high[k](y, fPlus.data());
+            low[k](y, fMinus.data());
+            double* out = sNext + k * n;
+            for (int i = 0; i < n; ++i)
+                out[i] = sk[i] + h * (g[i] + (fPlus[i] - fMinus[i]) / (2.0 * parameters[k].delta));
+        }
+    }
+
+private:
+    const std::vector<SensitivityParameter>& parameters;
+    std::vector<RhsFunction> low, high;
+    std::vector<double> probe, fPlus, fMinus;
+};
+
+} // namespace
+
+bool integrateEulerSensitivity(const NetworkSpec& spec, const std::vector<double>& y0, int steps, double h,
+                               const std::vector<SensitivityParameter>& parameters, StateArena& arena,
+                               SensitivityResult& result, const SolverProgressFn& progress)
+{
+    const auto start = std::chrono::steady_clock::now();
+    arena.prepare(spec.nodeCount, steps);
+    double* first = arena.state(0);
+    for (int i = 0; i < spec.nodeCount; ++i) first[i] = y0[i];
+
+    result = SensitivityResult();
+    for (const SensitivityParameter& p : parameters) result.names.push_back(p.name);
+    result.steps = steps;
+    result.analytic = analyticParameters(spec, parameters);
+
+    bool done = true;
+    visitRhsKernel(spec, [&](const auto& kernel) {
+        const int n = kernel.nodeCount();
+        const std::size_t row = parameters.size() * std::size_t(n);
+        result.nodeCount = n;
+        result.values.assign((std::size_t(steps) + 1) * row, 0.0);
+        std::vector<double> g(n);
+        std::unique_ptr<AnalyticStep> analytic;
+        std::unique_ptr<DifferenceStep> difference;
+        if (result.analytic) analytic.reset(new AnalyticStep(spec, parameters));
+        else difference.reset(new DifferenceStep(parameters));
+
+        // same arithmetic as eulerLoop (networksolver.cpp) for the trajectory
+        for (int t = 1; t <= steps; ++t) {
+            if (progress && t % kSensitivityProgressInterval == 0 && !progress(t)) {
+                done = false;
+                return;
+            }
+            const double* prev = arena.state(t - 1);
+            double* dy = arena.rhs(t - 1);
+            double* next = arena.state(t);
+            kernel.eval(prev, dy);
+
+            const double* s = result.values.data() + std::size_t(t - 1) * row;
+            double* sNext = result.values.data() + std::size_t(t) * row;
+            if (analytic) (*analytic)(n, prev, s, sNext, h, g);
+            else (*difference)(kernel, n, prev, s, sNext, h, g);
+
+            for (int i = 0; i < n; ++i) next[i] = prev[i] + h * dy[i];
+        }
+    });
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return done;
+}
@@ -0,0 +1,51 @@
+#ifndef SENSITIVITY_H
+#define SENSITIVITY_H
+
+#include <string>
+#include <vector>
+
+#include "networksolver.h"
+#include "networkspec.h"
+#include "statearena.h"
+
+// Forward sensitivities s_k(t) = d y(t) / d p_k of an ODE (Euler) run, integrated together
+// with the trajectory in one augmented run instead of one perturbed run per parameter:
+//   s_k,t = s_k,t-1 + h * (J(y_t-1) s_k,t-1 + d f / d p_k (y_t-1)),   s_k,0 = 0
+// This is the exact derivative of the Euler steps themselves, so it agrees with finite
+// differences of whole runs up to their own truncation error. Edges and gates use the
+// analytic Jacobian and evaluate every activation and its slope once per step for all
+// parameters; custom equations use central differences through the RHS kernel.
+// The trajectory is the same as integrateEuler's, bit for bit.
+
+// A parameter is given as the network at p - delta and p + delta. Edge weights, gate bases
+// and gate coefficients are linear in alpha1-3 / s<ij>, so for edges and gates the
+// derivative of the network is exact whatever delta is.
+struct SensitivityParameter {
+    std::string name;
+    NetworkSpec low;
+    NetworkSpec high;
+    double delta = 1e-4;
+};
+
+struct SensitivityResult {
+    std::vector<std::string> names;
+    int nodeCount = 0;
+    int steps = 0;
+    bool analytic = true;          // false: central differences (custom equations)
+    // row t, parameter k, node i at [(t * names.size() + k) * nodeCount + i], t = 0..steps
+    std::vector<double> values;
+    double wallSeconds = 0.0;
+
+    double at(int t, int k, int i) const
+    {
+        return values[(std::size_t(t) * names.size() + k) * nodeCount + i];
+    }
+};
+
+// Like integrateEuler (the arena holds the trajectory afterwards), plus the sensitivities.
+// Returns false when the progress callback cancelled the run.
+bool integrateEulerSensitivity(const NetworkSpec& spec, const std::vector<double>& y0, int steps, double h,
+                               const std::vector<SensitivityParameter>& parameters, StateArena& arena,
+                               SensitivityResult& result, const SolverProgressFn& progress = SolverProgressFn());
+
+#endif // SENSITIVITY_H
@@ -0,0 +1,758 @@
+#include "simulationconfig.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QStringList>
+#include <QTextStream>
+
+#include <mutex>
+
+#include "networkgenerator.h"
+#include "networksolver.h"
+#include "nodeordering.h"
+#include "resultcache.h"
+#include "rhskernel.h"
+
+namespace {
+
+// shortest text that reads back to the same double, so replayed runs are identical
+QString num(double v) { return QString::number(v, 'g', QLocale::FloatingPointShortest); }
+
+//networkSpec() 은 cache key, run_info 등에서 여러 번 불리므로 마지막 edge list 는 parse 결과를 재사용
+struct ParsedEdgeList {
+    QString path;
+    QDateTime modified;
+    qint64 size = -1;
+    ActivationKind fn = ActivationKind::None;
+    bool ok = false;
+    QString error;
+    NetworkSpec spec;
+};
+
+bool loadEdgeList(const QString& path, ActivationKind fn, NetworkSpec& spec, QString* error)
+{
+    static std::mutex mutex;
+    static ParsedEdgeList last;
+
+    const QFileInfo fi(path);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (last.path != fi.absoluteFilePath() || last.modified != fi.lastModified()
+        || last.size != fi.size() || last.fn != fn) {
+        last = ParsedEdgeList();
+        last.path = fi.absoluteFilePath();
+        last.modified = fi.lastModified();
+        last.size = fi.size();
+        last.fn = fn;
+
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            last.error = "cannot read " + path;
+        } else {
+            std::string why;
+            last.ok = parseEdgeList(f.readAll().toStdString(), fn, last.spec, &why);
+            if (!last.ok) last.error = path + ": " + QString::fromStdString(why);
+        }
+    }
+    if (!last.ok) {
+        if (error) *error = last.error;
+        return false;
+    }
+    spec = last.spec;
+    return true;
+}
+
+//"s<from><to>", node 1..5
+bool isWeightName(const QString& name)
+{
+    for (int from = 1; from <= 5; ++from)
+        for (int to = 1; to <= 5; ++to)
+            if (name == SimulationConfig::weightKey(from, to)) return true;
+    return false;
+}
+
+//"nu3" -> 3 (node order), 아니면 0
+int nodeOrderIndex(const QString& name)
+{
+    if (!name.startsWith("nu") || name.size() < 3) return 0;
+    bool ok = false;
+    const int node = name.mid(2).toInt(&ok);
+    return (ok && node >= 1) ? node : 0;
+}
+
+} // namespace
+
+SimulationConfig::SimulationConfig()
+{
+    // Defaults for demo
+    gateNode4.enabled = true;
+    gateNode4.baseType = "alpha2";
+    gateNode4.baseConst = 1.0;
+    gateNode4.coeff = 1.2;
+    gateNode4.fn = "sin";
+
+    gateNode5.enabled = true;
+    gateNode5.baseType = "const";
+    gateNode5.baseConst = 1.0;
+    gateNode5.coeff = 2.2;
+    gateNode5.fn = "tanh";
+}
+
+QString SimulationConfig::weightKey(int from, int to)
+{
+    return "s" + QString::number(from) + QString::number(to);
+}
+
+ActivationKind SimulationConfig::activationFromName(const QString& fn)
+{
+    if (fn == "sin_exp" || fn == "sin") return ActivationKind::Sin;
+    if (fn == "tanh") return ActivationKind::Tanh;
+    if (fn == "relu") return ActivationKind::Relu;
+    return ActivationKind::None;
+}
+
+// ================= Scan parameters =================
+
+QStringList SimulationConfig::scanParameterNames()
+{
+    return {"alpha1", "alpha2", "alpha3", "nu", "h"};
+}
+
+bool SimulationConfig::setScanParameter(const QString& name, double value)
+{
+    if (name == "alpha1") alpha1 = value;
+    else if (name == "alpha2") alpha2 = value;
+    else if (name == "alpha3") alpha3 = value;
+    else if (name == "nu") nu = value;
+    else if (nodeOrderIndex(name) > 0) nodeOrders[nodeOrderIndex(name)] = value;
+    else if (name == "h" && solverKind() == RunSolverKind::FractionalAbm) fractionalStep = value;
+    else if (name == "h" && solverKind() == RunSolverKind::FractionalGraded) gradedMesh.maxStep = value;
+    else if (name == "h") odeStep = value;
+    else if (isWeightName(name)) weightValues[name] = value;
+    else if (name == "g4coeff") gateNode4.coeff = value;
+    else if (name == "g5coeff") gateNode5.coeff = value;
+    else if (name == "g4base") gateNode4.baseConst = value;
+    else if (name == "g5base") gateNode5.baseConst = value;
+    else return false;
+    return true;
+}
+
+bool SimulationConfig::scanParameter(const QString& name, double& value) const
+{
+    if (name == "alpha1") value = alpha1;
+    else if (name == "alpha2") value = alpha2;
+    else if (name == "alpha3") value = alpha3;
+    else if (name == "nu") value = nu;
+    else if (nodeOrderIndex(name) > 0) value = nodeOrders.value(nodeOrderIndex(name), nu);
+    else if (name == "h") value = solverStep();
+    else if (isWeightName(name)) value = weightValues.value(name, 0.0);
+    else if (name == "g4coeff") value = gateNode4.coeff;
+    else if (name == "g5coeff") value = gateNode5.coeff;
+    else if (name == "g4base") value = gateNode4.baseConst;
+    else if (name == "g5base") value = gateNode5.baseConst;
+    else return false;
+    return true;
+}
+
+// ================= Per-node orders =================
+
+std::vector<double> SimulationConfig::nodeNu(int nodeCount) const
+{
+    std::vector<double> orders(nodeCount, nu);
+    for (auto it = nodeOrders.begin(); it != nodeOrders.end(); ++it)
+        if (it.key() >= 1 && it.key() <= nodeCount) orders[it.key() - 1] = it.value();
+    return orders;
+}
+
+bool SimulationConfig::mixedOrders() const
+{
+    for (double order : nodeOrders)
+        if (order != nu) return true;
+    return false;
+}
+
+QString SimulationConfig::nodeOrdersText() const
+{
+    QStringList parts;
+    for (auto it = nodeOrders.begin(); it != nodeOrders.end(); ++it)
+        if (it.value() != nu) parts << QString::number(it.key()) + "=" + num(it.value());
+    return parts.join(" ");
+}
+
+//"3=0.5, 5=1" 형식, 빈 문자열이면 모든 node 가 nu
+bool SimulationConfig::setNodeOrdersText(const QString& text)
+{
+    QMap<int, double> orders;
+    QString list = text;
+    list.replace(",", " ");
+    for (const QString& token : list.split(' ', Qt::SkipEmptyParts)) {
+        const QStringList parts = token.split('=');
+        bool okNode = false, okOrder = false;
+        const int node = parts.size() == 2 ? parts[0].toInt(&okNode) : 0;
+        const double order = parts.size() == 2 ? parts[1].toDouble(&okOrder) : 0.0;
+        if (!okNode || !okOrder || node < 1 || order <= 0.0) return false;
+        orders[node] = order;
+    }
+    nodeOrders = orders;
+    return true;
+}
+
+//ABM / graded mesh 는 node 별 차수를 지원하지 않음 (ODE 는 차수를 쓰지 않음)
+bool SimulationConfig::checkNodeOrders(QString* error) const
+{
+    const RunSolverKind kind = solverKind();
+    if (!mixedOrders() || kind == RunSolverKind::Fractional || kind == RunSolverKind::Euler) return true;
+    if (error) *error = "Per-node orders (" + nodeOrdersText() + ") need the GAMMA solver.";
+    return false;
+}
+
+// ================= Events =================
+
+std::vector<EventSpec> SimulationConfig::eventSpecs() const
+{
+    std::vector<EventSpec> specs;
+    parseEventSpecs(events.toStdString(), specs);
+    return specs;
+}
+
+bool SimulationConfig::checkEvents(int nodeCount, QString* error) const
+{
+    std::vector<EventSpec> specs;
+    std::string why;
+    if (!parseEventSpecs(events.toStdString(), specs, &why)) {
+        if (error) *error = "Events: " + QString::fromStdString(why);
+        return false;
+    }
+    for (const EventSpec& s : specs) {
+        if (nodeCount > 0 && s.node >= nodeCount) {
+            if (error) *error = QString("Events: y%1, the network has %2 nodes.").arg(s.node + 1).arg(nodeCount);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ================= Gate helpers =================
+
+double SimulationConfig::baseValueFromType(const QString& baseType, double baseConst) const
+{
+    if (baseType == "alpha1") return alpha1;
+    if (baseType == "alpha2") return alpha2;
+    if (baseType == "alpha3") return alpha3;
+    if (baseType == "const")  return baseConst;
+    return baseConst;
+}
+
+//nodeIndex가 node4 또는 node5일 때, 그 노드의 Gate(G2 또는 G1) 항을 solver용 GateTermSpec으로 변환.
+//Gate가 꺼져 있으면 기존 고정식 (alpha2 - alpha3*sin(y5)), (1 - alpha1*tanh(y3)) 사용
+GateTermSpec SimulationConfig::gateTermForNode(int nodeIndex) const
+{
+    GateTermSpec term;
+    term.node = nodeIndex;
+
+    const GateConfig& gate = (nodeIndex == 3) ? gateNode4 : gateNode5;
+    if (gate.enabled) {
+        term.source = nodeIndex;
+        term.base = baseValueFromType(gate.baseType, gate.baseConst);
+        term.coeff = gate.coeff;
+        term.fn = activationFromName(gate.fn);
+        if (term.fn == ActivationKind::None) term.fn = ActivationKind::Sin;
+    } else if (nodeIndex == 3) {
+        term.source = 4;
+        term.base = alpha2;
+        term.coeff = alpha3;
+        term.fn = ActivationKind::Sin;
+    } else {
+        term.source = 2;
+        term.base = 1.0;
+        term.coeff = alpha1;
+        term.fn = ActivationKind::Tanh;
+    }
+    return term;
+}
+
+// ================= Network -> solver spec =================
+
+// ODE: drawn connections, start -> end adds w*fn(y_start) to dy_end
+NetworkSpec SimulationConfig::buildDrawnNetworkSpec() const
+{
+    NetworkSpec spec;
+    spec.nodeCount = 5;
+
+    for (const ConnectionConfig& conn : connections) {
+        EdgeSpec e;
+        e.from = conn.from - 1;
+        e.to   = conn.to - 1;
+        e.weight = weightValues.value(weightKey(conn.from, conn.to), 0.0);
+        e.fn = activationFromName(conn.function);
+        spec.edges.push_back(e);
+    }
+
+    spec.gates.push_back(gateTermForNode(3));
+    spec.gates.push_back(gateTermForNode(4));
+    return spec;
+}
+
+// GAMMA: fixed equations of solver.c, s_ij adds s_ij*fn(y_j) to dy_i
+NetworkSpec SimulationConfig::buildGammaNetworkSpec() const
+{
+    struct Term { int i; int j; ActivationKind fn; };
+    static const Term terms[] = {
+        {1, 2, ActivationKind::Tanh}, {1, 3, ActivationKind::Sin}, {1, 4, ActivationKind::Sin},
+        {2, 1, ActivationKind::Sin},  {2, 3, ActivationKind::Sin}, {2, 5, ActivationKind::Sin},
+        {3, 1, ActivationKind::Tanh}, {3, 2, ActivationKind::Tanh}, {3, 3, ActivationKind::Sin},
+        {4, 1, ActivationKind::Tanh},
+        {5, 2, ActivationKind::Tanh},
+    };
+
+    NetworkSpec spec;
+    spec.nodeCount = 5;
+    for (const Term& t : terms)
+        spec.edges.push_back({t.j - 1, t.i - 1, weightValues.value(weightKey(t.i, t.j), 0.0), t.fn});
+
+    spec.gates.push_back(gateTermForNode(3));
+    spec.gates.push_back(gateTermForNode(4));
+    return spec;
+}
+
+//Large network: 생성된 graph 또는 edge list. Gate 없음, 모든 node 가 dy_i = -y_i + sum w*fn(y_j)
+NetworkSpec SimulationConfig::buildLargeNetworkSpec(QString* error) const
+{
+    if (error) error->clear();
+    NetworkSpec spec;
+    const ActivationKind fn = activationFromName(large.fn);
+    if (fn == ActivationKind::None) {
+        if (error) *error = "unknown function \"" + large.fn + "\"";
+        return spec;
+    }
+
+    NodeOrdering ordering = NodeOrdering::None;
+    if (!nodeOrderingFromName(large.ordering.toStdString(), ordering)) {
+        if (error) *error = "unknown node ordering \"" + large.ordering + "\"";
+        return spec;
+    }
+
+    if (large.kind == "edgelist") {
+        if (!loadEdgeList(large.edgeListPath, fn, spec, error)) spec = NetworkSpec();
+        spec.ordering = ordering;
+        return spec;
+    }
+
+    SparseGraphSettings settings;
+    if (!sparseGraphKindFromName(large.kind.toStdString(), settings.kind)) {
+        if (error) *error = "unknown large network kind \"" + large.kind + "\"";
+        return spec;
+    }
+    settings.nodes = large.nodes;
+    settings.degree = large.degree;
+    settings.rewire = large.rewire;
+    settings.weightScale = large.weightScale;
+    settings.seed = large.seed;
+    settings.fn = fn;
+    spec = generateSparseNetwork(settings);
+    spec.ordering = ordering;
+    return spec;
+}
+
+bool SimulationConfig::checkLargeNetwork(QString* error) const
+{
+    if (!large.enabled() || !equations.trimmed().isEmpty()) return true;
+    QString why;
+    buildLargeNetworkSpec(&why);
+    if (why.isEmpty()) return true;
+    if (error) *error = "Large network: " + why;
+    return false;
+}
+
+NetworkSpec SimulationConfig::networkSpec() const
+{
+    if (!equations.trimmed().isEmpty()) {
+        // edges/gates stay empty so the cache key only depends on the compiled equations
+        NetworkSpec spec;
+        spec.nodeCount = 5;
+        spec.equations = compileEquations();
+        return spec;
+    }
+    if (large.enabled()) return buildLargeNetworkSpec();
+    return (solverMode == "ODE") ? buildDrawnNetworkSpec() : buildGammaNetworkSpec();
+}
+
+RunSolverKind SimulationConfig::solverKind() const
+{
+    if (solverMode == "ODE") return RunSolverKind::Euler;
+    if (solverMode == "GAMMA-ABM") return RunSolverKind::FractionalAbm;
+    return (solverMode == "GAMMA-GRADED") ? RunSolverKind::FractionalGraded : RunSolverKind::Fractional;
+}
+
+FractionalKernel SimulationConfig::historyKernel() const
+{
+    return (fractionalKernel == "gamma") ? FractionalKernel::GammaRatio : FractionalKernel::PowDifference;
+}
+
+double SimulationConfig::solverStep() const
+{
+    if (solverKind() == RunSolverKind::FractionalAbm) return fractionalStep;
+    return (solverKind() == RunSolverKind::FractionalGraded) ? gradedMesh.maxStep : odeStep;
+}
+
+// ================= Custom equations =================
+
+// alpha1-3, nu and s11..s55 (weights not set read as 0, as in the drawn network)
+EquationParameters SimulationConfig::equationParameters() const
+{
+    EquationParameters params;
+    params["alpha1"] = alpha1;
+    params["alpha2"] = alpha2;
+    params["alpha3"] = alpha3;
+    params["nu"] = nu;
+    for (int i = 1; i <= 5; ++i)
+        for (int j = 1; j <= 5; ++j)
+            params[weightKey(i, j).toStdString()] = 0.0;
+    for (auto it = weightValues.begin(); it != weightValues.end(); ++it)
+        params[it.key().toStdString()] = it.value();
+    return params;
+}
+
+std::shared_ptr<const EquationProgram> SimulationConfig::compileEquations(QString* error) const
+{
+    std::string why;
+    auto program = ::compileEquations(equations.toStdString(), 5, equationParameters(), &why);
+    if (program && program->nodeCount > 5) {
+        why = "y" + std::to_string(program->nodeCount) + ": the network has 5 nodes";
+        program.reset();
+    }
+    if (error) *error = QString::fromStdString(why);
+    return program;
+}
+
+bool SimulationConfig::checkEquations(QString* error) const
+{
+    if (equations.trimmed().isEmpty()) return true;
+    QString why;
+    if (compileEquations(&why)) return true;
+    if (error) *error = "Equations: " + why;
+    return false;
+}
+
+//지금 그려진 network(또는 GAMMA 고정식)를 "Dy_i = ..." 형태로. weight/alpha는 이름으로 남겨서
+//alpha2 scan 이나 weight 수정이 그대로 반영되게 함
+QString SimulationConfig::networkAsEquations() const
+{
+    const bool ode = (solverMode == "ODE");
+    const NetworkSpec spec = ode ? buildDrawnNetworkSpec() : buildGammaNetworkSpec();
+
+    auto fnName = [](ActivationKind fn) -> QString {
+        switch (fn) {
+        case ActivationKind::Sin:  return "sin";
+        case ActivationKind::Tanh: return "tanh";
+        case ActivationKind::Relu: return "relu";
+        case ActivationKind::None: break;
+        }
+        return QString();
+    };
+    auto y = [](int index) { return "y" + QString::number(index + 1); };
+
+    QStringList lines;
+    for (int i = 0; i < spec.nodeCount; ++i) {
+        QString line = "Dy" + QString::number(i + 1) + " = -" + y(i);
+
+        for (const EdgeSpec& e : spec.edges) {
+            if (e.to != i || e.fn == ActivationKind::None) continue;
+            const QString w = ode ? weightKey(e.from + 1, e.to + 1) : weightKey(e.to + 1, e.from + 1);
+            line += " + " + w + "*" + fnName(e.fn) + "(" + y(e.from) + ")";
+        }
+
+        for (const GateTermSpec& g : spec.gates) {
+            if (g.node != i) continue;
+            const GateConfig& gate = (g.node == 3) ? gateNode4 : gateNode5;
+            QString base, coeff;
+            if (gate.enabled) {
+                base = gate.baseType.startsWith("alpha") ? gate.baseType : num(g.base);
+                coeff = num(g.coeff);
+            } else if (g.node == 3) {
+                base = "alpha2";
+                coeff = "alpha3";
+            } else {
+                base = "1";
+                coeff = "alpha1";
+            }
+            line += " + (" + base + " - " + coeff + "*" + fnName(g.fn) + "(" + y(g.source) + "))*tanh(" + y(i) + ")";
+        }
+        lines << line;
+    }
+    return lines.join("\n") + "\n";
+}
+
+// ================= Cache / continuation keys =================
+
+QString SimulationConfig::solverCacheConfig(int steps) const
+{
+    const NetworkSpec spec = networkSpec();
+    QString config = ResultCache::canonicalRunConfig(solverMode, spec, defaultInitialState(spec.nodeCount),
+                                                     steps, solverStep(), nu);
+    if (solverKind() == RunSolverKind::FractionalGraded)
+        QTextStream(&config) << "graded intervals=" << gradedMesh.gradedIntervals
+                             << " exponent=" << QString::number(gradedMesh.exponent, 'g', 17) << "\n";
+    // pow 은 기존 key 그대로
+    if (solverKind() == RunSolverKind::Fractional && historyKernel() == FractionalKernel::GammaRatio)
+        QTextStream(&config) << "kernel=gamma-ratio\n";
+    if (solverKind() == RunSolverKind::Fractional && mixedOrders())
+        QTextStream(&config) << "orders " << nodeOrdersText() << "\n";
+    return config;
+}
+
+QString SimulationConfig::runCacheConfig() const
+{
+    QString config = solverCacheConfig(tMax);
+    if (usesParareal())
+        QTextStream(&config) << "parareal slices=" << parareal.slices << " coarse=" << parareal.coarseRatio
+                             << " tol=" << QString::number(parareal.tolerance, 'g', 17)
+                             << " maxIter=" << parareal.maxIterations << "\n";
+    //event 는 trajectory 를 바꾸지 않고 events.dat 만 추가 -> 설정된 경우에만 key 에 포함
+    const std::vector<EventSpec> specs = eventSpecs();
+    if (!specs.empty()) QTextStream(&config) << "events " << QString::fromStdString(eventSpecsText(specs)) << "\n";
+    return config;
+}
+
+QString SimulationConfig::alpha2ScanCacheConfig(const Alpha2ScanSettings& scan) const
+{
+    QString config = runCacheConfig();
+    QTextStream(&config) << "scan=alpha2"
+                         << " min=" << QString::number(scan.min, 'g', 17)
+                         << " max=" << QString::number(scan.max, 'g', 17)
+                         << " step=" << QString::number(scan.step, 'g', 17)
+                         << " transient=" << scan.transientPercent
+                         << " stride=" << scan.sampleStride << "\n";
+    return config;
+}
+
+//basin map 은 Parareal 과 thread 수에 관계없이 같은 결과 -> run key 에서 parareal 줄 제외
+QString SimulationConfig::basinCacheConfig(const BasinSettings& basin) const
+{
+    QString config = solverCacheConfig(tMax);
+    QTextStream(&config) << "basin x=" << basin.xNode << " y=" << basin.yNode
+                         << " xRange=" << QString::number(basin.xMin, 'g', 17) << ":" << QString::number(basin.xMax, 'g', 17)
+                         << " yRange=" << QString::number(basin.yMin, 'g', 17) << ":" << QString::number(basin.yMax, 'g', 17)
+                         << " grid=" << basin.width << "x" << basin.height
+                         << " settle=" << QString::number(basin.settleTolerance, 'g', 17)
+                         << " diverge=" << QString::number(basin.divergeLimit, 'g', 17)
+                         << " transient=" << basin.transientPercent
+                         << " radius=" << QString::number(basin.clusterRadius, 'g', 17) << "\n";
+    return config;
+}
+
+//plane scan 도 Parareal / thread 수와 무관. 스캔하는 두 parameter 의 현재 값은 key 에서 의미 없지만 그대로 둠
+QString SimulationConfig::planeScanCacheConfig(const PlaneScanSettings& plane) const
+{
+    QString config = solverCacheConfig(tMax);
+    QTextStream(&config) << "plane x=" << QString::fromStdString(plane.xParam)
+                         << ":" << QString::number(plane.xMin, 'g', 17) << ":" << QString::number(plane.xMax, 'g', 17)
+                         << " y=" << QString::fromStdString(plane.yParam)
+                         << ":" << QString::number(plane.yMin, 'g', 17) << ":" << QString::number(plane.yMax, 'g', 17)
+                         << " grid=" << plane.width << "x" << plane.height
+                         << " transient=" << plane.transientPercent
+                         << " fixedTol=" << QString::number(plane.fixedTolerance, 'g', 17)
+                         << " maximaTol=" << QString::number(plane.maximaTolerance, 'g', 17)
+                         << " maxPeriod=" << plane.maxPeriod
+                         << " lyapunov=" << QString::number(plane.lyapunovThreshold, 'g', 17)
+                         << " diverge=" << QString::number(plane.divergeLimit, 'g', 17) << "\n";
+    return config;
+}
+
+//noisy ensemble 도 path 별 난수가 (seed, step, node, path) 로만 정해지므로 thread 수와 무관
+QString SimulationConfig::ensembleCacheConfig(const SdeSettings& sde) const
+{
+    QString config = solverCacheConfig(tMax);
+    QTextStream out(&config);
+    out << "sde paths=" << sde.paths << " sigma=";
+    for (std::size_t i = 0; i < sde.sigma.size(); ++i) out << (i ? "," : "") << QString::number(sde.sigma[i], 'g', 17);
+    out << " noise=" << (sde.noise == NoiseKind::Additive ? "add" : "mul")
+        << " scheme=" << (sde.scheme == SdeScheme::EulerMaruyama ? "em" : "milstein")
+        << " seed=" << sde.seed << " stride=" << sde.recordStride << " observed=" << sde.observedNodes
+        << " quantiles=";
+    for (std::size_t k = 0; k < sde.quantiles.size(); ++k)
+        out << (k ? "," : "") << QString::number(sde.quantiles[k], 'g', 17);
+    out << " diverge=" << QString::number(sde.divergeLimit, 'g', 17) << "\n";
+    return config;
+}
+
+QString SimulationConfig::uncertaintyCacheConfig(const std::vector<ParameterDistribution>& parameters,
+                                                const UncertaintySettings& settings) const
+{
+    QString config = solverCacheConfig(tMax);
+    QTextStream out(&config);
+    out << "uncertainty";
+    for (const ParameterDistribution& p : parameters)
+        out << " " << QString::fromStdString(p.name) << "=" << (p.kind == DistributionKind::Normal ? "normal" : "uniform")
+            << ":" << QString::number(p.a, 'g', 17) << ":" << QString::number(p.b, 'g', 17);
+    out << " samples=" << settings.minSamples << ".." << settings.maxSamples << " sobol=" << settings.sobol
+        << " seed=" << settings.seed << " tolerance=" << QString::number(settings.tolerance, 'g', 17)
+        << " stride=" << settings.recordStride << " observed=" << settings.observedNodes << " quantiles=";
+    for (std::size_t k = 0; k < settings.quantiles.size(); ++k)
+        out << (k ? "," : "") << QString::number(settings.quantiles[k], 'g', 17);
+    out << " diverge=" << QString::number(settings.divergeLimit, 'g', 17) << "\n";
+    return config;
+}
+
+//tMax가 바뀌어도 state만 같으면 이어서 계산 가능하도록 step 수를 뺀 설정 key
+QString SimulationConfig::continuationConfigKey() const
+{
+    return ResultCache::keyFor(solverCacheConfig(0));
+}
+
+// ================= params.txt / run_info.txt =================
+
+bool SimulationConfig::saveParams(const QString& path) const
+{
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    QTextStream out(&f);
+
+    out << "solverMode=" << solverMode << "\n";
+    out << "tMax=" << tMax << "\n";
+    out << "odeStep=" << num(odeStep) << "\n";
+    out << "fractionalStep=" << num(fractionalStep) << "\n";
+    out << "fractionalKernel=" << fractionalKernel << "\n";
+    out << "gradedMesh.intervals=" << gradedMesh.gradedIntervals << "\n";
+    out << "gradedMesh.exponent=" << num(gradedMesh.exponent) << "\n";
+    out << "gradedMesh.maxStep=" << num(gradedMesh.maxStep) << "\n";
+    out << "alpha1=" << num(alpha1) << "\n";
+    out << "alpha2=" << num(alpha2) << "\n";
+    out << "alpha3=" << num(alpha3) << "\n";
+    out << "nu=" << num(nu) << "\n";
+
+    out << "GateNode4.enabled=" << gateNode4.enabled << "\n";
+    out << "GateNode4.baseType=" << gateNode4.baseType << "\n";
+    out << "GateNode4.baseConst=" << num(gateNode4.baseConst) << "\n";
+    out << "GateNode4.coeff=" << num(gateNode4.coeff) << "\n";
+    out << "GateNode4.fn=" << gateNode4.fn << "\n";
+
+    out << "GateNode5.enabled=" << gateNode5.enabled << "\n";
+    out << "GateNode5.baseType=" << gateNode5.baseType << "\n";
+    out << "GateNode5.baseConst=" << num(gateNode5.baseConst) << "\n";
+    out << "GateNode5.coeff=" << num(gateNode5.coeff) << "\n";
+    out << "GateNode5.fn=" << gateNode5.fn << "\n";
+
+    out << "parareal.enabled=" << parareal.enabled << "\n";
+    out << "parareal.slices=" << parareal.slices << "\n";
+    out << "parareal.coarseRatio=" << parareal.coarseRatio << "\n";
+    out << "parareal.tolerance=" << num(parareal.tolerance) << "\n";
+    out << "parareal.maxIterations=" << parareal.maxIterations << "\n";
+    if (!eventSpecs().empty()) out << "events=" << QString::fromStdString(eventSpecsText(eventSpecs())) << "\n";
+
+    if (mixedOrders()) {
+        out << "\n[orders]\n";
+        for (auto it = nodeOrders.begin(); it != nodeOrders.end(); ++it)
+            if (it.value() != nu) out << it.key() << "=" << num(it.value()) << "\n";
+    }
+
+    out << "\n[weights]\n";
+    for (auto it = weightValues.begin(); it != weightValues.end(); ++it) {
+        out << it.key() << "=" << num(it.value()) << "\n";
+    }
+
+    // drawn edges, so the file alone rebuilds the ODE network
+    out << "\n[connections]\n";
+    for (const ConnectionConfig& c : connections) {
+        out << c.from << ">" << c.to << "=" << c.function << "\n";
+    }
+
+    if (!equations.trimmed().isEmpty()) {
+        out << "\n[equations]\n";
+        for (const QString& line : equations.split('\n'))
+            if (!line.trimmed().isEmpty()) out << line.trimmed() << "\n";
+    }
+
+    if (large.enabled()) {
+        out << "\n[large]\n";
+        out << "kind=" << large.kind << "\n";
+        out << "nodes=" << large.nodes << "\n";
+        out << "degree=" << large.degree << "\n";
+        out << "rewire=" << num(large.rewire) << "\n";
+        out << "weightScale=" << num(large.weightScale) << "\n";
+        out << "seed=" << large.seed << "\n";
+        out << "fn=" << large.fn << "\n";
+        out << "ordering=" << large.ordering << "\n";
+        if (!large.edgeListPath.isEmpty()) out << "edgeList=" << large.edgeListPath << "\n";
+    }
+    f.close();
+    return true;
+}
+
+void SimulationConfig::writeRunInfo(const QString& path, const QString& runDir) const
+{
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+
+    QTextStream out(&f); //f는 QFile 객체,TextStream writes formatted text to a QIODevice
+    out << "=== Hopfield Fractional Network Run Info ===\n";
+    out << "RunDir: " << runDir << "\n";
+    out << "Solver: " << solverMode << "\n";
+    //수렴 차수: 오차 ~ h^order (GAMMA 는 h = 1 고정). 끝의 key=value 는 networkloader 가 다시 읽음
+    if (solverKind() == RunSolverKind::Euler) {
+        out << "Scheme: explicit Euler, h=" << num(odeStep) << ", convergence order 1\n";
+    } else if (solverKind() == RunSolverKind::Fractional) {
+        out << "Scheme: fractional rectangle rule, h=1, convergence order 1, fractionalKernel="
+            << fractionalKernel << "\n";
+    } else if (solverKind() == RunSolverKind::FractionalAbm) {
+        out << "Scheme: fractional Adams-Bashforth-Moulton (PECE), convergence order "
+            << num(fractionalAbmOrder(nu)) << " (min(2, 1+nu)), fractionalStep=" << num(fractionalStep) << "\n";
+    } else {
+        const double r = gradedMeshExponent(nu, gradedMesh.exponent);
+        out << "Scheme: fractional Adams-Bashforth-Moulton (PECE) on a graded mesh of "
+            << int(gradedMeshTimes(tMax, gradedMesh, r).size()) - 1 << " steps (r=" << num(r)
+            << "), convergence order " << num(fractionalAbmOrder(nu)) << ", gradedMesh.intervals="
+            << gradedMesh.gradedIntervals << " gradedMesh.exponent=" << num(gradedMesh.exponent)
+            << " gradedMesh.maxStep=" << num(gradedMesh.maxStep) << "\n";
+    }
+    out << "tMax: " << tMax << "\n";
+    out << "alpha1=" << num(alpha1) << " alpha2=" << num(alpha2) << " alpha3=" << num(alpha3) << "\n";
+    out << "nu=" << num(nu) << "\n";
+    if (mixedOrders()) out << "NodeOrders: " << nodeOrdersText() << "\n";
+    if (!eventSpecs().empty()) out << "Events: " << QString::fromStdString(eventSpecsText(eventSpecs())) << "\n";
+    const NetworkSpec spec = networkSpec();
+    out << "RhsKernel: " << QString::fromStdString(rhsKernelName(spec)) << "\n";
+    if (large.enabled() && equations.trimmed().isEmpty()) {
+        out << "LargeNetwork: kind=" << large.kind << " nodes=" << spec.nodeCount
+            << " edges=" << qint64(spec.edges.size());
+        out << " ordering=" << large.ordering;
+        if (large.kind == "edgelist") out << " file=" << large.edgeListPath << " fn=" << large.fn << "\n";
+        else out << " degree=" << large.degree << " rewire=" << num(large.rewire) << " weightScale="
+                 << num(large.weightScale) << " seed=" << large.seed << " fn=" << large.fn << "\n";
+
+        //gather 거리: 최대/평균 index 거리, 같은 4 KiB page(512 node) 안에서 읽히는 edge 비율
+        const OrderingMetrics before = orderingMetrics(spec);
+        const OrderingMetrics after = orderingMetrics(spec, computeNodeOrdering(spec, spec.ordering));
+        out << "NodeOrdering: " << large.ordering
+            << " bandwidth " << before.bandwidth << " -> " << after.bandwidth
+            << ", mean |i-j| " << QString::number(before.meanDistance, 'f', 1) << " -> "
+            << QString::number(after.meanDistance, 'f', 1)
+            << ", within 512 nodes " << QString::number(100.0 * before.nearFraction, 'f', 1) << "% -> "
+            << QString::number(100.0 * after.nearFraction, 'f', 1) << "%\n";
+    }
+    out << "CacheKey: " << ResultCache::keyFor(runCacheConfig()) << "\n";
+    if (usesParareal())
+        out << "Parareal: slices=" << parareal.slices << " coarseRatio=" << parareal.coarseRatio
+            << " tolerance=" << num(parareal.tolerance) << " maxIterations=" << parareal.maxIterations << "\n";
+    out << "Gate4(G2): enabled=" << gateNode4.enabled
+        << " base=" << gateNode4.baseType << "(" << num(gateNode4.baseConst) << ")"
+        << " coeff=" << num(gateNode4.coeff) << " fn=" << gateNode4.fn << "\n";
+    out << "Gate5(G1): enabled=" << gateNode5.enabled
+        << " base=" << gateNode5.baseType << "(" << num(gateNode5.baseConst) << ")"
+        << " coeff=" << num(gateNode5.coeff) << " fn=" << gateNode5.fn << "\n\n";
+
+    out << "Connections:\n";
+    for (const ConnectionConfig& c : connections) {
+        const QString key = weightKey(c.from, c.to);
+        out << " " << key << " = " << num(weightValues.value(key, 0.0))
+            << " fn=" << c.function << "\n";
+    }
+
+    if (!equations.trimmed().isEmpty()) {
+        out << "\nEquations:\n";
+        for (const QString& line : equations.split('\n'))
+            if (!line.trimmed().isEmpty()) out << " " << line.trimmed() << "\n";
+    }
+    f.close();
+}
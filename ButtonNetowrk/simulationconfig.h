@@ -0,0 +1,168 @@
+#ifndef SIMULATIONCONFIG_H
+#define SIMULATIONCONFIG_H
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+#include "basinmapper.h"
+#include "equationdsl.h"
+#include "eventdetector.h"
+#include "networksolver.h"
+#include "networkspec.h"
+#include "planescan.h"
+#include "runstate.h"
+#include "sdeensemble.h"
+#include "uncertainty.h"
+
+// Everything a run depends on, without any widget: the GUI fills it from the
+// canvas, buttonnetwork-cli from files read by networkloader.h.
+
+struct GateConfig {
+    bool enabled = false;
+    QString baseType = "const"; // "const", "alpha1", "alpha2", "alpha3"
+    double baseConst = 1.0;
+    double coeff = 1.0;
+    QString fn = "tanh";        // "sin", "tanh", "relu"
+};
+
+struct ConnectionConfig {
+    int from = 1;      // 1-based node numbers, as drawn
+    int to = 1;
+    QString function;  // "sin_exp", "tanh", "relu"
+};
+
+struct Alpha2ScanSettings {
+    double min = -10.0;
+    double max = 10.0;
+    double step = 0.5;
+    int transientPercent = 70;
+    int sampleStride = 20;
+};
+
+// Large-network mode (networkgenerator.h): replaces the canvas by a generated graph
+// or an edge-list file. kind "" = off.
+struct LargeNetworkConfig {
+    QString kind;              // "", "random", "smallworld", "lattice", "edgelist"
+    int nodes = 10000;
+    int degree = 8;
+    double rewire = 0.1;
+    double weightScale = 1.0;
+    quint64 seed = 1;
+    QString fn = "tanh";       // generated edges; edge-list default
+    QString edgeListPath;
+    QString ordering = "none"; // "none", "rcm", "community": memory order only, same results
+
+    bool enabled() const { return !kind.isEmpty(); }
+};
+
+// Parareal (networksolver.h) for ODE runs; the settings change results within
+// `tolerance`, so they are part of the run cache key.
+struct PararealConfig {
+    bool enabled = false;
+    int slices = 16;
+    int coarseRatio = 10;
+    double tolerance = 1e-9;
+    int maxIterations = 0; // 0: slices (exact serial result)
+};
+
+struct SimulationConfig {
+    SimulationConfig(); // default G2/G1 gates
+
+    QString solverMode = "ODE";
+    int tMax = 800;          // steps
+    double odeStep = 0.01;   // Euler step h
+    double fractionalStep = 1.0; // GAMMA-ABM step h (GAMMA: always one step per time unit)
+    GradedMeshOptions gradedMesh;  // GAMMA-GRADED: M graded intervals, exponent r, maxStep
+    QString fractionalKernel = "pow"; // GAMMA history weights: "pow" or "gamma" (solver.c), statearena.h
+    double alpha1 = 1.0;
+    double alpha2 = 1.0;
+    double alpha3 = 1.0;
+    double nu = 0.9;
+    QMap<int, double> nodeOrders;          // GAMMA: 1-based node -> its own nu (1: classical ODE); others use nu
+
+    GateConfig gateNode4;
+    GateConfig gateNode5;
+
+    QVector<ConnectionConfig> connections; // drawn edges (ODE)
+    QMap<QString, double> weightValues;    // "s<from><to>"
+
+    // Custom right-hand side, "Dy1 = ..." per line (equationdsl.h). Empty: drawn
+    // network (ODE) / solver.c equations (GAMMA). Set: replaces edges and gates in
+    // both solver modes; alpha1-3, nu and the s<ij> weights can be used by name.
+    QString equations;
+
+    // Generated / imported network of thousands of nodes; used when no equations are set.
+    LargeNetworkConfig large;
+
+    PararealConfig parareal;
+    bool usesParareal() const { return parareal.enabled && solverKind() == RunSolverKind::Euler; }
+
+    // Per-node orders (networksolver.h): nu of every node, and whether any differs from nu.
+    std::vector<double> nodeNu(int nodeCount) const;
+    bool mixedOrders() const;
+    QString nodeOrdersText() const; // "3=0.5 5=1", the nodes whose order differs from nu
+    bool setNodeOrdersText(const QString& text); // the same, ',' or ' ' separated; false leaves nodeOrders as is
+    bool checkNodeOrders(QString* error = nullptr) const; // true when uniform or GAMMA / ODE
+
+    // Events (eventdetector.h) logged per run / scan point, "" = off: "y3 up 0, y2 max".
+    // Set: events.dat per run, and the alpha2 scan plots the event states instead of
+    // every sampleStride-th step.
+    QString events;
+    std::vector<EventSpec> eventSpecs() const;
+    // nodeCount 0: syntax only
+    bool checkEvents(int nodeCount = 0, QString* error = nullptr) const;
+
+    // Scan parameters by name: alpha1, alpha2, alpha3, nu (GAMMA) and h (step of ODE /
+    // GAMMA-ABM, maxStep of GAMMA-GRADED), nu<i> for the order of node i (GAMMA);
+    // the setter / getter also take connection weights "s<from><to>" and the gate
+    // coefficients g4coeff / g5coeff and constant bases g4base / g5base (enabled gates only).
+    static QStringList scanParameterNames();
+    bool setScanParameter(const QString& name, double value);
+    bool scanParameter(const QString& name, double& value) const;
+
+    static QString weightKey(int from, int to);
+    static ActivationKind activationFromName(const QString& fn);
+
+    // Gate helpers
+    double baseValueFromType(const QString& baseType, double baseConst) const;
+    GateTermSpec gateTermForNode(int nodeIndex) const;
+
+    // Custom equations
+    EquationParameters equationParameters() const;
+    std::shared_ptr<const EquationProgram> compileEquations(QString* error = nullptr) const;
+    bool checkEquations(QString* error = nullptr) const; // true when empty or compiles
+    QString networkAsEquations() const; // current edges/gates written in the same syntax
+
+    // Network -> solver spec
+    NetworkSpec buildDrawnNetworkSpec() const;
+    NetworkSpec buildGammaNetworkSpec() const;
+    NetworkSpec buildLargeNetworkSpec(QString* error = nullptr) const;
+    bool checkLargeNetwork(QString* error = nullptr) const; // true when off or buildable
+    NetworkSpec networkSpec() const;
+    RunSolverKind solverKind() const;
+    // Step h of the solver: odeStep, fractionalStep for GAMMA-ABM, gradedMesh.maxStep for
+    // GAMMA-GRADED. GAMMA has no step of its own and keeps odeStep in its cache keys.
+    double solverStep() const;
+    FractionalKernel historyKernel() const;
+
+    // Result cache / continuation keys
+    QString solverCacheConfig(int steps) const; // canonical run config, plus the graded mesh
+    QString runCacheConfig() const;
+    QString alpha2ScanCacheConfig(const Alpha2ScanSettings& scan) const;
+    QString basinCacheConfig(const BasinSettings& basin) const;
+    QString planeScanCacheConfig(const PlaneScanSettings& plane) const;
+    QString ensembleCacheConfig(const SdeSettings& sde) const;
+    QString uncertaintyCacheConfig(const std::vector<ParameterDistribution>& parameters,
+                                   const UncertaintySettings& settings) const;
+    QString continuationConfigKey() const;
+
+    // params.txt (key=value, [weights], [connections], [equations], [large]) and run_info.txt;
+    // networkloader.h reads both back
+    bool saveParams(const QString& path) const;
+    void writeRunInfo(const QString& path, const QString& runDir) const;
+};
+
+#endif // SIMULATIONCONFIG_H
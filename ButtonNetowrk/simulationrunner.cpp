@@ -0,0 +1,1474 @@
+#include "simulationrunner.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "resultcache.h"
+#include "rhskernel.h"
+#include "runoutput.h"
+#include "workerpool.h"
+
+namespace {
+
+//result.dat / scan 파일의 열 수 (y1..y5); node 가 더 적으면 그만큼만
+const int kResultColumns = 5;
+
+int resultColumns(int nodeCount)
+{
+    return std::min(nodeCount, kResultColumns);
+}
+
+//Euler 는 저장된 rhs 로 Hermite 기울기 h f, GAMMA 계열은 0 -> 차분 기울기
+double eventStep(const SimulationConfig& config)
+{
+    return config.solverKind() == RunSolverKind::Euler ? config.odeStep : 0.0;
+}
+
+} // namespace
+
+// ================= Run folder =================
+
+QString SimulationRunner::runPath(const QString& filename) const
+{
+    if (runDir.isEmpty()) return filename;
+    return runDir + "/" + filename;
+}
+
+//같은 초에 여러 프로세스가 시작해도 겹치지 않도록 mkdir 실패 시 _2, _3 ... 붙임
+bool SimulationRunner::createRunDir()
+{
+    QDir base(baseResultDir);
+    if (!base.exists() && !base.mkpath(".")) {
+        fail("Cannot create base result dir:\n" + baseResultDir);
+        return false;
+    }
+
+    const QString ts = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+    for (int n = 1; n < 10000; ++n) {
+        const QString name = (n == 1) ? "run_" + ts : QString("run_%1_%2").arg(ts).arg(n);
+        if (base.mkdir(name)) {
+            runDir = base.filePath(name);
+            return true;
+        }
+        if (!base.exists(name)) break; // mkdir failed for another reason
+    }
+
+    runDir.clear();
+    fail("Cannot create run folder in:\n" + baseResultDir);
+    return false;
+}
+
+bool SimulationRunner::hasRunCheckpoint() const
+{
+    return !runDir.isEmpty() && QFileInfo::exists(runPath("checkpoint.bin"));
+}
+
+bool SimulationRunner::hasScanCheckpoint() const
+{
+    return !runDir.isEmpty() && QFileInfo::exists(runPath("scan_checkpoint.txt"));
+}
+
+bool SimulationRunner::writeRunHeaderFiles(const SimulationConfig& config)
+{
+    if (runDir.isEmpty()) return false;
+    const bool ok = config.saveParams(runPath("params.txt"));
+    config.writeRunInfo(runPath("run_info.txt"), runDir);
+    return ok;
+}
+
+//cache 에서 restore / store 된 출력은 cache 항목과 hard link 로 공유될 수 있음:
+//그 자리에 다시 쓰면 (WriteOnly 는 같은 inode 를 자름) 다른 key 의 cache 내용이 바뀌므로
+//쓰기 전에 지워서 새 파일로 만듦. 모든 결과 writer 가 쓰기 전에 호출
+void SimulationRunner::detachOutputs(const QStringList& files) const
+{
+    for (const QString& name : files) QFile::remove(runPath(name));
+}
+
+QStringList SimulationRunner::runResultFiles(const SimulationConfig& config)
+{
+    QStringList files = {"result.dat", "result_stream.csv", "result_final.csv", "result_summary.dat", "table.txt",
+                         "state.bin"};
+    if (!config.eventSpecs().empty()) files << "events.dat";
+    return files;
+}
+
+QStringList SimulationRunner::scanResultFiles(const SimulationConfig& config)
+{
+    QStringList files = {"alpha2_scan_3d.dat", "alpha2_scan_2d.dat"};
+    if (!config.eventSpecs().empty()) files << "alpha2_scan_events.dat";
+    return files;
+}
+
+QStringList SimulationRunner::basinResultFiles()
+{
+    return {"basin.ppm", "basin_labels.dat", "basin_summary.txt", "basin.gnu"};
+}
+
+QStringList SimulationRunner::planeResultFiles()
+{
+    return {"plane_scan.bin", "plane_scan.ppm", "plane_scan_summary.txt"};
+}
+
+QStringList SimulationRunner::ensembleResultFiles()
+{
+    return {"ensemble.dat", "ensemble_summary.txt", "ensemble.gnu"};
+}
+
+QStringList SimulationRunner::uncertaintyResultFiles()
+{
+    return {"uncertainty.dat", "uncertainty_summary.txt", "uncertainty.gnu"};
+}
+
+// ================= Single run =================
+
+SimulationRunner::Status SimulationRunner::computeRun(const SimulationConfig& config)
+{
+    if (runDir.isEmpty()) return fail("No run folder.");
+    if (checkRunnable(config) == Status::Failed) return Status::Failed;
+    writeRunHeaderFiles(config);
+
+    //같은 설정으로 이미 계산한 결과가 있으면 적분 없이 재사용
+    ResultCache cache(baseResultDir + "/cache", resultCacheMaxBytes);
+    const QString cacheConfig = config.runCacheConfig();
+    const QString key = ResultCache::keyFor(cacheConfig);
+    if (useCache && cache.restore(key, runResultFiles(config), runDir)) {
+        say("[cache] hit " + key.left(12) + ", reused stored results");
+        return Status::CacheHit;
+    }
+
+    if (!integrate(config)) return cancelled();
+    if (!finishRun(config)) return Status::Failed;
+
+    if (config.usesParareal()) {
+        const PararealStats& st = pararealStats;
+        QFile info(runPath("run_info.txt"));
+        if (info.open(QIODevice::Append | QIODevice::Text)) {
+            QTextStream out(&info);
+            out << "PararealRun: iterations=" << st.iterations << " slices=" << st.slices
+                << " exactSlices=" << st.exactSlices << " converged=" << st.converged
+                << " wall=" << QString::number(st.wallSeconds, 'f', 3) << "s"
+                << " serialEstimate=" << QString::number(st.serialSeconds, 'f', 3) << "s"
+                << " speedup=" << QString::number(st.speedup(), 'f', 2) << "\n";
+            info.close();
+        }
+    }
+
+    if (useCache) cache.store(key, runResultFiles(config), runDir, cacheConfig);
+    return Status::Done;
+}
+
+//equations 가 compile 되는지, large network 가 만들어지고 memory 에 들어가는지 확인
+SimulationRunner::Status SimulationRunner::checkRunnable(const SimulationConfig& config)
+{
+    QString why;
+    if (!config.checkEquations(&why)) return fail(why);
+    if (!config.checkLargeNetwork(&why)) return fail(why);
+    if (!config.checkNodeOrders(&why)) return fail(why);
+
+    const int nodes = config.networkSpec().nodeCount;
+    if (!config.checkEvents(nodes, &why)) return fail(why);
+    const qint64 bytes = qint64(nodes) * (2LL * config.tMax + 1) * qint64(sizeof(double));
+    if (bytes > maxArenaBytes)
+        return fail(QString("%1 nodes x %2 steps need %3 MB for the trajectory (limit %4 MB).\n"
+                            "Lower tMax or the node count.")
+                        .arg(nodes).arg(config.tMax).arg(bytes >> 20).arg(maxArenaBytes >> 20));
+    return Status::Done;
+}
+
+//useNativeCode 이면 network 를 native code 로 붙여서 반환 (실패하면 그냥 interpreter)
+//결과는 bitwise 같으므로 cache key 에는 영향 없음. Large network 는 thread 수만 지정
+NetworkSpec SimulationRunner::solverSpec(const SimulationConfig& config)
+{
+    NetworkSpec spec = config.networkSpec();
+    spec.threads = rhsThreads;
+    if (spec.nodeCount >= kSparseKernelMinNodes) {
+        SparseRhsKernel probe(spec, rhsThreads);
+        say(QString("[large] %1 nodes, %2 edges, %3 RHS threads%4")
+                .arg(spec.nodeCount).arg(qint64(probe.edgeCount())).arg(probe.threadCount())
+                .arg(useNativeCode ? " (native code is for small networks, not used)" : ""));
+        return spec;
+    }
+    if (!useNativeCode) return spec;
+
+    const auto program = spec.equations ? spec.equations : programFromNetwork(spec);
+    if (!program) return spec;
+
+    const QString nativeDir = baseResultDir + "/native";
+    if (!nativeCache || nativeCache->directory() != nativeDir)
+        nativeCache.reset(new NativeCodeCache(nativeDir));
+
+    QString message;
+    spec.native = nativeCache->load(*program, &message);
+    if (!message.isEmpty()) say("[native] " + message);
+    return spec;
+}
+
+//solver 종류에 따라 ODE(Euler), GAMMA(fractional), GAMMA-ABM(predictor-corrector) 또는 GAMMA-GRADED 로 적분, 고정 토폴로지면 전용 커널 사용
+//Cancel 되면 false (checkpoint.bin 은 남아 있음)
+bool SimulationRunner::integrate(const SimulationConfig& config)
+{
+    const NetworkSpec spec = solverSpec(config);
+    const std::vector<double> y0 = defaultInitialState(spec.nodeCount);
+    const SolverProgressFn progress = makeRunProgress(config, config.tMax);
+
+    if (config.usesParareal()) {
+        PararealOptions options;
+        options.slices = config.parareal.slices;
+        options.coarseRatio = config.parareal.coarseRatio;
+        options.tolerance = config.parareal.tolerance;
+        options.maxIterations = config.parareal.maxIterations;
+        options.threads = rhsThreads;
+        pararealStats = PararealStats();
+        const bool done = integrateEulerParareal(spec, y0, config.tMax, config.odeStep, options, arena,
+                                                 &pararealStats, progress);
+        if (done)
+            say(QString("[parareal] %1 iterations over %2 slices%3, %4 s (serial ~%5 s, speedup %6x)")
+                    .arg(pararealStats.iterations).arg(pararealStats.slices)
+                    .arg(pararealStats.converged ? "" : " (not converged)")
+                    .arg(pararealStats.wallSeconds, 0, 'f', 3).arg(pararealStats.serialSeconds, 0, 'f', 3)
+                    .arg(pararealStats.speedup(), 0, 'f', 2));
+        return done;
+    }
+    if (config.solverKind() == RunSolverKind::Euler)
+        return integrateEuler(spec, y0, config.tMax, config.odeStep, arena, progress);
+    if (config.solverKind() == RunSolverKind::FractionalAbm)
+        return integrateFractionalAbm(spec, y0, config.tMax, config.nu, config.fractionalStep, arena, progress);
+    if (config.solverKind() == RunSolverKind::FractionalGraded)
+        return integrateFractionalGraded(spec, y0, config.tMax, config.nu, config.gradedMesh, arena, progress);
+    return integrateFractional(spec, y0, config.tMax, config.nodeNu(spec.nodeCount), arena, progress,
+                               config.historyKernel());
+}
+
+//arena 에 들어있는 state(header.steps 까지)부터 targetSteps 까지 이어서 적분
+//graded mesh 는 끝 시간에 따라 mesh 가 바뀌므로 0 부터 다시 적분 (mesh 가 작아서 빠름)
+bool SimulationRunner::continueIntegration(const SimulationConfig& config, const RunStateHeader& header,
+                                           int targetSteps)
+{
+    const NetworkSpec spec = solverSpec(config);
+    const SolverProgressFn progress = makeRunProgress(config, targetSteps);
+
+    if (header.solver == RunSolverKind::FractionalGraded) {
+        const std::vector<double> y0(arena.state(0), arena.state(0) + spec.nodeCount);
+        return integrateFractionalGraded(spec, y0, targetSteps, header.nu, config.gradedMesh, arena, progress);
+    }
+
+    if (header.solver == RunSolverKind::Euler) return extendEuler(spec, targetSteps, header.h, arena, progress);
+    if (header.solver == RunSolverKind::FractionalAbm)
+        return extendFractionalAbm(spec, targetSteps, header.nu, header.h, arena, progress);
+    return extendFractional(spec, targetSteps, config.nodeNu(spec.nodeCount), arena, progress,
+                            config.historyKernel());
+}
+
+bool SimulationRunner::finishRun(const SimulationConfig& config)
+{
+    detachOutputs(runResultFiles(config));
+    if (!writeResultFiles(runDir, arena, arena.steps())) {
+        fail("Cannot write result.dat");
+        return false;
+    }
+    const std::vector<EventSpec> events = config.eventSpecs();
+    if (!events.empty()) {
+        EventLog found;
+        found.reset(resultColumns(arena.nodeCount()));
+        detectEvents(config.networkSpec(), arena, eventStep(config), 0, events, found);
+        if (!writeEventFile(runDir, found, events)) {
+            fail("Cannot write events.dat");
+            return false;
+        }
+        say(QString("[events] %1 events in events.dat").arg(qint64(found.size())));
+    }
+
+    const RunStateHeader header = runStateHeader(config, arena.steps(), arena.steps());
+    if (!saveRunState(runPath("state.bin").toStdString(), header, arena))
+        say("[warn] cannot write state.bin, this run cannot be extended");
+    QFile::remove(runPath("checkpoint.bin"));
+    return true;
+}
+
+// an extended / resumed run is identical to a fresh run with the same tMax.
+// Those steps are always integrated serially, so with Parareal on the result is not the
+// one stored under the Parareal key (equal only within its tolerance): not cached.
+void SimulationRunner::storeRun(const SimulationConfig& config)
+{
+    if (!useCache || config.usesParareal()) return;
+    ResultCache cache(baseResultDir + "/cache", resultCacheMaxBytes);
+    const QString cacheConfig = config.runCacheConfig();
+    cache.store(ResultCache::keyFor(cacheConfig), runResultFiles(config), runDir, cacheConfig);
+}
+
+// ================= Sensitivities =================
+
+namespace {
+
+//name 의 현재 값 p 에서 p -+ delta 인 network (알 수 없는 이름 / nu / h 이면 false)
+bool shiftedNetworks(const SimulationConfig& config, const QString& name, SensitivityParameter& shifted)
+{
+    double p = 0.0;
+    if (name == "nu" || name == "h" || !config.scanParameter(name, p)) return false;
+    shifted.name = name.toStdString();
+    shifted.delta = 1e-4 * (1.0 + std::fabs(p));
+    SimulationConfig c = config;
+    c.setScanParameter(name, p - shifted.delta);
+    shifted.low = c.networkSpec();
+    c.setScanParameter(name, p + shifted.delta);
+    shifted.high = c.networkSpec();
+    return true;
+}
+
+} // namespace
+
+//d y / d p 를 trajectory 와 같이 적분 (parameter 마다 다시 돌리지 않음). 결과: sensitivity_<p>.dat
+SimulationRunner::Status SimulationRunner::computeSensitivities(const SimulationConfig& config,
+                                                                const QStringList& parameters)
+{
+    if (runDir.isEmpty()) return fail("No run folder.");
+    if (config.solverKind() != RunSolverKind::Euler) return fail("Sensitivities need the ODE solver.");
+    if (parameters.isEmpty()) return fail("Sensitivities: no parameter given.");
+    if (checkRunnable(config) == Status::Failed) return Status::Failed;
+
+    const int nodes = config.networkSpec().nodeCount;
+    const qint64 bytes = qint64(nodes) * (config.tMax + 1LL) * parameters.size() * qint64(sizeof(double));
+    if (bytes > maxArenaBytes)
+        return fail(QString("%1 parameters x %2 nodes x %3 steps need %4 MB of sensitivities (limit %5 MB).")
+                        .arg(parameters.size()).arg(nodes).arg(config.tMax).arg(bytes >> 20)
+                        .arg(maxArenaBytes >> 20));
+
+    const std::vector<double> y0 = defaultInitialState(nodes);
+    std::vector<SensitivityParameter> shifted;
+    for (const QString& name : parameters) {
+        SensitivityParameter s;
+        if (!shiftedNetworks(config, name, s))
+            return fail("Sensitivities: unknown parameter \"" + name
+                        + "\" (alpha1-3, s<ij>, g4coeff, g5coeff, g4base, g5base).");
+
+        // zero sensitivity is a valid answer, but usually a typo or a disabled gate
+        std::vector<double> fLow(s.low.nodeCount), fHigh(s.high.nodeCount);
+        s.low.threads = s.high.threads = 1;
+        visitRhsKernel(s.low, [&](const auto& kernel) { kernel.eval(y0.data(), fLow.data()); });
+        visitRhsKernel(s.high, [&](const auto& kernel) { kernel.eval(y0.data(), fHigh.data()); });
+        if (fLow == fHigh) say("[warn] " + name + " does not enter the network equations, its sensitivity is 0");
+        shifted.push_back(s);
+    }
+
+    writeRunHeaderFiles(config);
+    if (config.usesParareal()) say("[sensitivity] Parareal is off for the augmented run (serial Euler)");
+
+    int lastReport = 0;
+    const SolverProgressFn progress = [&](int step) {
+        if (keepAlive) keepAlive();
+        if (step - lastReport >= config.tMax / 10 + 1) {
+            lastReport = step;
+            say(QString("[sensitivity] step %1 / %2").arg(step).arg(config.tMax));
+        }
+        return !(cancelRequested && cancelRequested());
+    };
+    SensitivityResult result;
+    if (!integrateEulerSensitivity(solverSpec(config), y0, config.tMax, config.odeStep, shifted, arena, result,
+                                   progress)) {
+        say("[cancel] sensitivity run stopped");
+        return Status::Cancelled;
+    }
+
+    if (!finishRun(config)) return Status::Failed;
+    if (!writeSensitivityFiles(runDir, result)) return fail("Cannot write sensitivity files");
+    storeRun(config);
+
+    say(QString("[sensitivity] %1 parameters (%2), %3 s")
+            .arg(parameters.join(", ")).arg(result.analytic ? "analytic Jacobian" : "central differences")
+            .arg(result.wallSeconds, 0, 'f', 3));
+    for (int k = 0; k < int(result.names.size()); ++k) {
+        QString ds;
+        for (int i = 0; i < result.nodeCount && i < 5; ++i)
+            ds += " " + QString::number(result.at(result.steps, k, i), 'g', 6);
+        say(QString("[sensitivity] d y(tMax) / d %1 =%2%3").arg(parameters[k]).arg(ds)
+                .arg(result.nodeCount > 5 ? " ..." : ""));
+    }
+    return Status::Done;
+}
+
+// ================= Parameter fit =================
+
+//target 궤적에 맞게 parameter 를 LM 으로 맞춤 (gradient 는 sensitivity run). 결과 run 의 params.txt 가 맞춘 network
+SimulationRunner::Status SimulationRunner::fitParameters(const SimulationConfig& config, const QString& targetPath,
+                                                         QStringList parameters, const FitSettings& settings)
+{
+    if (runDir.isEmpty()) return fail("No run folder.");
+    if (config.solverKind() != RunSolverKind::Euler) return fail("Parameter fitting needs the ODE solver.");
+    if (checkRunnable(config) == Status::Failed) return Status::Failed;
+
+    if (parameters.isEmpty())
+        for (const ConnectionConfig& c : config.connections)
+            if (!parameters.contains(SimulationConfig::weightKey(c.from, c.to)))
+                parameters << SimulationConfig::weightKey(c.from, c.to);
+    if (parameters.isEmpty()) return fail("Fit: no parameter given and no drawn connection weights.");
+
+    std::vector<std::string> names;
+    std::vector<double> p0;
+    for (const QString& name : parameters) {
+        double p = 0.0;
+        SensitivityParameter probe;
+        if (!shiftedNetworks(config, name, probe) || !config.scanParameter(name, p))
+            return fail("Fit: unknown parameter \"" + name + "\" (alpha1-3, s<ij>, g4coeff, g5coeff, g4base, g5base).");
+        names.push_back(name.toStdString());
+        p0.push_back(p);
+    }
+
+    QFile file(targetPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return fail("Fit: cannot read " + targetPath);
+    FitTarget target;
+    std::string why;
+    if (!parseFitTarget(file.readAll().toStdString(), target, &why))
+        return fail("Fit: " + targetPath + ": " + QString::fromStdString(why));
+
+    const int nodes = config.networkSpec().nodeCount;
+    const int steps = target.rows - 1;
+    if (steps < 1) return fail("Fit: the target needs at least two rows (steps 0 and 1).");
+    if (target.columns > nodes)
+        return fail(QString("Fit: the target has %1 columns, the network %2 nodes.").arg(target.columns).arg(nodes));
+
+    FitSettings s = settings;
+    s.threads = rhsThreads;
+    const qint64 workers = qMin(s.threads > 0 ? s.threads : WorkerPool::hardwareThreads(), qMax(1, s.starts));
+    const qint64 bytes = workers * qint64(nodes) * (steps + 1LL) * (parameters.size() + 2) * qint64(sizeof(double));
+    if (bytes > maxArenaBytes)
+        return fail(QString("Fit: %1 workers x %2 parameters x %3 nodes x %4 steps need %5 MB (limit %6 MB).")
+                        .arg(workers).arg(parameters.size()).arg(nodes).arg(steps).arg(bytes >> 20)
+                        .arg(maxArenaBytes >> 20));
+
+    // called on worker threads: every call works on its own copy of the config
+    const FitModelFn model = [config, parameters](const std::vector<double>& p, NetworkSpec& spec,
+                                                  std::vector<SensitivityParameter>& shifted) {
+        SimulationConfig c = config;
+        for (int k = 0; k < parameters.size(); ++k) c.setScanParameter(parameters[k], p[k]);
+        spec = c.networkSpec();
+        shifted.resize(parameters.size());
+        for (int k = 0; k < parameters.size(); ++k) shiftedNetworks(c, parameters[k], shifted[k]);
+    };
+
+    say(QString("[fit] %1 parameters (%2), %3 starts, %4 rows x %5 columns of %6")
+            .arg(parameters.size()).arg(parameters.join(", ")).arg(s.starts).arg(target.rows).arg(target.columns)
+            .arg(QFileInfo(targetPath).fileName()));
+    int reported = 0;
+    const FitProgressFn progress = [&](int startsDone) {
+        if (keepAlive) keepAlive();
+        if (startsDone > reported) {
+            reported = startsDone;
+            say(QString("[fit] %1 / %2 starts done").arg(startsDone).arg(s.starts));
+        }
+        return !(cancelRequested && cancelRequested());
+    };
+    if (!::fitParameters(model, names, p0, defaultInitialState(nodes), steps, config.odeStep, target, s, fit,
+                         progress)) {
+        say("[cancel] fit stopped");
+        return Status::Cancelled;
+    }
+    if (fit.best < 0) return fail("Fit: every start diverged.");
+
+    for (int k = 0; k < int(fit.starts.size()); ++k) {
+        const FitStart& st = fit.starts[k];
+        say(QString("[fit] start %1: cost %2 -> %3 (rms %4), %5 iterations%6")
+                .arg(k).arg(st.initialCost, 0, 'g', 6).arg(st.cost, 0, 'g', 6).arg(fit.rmsError(k), 0, 'g', 6)
+                .arg(st.iterations).arg(st.converged ? "" : ", not converged"));
+    }
+
+    // the best fit becomes this run folder's network
+    SimulationConfig fitted = config;
+    const FitStart& best = fit.starts[fit.best];
+    QStringList values;
+    for (int k = 0; k < parameters.size(); ++k) {
+        fitted.setScanParameter(parameters[k], best.fitted[k]);
+        values << parameters[k] + " = " + QString::number(best.fitted[k], 'g', 10);
+    }
+    say(QString("[fit] best start %1, rms %2: %3 (%4 runs, %5 s)")
+            .arg(fit.best).arg(fit.rmsError(fit.best), 0, 'g', 6).arg(values.join(", ")).arg(fit.runs)
+            .arg(fit.wallSeconds, 0, 'f', 3));
+
+    const Status status = computeRun(fitted);
+    if (status != Status::Done && status != Status::CacheHit) return status;
+    if (!writeFitFiles(runDir, fit, target)) return fail("Cannot write fit_summary.txt");
+    return status;
+}
+
+// ================= Extend run =================
+
+//현재 run의 state.bin을 불러와 old tMax+1 .. tMax 구간만 추가로 적분 (0부터 다시 계산하지 않음)
+SimulationRunner::Status SimulationRunner::extendRun(const SimulationConfig& config)
+{
+    if (runDir.isEmpty()) return fail("No run folder. Press Compute first.");
+
+    RunStateHeader header;
+    if (!loadRunState(runPath("state.bin").toStdString(), header, arena))
+        return fail("Cannot read state.bin in the run folder.");
+    if (header.configKey != config.continuationConfigKey().toStdString())
+        return fail("Network or parameters changed since this run.\n"
+                    "Press Compute to start a new run.");
+    if (config.tMax <= header.steps)
+        return fail(QString("This run already has %1 steps.\nRaise tMax first.").arg(header.steps));
+
+    const int oldSteps = header.steps;
+    if (config.usesParareal()) say("[extend] Parareal is off for the new steps (serial Euler), not cached");
+    if (!continueIntegration(config, header, config.tMax)) return cancelled();
+
+    if (!finishRun(config)) return Status::Failed;
+
+    writeRunHeaderFiles(config);
+    QFile info(runPath("run_info.txt"));
+    if (info.open(QIODevice::Append | QIODevice::Text)) {
+        QTextStream out(&info);
+        out << "\nExtended: steps " << oldSteps << " -> " << config.tMax << "\n";
+        info.close();
+    }
+
+    storeRun(config);
+    say(QString("[extend] steps %1 -> %2 in %3").arg(oldSteps).arg(config.tMax).arg(runDir));
+    return Status::Done;
+}
+
+// ================= Checkpoint / resume =================
+
+RunStateHeader SimulationRunner::runStateHeader(const SimulationConfig& config, int steps, int targetSteps) const
+{
+    RunStateHeader header;
+    header.solver = config.solverKind();
+    header.nodeCount = config.networkSpec().nodeCount;
+    header.steps = steps;
+    header.targetSteps = targetSteps;
+    header.h = config.solverStep();
+    header.nu = config.nu;
+    header.configKey = config.continuationConfigKey().toStdString();
+    return header;
+}
+
+//keepAlive(UI 유지) + checkpointIntervalMs 마다 / Cancel 시 checkpoint.bin 저장
+SolverProgressFn SimulationRunner::makeRunProgress(const SimulationConfig& config, int targetSteps)
+{
+    auto sinceCheckpoint = std::make_shared<QElapsedTimer>();
+    sinceCheckpoint->start();
+    RunStateHeader header = runStateHeader(config, 0, targetSteps);
+
+    return [this, header, sinceCheckpoint](int step) mutable {
+        if (keepAlive) keepAlive();
+        const bool cancel = cancelRequested && cancelRequested();
+        if (cancel || sinceCheckpoint->elapsed() >= checkpointIntervalMs) {
+            // at the start of `step`, rows 0..step-1 are complete
+            header.steps = step - 1;
+            writeCheckpoint(header);
+            sinceCheckpoint->restart();
+        }
+        return !cancel;
+    };
+}
+
+void SimulationRunner::writeCheckpoint(const RunStateHeader& header)
+{
+    if (runDir.isEmpty()) return;
+    if (!saveRunState(runPath("checkpoint.bin").toStdString(), header, arena))
+        say("[warn] cannot write checkpoint.bin");
+}
+
+void SimulationRunner::writeScanCheckpoint(const ScanCheckpoint& ck) const
+{
+    QSaveFile f(runPath("scan_checkpoint.txt"));
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+
+    QTextStream out(&f);
+    out << "configKey=" << ck.configKey << "\n";
+    out << "min=" << QString::number(ck.settings.min, 'g', 17) << "\n";
+    out << "max=" << QString::number(ck.settings.max, 'g', 17) << "\n";
+    out << "step=" << QString::number(ck.settings.step, 'g', 17) << "\n";
+    out << "transient=" << ck.settings.transientPercent << "\n";
+    out << "stride=" << ck.settings.sampleStride << "\n";
+    out << "nextIndex=" << ck.nextIndex << "\n";
+    out << "size3d=" << ck.size3d << "\n";
+    out << "size2d=" << ck.size2d << "\n";
+    out << "sizeEvents=" << ck.sizeEvents << "\n";
+    out.flush();
+    f.commit(); // atomic rename over the previous checkpoint
+}
+
+bool SimulationRunner::readScanCheckpoint(ScanCheckpoint& ck) const
+{
+    QFile f(runPath("scan_checkpoint.txt"));
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+
+    QMap<QString, QString> kv;
+    QTextStream in(&f);
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        const int eq = line.indexOf('=');
+        if (eq > 0) kv[line.left(eq)] = line.mid(eq + 1).trimmed();
+    }
+
+    const QStringList required = {"configKey", "min", "max", "step", "transient", "stride",
+                                  "nextIndex", "size3d", "size2d"};
+    for (const QString& key : required)
+        if (!kv.contains(key)) return false;
+
+    ck.configKey = kv["configKey"];
+    ck.settings.min = kv["min"].toDouble();
+    ck.settings.max = kv["max"].toDouble();
+    ck.settings.step = kv["step"].toDouble();
+    ck.settings.transientPercent = kv["transient"].toInt();
+    ck.settings.sampleStride = kv["stride"].toInt();
+    ck.nextIndex = kv["nextIndex"].toInt();
+    ck.size3d = kv["size3d"].toLongLong();
+    ck.size2d = kv["size2d"].toLongLong();
+    ck.sizeEvents = kv.value("sizeEvents", "0").toLongLong(); // older checkpoints: no event log
+    return ck.settings.step > 0.0 && ck.settings.sampleStride >= 1;
+}
+
+//checkpoint.bin 에서 중단된 run 이어서 계산 (결과는 중단 없이 돌린 것과 동일)
+SimulationRunner::Status SimulationRunner::resumeRun(SimulationConfig& config)
+{
+    RunStateHeader header;
+    if (!loadRunState(runPath("checkpoint.bin").toStdString(), header, arena))
+        return fail("Cannot read checkpoint.bin");
+    if (header.configKey != config.continuationConfigKey().toStdString())
+        return fail("Network or parameters differ from the checkpointed run.\n"
+                    "Restore the same network, then press Resume.");
+
+    config.tMax = header.targetSteps;
+    say(QString("[resume] run from step %1 to %2").arg(header.steps).arg(config.tMax));
+    if (!continueIntegration(config, header, config.tMax)) return cancelled();
+
+    if (!finishRun(config)) return Status::Failed;
+
+    storeRun(config);
+    return Status::Done;
+}
+
+SimulationRunner::Status SimulationRunner::resumeScan(const SimulationConfig& config)
+{
+    ScanCheckpoint ck;
+    if (!readScanCheckpoint(ck)) return fail("Cannot read scan_checkpoint.txt");
+    if (ck.configKey != ResultCache::keyFor(config.alpha2ScanCacheConfig(ck.settings)))
+        return fail("Network or parameters differ from the checkpointed scan.\n"
+                    "Restore the same network and tMax, then press Resume.");
+
+    say(QString("[resume] alpha2 scan from point %1").arg(ck.nextIndex));
+    return runAlpha2Scan(config, ck.settings, &ck);
+}
+
+// ================= Alpha2 scan =================
+
+SimulationRunner::Status SimulationRunner::scanAlpha2(const SimulationConfig& config,
+                                                      const Alpha2ScanSettings& scan)
+{
+    if (runDir.isEmpty()) return fail("No run folder. Press Compute first (or Auto Test).");
+    return runAlpha2Scan(config, scan, nullptr);
+}
+
+SimulationRunner::Status SimulationRunner::runAlpha2Scan(const SimulationConfig& config,
+                                                         const Alpha2ScanSettings& scan,
+                                                         const ScanCheckpoint* resumeFrom)
+{
+    if (checkRunnable(config) == Status::Failed) return Status::Failed;
+
+    //같은 scan 설정이면 캐시된 scan 파일 재사용 (resume 중이면 캐시 건너뜀)
+    ResultCache cache(baseResultDir + "/cache", resultCacheMaxBytes);
+    const QString scanConfig = config.alpha2ScanCacheConfig(scan);
+    const QString scanKey = ResultCache::keyFor(scanConfig);
+
+    if (useCache && !resumeFrom && cache.restore(scanKey, scanResultFiles(config), runDir)) {
+        say("[cache] alpha2 scan hit " + scanKey.left(12));
+        return Status::CacheHit;
+    }
+
+    const Status status = writeAlpha2ScanData(config, scan, scanKey, resumeFrom);
+    if (status == Status::Done && useCache) cache.store(scanKey, scanResultFiles(config), runDir, scanConfig);
+    return status;
+}
+
+//alpha2 값을 scan.min..scan.max로 바꿔가며 적분하고 alpha2_scan_3d.dat / alpha2_scan_2d.dat 작성.
+//event 가 설정되면 2d 는 stride sample 대신 transient 이후 event 상태, 전체 event 는 alpha2_scan_events.dat
+//각 point 시작마다 scan_checkpoint.txt 갱신, point 내부는 checkpoint.bin 으로 저장 -> Resume 가능
+SimulationRunner::Status SimulationRunner::writeAlpha2ScanData(const SimulationConfig& config,
+                                                               const Alpha2ScanSettings& scan,
+                                                               const QString& scanKey,
+                                                               const ScanCheckpoint* resumeFrom)
+{
+    const QString path3d = runPath("alpha2_scan_3d.dat");
+    const QString path2d = runPath("alpha2_scan_2d.dat");
+    const QString pathEvents = runPath("alpha2_scan_events.dat");
+    const std::vector<EventSpec> events = config.eventSpecs();
+    QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Text;
+    if (resumeFrom) {
+        // drop anything written after the checkpointed point, then continue appending
+        // (an unfinished scan was never stored, so these files are its own)
+        QFile::resize(path3d, resumeFrom->size3d);
+        QFile::resize(path2d, resumeFrom->size2d);
+        if (!events.empty()) QFile::resize(pathEvents, resumeFrom->sizeEvents);
+        mode = QIODevice::Append | QIODevice::Text;
+    } else {
+        detachOutputs(scanResultFiles(config));
+    }
+
+    QFile f3d(path3d);
+    QFile f2d(path2d);
+    QFile fEvents(pathEvents);
+    if (!f3d.open(mode)) return fail("Cannot write alpha2_scan_3d.dat");
+    if (!f2d.open(mode)) return fail("Cannot write alpha2_scan_2d.dat");
+    if (!events.empty() && !fEvents.open(mode)) return fail("Cannot write alpha2_scan_events.dat");
+
+    QTextStream out3d(&f3d);
+    QTextStream out2d(&f2d);
+    QTextStream outEvents(&fEvents);
+    outEvents.setRealNumberPrecision(12);
+    const int columns = resultColumns(config.networkSpec().nodeCount);
+    if (!events.empty() && fEvents.size() == 0)
+        outEvents << "# events: " << QString::fromStdString(eventSpecsText(events)) << "\n"
+                  << "# alpha2 event step value y1..y" << columns << "\n";
+    EventLog found;
+
+    const int steps = config.tMax;
+    const int transientStart = std::min(std::max(int(std::floor(steps * (scan.transientPercent / 100.0))), 0), steps);
+    const int sampleStride = scan.sampleStride;
+    const int startIndex = resumeFrom ? resumeFrom->nextIndex : 0;
+
+    SimulationConfig point = config;
+    const StateArena& y = arena;
+    int index = 0;
+    // a2 is accumulated exactly as in an uninterrupted scan, also over skipped points
+    for (double a2 = scan.min; a2 <= scan.max + 1e-12; a2 += scan.step, ++index) {
+        if (index < startIndex) continue;
+
+        out3d.flush();
+        out2d.flush();
+        if (!events.empty()) outEvents.flush();
+        ScanCheckpoint ck;
+        ck.configKey = scanKey;
+        ck.settings = scan;
+        ck.nextIndex = index;
+        ck.size3d = f3d.size();
+        ck.size2d = f2d.size();
+        ck.sizeEvents = events.empty() ? 0 : fEvents.size();
+        writeScanCheckpoint(ck);
+
+        point.alpha2 = a2;
+
+        bool done = false;
+        RunStateHeader header;
+        if (resumeFrom && index == startIndex
+            && loadRunState(runPath("checkpoint.bin").toStdString(), header, arena)
+            && header.configKey == point.continuationConfigKey().toStdString()
+            && header.targetSteps == steps) {
+            done = continueIntegration(point, header, steps);
+        } else {
+            done = integrate(point);
+        }
+        if (!done) return cancelled();
+
+        const int width = std::min(columns, y.nodeCount());
+        for (int t = 1; t <= steps; ++t) {
+            if (t % sampleStride == 0 || t == steps) {
+                out3d << a2 << " " << t;
+                for (int i = 0; i < width; ++i) out3d << " " << y.at(t, i);
+                out3d << "\n";
+            }
+        }
+
+        if (events.empty()) {
+            for (int t = transientStart; t <= steps; t += sampleStride) {
+                out2d << a2;
+                for (int i = 0; i < width; ++i) out2d << " " << y.at(t, i);
+                out2d << "\n";
+            }
+        } else {
+            //event 위치는 stride 와 무관 -> 주기와 aliasing 없는 bifurcation 점
+            found.reset(width);
+            detectEvents(point.networkSpec(), y, eventStep(point), 0, events, found);
+            for (std::size_t e = 0; e < found.size(); ++e) {
+                const double* s = &found.state[e * width];
+                outEvents << a2 << " " << found.spec[e] + 1 << " " << found.step[e] << " " << found.value[e];
+                for (int i = 0; i < width; ++i) outEvents << " " << s[i];
+                outEvents << "\n";
+                if (found.step[e] >= transientStart) {
+                    out2d << a2;
+                    for (int i = 0; i < width; ++i) out2d << " " << s[i];
+                    out2d << "\n";
+                }
+            }
+            outEvents << "\n";
+        }
+
+        out3d << "\n";
+        out2d << "\n";
+    }
+
+    f3d.close();
+    f2d.close();
+    if (!events.empty()) fEvents.close();
+
+    QFile::remove(runPath("scan_checkpoint.txt"));
+    QFile::remove(runPath("checkpoint.bin"));
+    return Status::Done;
+}
+
+// ================= Basin map =================
+
+//초기값 두 개(xNode, yNode)를 grid 로 바꿔가며 각 cell 을 따로 적분, 끝난 attractor 별로 색칠
+//cell 들은 서로 독립이라 thread 수와 관계없이 같은 map
+SimulationRunner::Status SimulationRunner::mapBasins(const SimulationConfig& config, const BasinSettings& basin)
+{
+    if (runDir.isEmpty()) return fail("No run folder. Press Compute first (or Auto Test).");
+    if (config.solverKind() != RunSolverKind::Euler)
+        return fail("Basin maps need the ODE solver (GAMMA steps depend on the whole history).");
+
+    QString why;
+    if (!config.checkEquations(&why)) return fail(why);
+    if (!config.checkLargeNetwork(&why)) return fail(why);
+
+    const int nodes = config.networkSpec().nodeCount;
+    if (basin.xNode < 0 || basin.xNode >= nodes || basin.yNode < 0 || basin.yNode >= nodes
+        || basin.xNode == basin.yNode)
+        return fail(QString("Basin map: pick two different nodes between 1 and %1.").arg(nodes));
+    if (basin.width < 1 || basin.height < 1 || !(basin.xMax > basin.xMin) || !(basin.yMax > basin.yMin))
+        return fail("Basin map: empty grid or range.");
+    const qint64 bytes = qint64(basin.width) * basin.height * 2 * std::min(nodes, kBasinDescriptorNodes)
+                         * qint64(sizeof(double));
+    if (bytes > maxArenaBytes)
+        return fail(QString("A %1x%2 basin map needs %3 MB (limit %4 MB).")
+                        .arg(basin.width).arg(basin.height).arg(bytes >> 20).arg(maxArenaBytes >> 20));
+
+    ResultCache cache(baseResultDir + "/cache", resultCacheMaxBytes);
+    const QString basinConfig = config.basinCacheConfig(basin);
+    const QString basinKey = ResultCache::keyFor(basinConfig);
+    if (useCache && cache.restore(basinKey, basinResultFiles(), runDir)) {
+        say("[cache] basin map hit " + basinKey.left(12));
+        return Status::CacheHit;
+    }
+    detachOutputs(basinResultFiles());
+
+    BasinSettings settings = basin;
+    settings.threads = rhsThreads;
+    const NetworkSpec spec = solverSpec(config);
+
+    const int reportEvery = std::max(1, basin.height / 20);
+    const BasinProgressFn progress = [&](int rowsDone) {
+        if (keepAlive) keepAlive();
+        if (rowsDone % reportEvery == 0) say(QString("[basin] %1 / %2 rows").arg(rowsDone).arg(basin.height));
+        return !(cancelRequested && cancelRequested());
+    };
+
+    BasinMap map;
+    if (!::mapBasins(spec, defaultInitialState(spec.nodeCount), config.tMax, config.odeStep, settings, map,
+                     progress)) {
+        say("[cancel] basin map stopped");
+        return Status::Cancelled;
+    }
+    if (!writeBasinFiles(runDir, map)) return fail("Cannot write basin_labels.dat");
+
+    say(QString("[basin] %1 basins over %2x%3 cells, %4 Euler steps per cell, %5 s")
+            .arg(int(map.attractors.size())).arg(basin.width).arg(basin.height)
+            .arg(double(map.eulerSteps) / (double(basin.width) * basin.height), 0, 'f', 0)
+            .arg(map.wallSeconds, 0, 'f', 2));
+    if (useCache) cache.store(basinKey, basinResultFiles(), runDir, basinConfig);
+    return Status::Done;
+}
+
+// ================= Noisy ensemble =================
+
+//noise 를 넣은 path 를 많이 돌려서 평균 / 분산 / quantile 만 모음 (path 는 저장하지 않음)
+SimulationRunner::Status SimulationRunner::runEnsemble(const SimulationConfig& config, const SdeSettings& sde)
+{
+    if (runDir.isEmpty()) return fail("No run folder. Press Compute first (or Auto Test).");
+    if (config.solverKind() != RunSolverKind::Euler) return fail("Noisy ensembles need the ODE solver.");
+    if (sde.paths < 1 || sde.sigma.empty() || sde.recordStride < 1) return fail("Ensemble: no paths or no sigma.");
+    for (double sigma : sde.sigma)
+        if (!(sigma >= 0.0)) return fail("Ensemble: sigma must not be negative.");
+    for (double p : sde.quantiles)
+        if (!(p > 0.0 && p < 1.0)) return fail("Ensemble: quantiles must lie between 0 and 1.");
+
+    QString why;
+    if (!config.checkEquations(&why)) return fail(why);
+    if (!config.checkLargeNetwork(&why)) return fail(why);
+
+    SdeSettings settings = sde;
+    std::sort(settings.quantiles.begin(), settings.quantiles.end());
+    const int nodes = config.networkSpec().nodeCount;
+    const qint64 rows = config.tMax / settings.recordStride + 2;
+    const qint64 cells = rows * qMin(nodes, qMax(1, settings.observedNodes));
+    const qint64 bytes = cells * (2 + 16 * qint64(settings.quantiles.size())) * qint64(sizeof(double));
+    if (bytes > maxArenaBytes)
+        return fail(QString("Ensemble statistics need %1 MB (limit %2 MB). Raise the record stride.")
+                        .arg(bytes >> 20).arg(maxArenaBytes >> 20));
+
+    ResultCache cache(baseResultDir + "/cache", resultCacheMaxBytes);
+    const QString ensembleConfig = config.ensembleCacheConfig(settings);
+    const QString ensembleKey = ResultCache::keyFor(ensembleConfig);
+    if (useCache && cache.restore(ensembleKey, ensembleResultFiles(), runDir)) {
+        say("[cache] ensemble hit " + ensembleKey.left(12));
+        return Status::CacheHit;
+    }
+    detachOutputs(ensembleResultFiles());
+
+    settings.threads = rhsThreads;
+    const NetworkSpec spec = solverSpec(config);
+    const int reportEvery = std::max(1, settings.paths / 10);
+    int reported = 0;
+    const SdeProgressFn progress = [&](int pathsDone) {
+        if (keepAlive) keepAlive();
+        if (pathsDone - reported >= reportEvery) {
+            reported = pathsDone;
+            say(QString("[ensemble] %1 / %2 paths").arg(pathsDone).arg(settings.paths));
+        }
+        return !(cancelRequested && cancelRequested());
+    };
+
+    EnsembleStats stats;
+    if (!runSdeEnsemble(spec, defaultInitialState(spec.nodeCount), config.tMax, config.odeStep, settings, stats,
+                        progress)) {
+        say("[cancel] ensemble stopped");
+        return Status::Cancelled;
+    }
+    if (!writeEnsembleFiles(runDir, stats, config.odeStep)) return fail("Cannot write ensemble.dat");
+
+    say(QString("[ensemble] %1 paths (%2 dropped as diverged), %3 recorded steps x %4 nodes, %5 s")
+            .arg(stats.paths).arg(stats.divergedPaths).arg(int(stats.rowSteps.size())).arg(stats.nodes)
+            .arg(stats.wallSeconds, 0, 'f', 3));
+    if (stats.paths > 0) {
+        const std::size_t last = (stats.rowSteps.size() - 1) * stats.nodes;
+        QString ys;
+        for (int i = 0; i < stats.nodes && i < 5; ++i)
+            ys += QString(" %1+-%2").arg(stats.mean[last + i], 0, 'g', 5).arg(std::sqrt(stats.variance[last + i]), 0, 'g', 3);
+        say("[ensemble] y(tMax) mean +- std:" + ys);
+    }
+    if (useCache) cache.store(ensembleKey, ensembleResultFiles(), runDir, ensembleConfig);
+    return Status::Done;
+}
+
+// ================= Uncertainty =================
+
+namespace {
+
+//"s12", "s12=normal:mean:sd", "s12=uniform:low:high" -> 분포 (이름 없는 값은 현재 값 기준 normal)
+bool parseDistribution(const SimulationConfig& config, const QString& text, double relativeSpread,
+                       ParameterDistribution& d, QString* why)
+{
+    const int eq = text.indexOf('=');
+    const QString name = (eq < 0 ? text : text.left(eq)).trimmed();
+    double p = 0.0;
+    if (name == "nu" || name == "h" || !config.scanParameter(name, p)) {
+        *why = "unknown parameter \"" + name + "\" (alpha1-3, s<ij>, g4coeff, g5coeff, g4base, g5base)";
+        return false;
+    }
+    d.name = name.toStdString();
+    if (eq < 0) {
+        d.kind = DistributionKind::Normal;
+        d.a = p;
+        d.b = relativeSpread * (std::fabs(p) > 0.0 ? std::fabs(p) : 1.0);
+        return true;
+    }
+    const QStringList parts = text.mid(eq + 1).split(':');
+    bool okA = false, okB = false;
+    if (parts.size() == 3) {
+        d.a = parts[1].toDouble(&okA);
+        d.b = parts[2].toDouble(&okB);
+    }
+    if (parts.size() != 3 || !okA || !okB || (parts[0] != "normal" && parts[0] != "uniform")) {
+        *why = "\"" + text + "\": expected name=normal:mean:sd or name=uniform:low:high";
+        return false;
+    }
+    d.kind = parts[0] == "normal" ? DistributionKind::Normal : DistributionKind::Uniform;
+    if (d.kind == DistributionKind::Normal ? !(d.b >= 0.0) : !(d.b >= d.a)) {
+        *why = "\"" + text + "\": negative sd or high < low";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+//weight 등 parameter 를 분포에서 (Sobol) 뽑아 여러 번 돌리고 y 의 quantile band 를 모음. 결과: uncertainty.dat
+SimulationRunner::Status SimulationRunner::propagateUncertainty(const SimulationConfig& config,
+                                                                QStringList parameters,
+                                                                const UncertaintySettings& settings)
+{
+    if (runDir.isEmpty()) return fail("No run folder. Press Compute first (or Auto Test).");
+    if (config.solverKind() != RunSolverKind::Euler) return fail("Uncertainty runs need the ODE solver.");
+    if (settings.maxSamples < 1) return fail("Uncertainty: no samples.");
+    for (double p : settings.quantiles)
+        if (!(p > 0.0 && p < 1.0)) return fail("Uncertainty: quantiles must lie between 0 and 1.");
+
+    QString why;
+    if (!config.checkEquations(&why)) return fail(why);
+    if (!config.checkLargeNetwork(&why)) return fail(why);
+
+    if (parameters.isEmpty())
+        for (const ConnectionConfig& c : config.connections)
+            if (!parameters.contains(SimulationConfig::weightKey(c.from, c.to)))
+                parameters << SimulationConfig::weightKey(c.from, c.to);
+    if (parameters.isEmpty()) return fail("Uncertainty: no parameter given and no drawn connection weights.");
+
+    std::vector<ParameterDistribution> distributions;
+    QStringList names;
+    for (const QString& text : parameters) {
+        ParameterDistribution d;
+        if (!parseDistribution(config, text.trimmed(), settings.relativeSpread, d, &why))
+            return fail("Uncertainty: " + why + ".");
+        distributions.push_back(d);
+        names << QString::fromStdString(d.name);
+    }
+
+    UncertaintySettings s = settings;
+    std::sort(s.quantiles.begin(), s.quantiles.end());
+    if (s.recordStride < 1) s.recordStride = qMax(1, (config.tMax + 999) / 1000);
+    const int nodes = config.networkSpec().nodeCount;
+    const qint64 rows = config.tMax / s.recordStride + 2;
+    const qint64 cells = rows * qMin(nodes, qMax(1, s.observedNodes));
+    const qint64 bytes = cells * (2 + 16 * qint64(s.quantiles.size())) * qint64(sizeof(double));
+    if (bytes > maxArenaBytes)
+        return fail(QString("Uncertainty bands need %1 MB (limit %2 MB). Raise the record stride.")
+                        .arg(bytes >> 20).arg(maxArenaBytes >> 20));
+
+    ResultCache cache(baseResultDir + "/cache", resultCacheMaxBytes);
+    const QString uncertaintyConfig = config.uncertaintyCacheConfig(distributions, s);
+    const QString uncertaintyKey = ResultCache::keyFor(uncertaintyConfig);
+    if (useCache && cache.restore(uncertaintyKey, uncertaintyResultFiles(), runDir)) {
+        say("[cache] uncertainty hit " + uncertaintyKey.left(12));
+        return Status::CacheHit;
+    }
+    detachOutputs(uncertaintyResultFiles());
+
+    // called on worker threads: every call works on its own copy of the config
+    const UncertaintyModelFn model = [config, names](const std::vector<double>& p, NetworkSpec& spec) {
+        SimulationConfig c = config;
+        for (int k = 0; k < names.size(); ++k) c.setScanParameter(names[k], p[k]);
+        spec = c.networkSpec();
+    };
+
+    s.threads = rhsThreads;
+    say(QString("[uncertainty] %1 parameters (%2), %3 .. %4 samples, %5")
+            .arg(names.size()).arg(names.join(", ")).arg(s.minSamples).arg(s.maxSamples)
+            .arg(s.sobol ? "Sobol" : "pseudo-random"));
+    int reported = 0;
+    const UncertaintyProgressFn progress = [&](int samplesDone) {
+        if (keepAlive) keepAlive();
+        if (samplesDone - reported >= std::max(1, s.minSamples)) {
+            reported = samplesDone;
+            say(QString("[uncertainty] %1 samples").arg(samplesDone));
+        }
+        return !(cancelRequested && cancelRequested());
+    };
+
+    UncertaintyBands bands;
+    if (!::propagateUncertainty(model, distributions, defaultInitialState(nodes), config.tMax, config.odeStep, s,
+                                bands, progress)) {
+        say("[cancel] uncertainty run stopped");
+        return Status::Cancelled;
+    }
+    if (!writeUncertaintyFiles(runDir, bands)) return fail("Cannot write uncertainty.dat");
+
+    for (const UncertaintyCheck& c : bands.checks)
+        say(QString("[uncertainty] %1 samples: bands moved %2 of their width").arg(c.samples).arg(c.change, 0, 'g', 3));
+    say(QString("[uncertainty] %1 samples (%2 dropped as diverged), %3, %4 s")
+            .arg(bands.samples).arg(bands.divergedSamples)
+            .arg(bands.converged ? "converged" : "sample limit reached").arg(bands.wallSeconds, 0, 'f', 3));
+    if (bands.samples > bands.divergedSamples && !s.quantiles.empty()) {
+        const int qs = int(s.quantiles.size());
+        const std::size_t last = (bands.rowSteps.size() - 1) * bands.nodes;
+        QString ys;
+        for (int i = 0; i < bands.nodes && i < 5; ++i)
+            ys += QString(" [%1, %2]").arg(bands.quantile[(last + i) * qs], 0, 'g', 5)
+                      .arg(bands.quantile[(last + i) * qs + qs - 1], 0, 'g', 5);
+        say(QString("[uncertainty] y(tMax) q%1 .. q%2:%3").arg(s.quantiles.front()).arg(s.quantiles.back()).arg(ys));
+    }
+    if (useCache) cache.store(uncertaintyKey, uncertaintyResultFiles(), runDir, uncertaintyConfig);
+    return Status::Done;
+}
+
+// ================= Plane scan =================
+
+//parameter 두 개를 grid 로 바꿔가며 cell 마다 처음부터 적분하고 tail 을 보고 regime 분류
+//coarse pass 가 끝날 때마다 plane_scan.ppm 을 다시 써서 미리보기가 점점 선명해짐
+SimulationRunner::Status SimulationRunner::scanPlane(const SimulationConfig& config, const PlaneScanSettings& plane)
+{
+    if (runDir.isEmpty()) return fail("No run folder. Press Compute first (or Auto Test).");
+
+    const QStringList names = SimulationConfig::scanParameterNames();
+    const QString xName = QString::fromStdString(plane.xParam);
+    const QString yName = QString::fromStdString(plane.yParam);
+    if (!names.contains(xName) || !names.contains(yName) || xName == yName)
+        return fail("Plane scan: pick two different parameters out of " + names.join(", ") + ".");
+    const bool ode = (config.solverKind() == RunSolverKind::Euler);
+    if ((xName == "nu" || yName == "nu") && ode) return fail("Plane scan: nu is a GAMMA parameter.");
+    const bool abm = (config.solverKind() == RunSolverKind::FractionalAbm);
+    const bool graded = (config.solverKind() == RunSolverKind::FractionalGraded);
+    if ((xName == "h" || yName == "h") && !ode && !abm && !graded)
+        return fail("Plane scan: h is the step of ODE / GAMMA-ABM / GAMMA-GRADED.");
+    if (plane.width < 1 || plane.height < 1 || !(plane.xMax > plane.xMin) || !(plane.yMax > plane.yMin))
+        return fail("Plane scan: empty grid or range.");
+
+    QString why;
+    if (!config.checkEquations(&why)) return fail(why);
+    if (!config.checkLargeNetwork(&why)) return fail(why);
+    if (!config.checkNodeOrders(&why)) return fail(why);
+
+    //worker 마다 trajectory 하나씩
+    PlaneScanSettings settings = plane;
+    settings.threads = rhsThreads;
+    const int workers = planeScanThreads(settings);
+    const int nodes = config.networkSpec().nodeCount;
+    const qint64 bytes = qint64(workers) * nodes * (2LL * config.tMax + 1) * qint64(sizeof(double));
+    if (bytes > maxArenaBytes)
+        return fail(QString("%1 workers x %2 nodes x %3 steps need %4 MB of trajectories (limit %5 MB).\n"
+                            "Lower tMax or the RHS threads.")
+                        .arg(workers).arg(nodes).arg(config.tMax).arg(bytes >> 20).arg(maxArenaBytes >> 20));
+
+    ResultCache cache(baseResultDir + "/cache", resultCacheMaxBytes);
+    const QString planeConfig = config.planeScanCacheConfig(plane);
+    const QString planeKey = ResultCache::keyFor(planeConfig);
+    if (useCache && cache.restore(planeKey, planeResultFiles(), runDir)) {
+        say("[cache] plane scan hit " + planeKey.left(12));
+        return Status::CacheHit;
+    }
+    detachOutputs(planeResultFiles());
+
+    //large network 는 alpha 와 무관하고 크므로 한 번만 만들어 공유 (edge list parse 도 한 번)
+    //native code 는 cell 마다 parameter 가 바뀌어 쓰지 않음
+    NetworkSpec largeSpec;
+    const bool shared = config.large.enabled() && config.equations.trimmed().isEmpty();
+    if (shared) {
+        largeSpec = config.networkSpec();
+        largeSpec.threads = 1;
+    }
+    std::vector<SimulationConfig> cellConfig(workers, config);
+    std::vector<StateArena> cellArena(workers);
+    const std::vector<double> y0 = defaultInitialState(nodes);
+
+    PlaneGrid grid;
+    const PlaneCellFn cell = [&](int worker, int row, int col) {
+        SimulationConfig& c = cellConfig[worker];
+        c.setScanParameter(xName, grid.cellX(col));
+        c.setScanParameter(yName, grid.cellY(row));
+        NetworkSpec spec = shared ? largeSpec : c.networkSpec();
+        spec.threads = 1;
+        StateArena& y = cellArena[worker];
+        if (ode) {
+            integrateEuler(spec, y0, c.tMax, c.odeStep, y);
+            return classifyTrajectory(spec, y, c.odeStep, settings);
+        }
+        if (abm) integrateFractionalAbm(spec, y0, c.tMax, c.nu, c.fractionalStep, y);
+        else if (graded) integrateFractionalGraded(spec, y0, c.tMax, c.nu, c.gradedMesh, y);
+        else integrateFractional(spec, y0, c.tMax, c.nodeNu(spec.nodeCount), y, SolverProgressFn(), c.historyKernel());
+        return classifyTrajectory(spec, y, 0.0, settings);
+    };
+    const PlaneProgressFn progress = [&](const PlaneGrid& g, bool passFinished) {
+        if (keepAlive) keepAlive();
+        if (passFinished) {
+            writePlaneScanFiles(runDir, g);
+            say(QString("[plane] stride %1 pass done, %2 / %3 cells, %4 s")
+                    .arg(g.stride).arg(g.computed).arg(qint64(plane.width) * plane.height)
+                    .arg(g.wallSeconds, 0, 'f', 1));
+        }
+        return !(cancelRequested && cancelRequested());
+    };
+
+    say(QString("[plane] %1 x %2 over %3x%4 cells, %5 workers")
+            .arg(xName, yName).arg(plane.width).arg(plane.height).arg(workers));
+    if (!::scanPlane(settings, grid, cell, progress)) {
+        say("[cancel] plane scan stopped, the preview keeps the finished passes");
+        return Status::Cancelled;
+    }
+    if (!writePlaneScanFiles(runDir, grid)) return fail("Cannot write plane_scan.bin");
+
+    say(QString("[plane] done, %1 cells in %2 s").arg(grid.computed).arg(grid.wallSeconds, 0, 'f', 2));
+    if (useCache) cache.store(planeKey, planeResultFiles(), runDir, planeConfig);
+    return Status::Done;
+}
+
+// ================= Equilibria =================
+
+namespace {
+
+//안정성 sector 의 order: ODE 는 1, GAMMA 는 nu. per-node order 가 섞이면 (incommensurate)
+//order 하나짜리 Matignon 판정이 맞지 않으므로 false
+bool stabilityOrder(const SimulationConfig& config, const QString& what, double& order, QString* why)
+{
+    if (config.solverKind() == RunSolverKind::Euler) {
+        order = 1.0;
+        return true;
+    }
+    if (config.mixedOrders()) {
+        if (why)
+            *why = what + ": the stability test needs one fractional order, not per-node orders ("
+                   + config.nodeOrdersText() + ").";
+        return false;
+    }
+    order = config.nu;
+    return true;
+}
+
+} // namespace
+
+//적분 없이 f(y) = 0 을 Newton 으로 직접 풀고, Jacobian 고유값으로 안정성 분류
+//ODE: Re < 0, GAMMA: |arg| > nu*pi/2 (fractional 은 안정 영역이 더 넓음)
+SimulationRunner::Status SimulationRunner::findEquilibria(const SimulationConfig& config,
+                                                          const EquilibriumSettings& settings)
+{
+    if (runDir.isEmpty()) return fail("No run folder. Press Compute first (or Auto Test).");
+
+    QString why;
+    if (!config.checkEquations(&why)) return fail(why);
+    if (!config.checkLargeNetwork(&why)) return fail(why);
+    double order = 1.0;
+    if (!stabilityOrder(config, "Equilibria", order, &why)) return fail(why);
+
+    //native code 가 켜져 있으면 Newton 도 그 Jacobian 을 씀
+    const NetworkSpec spec = solverSpec(config);
+    if (spec.nodeCount > kEquilibriumMaxNodes)
+        return fail(QString("Equilibria: %1 nodes, the dense Jacobian allows up to %2.")
+                        .arg(spec.nodeCount).arg(kEquilibriumMaxNodes));
+
+    EquilibriumSettings s = settings;
+    s.order = order;
+    s.threads = rhsThreads;
+
+    const int reportEvery = std::max(1, s.seeds / 10);
+    const EquilibriumProgressFn progress = [&](int seedsDone) {
+        if (keepAlive) keepAlive();
+        if (seedsDone % reportEvery == 0) say(QString("[equilibria] %1 / %2 seeds").arg(seedsDone).arg(s.seeds));
+        return !(cancelRequested && cancelRequested());
+    };
+
+    if (!::findEquilibria(spec, defaultInitialState(spec.nodeCount), s, equilibria, progress)) {
+        say("[cancel] equilibrium search stopped");
+        return Status::Cancelled;
+    }
+    if (!writeEquilibriumFiles(runDir, equilibria)) return fail("Cannot write equilibria.txt");
+
+    int stable = 0;
+    for (const Equilibrium& e : equilibria.equilibria)
+        if (e.kind == EquilibriumKind::StableNode || e.kind == EquilibriumKind::StableFocus) ++stable;
+    say(QString("[equilibria] %1 found (%2 stable), %3 of %4 seeds did not converge, %5 s")
+            .arg(int(equilibria.equilibria.size())).arg(stable).arg(equilibria.failedSeeds).arg(s.seeds)
+            .arg(equilibria.wallSeconds, 0, 'f', 4));
+    for (int k = 0; k < int(equilibria.equilibria.size()) && k < 10; ++k) {
+        const Equilibrium& e = equilibria.equilibria[k];
+        QString ys;
+        for (int i = 0; i < int(e.y.size()) && i < 5; ++i) ys += " " + QString::number(e.y[i], 'g', 6);
+        say(QString("[equilibria] #%1 %2, max Re = %3, y =%4%5")
+                .arg(k).arg(equilibriumKindName(e.kind))
+                .arg(e.eigenvalues.empty() ? 0.0 : e.eigenvalues.front().real(), 0, 'g', 6)
+                .arg(ys).arg(e.y.size() > 5 ? " ..." : ""));
+    }
+    return Status::Done;
+}
+
+// ================= Continuation =================
+
+namespace {
+
+//같은 edge / gate / equation 구조인지 (values 이면 weight, base, coeff, 상수 값까지)
+bool sameNetwork(const NetworkSpec& a, const NetworkSpec& b, bool values)
+{
+    if (a.nodeCount != b.nodeCount || a.edges.size() != b.edges.size() || a.gates.size() != b.gates.size()
+        || bool(a.equations) != bool(b.equations) || a.native || b.native)
+        return false;
+    for (std::size_t e = 0; e < a.edges.size(); ++e) {
+        const EdgeSpec &x = a.edges[e], &y = b.edges[e];
+        if (x.from != y.from || x.to != y.to || x.fn != y.fn || (values && x.weight != y.weight)) return false;
+    }
+    for (std::size_t g = 0; g < a.gates.size(); ++g) {
+        const GateTermSpec &x = a.gates[g], &y = b.gates[g];
+        if (x.node != y.node || x.source != y.source || x.fn != y.fn
+            || (values && (x.base != y.base || x.coeff != y.coeff)))
+            return false;
+    }
+    if (!a.equations) return true;
+    if (a.equations->constants.size() != b.equations->constants.size()
+        || a.equations->structure() != b.equations->structure())
+        return false;
+    return !values || a.equations->constants == b.equations->constants;
+}
+
+//parameter 하나만 움직이는 network: spec 은 한 번만 만들고 값이 parameter 그대로인 자리
+//(edge weight, gate base / coeff, equation 상수) 에만 p 를 써 넣음.
+//자리는 두 값에서 만든 spec 을 비교해 찾고, 세 번째 값에서 다시 만든 spec 과 같은지 확인.
+//p 가 다른 값과 접혀 들어가면 (1 - alpha1 같은 상수 folding) 확인이 실패하고 매번 다시 만듦
+class ParameterNetworks
+{
+public:
+    ParameterNetworks(const SimulationConfig& config, const QString& parameter, double p0)
+        : work(config), parameter(parameter)
+    {
+        const double p1 = p0 + 0.6180339887498949, p2 = p0 - 0.4142135623730951;
+        base = build(p1);
+        const NetworkSpec other = build(p2);
+        if (!sameNetwork(base, other, false)) return;
+
+        for (std::size_t e = 0; e < base.edges.size(); ++e)
+            if (base.edges[e].weight == p1 && other.edges[e].weight == p2) edgeSlots.push_back(e);
+        for (std::size_t g = 0; g < base.gates.size(); ++g) {
+            if (base.gates[g].base == p1 && other.gates[g].base == p2) gateBaseSlots.push_back(g);
+            if (base.gates[g].coeff == p1 && other.gates[g].coeff == p2) gateCoeffSlots.push_back(g);
+        }
+        if (base.equations)
+            for (std::size_t c = 0; c < base.equations->constants.size(); ++c)
+                if (base.equations->constants[c] == p1 && other.equations->constants[c] == p2)
+                    constantSlots.push_back(c);
+
+        // not at p0 itself: equal constants share a register, so p0 = alpha1 would not compare
+        const double p3 = p0 + 0.2360679774997897;
+        patchable = true;
+        patchable = sameNetwork(at(p3), build(p3), true);
+    }
+
+    NetworkSpec at(double p)
+    {
+        if (!patchable) return build(p);
+        NetworkSpec spec = base;
+        for (std::size_t e : edgeSlots) spec.edges[e].weight = p;
+        for (std::size_t g : gateBaseSlots) spec.gates[g].base = p;
+        for (std::size_t g : gateCoeffSlots) spec.gates[g].coeff = p;
+        if (!constantSlots.empty()) {
+            auto program = std::make_shared<EquationProgram>(*base.equations);
+            for (std::size_t c : constantSlots) program->constants[c] = p;
+            spec.equations = program;
+        }
+        return spec;
+    }
+
+private:
+    NetworkSpec build(double p)
+    {
+        work.setScanParameter(parameter, p);
+        return work.networkSpec();
+    }
+
+    SimulationConfig work;
+    QString parameter;
+    NetworkSpec base;
+    bool patchable = false;
+    std::vector<std::size_t> edgeSlots, gateBaseSlots, gateCoeffSlots, constantSlots;
+};
+
+} // namespace
+
+//현재 parameter 값에서 찾은 평형점마다 양쪽으로 branch 를 따라감 (fold 를 돌아 unstable branch 까지)
+//이미 앞 branch 위에 있는 평형점은 건너뜀
+SimulationRunner::Status SimulationRunner::continueBranches(const SimulationConfig& config, const QString& parameter,
+                                                            const ContinuationSettings& settings)
+{
+    if (runDir.isEmpty()) return fail("No run folder. Press Compute first (or Auto Test).");
+
+    double p0 = 0.0;
+    if (parameter == "nu" || parameter == "h" || !config.scanParameter(parameter, p0))
+        return fail("Continuation: the parameter must be alpha1, alpha2, alpha3 or a weight s<ij>.");
+    if (!(settings.pMax > settings.pMin) || p0 < settings.pMin || p0 > settings.pMax)
+        return fail(QString("Continuation: %1 = %2 must lie inside [min, max].").arg(parameter).arg(p0));
+
+    QString why;
+    if (!config.checkEquations(&why)) return fail(why);
+    if (!config.checkLargeNetwork(&why)) return fail(why);
+    double order = 1.0;
+    if (!stabilityOrder(config, "Continuation", order, &why)) return fail(why);
+
+    const NetworkSpec spec = config.networkSpec();
+    const int n = spec.nodeCount;
+    if (n > kEquilibriumMaxNodes)
+        return fail(QString("Continuation: %1 nodes, the dense Jacobian allows up to %2.")
+                        .arg(n).arg(kEquilibriumMaxNodes));
+
+    ParameterNetworks networks(config, parameter, p0);
+    const ParameterSpecFn specAt = [&](double p) { return networks.at(p); };
+
+    // the parameter has to reach the right-hand side (large networks / equations may not use it)
+    const std::vector<double> y0 = defaultInitialState(n);
+    std::vector<double> fLow(n), fHigh(n);
+    for (double p : {p0 - 1.0, p0 + 1.0}) {
+        NetworkSpec probe = specAt(p);
+        probe.threads = 1;
+        visitRhsKernel(probe, [&](const auto& kernel) { kernel.eval(y0.data(), (p < p0 ? fLow : fHigh).data()); });
+    }
+    if (fLow == fHigh) return fail("Continuation: " + parameter + " does not enter the network equations.");
+
+    EquilibriumSettings start;
+    start.seeds = 32;
+    start.order = order;
+    start.threads = rhsThreads;
+    EquilibriumResult found;
+    ::findEquilibria(specAt(p0), y0, start, found);
+    if (found.equilibria.empty())
+        return fail(QString("Continuation: no equilibrium found at %1 = %2.").arg(parameter).arg(p0));
+
+    ContinuationSettings s = settings;
+    s.order = order;
+    int points = 0;
+    const ContinuationProgressFn progress = [&](const ContinuationResult& r) {
+        if (keepAlive) keepAlive();
+        if (++points % 200 == 0)
+            say(QString("[continuation] %1 points, %2 = %3").arg(points).arg(parameter).arg(r.branch.back().p));
+        return !(cancelRequested && cancelRequested());
+    };
+
+    std::vector<ContinuationResult> branches;
+    for (const Equilibrium& e : found.equilibria) {
+        if (branches.size() >= 8) break;
+        // already on a branch traced from an earlier equilibrium
+        bool known = false;
+        for (const ContinuationResult& b : branches)
+            for (const BranchPoint& bp : b.branch) {
+                double distance = std::fabs(bp.p - p0);
+                for (int i = 0; i < n; ++i) distance = std::max(distance, std::fabs(bp.y[i] - e.y[i]));
+                if (distance < 0.5 * s.dsMax) known = true;
+            }
+        if (known) continue;
+
+        ContinuationResult backward, forward;
+        s.direction = -1;
+        if (!continueEquilibrium(specAt, p0, e.y, s, backward, progress) && backward.stopReason == "cancelled") {
+            say("[cancel] continuation stopped");
+            return Status::Cancelled;
+        }
+        s.direction = 1;
+        if (!continueEquilibrium(specAt, p0, e.y, s, forward, progress) && forward.stopReason == "cancelled") {
+            say("[cancel] continuation stopped");
+            return Status::Cancelled;
+        }
+        if (backward.branch.empty() && forward.branch.empty()) continue;
+        branches.push_back(joinHalfBranches(backward, forward));
+
+        const ContinuationResult& b = branches.back();
+        say(QString("[continuation] branch %1 from %2 at %3 = %4: %5 points, %6 = %7 .. %8 (%9)")
+                .arg(int(branches.size()) - 1).arg(equilibriumKindName(e.kind)).arg(parameter).arg(p0)
+                .arg(int(b.branch.size())).arg(parameter).arg(b.branch.front().p).arg(b.branch.back().p)
+                .arg(QString::fromStdString(b.stopReason)));
+        for (const BifurcationPoint& bp : b.bifurcations)
+            say(QString("[continuation]   %1 at %2 = %3%4")
+                    .arg(bifurcationKindName(bp.kind)).arg(parameter).arg(bp.p, 0, 'g', 8)
+                    .arg(bp.kind == BifurcationKind::Hopf ? QString(", frequency %1").arg(bp.frequency, 0, 'g', 6)
+                                                          : QString()));
+    }
+    if (!writeContinuationFiles(runDir, parameter, branches)) return fail("Cannot write continuation.dat");
+    return Status::Done;
+}
+
+// ================= Reporting =================
+
+SimulationRunner::Status SimulationRunner::fail(const QString& message)
+{
+    error = message;
+    return Status::Failed;
+}
+
+SimulationRunner::Status SimulationRunner::cancelled()
+{
+    say("[cancel] stopped. Checkpoint saved in " + runDir);
+    return Status::Cancelled;
+}
+
+void SimulationRunner::say(const QString& message) const
+{
+    if (log) log(message);
+}
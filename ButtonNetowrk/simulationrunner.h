@@ -0,0 +1,157 @@
+#ifndef SIMULATIONRUNNER_H
+#define SIMULATIONRUNNER_H
+
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+#include <memory>
+
+#include "continuation.h"
+#include "equilibrium.h"
+#include "nativecompiler.h"
+#include "networksolver.h"
+#include "parameterfit.h"
+#include "runstate.h"
+#include "sdeensemble.h"
+#include "uncertainty.h"
+#include "sensitivity.h"
+#include "simulationconfig.h"
+#include "statearena.h"
+
+// scan_checkpoint.txt: scan points before nextIndex are complete and the scan
+// files were size3d / size2d bytes long at that point.
+struct ScanCheckpoint {
+    QString configKey;
+    Alpha2ScanSettings settings;
+    int nextIndex = 0;
+    qint64 size3d = 0;
+    qint64 size2d = 0;
+    qint64 sizeEvents = 0;
+};
+
+// Runs, extends, resumes and alpha2-scans a SimulationConfig into a run folder
+// (result cache, state.bin, checkpoints). No widgets: the GUI and
+// buttonnetwork-cli both drive it and only differ in how they report.
+class SimulationRunner
+{
+public:
+    enum class Status { Done, CacheHit, Cancelled, Failed };
+
+    QString baseResultDir;   // holds run_* folders and cache/
+    QString runDir;          // current run folder
+    bool useCache = true;
+    qint64 resultCacheMaxBytes = 512LL * 1024 * 1024; // <baseResultDir>/cache, LRU
+    int checkpointIntervalMs = 30000;
+    // Compile the network to native code (<baseResultDir>/native) and run that;
+    // falls back to the interpreter when the host compiler is missing or fails.
+    bool useNativeCode = false;
+    // Threads for the RHS of large networks (>= kSparseKernelMinNodes nodes) and for
+    // Parareal slices, 0: all cores. Results do not depend on it.
+    int rhsThreads = 0;
+    // A run keeps every state and rhs row in memory: refuse runs that need more.
+    qint64 maxArenaBytes = 4LL * 1024 * 1024 * 1024;
+
+    // Hooks: log line, called every few hundred steps (GUI: processEvents), cancel poll
+    std::function<void(const QString&)> log;
+    std::function<void()> keepAlive;
+    std::function<bool()> cancelRequested;
+
+    QString runPath(const QString& filename) const;
+    bool createRunDir();   // <baseResultDir>/run_<timestamp>[_n]
+    bool hasRunCheckpoint() const;
+    bool hasScanCheckpoint() const;
+
+    // params.txt + run_info.txt
+    bool writeRunHeaderFiles(const SimulationConfig& config);
+
+    // Single run into runDir (writes params/run_info, cache aware).
+    Status computeRun(const SimulationConfig& config);
+    // Continue the finished run in runDir (state.bin) up to config.tMax.
+    Status extendRun(const SimulationConfig& config);
+    // Continue checkpoint.bin; config.tMax is set to the checkpointed target.
+    Status resumeRun(SimulationConfig& config);
+    // Single ODE run that also integrates d y / d p for each named parameter (alpha1-3,
+    // s<ij>, g4coeff ...) and writes sensitivity_<p>.dat beside result.dat. Serial Euler
+    // even when Parareal is on; the trajectory is stored in the result cache.
+    Status computeSensitivities(const SimulationConfig& config, const QStringList& parameters);
+    // Levenberg-Marquardt fit of the named parameters (empty: every drawn connection
+    // weight) to the trajectory in targetPath (parameterfit.h), several starts in
+    // parallel. runDir then holds the best fit as a normal run: params.txt loads back.
+    Status fitParameters(const SimulationConfig& config, const QString& targetPath, QStringList parameters,
+                         const FitSettings& settings);
+    const FitResult& lastFit() const { return fit; }
+
+    // alpha2 scan into runDir (cache aware); resumeScan() continues scan_checkpoint.txt.
+    Status scanAlpha2(const SimulationConfig& config, const Alpha2ScanSettings& scan);
+    Status resumeScan(const SimulationConfig& config);
+
+    // Basin-of-attraction map into runDir (ODE only, cache aware, rhsThreads workers).
+    // Not checkpointed: a cancelled map is simply started again.
+    Status mapBasins(const SimulationConfig& config, const BasinSettings& basin);
+    // Two-parameter regime map into runDir (ODE or GAMMA, cache aware, rhsThreads workers).
+    // The preview files are rewritten after every coarse-to-fine pass.
+    Status scanPlane(const SimulationConfig& config, const PlaneScanSettings& plane);
+    // Noisy (SDE) ensemble of the ODE network into runDir (sdeensemble.h, cache aware,
+    // rhsThreads workers): streamed mean / std / quantiles, bitwise the same for any thread count.
+    Status runEnsemble(const SimulationConfig& config, const SdeSettings& sde);
+    // Monte Carlo bands of y over uncertain parameters (uncertainty.h, cache aware, rhsThreads
+    // workers). Each entry is "name" (normal around the current value, sd = relativeSpread * |value|),
+    // "name=normal:mean:sd" or "name=uniform:low:high"; empty: every drawn connection weight.
+    Status propagateUncertainty(const SimulationConfig& config, QStringList parameters,
+                                const UncertaintySettings& settings);
+    // Equilibria by damped Newton from many seeds, with Jacobian eigenvalues, into runDir.
+    // Stability uses Re < 0 for ODE and |arg| > nu pi/2 for GAMMA. Not cached (milliseconds).
+    Status findEquilibria(const SimulationConfig& config, const EquilibriumSettings& settings);
+    const EquilibriumResult& lastEquilibria() const { return equilibria; }
+    // Equilibrium branches through the parameter (alpha1-3 or a weight s<ij>) by
+    // pseudo-arclength continuation, started from the equilibria at its current value.
+    Status continueBranches(const SimulationConfig& config, const QString& parameter,
+                            const ContinuationSettings& settings);
+
+    const StateArena& trajectory() const { return arena; }
+    const PararealStats& lastPararealStats() const { return pararealStats; }
+    const QString& lastError() const { return error; }
+
+    // events.dat / alpha2_scan_events.dat only when config.events is set
+    static QStringList runResultFiles(const SimulationConfig& config);
+    static QStringList scanResultFiles(const SimulationConfig& config);
+    static QStringList basinResultFiles();
+    static QStringList planeResultFiles();
+    static QStringList ensembleResultFiles();
+    static QStringList uncertaintyResultFiles();
+
+private:
+    NetworkSpec solverSpec(const SimulationConfig& config);
+    Status checkRunnable(const SimulationConfig& config);
+    bool integrate(const SimulationConfig& config);
+    bool continueIntegration(const SimulationConfig& config, const RunStateHeader& header, int targetSteps);
+    bool finishRun(const SimulationConfig& config);
+    void detachOutputs(const QStringList& files) const;
+    void storeRun(const SimulationConfig& config);
+
+    RunStateHeader runStateHeader(const SimulationConfig& config, int steps, int targetSteps) const;
+    SolverProgressFn makeRunProgress(const SimulationConfig& config, int targetSteps);
+    void writeCheckpoint(const RunStateHeader& header);
+    void writeScanCheckpoint(const ScanCheckpoint& ck) const;
+    bool readScanCheckpoint(ScanCheckpoint& ck) const;
+
+    Status runAlpha2Scan(const SimulationConfig& config, const Alpha2ScanSettings& scan,
+                         const ScanCheckpoint* resumeFrom);
+    Status writeAlpha2ScanData(const SimulationConfig& config, const Alpha2ScanSettings& scan,
+                               const QString& scanKey, const ScanCheckpoint* resumeFrom);
+
+    Status fail(const QString& message);
+    Status cancelled();
+    void say(const QString& message) const;
+
+    // Trajectory / history buffers, reused by every run and scan point
+    StateArena arena;
+    PararealStats pararealStats;
+    EquilibriumResult equilibria;
+    FitResult fit;
+    QString error;
+    std::unique_ptr<NativeCodeCache> nativeCache;
+};
+
+#endif // SIMULATIONRUNNER_H
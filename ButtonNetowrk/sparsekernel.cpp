@@ -0,0 +1,132 @@
+#include "sparsekernel.h"
+
+#include <algorithm>
+
+#include "nodeordering.h"
+
+namespace {
+
+// below this many edge+node evaluations per step, waking threads costs more than it saves
+const std::int64_t kMinWorkPerThread = 20000;
+
+} // namespace
+
+SparseRhsKernel::SparseRhsKernel(const NetworkSpec& spec, int threads)
+    : n(spec.nodeCount)
+{
+    auto valid = [&](int i) { return i >= 0 && i < n; };
+
+    std::vector<int> slotOf(4, -1);
+    for (const EdgeSpec& e : spec.edges) {
+        if (e.fn == ActivationKind::None || !valid(e.from) || !valid(e.to)) continue;
+        int& slot = slotOf[int(e.fn)];
+        if (slot < 0) {
+            slot = int(kinds.size());
+            kinds.push_back(e.fn);
+        }
+    }
+
+    // position of every node in memory (nodeordering.h); rows and the act buffer use it
+    const std::vector<int> pos = computeNodeOrdering(spec, spec.ordering);
+    node.resize(n);
+    for (int i = 0; i < n; ++i) node[pos[i]] = i;
+    ordering = spec.ordering;
+    permuted = (ordering != NodeOrdering::None);
+
+    // CSR by target position; counting sort is stable, so a row keeps the spec order
+    rowStart.assign(n + 1, 0);
+    for (const EdgeSpec& e : spec.edges)
+        if (e.fn != ActivationKind::None && valid(e.from) && valid(e.to)) ++rowStart[pos[e.to] + 1];
+    for (int r = 0; r < n; ++r) rowStart[r + 1] += rowStart[r];
+
+    col.resize(rowStart[n]);
+    weight.resize(rowStart[n]);
+    std::vector<std::int64_t> fill(rowStart.begin(), rowStart.end() - 1);
+    for (const EdgeSpec& e : spec.edges) {
+        if (e.fn == ActivationKind::None || !valid(e.from) || !valid(e.to)) continue;
+        const std::int64_t k = fill[pos[e.to]]++;
+        col[k] = std::int64_t(slotOf[int(e.fn)]) * n + pos[e.from];
+        weight[k] = e.weight;
+    }
+
+    gateStart.assign(n + 1, 0);
+    for (const GateTermSpec& g : spec.gates)
+        if (valid(g.node) && valid(g.source)) ++gateStart[pos[g.node] + 1];
+    for (int r = 0; r < n; ++r) gateStart[r + 1] += gateStart[r];
+    gatesByNode.resize(gateStart[n]);
+    std::vector<int> gateFill(gateStart.begin(), gateStart.end() - 1);
+    for (const GateTermSpec& g : spec.gates)
+        if (valid(g.node) && valid(g.source)) gatesByNode[gateFill[pos[g.node]]++] = g;
+
+    act.assign(kinds.size() * std::size_t(n), 0.0);
+    if (permuted) ordered.assign(n, 0.0);
+
+    const std::int64_t work = std::int64_t(n) * std::int64_t(kinds.size() + 1) + std::int64_t(col.size());
+    if (threads <= 0) threads = WorkerPool::hardwareThreads();
+    threads = int(std::max<std::int64_t>(1, std::min<std::int64_t>(threads, work / kMinWorkPerThread)));
+    pool.reset(new WorkerPool(threads));
+
+    const int parts = pool->size();
+    nodeSplit.resize(parts + 1);
+    rowSplit.resize(parts + 1);
+    for (int k = 0; k <= parts; ++k) nodeSplit[k] = int(std::int64_t(n) * k / parts);
+
+    // rows balanced on (edges + 1) each
+    const std::int64_t total = rowStart[n] + n;
+    rowSplit[0] = 0;
+    int row = 0;
+    for (int k = 1; k < parts; ++k) {
+        const std::int64_t target = total * k / parts;
+        while (row < n && rowStart[row] + row < target) ++row;
+        rowSplit[k] = row;
+    }
+    rowSplit[parts] = n;
+}
+
+std::string SparseRhsKernel::name() const
+{
+    std::string text = "sparse(" + std::to_string(col.size()) + " edges";
+    if (permuted) text += std::string(", ") + nodeOrderingName(ordering);
+    return text + ")";
+}
+
+void SparseRhsKernel::eval(const double* y, double* dy) const
+{
+    double* a = act.data();
+    const int* at = node.data();
+    const std::size_t kindCount = kinds.size();
+
+    // permuted: y is gathered once into position order, dy scattered once at the end of a row;
+    // everything in between (the per-edge gathers) stays inside the reordered buffers
+    const double* yr = y;
+    if (permuted) yr = ordered.data();
+
+    auto activations = [&](int k) {
+        if (permuted) {
+            double* out = ordered.data();
+            for (int r = nodeSplit[k]; r < nodeSplit[k + 1]; ++r) out[r] = y[at[r]];
+        }
+        for (std::size_t s = 0; s < kindCount; ++s) {
+            const ActivationKind fn = kinds[s];
+            double* out = a + s * std::size_t(n);
+            for (int r = nodeSplit[k]; r < nodeSplit[k + 1]; ++r) out[r] = applyActivation(fn, yr[r]);
+        }
+    };
+
+    auto rows = [&](int k) {
+        const std::int64_t* cols = col.data();
+        const double* w = weight.data();
+        for (int r = rowSplit[k]; r < rowSplit[k + 1]; ++r) {
+            double sum = -yr[r];
+            for (std::int64_t e = rowStart[r]; e < rowStart[r + 1]; ++e) sum += w[e] * a[cols[e]];
+            for (int g = gateStart[r]; g < gateStart[r + 1]; ++g) {
+                const GateTermSpec& gate = gatesByNode[g];
+                sum += (gate.base - gate.coeff * applyActivation(gate.fn, y[gate.source])) * std::tanh(yr[r]);
+            }
+            dy[at[r]] = sum;
+        }
+    };
+
+    pool->run(activations);
+    pool->run(rows);
+}
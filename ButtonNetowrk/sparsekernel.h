@@ -0,0 +1,53 @@
+#ifndef SPARSEKERNEL_H
+#define SPARSEKERNEL_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "networkspec.h"
+#include "workerpool.h"
+
+// Kernel for large networks (thousands of nodes). Same sums as GenericRhsKernel
+// in the same order, so results are identical to it for any thread count and ordering:
+//   1. fn(y_j) once per node and activation kind in use (not once per edge),
+//   2. per target row: -y_i + sum w * act[col] over a CSR structure-of-arrays,
+//      plus the row's gates.
+// Both passes are split over a WorkerPool: nodes evenly, rows by edge count.
+// With spec.ordering set, rows and act[] are laid out in that node order
+// (nodeordering.h); y and dy stay in the user's numbering.
+class SparseRhsKernel
+{
+public:
+    // threads <= 0: hardware threads; small networks always run on one thread
+    SparseRhsKernel(const NetworkSpec& spec, int threads);
+
+    int nodeCount() const { return n; }
+    std::string name() const;
+    void eval(const double* y, double* dy) const;
+
+    std::size_t edgeCount() const { return col.size(); }
+    int threadCount() const { return pool->size(); }
+
+private:
+    int n = 0;
+    NodeOrdering ordering = NodeOrdering::None;
+    bool permuted = false;
+    std::vector<int> node;                 // node[r]: user index of the node at position r
+    std::vector<ActivationKind> kinds;     // activation kinds in use
+    std::vector<std::int64_t> rowStart;    // n + 1, by position
+    std::vector<std::int64_t> col;         // act index: kind slot * n + source position
+    std::vector<double> weight;
+    std::vector<int> gateStart;            // n + 1, by position
+    std::vector<GateTermSpec> gatesByNode;
+
+    std::vector<int> nodeSplit;            // pool.size() + 1 node ranges (pass 1)
+    std::vector<int> rowSplit;             // pool.size() + 1 row ranges (pass 2)
+
+    mutable std::vector<double> act;       // kinds.size() * n
+    mutable std::vector<double> ordered;   // permuted: y by position
+    std::unique_ptr<WorkerPool> pool;
+};
+
+#endif // SPARSEKERNEL_H
@@ -0,0 +1,141 @@
+#include "statearena.h"
+
+#include <cmath>
+#include <cstring>
+#include <new>
+
+namespace {
+
+std::size_t roundUpToLine(std::size_t count)
+{
+    const std::size_t perLine = StateArena::kAlignment / sizeof(double);
+    return (count + perLine - 1) / perLine * perLine;
+}
+
+} // namespace
+
+std::size_t StateArena::requiredDoubles(std::size_t rowStride, int steps, int tables)
+{
+    return rowStride * (std::size_t(steps) + 1)                           // trajectory
+         + rowStride * std::size_t(steps)                                 // rhs history
+         + (std::size_t(tables) + 1) * roundUpToLine(std::size_t(steps)); // kernel tables + corrector
+}
+
+void StateArena::reserveDoubles(std::size_t need, std::size_t keepTrajectory,
+                                std::size_t oldRhsOffset, std::size_t keepRhs,
+                                std::size_t newRhsOffset)
+{
+    if (need <= capacity) {
+        // rhs rows move up when the trajectory grows; ranges may overlap
+        if (keepRhs > 0 && oldRhsOffset != newRhsOffset)
+            std::memmove(block.get() + newRhsOffset, block.get() + oldRhsOffset, keepRhs * sizeof(double));
+        return;
+    }
+
+    // grow geometrically so a slowly increasing tMax does not reallocate every run
+    std::size_t grown = capacity + capacity / 2;
+    if (grown < need) grown = need;
+    std::unique_ptr<double[], AlignedDelete> fresh(
+        static_cast<double*>(::operator new[](grown * sizeof(double), std::align_val_t(kAlignment))));
+
+    if (keepTrajectory > 0)
+        std::memcpy(fresh.get(), block.get(), keepTrajectory * sizeof(double));
+    if (keepRhs > 0)
+        std::memcpy(fresh.get() + newRhsOffset, block.get() + oldRhsOffset, keepRhs * sizeof(double));
+
+    block = std::move(fresh);
+    capacity = grown;
+    ++allocations;
+}
+
+void StateArena::invalidateWeights()
+{
+    for (WeightCache& cache : tableCache) cache.valid = false;
+    correctorCache.valid = false;
+}
+
+void StateArena::prepare(int nodeCount, int steps)
+{
+    const std::size_t newStride = roundUpToLine(std::size_t(nodeCount));
+    const std::size_t newRhsOffset = newStride * (std::size_t(steps) + 1);
+    const std::size_t newWeightOffset = newRhsOffset + newStride * std::size_t(steps);
+
+    reserveDoubles(requiredDoubles(newStride, steps, 1), 0, 0, 0, 0);
+    if (newWeightOffset != weightOffset || tableCount != 1) invalidateWeights();
+
+    n = nodeCount;
+    stepCount = steps;
+    stride = newStride;
+    rhsOffset = newRhsOffset;
+    weightOffset = newWeightOffset;
+    tableCount = 1;
+    tableCache.resize(1);
+}
+
+void StateArena::extend(int newSteps)
+{
+    if (newSteps <= stepCount) return;
+
+    const std::size_t oldRhsOffset = rhsOffset;
+    const std::size_t newRhsOffset = stride * (std::size_t(newSteps) + 1);
+
+    reserveDoubles(requiredDoubles(stride, newSteps, tableCount),
+                   stride * (std::size_t(stepCount) + 1),
+                   oldRhsOffset, stride * std::size_t(stepCount),
+                   newRhsOffset);
+
+    stepCount = newSteps;
+    rhsOffset = newRhsOffset;
+    weightOffset = newRhsOffset + stride * std::size_t(newSteps);
+    invalidateWeights();
+}
+
+void StateArena::setWeightTables(int tables)
+{
+    if (tables < 1 || tables == tableCount) return;
+    // the tables sit behind the rhs rows: growing them keeps everything before weightOffset
+    reserveDoubles(requiredDoubles(stride, stepCount, tables), weightOffset, 0, 0, 0);
+    tableCount = tables;
+    tableCache.resize(tables);
+    invalidateWeights();
+}
+
+const double* StateArena::historyWeights(FractionalKernel kernel, double nu, int table)
+{
+    double* b = block.get() + weightOffset + std::size_t(table) * roundUpToLine(std::size_t(stepCount));
+    WeightCache& cache = tableCache[table];
+    if (cache.valid && cache.allocation == allocations && cache.kernel == kernel && cache.nu == nu
+        && cache.count == stepCount)
+        return b;
+
+    if (kernel == FractionalKernel::PowDifference) {
+        for (int k = 0; k < stepCount; ++k)
+            b[k] = std::pow(k + 1.0, nu) - std::pow(double(k), nu);
+    } else if (stepCount > 0) {
+        // every factor is below 1 for nu < 1: the weights only shrink, relative error ~ k eps
+        b[0] = 1.0;
+        for (int k = 1; k < stepCount; ++k) b[k] = b[k - 1] * ((k - 1 + nu) / k);
+    }
+
+    cache = {true, kernel, nu, stepCount, allocations};
+    return b;
+}
+
+const double* StateArena::correctorWeights(double nu)
+{
+    double* c = block.get() + weightOffset + std::size_t(tableCount) * roundUpToLine(std::size_t(stepCount));
+    if (correctorCache.valid && correctorCache.allocation == allocations && correctorCache.nu == nu
+        && correctorCache.count == stepCount)
+        return c;
+
+    // second difference of k^(nu+1) around k+1, written without the cancellation of
+    // the three large powers: (k+1)^p ((1+x)^p - 1 + (1-x)^p - 1), x = 1 / (k+1)
+    const double p = nu + 1.0;
+    for (int k = 0; k < stepCount; ++k) {
+        const double x = 1.0 / (k + 1.0);
+        c[k] = std::pow(k + 1.0, p) * (std::expm1(p * std::log1p(x)) + std::expm1(p * std::log1p(-x)));
+    }
+
+    correctorCache = {true, FractionalKernel::PowDifference, nu, stepCount, allocations};
+    return c;
+}
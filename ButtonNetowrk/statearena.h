@@ -0,0 +1,93 @@
+#ifndef STATEARENA_H
+#define STATEARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// History weights of the fractional (GAMMA) sum y_om = y_0 + sum_r f(y_{r-1}) w_{om-r}:
+//   PowDifference  w_k = (k+1)^nu - k^nu
+//   GammaRatio     w_k = Gamma(k+nu) / (Gamma(k+1) Gamma(nu)), the kernel of solver.c, by the
+//                  recurrence w_0 = 1, w_k = w_{k-1} (k-1+nu) / k: no Gamma calls, no overflow
+// For large k they behave like nu k^(nu-1) and k^(nu-1) / Gamma(nu): the two kernels differ
+// by Gamma(nu+1) and give different trajectories.
+enum class FractionalKernel { PowDifference, GammaRatio };
+
+// Single 64-byte aligned block for one integration:
+//   trajectory   (steps + 1) rows, row t = y(t)
+//   rhs history  steps rows,       row r = f(y(r))
+//   kernel       one table of steps weights of the fractional history sum per
+//                distinct order (weightTables(), 1 unless nodes have their own nu),
+//                then as many corrector weights for the predictor-corrector scheme
+// All rows are time-major and padded to a full cache line, so the per-step
+// loops read/write contiguous memory across nodes.
+// The block only grows: keep one arena alive and prepare() it for every run or
+// scan point, and steady-state runs do not touch the allocator.
+class StateArena
+{
+public:
+    static constexpr std::size_t kAlignment = 64;
+
+    // Resets the weight tables to one.
+    void prepare(int nodeCount, int steps);
+    // Grows to newSteps keeping trajectory rows 0..steps() and rhs rows 0..steps()-1.
+    void extend(int newSteps);
+    // Room for `tables` history weight tables; keeps the trajectory and rhs rows.
+    void setWeightTables(int tables);
+    int weightTables() const { return tableCount; }
+
+    int nodeCount() const { return n; }
+    int steps() const { return stepCount; }
+    std::size_t rowStride() const { return stride; }
+    std::size_t capacityDoubles() const { return capacity; }
+    int allocationCount() const { return allocations; }
+
+    double* state(int t) { return block.get() + std::size_t(t) * stride; }
+    const double* state(int t) const { return block.get() + std::size_t(t) * stride; }
+    double at(int t, int i) const { return state(t)[i]; }
+
+    double* rhs(int r) { return block.get() + rhsOffset + std::size_t(r) * stride; }
+    const double* rhs(int r) const { return block.get() + rhsOffset + std::size_t(r) * stride; }
+
+    // Fractional history weights w_k, k = 0..steps-1, in table `table`. Recomputed only
+    // when the kernel, nu or the length changed since the last call for that table.
+    const double* historyWeights(FractionalKernel kernel, double nu, int table = 0);
+    const double* powWeights(double nu) { return historyWeights(FractionalKernel::PowDifference, nu); }
+    // Adams-Moulton corrector weights c_k = (k+2)^(nu+1) + k^(nu+1) - 2 (k+1)^(nu+1),
+    // k = 0..steps-1, cached the same way.
+    const double* correctorWeights(double nu);
+
+private:
+    struct AlignedDelete {
+        void operator()(double* p) const { ::operator delete[](p, std::align_val_t(kAlignment)); }
+    };
+
+    struct WeightCache {
+        bool valid = false;
+        FractionalKernel kernel = FractionalKernel::PowDifference;
+        double nu = 0.0;
+        int count = 0;
+        int allocation = 0;
+    };
+
+    static std::size_t requiredDoubles(std::size_t rowStride, int steps, int tables);
+    void invalidateWeights();
+    void reserveDoubles(std::size_t need, std::size_t keepTrajectory,
+                        std::size_t oldRhsOffset, std::size_t keepRhs,
+                        std::size_t newRhsOffset);
+
+    std::unique_ptr<double[], AlignedDelete> block;
+    std::size_t capacity = 0;
+    std::size_t stride = 0;
+    std::size_t rhsOffset = 0;
+    std::size_t weightOffset = 0;
+    int n = 0;
+    int stepCount = 0;
+    int allocations = 0;
+    int tableCount = 1;
+
+    std::vector<WeightCache> tableCache = std::vector<WeightCache>(1);
+    WeightCache correctorCache;
+};
+
+#endif // STATEARENA_H
@@ -0,0 +1,159 @@
+// Result cache (resultcache.h) and the runner on top of it (simulationrunner.h): restored
+// files are the stored ones, a later run in the same folder never changes a cache entry,
+// and an extended run equals a fresh run of the same length.
+
+#include "resultcache.h"
+#include "simulationrunner.h"
+#include "testsupport.h"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QTemporaryDir>
+
+namespace {
+
+QByteArray readFile(const QString& path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return QByteArray();
+    return f.readAll();
+}
+
+bool writeFile(const QString& path, const QByteArray& data)
+{
+    QFile::remove(path); // never into a file restored from the cache
+    QFile f(path);
+    return f.open(QIODevice::WriteOnly) && f.write(data) == data.size();
+}
+
+QList<QByteArray> readFiles(const QString& dir, const QStringList& files)
+{
+    QList<QByteArray> contents;
+    for (const QString& name : files) contents.append(readFile(dir + "/" + name));
+    return contents;
+}
+
+void testStoreRestore(const QString& root)
+{
+    const QString cacheDir = root + "/cache";
+    const QString runA = root + "/a", runB = root + "/b";
+    QDir().mkpath(runA);
+    QDir().mkpath(runB);
+    const QStringList files = {"result.dat", "state.bin"};
+    CHECK(writeFile(runA + "/result.dat", "1 2 3\n"));
+    CHECK(writeFile(runA + "/state.bin", QByteArray(100, '\x07')));
+
+    NetworkSpec spec = autoPreset5Network();
+    const QString config = ResultCache::canonicalRunConfig("ODE", spec, defaultInitialState(5), 800, 0.01, 0.9);
+    const QString key = ResultCache::keyFor(config);
+    CHECK(key.size() == 64);
+    CHECK(key == ResultCache::keyFor(config));
+
+    // the edge order fixes the summation order, so it is part of the key
+    std::swap(spec.edges[0], spec.edges[1]);
+    CHECK(ResultCache::keyFor(ResultCache::canonicalRunConfig("ODE", spec, defaultInitialState(5), 800, 0.01, 0.9))
+          != key);
+
+    ResultCache cache(cacheDir);
+    CHECK(!cache.restore(key, files, runB));
+    cache.store(key, files, runA, config);
+    CHECK(readFile(cacheDir + "/" + key + "/config.txt") == config.toUtf8());
+    CHECK(cache.restore(key, files, runB));
+    CHECK(readFiles(runB, files) == readFiles(runA, files));
+
+    // a missing file is a miss, not a partial restore
+    QStringList withEvents = files;
+    withEvents << "events.dat";
+    CHECK(!cache.restore(key, withEvents, runB));
+
+    // replacing a restored file (remove + write) leaves the entry alone
+    CHECK(writeFile(runB + "/result.dat", "4 5 6\n"));
+    CHECK(readFile(cacheDir + "/" + key + "/result.dat") == "1 2 3\n");
+    CHECK(readFile(runA + "/result.dat") == "1 2 3\n");
+
+    // least recently used entries go first once the cache is over its size
+    ResultCache small(cacheDir, 1);
+    small.evict();
+    CHECK(!QDir(cacheDir + "/" + key).exists());
+}
+
+SimulationConfig smallRun(int tMax)
+{
+    SimulationConfig config;
+    config.solverMode = "ODE";
+    config.tMax = tMax;
+    config.connections = {{1, 2, "tanh"}, {2, 3, "sin_exp"}, {3, 1, "tanh"}, {5, 4, "sin_exp"}, {1, 5, "tanh"}};
+    for (const ConnectionConfig& c : config.connections)
+        config.weightValues[SimulationConfig::weightKey(c.from, c.to)] = 0.4 + 0.3 * c.from - 0.2 * c.to;
+    return config;
+}
+
+SimulationRunner runnerIn(const QString& base, bool useCache)
+{
+    SimulationRunner runner;
+    runner.baseResultDir = base;
+    runner.useCache = useCache;
+    return runner;
+}
+
+void testRunnerCache(const QString& base)
+{
+    const SimulationConfig shortRun = smallRun(400);
+    const SimulationConfig longRun = smallRun(900);
+    const QStringList files = SimulationRunner::runResultFiles(shortRun);
+
+    SimulationRunner first = runnerIn(base, true);
+    CHECK(first.createRunDir());
+    CHECK(first.computeRun(shortRun) == SimulationRunner::Status::Done);
+    const QList<QByteArray> computed = readFiles(first.runDir, files);
+    CHECK(!computed.first().isEmpty()); // result.dat
+
+    // a cache hit, then extended in place: the restored links are replaced, not rewritten
+    SimulationRunner second = runnerIn(base, true);
+    CHECK(second.createRunDir());
+    CHECK(second.computeRun(shortRun) == SimulationRunner::Status::CacheHit);
+    CHECK(readFiles(second.runDir, files) == computed);
+    CHECK(second.extendRun(longRun) == SimulationRunner::Status::Done);
+    CHECK(readFiles(first.runDir, files) == computed);
+
+    SimulationRunner third = runnerIn(base, true);
+    CHECK(third.createRunDir());
+    CHECK(third.computeRun(shortRun) == SimulationRunner::Status::CacheHit);
+    CHECK(readFiles(third.runDir, files) == computed);
+
+    // the extended run is the fresh run of 900 steps, files included
+    SimulationRunner fresh = runnerIn(base, false);
+    CHECK(fresh.createRunDir());
+    CHECK(fresh.computeRun(longRun) == SimulationRunner::Status::Done);
+    CHECK(readFiles(fresh.runDir, files) == readFiles(second.runDir, files));
+    CHECK(sameRun(fresh.trajectory(), second.trajectory()));
+
+    // and it was stored under the long run's key
+    SimulationRunner fourth = runnerIn(base, true);
+    CHECK(fourth.createRunDir());
+    CHECK(fourth.computeRun(longRun) == SimulationRunner::Status::CacheHit);
+    CHECK(readFiles(fourth.runDir, files) == readFiles(fresh.runDir, files));
+
+    // a recomputed run in a folder holding restored files leaves the entry it came from alone
+    SimulationConfig changed = shortRun;
+    changed.weightValues[SimulationConfig::weightKey(1, 2)] = -0.7;
+    CHECK(third.computeRun(changed) == SimulationRunner::Status::Done);
+    CHECK(readFiles(third.runDir, files) != computed);
+    CHECK(readFiles(first.runDir, files) == computed);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QTemporaryDir tmp;
+    CHECK(tmp.isValid());
+    if (!tmp.isValid()) return testResult("cache");
+    testStoreRestore(tmp.path() + "/store");
+    testRunnerCache(tmp.path() + "/runs");
+    return testResult("cache");
+}
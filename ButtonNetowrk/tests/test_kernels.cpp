@@ -0,0 +1,171 @@
+// Right-hand side kernels: the fixed-topology, bytecode and sparse kernels must give
+// GenericRhsKernel's results bit for bit (rhskernel.h, equationdsl.h, sparsekernel.h).
+
+#include "equationdsl.h"
+#include "networkgenerator.h"
+#include "networksolver.h"
+#include "rhskernel.h"
+#include "sparsekernel.h"
+#include "testsupport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool startsWith(const std::string& text, const std::string& prefix)
+{
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Evaluates every kernel along an Euler trajectory driven by the generic kernel and
+// counts the states where any of them differs from it in a single bit.
+int mismatchingStates(const NetworkSpec& spec, int steps, double h)
+{
+    const int n = spec.nodeCount;
+    GenericRhsKernel generic(spec);
+    BytecodeRhsKernel bytecode(programFromNetwork(spec));
+    std::vector<double> y = defaultInitialState(n), ref(n), dy(n);
+    int bad = 0;
+    for (int t = 0; t < steps; ++t) {
+        generic.eval(y.data(), ref.data());
+        visitRhsKernel(spec, [&](const auto& kernel) { kernel.eval(y.data(), dy.data()); });
+        bool same = sameBits(ref, dy);
+        bytecode.eval(y.data(), dy.data());
+        same = same && sameBits(ref, dy);
+        if (!same) ++bad;
+        for (int i = 0; i < n; ++i) y[i] += h * ref[i];
+    }
+    return bad;
+}
+
+void testFixedKernels()
+{
+    const NetworkSpec preset = autoPreset5Network();
+    CHECK(rhsKernelName(preset) == "autoPreset5+classicGates");
+    CHECK(mismatchingStates(preset, 20000, 0.01) == 0);
+
+    const NetworkSpec paper = paper5Network();
+    CHECK(rhsKernelName(paper) == "paper5+selfGates");
+    CHECK(mismatchingStates(paper, 20000, 0.01) == 0);
+
+    // same topology, terms listed in another order: no fixed kernel, still the generic sums
+    NetworkSpec reversed = preset;
+    std::reverse(reversed.edges.begin(), reversed.edges.end());
+    CHECK(rhsKernelName(reversed) == "generic");
+    CHECK(mismatchingStates(reversed, 20000, 0.01) == 0);
+
+    NetworkSpec swappedGates = paper;
+    swappedGates.edges.push_back({3, 3, 0.0, ActivationKind::None}); // unused edge: still fixed
+    CHECK(rhsKernelName(swappedGates) == "paper5+selfGates");
+    std::swap(swappedGates.gates[0], swappedGates.gates[1]);
+    CHECK(rhsKernelName(swappedGates) == "paper5+selfGates"); // gates on different nodes
+}
+
+void testSpecialValues()
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const std::vector<std::vector<double>> states = {
+        {0.0, -0.0, 0.0, -0.0, 0.0},
+        {-0.0, -0.0, -0.0, -0.0, -0.0},
+        {inf, -inf, 0.5, -0.5, 1.0},
+        {nan, 0.3, -inf, 2.0, -0.0},
+        {1e308, -1e308, 1e-310, -1e-310, 0.0},
+    };
+    for (NetworkSpec spec : {autoPreset5Network(), paper5Network()}) {
+        spec.edges.push_back({2, 3, 0.0, ActivationKind::Tanh}); // weight zero, not folded away
+        spec.edges.push_back({4, 0, -0.0, ActivationKind::Sin});
+        GenericRhsKernel generic(spec);
+        BytecodeRhsKernel bytecode(programFromNetwork(spec));
+        for (const std::vector<double>& y : states) {
+            double ref[5], dy[5];
+            generic.eval(y.data(), ref);
+            bytecode.eval(y.data(), dy);
+            CHECK(sameBits(ref, dy, 5));
+        }
+    }
+}
+
+// A typed equation evaluates like the same expression written in C++.
+void testEquations()
+{
+    const std::string text =
+        "Dy1 = -y1 + 0.5*sin(y2) + (1 - alpha1*tanh(y3))*tanh(y1)\n"
+        "Dy2 = -y2 + s12*tanh(y1) + y2*1 - 0*y3   # identities that must not change the result\n";
+    std::string error;
+    const auto program = compileEquations(text, 3, {{"alpha1", 0.7}, {"s12", 1.3}}, &error);
+    CHECK(program != nullptr);
+    if (!program) return;
+    CHECK(program->nodeCount == 3);
+
+    BytecodeRhsKernel kernel(program);
+    volatile double alpha1 = 0.7, s12 = 1.3; // keep the compiler from rearranging constants
+    std::vector<double> y = {0.8, -0.0, 0.4};
+    for (int t = 0; t < 5000; ++t) {
+        double dy[3];
+        kernel.eval(y.data(), dy);
+        double ref[3];
+        ref[0] = -y[0] + 0.5 * std::sin(y[1]) + (1 - alpha1 * std::tanh(y[2])) * std::tanh(y[0]);
+        ref[1] = -y[1] + s12 * std::tanh(y[0]) + y[1] * 1 - 0 * y[2];
+        ref[2] = -y[2];
+        CHECK(sameBits(ref, dy, 3));
+        if (!sameBits(ref, dy, 3)) break;
+        for (int i = 0; i < 3; ++i) y[i] += 0.01 * dy[i];
+    }
+
+    CHECK(compileEquations("Dy1 = -y1 + alpah1", 1, {{"alpha1", 1.0}}, &error) == nullptr);
+    CHECK(!error.empty());
+}
+
+// Large networks: the CSR kernel sums like the generic kernel for any thread count
+// and node ordering, and the integrators pick it up.
+void testSparseKernel()
+{
+    SparseGraphSettings graph;
+    graph.kind = SparseGraphKind::SmallWorld;
+    graph.nodes = 600;
+    graph.degree = 6;
+    graph.seed = 7;
+    NetworkSpec spec = generateSparseNetwork(graph);
+    spec.gates.push_back({10, 20, 0.5, 0.8, ActivationKind::Sin});
+    spec.gates.push_back({10, 11, 0.2, -0.3, ActivationKind::Tanh});
+    CHECK(startsWith(rhsKernelName(spec), "sparse("));
+
+    const int n = spec.nodeCount;
+    GenericRhsKernel generic(spec);
+    const std::vector<double> y = defaultInitialState(n);
+    std::vector<double> ref(n), dy(n);
+    generic.eval(y.data(), ref.data());
+    for (NodeOrdering ordering : {NodeOrdering::None, NodeOrdering::Rcm, NodeOrdering::Community}) {
+        for (int threads : {1, 3, 8}) {
+            spec.ordering = ordering;
+            SparseRhsKernel sparse(spec, threads);
+            sparse.eval(y.data(), dy.data());
+            CHECK(sameBits(ref, dy));
+        }
+    }
+
+    StateArena serial, parallel;
+    spec.ordering = NodeOrdering::None;
+    spec.threads = 1;
+    integrateEuler(spec, y, 200, 0.01, serial);
+    spec.ordering = NodeOrdering::Rcm;
+    spec.threads = 4;
+    integrateEuler(spec, y, 200, 0.01, parallel);
+    CHECK(sameRun(serial, parallel));
+}
+
+} // namespace
+
+int main()
+{
+    testFixedKernels();
+    testSpecialValues();
+    testEquations();
+    testSparseKernel();
+    return testResult("kernels");
+}
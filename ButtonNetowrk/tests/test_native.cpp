@@ -0,0 +1,87 @@
+// Native right-hand sides (nativekernel.h, nativecompiler.h): the compiled kernel gives the
+// interpreter's results bit for bit, and programs that differ only in their constants
+// share one shared object. Skipped when the host has no working compiler.
+
+#include "equationdsl.h"
+#include "equilibrium.h"
+#include "nativecompiler.h"
+#include "networksolver.h"
+#include "rhskernel.h"
+#include "testsupport.h"
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv); // QProcess / applicationPid()
+    QTemporaryDir tmp;
+    CHECK(tmp.isValid());
+    if (!tmp.isValid()) return testResult("native");
+    NativeCodeCache cache(tmp.path());
+
+    const NetworkSpec spec = autoPreset5Network();
+    const auto program = programFromNetwork(spec);
+    QString message;
+    const std::shared_ptr<const NativeRhs> native = cache.load(*program, &message);
+    if (!native) {
+        std::printf("native: skipped (%s)\n", message.toStdString().c_str());
+        return kTestSkipped;
+    }
+    CHECK(native->nodeCount == 5);
+
+    NetworkSpec nativeSpec = spec;
+    nativeSpec.native = native;
+    CHECK(rhsKernelName(nativeSpec).compare(0, 7, "native(") == 0);
+
+    // rhs along a trajectory, against the interpreter and the generic kernel
+    NativeRhsKernel kernel(native);
+    BytecodeRhsKernel bytecode(program);
+    GenericRhsKernel generic(spec);
+    std::vector<double> y = defaultInitialState(5);
+    int bad = 0;
+    double worstJacobian = 0.0;
+    for (int t = 0; t < 5000; ++t) {
+        double a[5], b[5], c[5];
+        kernel.eval(y.data(), a);
+        bytecode.eval(y.data(), b);
+        generic.eval(y.data(), c);
+        if (!sameBits(a, b, 5) || !sameBits(a, c, 5)) ++bad;
+        if (t % 500 == 0) {
+            double fromCode[25], analytic[25];
+            kernel.jacobian(y.data(), fromCode);
+            CHECK(networkJacobian(spec, y.data(), analytic));
+            for (int k = 0; k < 25; ++k)
+                worstJacobian = std::fmax(worstJacobian, std::fabs(fromCode[k] - analytic[k]));
+        }
+        for (int i = 0; i < 5; ++i) y[i] += 0.01 * a[i];
+    }
+    CHECK(bad == 0);
+    CHECK(worstJacobian < 1e-12);
+
+    StateArena interpreted, compiled;
+    integrateFractional(spec, defaultInitialState(5), 600, 0.8, interpreted);
+    integrateFractional(nativeSpec, defaultInitialState(5), 600, 0.8, compiled);
+    CHECK(sameRun(interpreted, compiled));
+
+    // other weights, same structure: no new compile, the constants travel with the kernel
+    NetworkSpec reweighted = spec;
+    for (EdgeSpec& e : reweighted.edges) e.weight *= -1.5;
+    const auto other = programFromNetwork(reweighted);
+    CHECK(other->structure() == program->structure());
+    const std::shared_ptr<const NativeRhs> again = cache.load(*other, &message);
+    CHECK(again != nullptr);
+    if (again) {
+        CHECK(again->key == native->key);
+        CHECK(message.isEmpty());
+        double a[5], b[5];
+        NativeRhsKernel(again).eval(y.data(), a);
+        GenericRhsKernel(reweighted).eval(y.data(), b);
+        CHECK(sameBits(a, b, 5));
+    }
+    return testResult("native");
+}
@@ -0,0 +1,290 @@
+// Weights and streams: fractional history / corrector weights (statearena.h), the ABM and
+// graded-mesh convergence orders (networksolver.h), Philox and Sobol (sdeensemble.h,
+// uncertainty.h) and the streaming statistics (P^2 quantiles, Welford).
+
+#include "networksolver.h"
+#include "sdeensemble.h"
+#include "testsupport.h"
+#include "uncertainty.h"
+#include "workerpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// (k+2)^p + k^p - 2 (k+1)^p = 2 (k+1)^p sum_m C(p, 2m) x^2m, x = 1 / (k+1), k >= 1: no
+// cancellation, so a reference for the corrector weights (which lose about k eps, the
+// naive form k^2 eps).
+double secondDifference(double p, int k)
+{
+    const double x = 1.0 / (k + 1.0);
+    double binomial = 1.0, power = 1.0, sum = 0.0;
+    for (int j = 1; j < 400; ++j) {
+        binomial *= (p - j + 1) / j;
+        power *= x;
+        if (j % 2 == 0) sum += binomial * power;
+        if (j % 2 == 0 && std::fabs(binomial * power) < 1e-18 * std::fabs(sum)) break;
+    }
+    return 2.0 * std::pow(k + 1.0, p) * sum;
+}
+
+void testHistoryWeights()
+{
+    const int steps = 3000;
+    StateArena arena;
+    arena.prepare(1, steps);
+    for (double nu : {0.3, 0.7, 0.95}) {
+        const double* pow = arena.historyWeights(FractionalKernel::PowDifference, nu);
+        int wrong = 0;
+        for (int k = 0; k < steps; ++k)
+            if (pow[k] != std::pow(k + 1.0, nu) - std::pow(double(k), nu)) ++wrong;
+        CHECK(wrong == 0);
+
+        // recurrence against Gamma(k+nu) / (Gamma(k+1) Gamma(nu))
+        const double* gamma = arena.historyWeights(FractionalKernel::GammaRatio, nu);
+        CHECK(gamma[0] == 1.0);
+        for (int k = 1; k < steps; k += 7) {
+            const double exact = std::exp(std::lgamma(k + nu) - std::lgamma(k + 1.0) - std::lgamma(nu));
+            CHECK_NEAR(gamma[k] / exact, 1.0, 1e-11);
+        }
+
+        const double* corrector = arena.correctorWeights(nu);
+        CHECK_NEAR(corrector[0], std::pow(2.0, nu + 1.0) - 2.0, 1e-15);
+        wrong = 0;
+        for (int k = 1; k < steps; ++k)
+            if (!(std::fabs(corrector[k] / secondDifference(nu + 1.0, k) - 1.0) < 1e-11)) ++wrong;
+        CHECK(wrong == 0);
+    }
+
+    // tables follow a change of kernel, order or length
+    const double first = arena.historyWeights(FractionalKernel::PowDifference, 0.5)[1];
+    CHECK(first == std::pow(2.0, 0.5) - 1.0);
+    arena.prepare(1, 10);
+    CHECK(arena.historyWeights(FractionalKernel::GammaRatio, 0.5)[1] == 0.5);
+}
+
+// Mittag-Leffler E_a(z) by its power series (|z| small enough here).
+double mittagLeffler(double a, double z)
+{
+    double sum = 1.0;
+    for (int k = 1; k < 300; ++k) {
+        const double term = std::exp(k * std::log(std::fabs(z)) - std::lgamma(a * k + 1.0));
+        sum += (z < 0.0 && (k & 1)) ? -term : term;
+        if (term < 1e-18) break;
+    }
+    return sum;
+}
+
+// Leak-only node dy = -y: the fractional solvers integrate y = y0 + Gamma(nu+1) I^nu f,
+// so y(t) = E_nu(-Gamma(nu+1) t^nu).
+double leakSolution(double nu, double t)
+{
+    return mittagLeffler(nu, -std::tgamma(nu + 1.0) * std::pow(t, nu));
+}
+
+double abmError(double nu, int steps, double T)
+{
+    NetworkSpec leak;
+    leak.nodeCount = 1;
+    StateArena arena;
+    integrateFractionalAbm(leak, {1.0}, steps, nu, T / steps, arena);
+    return std::fabs(arena.at(steps, 0) - leakSolution(nu, T));
+}
+
+double gradedError(double nu, int intervals, int steps)
+{
+    NetworkSpec leak;
+    leak.nodeCount = 1;
+    GradedMeshOptions mesh;
+    mesh.gradedIntervals = intervals;
+    mesh.maxStep = steps * gradedMeshExponent(nu, 0.0) / intervals; // the graded part covers 0..steps
+    StateArena arena;
+    integrateFractionalGraded(leak, {1.0}, steps, nu, mesh, arena);
+    return std::fabs(arena.at(steps, 0) - leakSolution(nu, steps));
+}
+
+void testConvergenceOrders()
+{
+    for (double nu : {0.5, 0.8, 1.0}) {
+        const double order = std::log2(abmError(nu, 64, 2.0) / abmError(nu, 256, 2.0)) / 2.0;
+        CHECK(order > fractionalAbmOrder(nu) - 0.15);
+        CHECK(abmError(nu, 256, 2.0) < 2e-5);
+    }
+    for (double nu : {0.5, 0.8}) {
+        const double order = std::log2(gradedError(nu, 64, 2) / gradedError(nu, 256, 2)) / 2.0;
+        CHECK(order > fractionalAbmOrder(nu) - 0.15);
+    }
+}
+
+void testGradedMesh()
+{
+    CHECK(gradedMeshExponent(0.5, 0.0) == 3.0);
+    CHECK(gradedMeshExponent(0.8, 0.0) == 2.25);
+    CHECK(gradedMeshExponent(0.1, 0.0) == kMaxGradedExponent);
+    CHECK(gradedMeshExponent(0.5, 1.5) == 1.5);
+
+    for (int steps : {1, 37, 1000}) {
+        GradedMeshOptions mesh;
+        mesh.gradedIntervals = 64;
+        mesh.maxStep = 0.75;
+        const double r = gradedMeshExponent(0.6, 0.0);
+        const std::vector<double> t = gradedMeshTimes(steps, mesh, r);
+        CHECK(t.front() == 0.0);
+        CHECK(t.back() == double(steps));
+        bool rising = true;
+        for (std::size_t m = 1; m < t.size(); ++m) rising = rising && t[m] > t[m - 1];
+        CHECK(rising);
+    }
+
+    // r = 1, maxStep = 1: the uniform predictor-corrector with h = 1
+    const NetworkSpec spec = autoPreset5Network();
+    const std::vector<double> y0 = defaultInitialState(spec.nodeCount);
+    GradedMeshOptions uniform;
+    uniform.gradedIntervals = 40;
+    uniform.exponent = 1.0;
+    uniform.maxStep = 1.0;
+    StateArena abm, graded;
+    integrateFractionalAbm(spec, y0, 300, 0.6, 1.0, abm);
+    integrateFractionalGraded(spec, y0, 300, 0.6, uniform, graded);
+    double worst = 0.0;
+    for (int t = 0; t <= 300; ++t)
+        for (int i = 0; i < spec.nodeCount; ++i)
+            worst = std::max(worst, std::fabs(abm.at(t, i) - graded.at(t, i)));
+    CHECK(worst < 1e-12);
+}
+
+// Known-answer vectors of the Random123 reference implementation.
+void testPhilox()
+{
+    using Block = std::array<std::uint32_t, 4>;
+    CHECK((philox4x32({0, 0, 0, 0}, {0, 0}) == Block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    CHECK((philox4x32({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff})
+           == Block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    CHECK((philox4x32({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0})
+           == Block{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+
+    // the normals: a pure function of (seed, step, pair, path), about N(0, 1)
+    double sum = 0.0, sumSq = 0.0;
+    const int paths = 20000;
+    for (int p = 0; p < paths; ++p) {
+        double z[2], again[2];
+        sdeNormals(42, 17, 3, p, z);
+        sdeNormals(42, 17, 3, p, again);
+        CHECK(sameBits(z, again, 2));
+        sum += z[0] + z[1];
+        sumSq += z[0] * z[0] + z[1] * z[1];
+    }
+    const double mean = sum / (2.0 * paths);
+    CHECK(std::fabs(mean) < 0.03);
+    CHECK(std::fabs(sumSq / (2.0 * paths) - mean * mean - 1.0) < 0.04);
+}
+
+// 2^m points of the shifted Sobol sequence put one point in every interval of width 2^-m
+// of each dimension, and the first two dimensions form a (0, m, 2)-net.
+void testSobol()
+{
+    const int m = 8, count = 1 << m;
+    std::vector<std::vector<double>> points(count, std::vector<double>(kSobolDimensions));
+    for (int j = 0; j < count; ++j) sobolPoint(std::uint32_t(j), kSobolDimensions, 5, points[j].data());
+
+    for (int d = 0; d < kSobolDimensions; ++d) {
+        std::vector<int> bins(count, 0);
+        bool inside = true;
+        for (const std::vector<double>& u : points) {
+            inside = inside && u[d] > 0.0 && u[d] < 1.0;
+            ++bins[std::min(count - 1, int(u[d] * count))];
+        }
+        CHECK(inside);
+        CHECK(std::all_of(bins.begin(), bins.end(), [](int b) { return b == 1; }));
+    }
+    for (int xBits = 0; xBits <= m; ++xBits) {
+        const int yBits = m - xBits;
+        std::vector<int> boxes(count, 0);
+        for (const std::vector<double>& u : points) {
+            const int bx = int(u[0] * (1 << xBits)), by = int(u[1] * (1 << yBits));
+            ++boxes[(bx << yBits) | by];
+        }
+        CHECK(std::all_of(boxes.begin(), boxes.end(), [](int b) { return b == 1; }));
+    }
+
+    // a different seed shifts the points, the same seed repeats them
+    double a[3], b[3], c[3];
+    sobolPoint(77, 3, 5, a);
+    sobolPoint(77, 3, 5, b);
+    sobolPoint(77, 3, 6, c);
+    CHECK(sameBits(a, b, 3));
+    CHECK(!sameBits(a, c, 3));
+
+    for (double u : {1e-12, 0.001, 0.02425, 0.3, 0.5, 0.9, 0.99999}) {
+        const double x = inverseNormalCdf(u);
+        CHECK_NEAR(0.5 * std::erfc(-x / std::sqrt(2.0)) / u, 1.0, 1e-12);
+    }
+}
+
+void testStreamingStatistics()
+{
+    // P^2 against the exact quantiles of a large sample
+    std::vector<double> sample;
+    for (int j = 0; j < 50000; ++j) {
+        const std::array<std::uint32_t, 4> r = philox4x32({std::uint32_t(j), 0, 0, 0}, {9, 0});
+        const double u = (r[0] + 0.5) / 4294967296.0;
+        sample.push_back(inverseNormalCdf(u) + 0.3 * u * u);
+    }
+    for (double p : {0.05, 0.5, 0.95}) {
+        P2Quantile estimate(p);
+        for (double x : sample) estimate.add(x);
+        std::vector<double> sorted = sample;
+        std::sort(sorted.begin(), sorted.end());
+        const double exact = sorted[std::size_t(p * (sorted.size() - 1))];
+        CHECK(estimate.count() == (long long)sample.size());
+        CHECK_NEAR(estimate.value(), exact, 0.02);
+    }
+
+    P2Quantile few(0.5);
+    for (double x : {3.0, 1.0, 2.0}) few.add(x);
+    CHECK(few.value() == 2.0);
+
+    // Welford mean / variance per cell, the same for any pool size
+    const std::size_t cells = 3;
+    std::vector<double> records;
+    std::vector<int> kept;
+    for (int b = 0; b < 400; ++b) {
+        for (std::size_t c = 0; c < cells; ++c) records.push_back(std::sin(b * 0.37 + double(c)) * (c + 1.0));
+        if (b % 5 != 3) kept.push_back(b);
+    }
+    std::vector<double> mean[2], variance[2], quantile[2];
+    for (int k = 0; k < 2; ++k) {
+        WorkerPool pool(k == 0 ? 1 : 3);
+        EnsembleAccumulator acc;
+        acc.reset(cells, {0.25, 0.75});
+        acc.add(records, kept, pool);
+        CHECK(acc.count() == (long long)kept.size());
+        acc.finish(mean[k], variance[k], quantile[k]);
+    }
+    CHECK(sameBits(mean[0], mean[1]) && sameBits(variance[0], variance[1]) && sameBits(quantile[0], quantile[1]));
+    for (std::size_t c = 0; c < cells; ++c) {
+        double sum = 0.0;
+        for (int b : kept) sum += records[b * cells + c];
+        const double m = sum / kept.size();
+        double ss = 0.0;
+        for (int b : kept) ss += (records[b * cells + c] - m) * (records[b * cells + c] - m);
+        CHECK_NEAR(mean[0][c], m, 1e-12);
+        CHECK_NEAR(variance[0][c], ss / (kept.size() - 1), 1e-12);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testHistoryWeights();
+    testConvergenceOrders();
+    testGradedMesh();
+    testPhilox();
+    testSobol();
+    testStreamingStatistics();
+    return testResult("numerics");
+}
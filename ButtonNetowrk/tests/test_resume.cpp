@@ -0,0 +1,127 @@
+// Extended, resumed and parallel-in-time runs must equal a fresh serial run bit for bit
+// (networksolver.h, runstate.h).
+
+#include "networksolver.h"
+#include "runstate.h"
+#include "testsupport.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int kSteps = 900;
+const int kShortSteps = 350;
+
+void testExtend()
+{
+    const NetworkSpec spec = autoPreset5Network();
+    const std::vector<double> y0 = defaultInitialState(spec.nodeCount);
+    StateArena fresh, extended;
+
+    integrateEuler(spec, y0, kSteps, 0.01, fresh);
+    integrateEuler(spec, y0, kShortSteps, 0.01, extended);
+    CHECK(extendEuler(spec, kSteps, 0.01, extended));
+    CHECK(sameRun(fresh, extended));
+
+    for (FractionalKernel kernel : {FractionalKernel::PowDifference, FractionalKernel::GammaRatio}) {
+        integrateFractional(spec, y0, kSteps, 0.7, fresh, SolverProgressFn(), kernel);
+        integrateFractional(spec, y0, kShortSteps, 0.7, extended, SolverProgressFn(), kernel);
+        CHECK(extendFractional(spec, kSteps, 0.7, extended, SolverProgressFn(), kernel));
+        CHECK(sameRun(fresh, extended));
+    }
+
+    // per-node orders, two of them classical (nu = 1)
+    const std::vector<double> nu = {0.6, 1.0, 0.85, 0.6, 1.0};
+    integrateFractional(spec, y0, kSteps, nu, fresh);
+    integrateFractional(spec, y0, kShortSteps, nu, extended);
+    CHECK(extendFractional(spec, kSteps, nu, extended));
+    CHECK(sameRun(fresh, extended));
+
+    // a single distinct order is the scalar solver
+    StateArena scalar;
+    integrateFractional(spec, y0, kSteps, std::vector<double>(5, 0.7), fresh);
+    integrateFractional(spec, y0, kSteps, 0.7, scalar);
+    CHECK(sameRun(fresh, scalar));
+    CHECK(!integrateFractional(spec, y0, kSteps, std::vector<double>(4, 0.7), fresh));
+
+    integrateFractionalAbm(spec, y0, kSteps, 0.8, 0.5, fresh);
+    integrateFractionalAbm(spec, y0, kShortSteps, 0.8, 0.5, extended);
+    CHECK(extendFractionalAbm(spec, kSteps, 0.8, 0.5, extended));
+    CHECK(sameRun(fresh, extended));
+}
+
+// A run stopped by the progress callback, checkpointed, loaded into another arena and
+// continued ends where the uninterrupted run does.
+void testCheckpointResume()
+{
+    const NetworkSpec spec = paper5Network();
+    const std::vector<double> y0 = defaultInitialState(spec.nodeCount);
+    const std::string path = "test_resume_checkpoint.bin";
+
+    StateArena fresh, stopped, resumed;
+    integrateFractional(spec, y0, kSteps, 0.7, fresh);
+
+    RunStateHeader header;
+    header.solver = RunSolverKind::Fractional;
+    header.nodeCount = spec.nodeCount;
+    header.targetSteps = kSteps;
+    header.nu = 0.7;
+    header.configKey = "test";
+    bool saved = false;
+    const bool finished = integrateFractional(spec, y0, kSteps, 0.7, stopped, [&](int step) {
+        if (step < kShortSteps) return true;
+        header.steps = step - 1;
+        saved = saveRunState(path, header, stopped);
+        return false;
+    });
+    CHECK(!finished);
+    CHECK(saved);
+
+    RunStateHeader onDisk;
+    CHECK(readRunStateHeader(path, onDisk));
+    CHECK(onDisk.steps == header.steps && onDisk.targetSteps == kSteps);
+    CHECK(onDisk.solver == RunSolverKind::Fractional && onDisk.configKey == "test");
+
+    RunStateHeader loaded;
+    CHECK(loadRunState(path, loaded, resumed));
+    CHECK(resumed.steps() == header.steps);
+    CHECK(extendFractional(spec, loaded.targetSteps, loaded.nu, resumed));
+    CHECK(sameRun(fresh, resumed));
+    std::remove(path.c_str());
+
+    CHECK(!loadRunState("test_resume_missing.bin", loaded, resumed));
+}
+
+// After `slices` iterations Parareal is the serial Euler run, whatever the thread count.
+void testParareal()
+{
+    const NetworkSpec spec = autoPreset5Network();
+    const std::vector<double> y0 = defaultInitialState(spec.nodeCount);
+    StateArena serial;
+    integrateEuler(spec, y0, 4000, 0.01, serial);
+
+    for (int threads : {1, 4}) {
+        PararealOptions options;
+        options.slices = 8;
+        options.coarseRatio = 10;
+        options.tolerance = 0.0;
+        options.threads = threads;
+        StateArena parallel;
+        PararealStats stats;
+        CHECK(integrateEulerParareal(spec, y0, 4000, 0.01, options, parallel, &stats));
+        CHECK(stats.exactSlices == options.slices);
+        CHECK(sameRun(serial, parallel));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testExtend();
+    testCheckpointResume();
+    testParareal();
+    return testResult("resume");
+}
@@ -0,0 +1,199 @@
+// Parallel maps and ensembles must not depend on the thread count: basin maps
+// (basinmapper.h), plane scans (planescan.h), SDE ensembles (sdeensemble.h) and
+// uncertainty bands (uncertainty.h), one thread against several, bit for bit.
+
+#include "basinmapper.h"
+#include "networksolver.h"
+#include "planescan.h"
+#include "sdeensemble.h"
+#include "testsupport.h"
+#include "uncertainty.h"
+
+#include <vector>
+
+namespace {
+
+const int kThreads[] = {1, 3, 8};
+
+bool sameAttractors(const BasinMap& a, const BasinMap& b)
+{
+    if (a.attractors.size() != b.attractors.size()) return false;
+    for (std::size_t k = 0; k < a.attractors.size(); ++k) {
+        const BasinAttractor& x = a.attractors[k];
+        const BasinAttractor& y = b.attractors[k];
+        if (x.diverged != y.diverged || x.fixedPoint != y.fixedPoint || x.cells != y.cells
+            || x.unsettledCells != y.unsettledCells || x.firstCell != y.firstCell
+            || !sameBits(&x.meanSteps, &y.meanSteps, 1) || !sameBits(x.low, y.low) || !sameBits(x.high, y.high))
+            return false;
+    }
+    return true;
+}
+
+void testBasins()
+{
+    const NetworkSpec spec = autoPreset5Network();
+    BasinSettings settings;
+    settings.xMin = settings.yMin = -3.0;
+    settings.xMax = settings.yMax = 3.0;
+    settings.width = 24;
+    settings.height = 20;
+
+    BasinMap reference;
+    for (int threads : kThreads) {
+        settings.threads = threads;
+        BasinMap map;
+        CHECK(mapBasins(spec, defaultInitialState(5), 3000, 0.01, settings, map));
+        CHECK(map.label.size() == std::size_t(24 * 20));
+        if (threads == kThreads[0]) {
+            reference = map;
+            CHECK(!map.attractors.empty());
+            continue;
+        }
+        CHECK(map.label == reference.label);
+        CHECK(sameAttractors(map, reference));
+        CHECK(map.eulerSteps == reference.eulerSteps);
+        CHECK(basinImagePpm(map) == basinImagePpm(reference));
+    }
+}
+
+void testPlaneScan()
+{
+    PlaneScanSettings settings;
+    settings.xMin = -4.0;
+    settings.xMax = 4.0;
+    settings.yMin = 0.0;
+    settings.yMax = 3.0;
+    settings.width = 20;
+    settings.height = 18;
+    settings.tileSize = 4;
+
+    PlaneGrid reference;
+    for (int threads : kThreads) {
+        settings.threads = threads;
+        const int workers = planeScanThreads(settings);
+        std::vector<StateArena> arenas(workers);
+        PlaneGrid grid;
+        // x: weight of the 1 -> 2 edge, y: the first gate's coefficient
+        const PlaneCellFn cell = [&](int worker, int row, int col) {
+            NetworkSpec spec = autoPreset5Network();
+            spec.edges[6].weight = grid.cellX(col);
+            spec.gates[0].coeff = grid.cellY(row);
+            StateArena& y = arenas[worker];
+            integrateEuler(spec, defaultInitialState(5), 1500, 0.02, y);
+            return classifyTrajectory(spec, y, 0.02, settings);
+        };
+        CHECK(scanPlane(settings, grid, cell));
+        CHECK(grid.stride == 1);
+        CHECK(grid.computed == 20 * 18);
+        if (threads == kThreads[0]) {
+            reference = grid;
+            continue;
+        }
+        CHECK(planeGridBinary(grid) == planeGridBinary(reference));
+    }
+}
+
+bool sameStats(const EnsembleStats& a, const EnsembleStats& b)
+{
+    return a.rowSteps == b.rowSteps && a.nodes == b.nodes && a.paths == b.paths
+           && a.divergedPaths == b.divergedPaths && sameBits(a.mean, b.mean)
+           && sameBits(a.variance, b.variance) && sameBits(a.quantile, b.quantile);
+}
+
+void testSdeEnsemble()
+{
+    const NetworkSpec spec = paper5Network();
+    for (SdeScheme scheme : {SdeScheme::EulerMaruyama, SdeScheme::Milstein}) {
+        SdeSettings settings;
+        settings.paths = 300;
+        settings.sigma = {0.2, 0.05, 0.1};
+        settings.noise = (scheme == SdeScheme::Milstein) ? NoiseKind::Multiplicative : NoiseKind::Additive;
+        settings.scheme = scheme;
+        settings.seed = 11;
+        settings.recordStride = 50;
+
+        EnsembleStats reference;
+        for (int threads : kThreads) {
+            settings.threads = threads;
+            EnsembleStats stats;
+            CHECK(runSdeEnsemble(spec, defaultInitialState(5), 600, 0.01, settings, stats));
+            if (threads == kThreads[0]) {
+                reference = stats;
+                CHECK(stats.paths + stats.divergedPaths == settings.paths);
+                CHECK(stats.paths > 0 && stats.rowSteps.back() == 600);
+                continue;
+            }
+            CHECK(sameStats(stats, reference));
+        }
+    }
+
+    // no noise: every path is the Euler run, the variance vanishes
+    SdeSettings quiet;
+    quiet.paths = 8;
+    quiet.sigma = {0.0};
+    quiet.observedNodes = 5;
+    EnsembleStats stats;
+    CHECK(runSdeEnsemble(spec, defaultInitialState(5), 400, 0.01, quiet, stats));
+    StateArena euler;
+    integrateEuler(spec, defaultInitialState(5), 400, 0.01, euler);
+    const std::size_t last = stats.rowSteps.size() - 1;
+    for (int i = 0; i < 5; ++i) {
+        CHECK(stats.mean[last * 5 + i] == euler.at(stats.rowSteps[last], i));
+        CHECK(stats.variance[last * 5 + i] == 0.0);
+    }
+}
+
+void testUncertainty()
+{
+    const std::vector<ParameterDistribution> parameters = {
+        {"s21", DistributionKind::Normal, 0.91, 0.1},
+        {"s14", DistributionKind::Uniform, 0.2, 0.5},
+        {"g4coeff", DistributionKind::Normal, 0.7, 0.05},
+    };
+    const UncertaintyModelFn model = [](const std::vector<double>& p, NetworkSpec& spec) {
+        spec = autoPreset5Network();
+        spec.edges[6].weight = p[0];
+        spec.edges[8].weight = p[1];
+        spec.gates[0].coeff = p[2];
+    };
+
+    for (bool sobol : {true, false}) {
+        UncertaintySettings settings;
+        settings.minSamples = 64;
+        settings.maxSamples = 256;
+        settings.sobol = sobol;
+        settings.seed = 3;
+        settings.tolerance = 0.0;
+        settings.recordStride = 40;
+
+        UncertaintyBands reference;
+        for (int threads : kThreads) {
+            settings.threads = threads;
+            UncertaintyBands bands;
+            CHECK(propagateUncertainty(model, parameters, defaultInitialState(5), 500, 0.01, settings, bands));
+            if (threads == kThreads[0]) {
+                reference = bands;
+                CHECK(bands.samples == settings.maxSamples && bands.divergedSamples < bands.samples);
+                CHECK(!bands.converged);
+                continue;
+            }
+            CHECK(bands.rowSteps == reference.rowSteps);
+            CHECK(bands.samples == reference.samples && bands.divergedSamples == reference.divergedSamples);
+            CHECK(sameBits(bands.mean, reference.mean));
+            CHECK(sameBits(bands.variance, reference.variance));
+            CHECK(sameBits(bands.quantile, reference.quantile));
+            CHECK(bands.checks.size() == reference.checks.size());
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testBasins();
+    testPlaneScan();
+    testSdeEnsemble();
+    testUncertainty();
+    return testResult("threads");
+}
@@ -0,0 +1,102 @@
+#ifndef TESTSUPPORT_H
+#define TESTSUPPORT_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "networkspec.h"
+#include "statearena.h"
+
+// Minimal checks for the ctest executables: a failed CHECK prints where and what,
+// the remaining checks still run, and testResult() makes main() return non-zero.
+// Return code 77 marks a test as skipped (SKIP_RETURN_CODE in tests/CMakeLists.txt).
+
+constexpr int kTestSkipped = 77;
+
+inline int& testFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+inline void testFailed(const char* file, int line, const char* what)
+{
+    std::fprintf(stderr, "%s:%d: FAILED %s\n", file, line, what);
+    ++testFailures();
+}
+
+#define CHECK(cond) \
+    do { if (!(cond)) testFailed(__FILE__, __LINE__, #cond); } while (0)
+
+#define CHECK_NEAR(a, b, tol) \
+    do { if (!(std::fabs(double(a) - double(b)) <= double(tol))) { \
+        std::fprintf(stderr, "    %.17g vs %.17g\n", double(a), double(b)); \
+        testFailed(__FILE__, __LINE__, #a " ~ " #b); } } while (0)
+
+inline int testResult(const char* name)
+{
+    if (testFailures() == 0) {
+        std::printf("%s: all checks passed\n", name);
+        return 0;
+    }
+    std::fprintf(stderr, "%s: %d check(s) failed\n", name, testFailures());
+    return 1;
+}
+
+// Bitwise equality (NaN payloads and the sign of zero included).
+inline bool sameBits(const double* a, const double* b, std::size_t n)
+{
+    return std::memcmp(a, b, n * sizeof(double)) == 0;
+}
+
+inline bool sameBits(const std::vector<double>& a, const std::vector<double>& b)
+{
+    return a.size() == b.size() && sameBits(a.data(), b.data(), a.size());
+}
+
+// Trajectory rows 0..steps and rhs rows 0..steps-1 of two arenas, bit for bit.
+inline bool sameRun(const StateArena& a, const StateArena& b)
+{
+    if (a.nodeCount() != b.nodeCount() || a.steps() != b.steps()) return false;
+    const std::size_t n = std::size_t(a.nodeCount());
+    for (int t = 0; t <= a.steps(); ++t)
+        if (!sameBits(a.state(t), b.state(t), n)) return false;
+    for (int r = 0; r < a.steps(); ++r)
+        if (!sameBits(a.rhs(r), b.rhs(r), n)) return false;
+    return true;
+}
+
+// runAutoTestNode5Preset() topology in preset order with the gates disabled (classic
+// gates): matches FixedRhsKernel<AutoPreset5Edges, ClassicGates5>.
+inline NetworkSpec autoPreset5Network()
+{
+    using A = ActivationKind;
+    NetworkSpec spec;
+    spec.nodeCount = 5;
+    spec.edges = {{0, 3, 0.37, A::Sin},  {3, 0, 1.13, A::Tanh}, {0, 2, -0.71, A::Sin}, {2, 0, 0.29, A::Tanh},
+                  {1, 2, 0.53, A::Sin},  {2, 1, -1.7, A::Tanh}, {0, 1, 0.91, A::Tanh}, {1, 0, 0.47, A::Sin},
+                  {1, 4, 0.33, A::Sin},  {4, 1, -0.61, A::Tanh}};
+    spec.gates = {{3, 4, 0.4, 0.7, A::Sin}, {4, 2, 1.0, 0.9, A::Tanh}};
+    return spec;
+}
+
+// Hard-coded GAMMA equations (solver.c) with the default self gates: matches
+// FixedRhsKernel<Paper5Edges, DefaultGates5>.
+inline NetworkSpec paper5Network()
+{
+    using A = ActivationKind;
+    NetworkSpec spec;
+    spec.nodeCount = 5;
+    spec.edges = {{1, 0, -0.3, A::Tanh}, {2, 0, -0.8, A::Sin}, {3, 0, 0.6, A::Sin},
+                  {0, 1, -3.0, A::Sin},  {2, 1, 0.9, A::Sin},  {4, 1, -0.4, A::Sin},
+                  {0, 2, 1.7, A::Tanh},  {1, 2, -1.1, A::Tanh}, {2, 2, 0.2, A::Sin},
+                  {0, 3, 1.3, A::Tanh},
+                  {1, 4, 1.7, A::Tanh}};
+    spec.gates = {{3, 3, 2.23, 1.2, A::Sin}, {4, 4, 1.0, -2.2, A::Tanh}};
+    return spec;
+}
+
+#endif // TESTSUPPORT_H
@@ -0,0 +1,309 @@
+#include "uncertainty.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "rhskernel.h"
+#include "sdeensemble.h"
+#include "workerpool.h"
+
+namespace {
+
+// new-joe-kuo-6.21201, dimensions 2..37: degree s, coefficients a, initial m_1..m_s
+struct SobolPolynomial {
+    int s;
+    unsigned a;
+    unsigned m[7];
+};
+
+const SobolPolynomial kSobolTable[kSobolDimensions - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+    {7, 7, {1, 1, 3, 13, 7, 35, 63}},
+    {7, 8, {1, 3, 5, 9, 1, 25, 53}},
+    {7, 14, {1, 3, 1, 13, 9, 35, 107}},
+    {7, 19, {1, 3, 1, 5, 27, 61, 31}},
+    {7, 21, {1, 1, 5, 11, 19, 41, 61}},
+    {7, 28, {1, 3, 5, 3, 3, 13, 69}},
+    {7, 31, {1, 1, 7, 13, 1, 19, 1}},
+    {7, 32, {1, 3, 7, 5, 13, 19, 59}},
+    {7, 37, {1, 1, 3, 9, 25, 29, 41}},
+    {7, 41, {1, 3, 5, 13, 23, 1, 55}},
+    {7, 42, {1, 3, 7, 3, 13, 59, 17}},
+    {7, 50, {1, 3, 1, 3, 5, 53, 69}},
+    {7, 55, {1, 1, 5, 5, 23, 33, 13}},
+    {7, 56, {1, 1, 7, 7, 1, 61, 123}},
+    {7, 59, {1, 1, 7, 9, 13, 61, 49}},
+    {7, 62, {1, 3, 3, 5, 3, 55, 33}},
+};
+
+// 32 direction numbers v_1..v_32 per dimension (bit 31 = 1/2)
+struct SobolDirections {
+    std::uint32_t v[kSobolDimensions][32];
+
+    SobolDirections()
+    {
+        for (int k = 0; k < 32; ++k) v[0][k] = 1u << (31 - k);
+        for (int d = 1; d < kSobolDimensions; ++d) {
+            const SobolPolynomial& p = kSobolTable[d - 1];
+            std::uint32_t* w = v[d];
+            for (int k = 0; k < 32; ++k) {
+                if (k < p.s) {
+                    w[k] = p.m[k] << (31 - k);
+                    continue;
+                }
+                w[k] = w[k - p.s] ^ (w[k - p.s] >> p.s);
+                for (int j = 1; j < p.s; ++j)
+                    if ((p.a >> (p.s - 1 - j)) & 1u) w[k] ^= w[k - j];
+            }
+        }
+    }
+};
+
+const SobolDirections& sobolDirections()
+{
+    static const SobolDirections directions;
+    return directions;
+}
+
+std::uint32_t mix32(std::uint64_t seed, std::uint64_t salt)
+{
+    std::uint64_t z = seed * 0x9E3779B97F4A7C15ULL + salt * 0xD1B54A32D192ED03ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return std::uint32_t((z ^ (z >> 31)) >> 32);
+}
+
+inline double unitInterval(std::uint32_t x)
+{
+    return (double(x) + 0.5) * (1.0 / 4294967296.0);
+}
+
+// Philox uniforms for sample `index` (pseudo-random mode, or Sobol dimensions past the table)
+void randomPoint(std::uint32_t index, int first, int dims, std::uint64_t seed, double* u)
+{
+    for (int d = first; d < dims; d += 4) {
+        const std::array<std::uint32_t, 4> x = philox4x32({index, std::uint32_t(d), 0x5EEDu, 0u},
+                                                          {std::uint32_t(seed), std::uint32_t(seed >> 32)});
+        for (int k = 0; k < 4 && d + k < dims; ++k) u[d + k] = unitInterval(x[k]);
+    }
+}
+
+int batchSize(std::size_t valuesPerSample)
+{
+    const std::size_t budget = (64u << 20) / sizeof(double);
+    return int(std::max<std::size_t>(1, std::min<std::size_t>(1024, budget / std::max<std::size_t>(1, valuesPerSample))));
+}
+
+// One sample: plain Euler (same arithmetic as integrateEuler), observed nodes copied into
+// `record` per recorded row. False when it diverged.
+template <class Kernel>
+bool integrateSample(const Kernel& kernel, const std::vector<double>& y0, int steps, double h,
+                     const std::vector<int>& rowSteps, int observed, double divergeLimit,
+                     std::vector<double>& y, std::vector<double>& dy, double* record)
+{
+    const int n = kernel.nodeCount();
+    std::copy(y0.begin(), y0.begin() + n, y.begin());
+    std::copy(y.begin(), y.begin() + observed, record);
+    std::size_t row = 1;
+    for (int t = 1; t <= steps; ++t) {
+        kernel.eval(y.data(), dy.data());
+        for (int i = 0; i < n; ++i) y[i] += h * dy[i];
+        for (int i = 0; i < n; ++i)
+            if (!(std::fabs(y[i]) <= divergeLimit)) return false;
+        if (row < rowSteps.size() && rowSteps[row] == t) {
+            std::copy(y.begin(), y.begin() + observed, record + row * observed);
+            ++row;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+double ParameterDistribution::sample(double u) const
+{
+    if (kind == DistributionKind::Uniform) return a + (b - a) * u;
+    return a + b * inverseNormalCdf(u);
+}
+
+void sobolPoint(std::uint32_t index, int dims, std::uint64_t seed, double* u)
+{
+    const SobolDirections& directions = sobolDirections();
+    const int sobolDims = std::min(dims, kSobolDimensions);
+    for (int d = 0; d < sobolDims; ++d) {
+        std::uint32_t x = mix32(seed, std::uint64_t(d) + 1);
+        for (int k = 0; k < 32 && (index >> k); ++k)
+            if ((index >> k) & 1u) x ^= directions.v[d][k];
+        u[d] = unitInterval(x);
+    }
+    randomPoint(index, sobolDims, dims, seed, u);
+}
+
+double inverseNormalCdf(double u)
+{
+    static const double a[6] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02,  -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[5] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01,  -1.328068155288572e+01};
+    static const double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00,  2.938163982698783e+00};
+    static const double d[4] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00};
+    if (!(u > 0.0)) return -std::numeric_limits<double>::infinity();
+    if (!(u < 1.0)) return std::numeric_limits<double>::infinity();
+
+    const double low = 0.02425;
+    double x;
+    if (u < low || u > 1.0 - low) {
+        const double q = std::sqrt(-2.0 * std::log(u < low ? u : 1.0 - u));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+            / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        if (u > low) x = -x;
+    } else {
+        const double q = u - 0.5;
+        const double r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+            / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    }
+    // Halley step on Phi(x) - u: full double precision
+    const double e = 0.5 * std::erfc(-x / std::sqrt(2.0)) - u;
+    const double step = e * std::sqrt(2.0 * 3.14159265358979323846) * std::exp(0.5 * x * x);
+    return x - step / (1.0 + 0.5 * x * step);
+}
+
+bool propagateUncertainty(const UncertaintyModelFn& model, const std::vector<ParameterDistribution>& parameters,
+                          const std::vector<double>& y0, int steps, double h, const UncertaintySettings& settings,
+                          UncertaintyBands& bands, const UncertaintyProgressFn& progress)
+{
+    const auto wallStart = std::chrono::steady_clock::now();
+    bands = UncertaintyBands();
+    bands.settings = settings;
+    bands.parameters = parameters;
+    UncertaintySettings& s = bands.settings;
+    s.maxSamples = std::max(1, s.maxSamples);
+    int firstCheck = 1;
+    while (firstCheck < std::min(std::max(1, s.minSamples), s.maxSamples)) firstCheck *= 2;
+    s.minSamples = std::min(firstCheck, s.maxSamples);
+    if (s.recordStride < 1) s.recordStride = std::max(1, (steps + 999) / 1000);
+
+    for (int t = 0; t <= steps; t += s.recordStride) bands.rowSteps.push_back(t);
+    if (bands.rowSteps.back() != steps) bands.rowSteps.push_back(steps);
+    const int rows = int(bands.rowSteps.size());
+    const int nodeCount = y0.empty() ? 1 : int(y0.size());
+    const int observed = std::max(1, std::min(s.observedNodes, nodeCount));
+    const int qs = int(s.quantiles.size());
+    const int m = int(parameters.size());
+    bands.nodes = observed;
+
+    const std::size_t cells = std::size_t(rows) * observed;
+    EnsembleAccumulator accumulator;
+    accumulator.reset(cells, s.quantiles);
+
+    WorkerPool pool(s.threads > 0 ? s.threads : WorkerPool::hardwareThreads());
+    const int batch = batchSize(cells);
+    std::vector<double> records(std::size_t(batch) * cells);
+    std::vector<char> ok(batch);
+    std::atomic<bool> stop(false);
+    std::atomic<int> samplesDone(0);
+    std::vector<double> previous;
+
+    int drawn = 0;
+    int target = s.minSamples;
+    while (!stop) {
+        for (int first = drawn; first < target && !stop; first += batch) {
+            const int count = std::min(batch, target - first);
+            std::atomic<int> nextSample(0);
+            auto integrateJob = [&](int k) {
+                std::vector<double> u(m), p(m), y, dy;
+                NetworkSpec spec;
+                for (;;) {
+                    const int b = nextSample++;
+                    if (b >= count || stop) break;
+                    const std::uint32_t index = std::uint32_t(first + b);
+                    if (s.sobol) sobolPoint(index, m, s.seed, u.data());
+                    else randomPoint(index, 0, m, s.seed, u.data());
+                    for (int j = 0; j < m; ++j) p[j] = parameters[j].sample(u[j]);
+                    model(p, spec);
+                    spec.threads = 1;
+                    visitRhsKernel(spec, [&](const auto& kernel) {
+                        y.resize(kernel.nodeCount());
+                        dy.resize(kernel.nodeCount());
+                        ok[b] = integrateSample(kernel, y0, steps, h, bands.rowSteps, observed, s.divergeLimit, y, dy,
+                                                &records[std::size_t(b) * cells]);
+                    });
+                    ++samplesDone;
+                    if (k == 0 && progress && !progress(samplesDone)) stop = true;
+                }
+            };
+            pool.run(integrateJob);
+            if (stop) break;
+
+            // feed in sample order
+            std::vector<int> kept;
+            for (int b = 0; b < count; ++b)
+                if (ok[b]) kept.push_back(b);
+                else ++bands.divergedSamples;
+            accumulator.add(records, kept, pool);
+            bands.samples = first + count;
+        }
+        if (stop) break;
+        drawn = target;
+
+        // convergence: quantile change over the last doubling against the widest band
+        std::vector<double> current(cells * qs);
+        double widest = 0.0, largest = 0.0;
+        for (std::size_t c = 0; c < cells; ++c) {
+            double lo = std::numeric_limits<double>::infinity(), hi = -lo;
+            for (int k = 0; k < qs; ++k) {
+                const double q = accumulator.quantile(c, k);
+                current[c * qs + k] = q;
+                lo = std::min(lo, q);
+                hi = std::max(hi, q);
+                largest = std::max(largest, std::fabs(q));
+            }
+            if (qs > 0) widest = std::max(widest, hi - lo);
+        }
+        if (!previous.empty()) {
+            double change = 0.0;
+            for (std::size_t k = 0; k < current.size(); ++k)
+                change = std::max(change, std::fabs(current[k] - previous[k]));
+            UncertaintyCheck check;
+            check.samples = drawn;
+            check.change = change / std::max(widest, 1e-12 * (1.0 + largest));
+            bands.checks.push_back(check);
+            if (s.tolerance > 0.0 && check.change <= s.tolerance && accumulator.count() > 0) {
+                bands.converged = drawn < s.maxSamples;
+                break;
+            }
+        }
+        previous.swap(current);
+        if (drawn >= s.maxSamples) break;
+        target = int(std::min<long long>(2LL * target, s.maxSamples));
+    }
+
+    accumulator.finish(bands.mean, bands.variance, bands.quantile);
+    bands.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    return !stop;
+}
@@ -0,0 +1,87 @@
+#ifndef UNCERTAINTY_H
+#define UNCERTAINTY_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "networkspec.h"
+
+// Monte Carlo propagation of parameter uncertainty (connection weights, alphas ...) through
+// the ODE (Euler) network. Every parameter gets a distribution; sample j draws all of them
+// from point j of a Sobol sequence (Joe-Kuo direction numbers, random digital shift from
+// the seed; dimensions past the table use Philox uniforms), so the quantile bands converge
+// faster than with pseudo-random samples. Samples are integrated in parallel and fed into
+// the streaming statistics of sdeensemble.h in sample order: the bands do not depend on the
+// thread count. Sample counts double from minSamples up to maxSamples (Sobol points are
+// balanced at powers of two); the run stops early once a doubling moved every quantile by
+// less than `tolerance` times the widest band.
+
+enum class DistributionKind { Normal, Uniform };
+
+struct ParameterDistribution {
+    std::string name;
+    DistributionKind kind = DistributionKind::Normal;
+    double a = 0.0;                    // Normal: mean, Uniform: low
+    double b = 0.0;                    // Normal: standard deviation, Uniform: high
+
+    double sample(double u) const;     // u in (0, 1)
+};
+
+struct UncertaintySettings {
+    int minSamples = 256;              // first convergence check (rounded up to a power of two)
+    int maxSamples = 8192;
+    bool sobol = true;                 // false: Philox pseudo-random samples
+    std::uint64_t seed = 1;
+    double tolerance = 0.01;           // early stop; 0: always run maxSamples
+    double relativeSpread = 0.1;       // parameters given without a distribution: sd = spread * |value|
+    int recordStride = 0;              // statistics every recordStride steps; 0: about 1000 rows
+    int observedNodes = 5;
+    std::vector<double> quantiles = {0.05, 0.25, 0.5, 0.75, 0.95};
+    double divergeLimit = 1e6;         // |y_i| above it (or not finite): the sample is dropped
+    int threads = 0;                   // 0: all cores
+};
+
+struct UncertaintyCheck {
+    int samples = 0;
+    double change = 0.0;               // max quantile change since the last check / widest band
+};
+
+struct UncertaintyBands {
+    UncertaintySettings settings;
+    std::vector<ParameterDistribution> parameters;
+    std::vector<int> rowSteps;         // step of each recorded row
+    int nodes = 0;                     // observed nodes
+    // same layout as EnsembleStats: row r, node i at [r * nodes + i], quantile k at [.. * quantiles + k]
+    std::vector<double> mean;
+    std::vector<double> variance;
+    std::vector<double> quantile;
+    int samples = 0;                   // samples drawn (the statistics hold the non-diverged ones)
+    int divergedSamples = 0;
+    bool converged = false;            // stopped by the tolerance before maxSamples
+    std::vector<UncertaintyCheck> checks;
+    double wallSeconds = 0.0;
+};
+
+// Sobol dimensions with direction numbers; further parameters get pseudo-random values.
+constexpr int kSobolDimensions = 37;
+
+// Point `index` of the digitally shifted Sobol sequence in dims dimensions, each in (0, 1).
+void sobolPoint(std::uint32_t index, int dims, std::uint64_t seed, double* u);
+
+// Inverse of the standard normal CDF (Acklam's rational approximation, one Halley step).
+double inverseNormalCdf(double u);
+
+// The network with parameter values p; called on worker threads, so it must not share
+// mutable state.
+using UncertaintyModelFn = std::function<void(const std::vector<double>& p, NetworkSpec& spec)>;
+// Called on the calling thread with the number of finished samples; false cancels.
+using UncertaintyProgressFn = std::function<bool(int samplesDone)>;
+
+// Returns false when cancelled; bands then covers the samples fed so far.
+bool propagateUncertainty(const UncertaintyModelFn& model, const std::vector<ParameterDistribution>& parameters,
+                          const std::vector<double>& y0, int steps, double h, const UncertaintySettings& settings,
+                          UncertaintyBands& bands, const UncertaintyProgressFn& progress = UncertaintyProgressFn());
+
+#endif // UNCERTAINTY_H
@@ -0,0 +1,67 @@
+#include "workerpool.h"
+
+WorkerPool::WorkerPool(int threads)
+{
+    if (threads <= 0) threads = hardwareThreads();
+    for (int k = 1; k < threads; ++k) workers.emplace_back(&WorkerPool::workerLoop, this, k);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+int WorkerPool::hardwareThreads()
+{
+    const unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? int(n) : 1;
+}
+
+void WorkerPool::dispatch(JobFn fn, void* ctx)
+{
+    if (workers.empty()) {
+        fn(ctx, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobFn = fn;
+        jobCtx = ctx;
+        pending = int(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+
+    fn(ctx, 0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+}
+
+void WorkerPool::workerLoop(int index)
+{
+    std::uint64_t seen = 0;
+    for (;;) {
+        JobFn fn;
+        void* ctx;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            fn = jobFn;
+            ctx = jobCtx;
+        }
+
+        fn(ctx, index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) done.notify_one();
+    }
+}
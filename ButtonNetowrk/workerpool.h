@@ -0,0 +1,50 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads for fork-join loops that run many times per second (one RHS
+// evaluation per step): run(job) calls job(k) once for every k in 0..size()-1 and
+// returns when all have finished. The calling thread is worker 0, so a pool of
+// size 1 starts no threads at all. Workers sleep between jobs.
+class WorkerPool
+{
+public:
+    explicit WorkerPool(int threads); // threads <= 0: hardware threads
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int size() const { return int(workers.size()) + 1; }
+
+    template <class Job>
+    void run(Job& job)
+    {
+        dispatch([](void* ctx, int k) { (*static_cast<Job*>(ctx))(k); }, &job);
+    }
+
+    static int hardwareThreads();
+
+private:
+    using JobFn = void (*)(void*, int);
+
+    void dispatch(JobFn fn, void* ctx);
+    void workerLoop(int index);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::uint64_t generation = 0;
+    int pending = 0;
+    bool stopping = false;
+    JobFn jobFn = nullptr;
+    void* jobCtx = nullptr;
+};
+
+#endif // WORKERPOOL_H